@@ -0,0 +1,291 @@
+/**
+ * @file bench.h
+ * @brief Micro-benchmark harness for the host build
+ * @details Each benchmark is one operation, repeated until it has run for a
+ *          minimum time. Reported per operation:
+ *
+ *          - ns_per_op: host wall time, so only comparable on the same machine
+ *          - allocs_per_op / bytes_per_op: calls to operator new and bytes asked
+ *            for, exact and machine independent
+ *          - peak_bytes: most heap held through operator new above the level at
+ *            the start of the run
+ *
+ *          Results go to stdout as a table and, with --json, to a file with one
+ *          benchmark per line. --baseline compares against such a file and
+ *          exits non-zero on a regression. --allocs-only restricts the
+ *          comparison to the allocation figures, which do not depend on the
+ *          machine.
+ *
+ *          It replaces the global operator new, so include it from exactly one
+ *          file per executable.
+ */
+
+#pragma once
+
+#include "host_hal.h"
+#include <malloc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+// --- Allocation accounting -------------------------------------------------
+
+struct BenchAllocStats {
+    uint64_t allocs;
+    uint64_t bytes;
+    int64_t live;       // Bytes held right now
+    int64_t peak;       // Highest `live` since the last benchResetPeak()
+};
+
+inline BenchAllocStats& benchAllocStats() {
+    static BenchAllocStats stats = {};
+    return stats;
+}
+
+inline void benchResetPeak() {
+    benchAllocStats().peak = benchAllocStats().live;
+}
+
+static void* benchAllocate(size_t size) {
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    BenchAllocStats& stats = benchAllocStats();
+    stats.allocs++;
+    stats.bytes += size;
+    stats.live += malloc_usable_size(p);
+    if (stats.live > stats.peak) stats.peak = stats.live;
+    return p;
+}
+
+static void benchFree(void* p) {
+    if (!p) return;
+    benchAllocStats().live -= malloc_usable_size(p);
+    free(p);
+}
+
+void* operator new(size_t size) { return benchAllocate(size); }
+void* operator new[](size_t size) { return benchAllocate(size); }
+void operator delete(void* p) noexcept { benchFree(p); }
+void operator delete[](void* p) noexcept { benchFree(p); }
+void operator delete(void* p, size_t) noexcept { benchFree(p); }
+void operator delete[](void* p, size_t) noexcept { benchFree(p); }
+
+// --- Benchmarks ------------------------------------------------------------
+
+struct Benchmark {
+    std::string name;
+    std::function<void()> op;
+    std::function<void()> setup;    // Runs before timing, not counted
+};
+
+#define BENCH_WARMUP_OPS 16
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations;
+    double nsPerOp;
+    double allocsPerOp;
+    double bytesPerOp;
+    int64_t peakBytes;
+};
+
+inline BenchResult runBenchmark(const Benchmark& bench, double minMs) {
+    if (bench.setup) bench.setup();
+    // Warm caches, first-use statics and containers that grow to a steady size, so the
+    // allocation figures do not depend on how many iterations a slow machine gets to time
+    for (int i = 0; i < BENCH_WARMUP_OPS; i++) bench.op();
+
+    uint64_t iterations = 1;
+    for (;;) {
+        BenchAllocStats before = benchAllocStats();
+        benchResetPeak();
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; i++) bench.op();
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        BenchAllocStats after = benchAllocStats();
+
+        if (elapsed.count() >= minMs || iterations >= (1ULL << 30)) {
+            BenchResult result;
+            result.name = bench.name;
+            result.iterations = iterations;
+            result.nsPerOp = elapsed.count() * 1e6 / iterations;
+            result.allocsPerOp = (double)(after.allocs - before.allocs) / iterations;
+            result.bytesPerOp = (double)(after.bytes - before.bytes) / iterations;
+            result.peakBytes = after.peak - before.live;
+            return result;
+        }
+        // Aim a little past the minimum so the final run usually is the last
+        double perOp = elapsed.count() / iterations;
+        uint64_t next = perOp > 0 ? (uint64_t)(minMs * 1.2 / perOp) : iterations * 10;
+        iterations = std::max(iterations * 2, std::min(next, iterations * 100));
+    }
+}
+
+// --- Result files ----------------------------------------------------------
+
+inline bool writeBenchJson(const char* path, const std::vector<BenchResult>& results) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "{\"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        fprintf(file,
+                "  {\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.1f, \"allocs_per_op\": %.2f, "
+                "\"bytes_per_op\": %.1f, \"peak_bytes\": %lld}%s\n",
+                r.name.c_str(), (unsigned long long)r.iterations, r.nsPerOp, r.allocsPerOp, r.bytesPerOp,
+                (long long)r.peakBytes, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "]}\n");
+    fclose(file);
+    return true;
+}
+
+/**
+ * @brief Read a file written by writeBenchJson()
+ */
+inline bool readBenchJson(const char* path, std::map<std::string, BenchResult>& results) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        char name[128];
+        BenchResult r;
+        unsigned long long iterations;
+        long long peak;
+        if (sscanf(line,
+                   " {\"name\": \"%127[^\"]\", \"iterations\": %llu, \"ns_per_op\": %lf, \"allocs_per_op\": %lf, "
+                   "\"bytes_per_op\": %lf, \"peak_bytes\": %lld}",
+                   name, &iterations, &r.nsPerOp, &r.allocsPerOp, &r.bytesPerOp, &peak) == 6) {
+            r.name = name;
+            r.iterations = iterations;
+            r.peakBytes = peak;
+            results[r.name] = r;
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+// --- Runner ----------------------------------------------------------------
+
+struct BenchOptions {
+    const char* jsonPath = nullptr;
+    const char* baselinePath = nullptr;
+    const char* filter = nullptr;
+    double minMs = 200;
+    double timeTolerance = 0.25;    // Allowed ns/op growth over the baseline
+    bool allocsOnly = false;
+};
+
+inline void printBenchUsage(const char* program) {
+    fprintf(stderr,
+            "usage: %s [--json FILE] [--baseline FILE] [--filter TEXT] [--min-ms N]\n"
+            "          [--tolerance FRACTION] [--allocs-only] [--quick]\n",
+            program);
+}
+
+inline bool parseBenchOptions(int argc, char** argv, BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        } else if (arg == "--baseline" && hasValue) {
+            options.baselinePath = argv[++i];
+        } else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--min-ms" && hasValue) {
+            options.minMs = atof(argv[++i]);
+        } else if (arg == "--tolerance" && hasValue) {
+            options.timeTolerance = atof(argv[++i]);
+        } else if (arg == "--allocs-only") {
+            options.allocsOnly = true;
+        } else if (arg == "--quick") {
+            options.minMs = 5;
+        } else {
+            printBenchUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Compare a result with its baseline
+ * @return Why it regressed, or empty
+ */
+inline std::string benchRegression(const BenchResult& r, const BenchResult& base, const BenchOptions& options) {
+    char reason[160];
+    // Half an allocation: a new one on every call shows, a retry now and then does not
+    if (r.allocsPerOp > base.allocsPerOp + 0.5) {
+        snprintf(reason, sizeof(reason), "allocs/op %.2f > %.2f", r.allocsPerOp, base.allocsPerOp);
+        return reason;
+    }
+    if (r.peakBytes > base.peakBytes + base.peakBytes / 10 + 256) {
+        snprintf(reason, sizeof(reason), "peak %lld > %lld bytes", (long long)r.peakBytes, (long long)base.peakBytes);
+        return reason;
+    }
+    if (!options.allocsOnly && r.nsPerOp > base.nsPerOp * (1 + options.timeTolerance)) {
+        snprintf(reason, sizeof(reason), "ns/op %.0f > %.0f +%.0f%%", r.nsPerOp, base.nsPerOp,
+                 options.timeTolerance * 100);
+        return reason;
+    }
+    return "";
+}
+
+/**
+ * @brief Run the benchmarks, print and save the results, compare with the baseline
+ * @return Process exit code: 0, or 1 on a regression or a bad argument
+ */
+inline int runBenchmarks(int argc, char** argv, const std::vector<Benchmark>& benchmarks) {
+    BenchOptions options;
+    if (!parseBenchOptions(argc, argv, options)) return 1;
+
+    std::map<std::string, BenchResult> baseline;
+    if (options.baselinePath && !readBenchJson(options.baselinePath, baseline)) {
+        fprintf(stderr, "cannot read baseline %s\n", options.baselinePath);
+        return 1;
+    }
+
+    printf("%-36s %12s %10s %12s %12s  %s\n", "benchmark", "ns/op", "allocs/op", "bytes/op", "peak bytes",
+           options.baselinePath ? "vs baseline" : "");
+    std::vector<BenchResult> results;
+    int regressions = 0;
+    for (const Benchmark& bench : benchmarks) {
+        if (options.filter && bench.name.find(options.filter) == std::string::npos) continue;
+        BenchResult r = runBenchmark(bench, options.minMs);
+        results.push_back(r);
+
+        std::string comparison;
+        auto base = baseline.find(r.name);
+        if (base != baseline.end()) {
+            std::string regression = benchRegression(r, base->second, options);
+            if (!regression.empty()) {
+                regressions++;
+                comparison = "REGRESSION: " + regression;
+            } else {
+                char change[32];
+                snprintf(change, sizeof(change), "%+.0f%% time", (r.nsPerOp / base->second.nsPerOp - 1) * 100);
+                comparison = change;
+            }
+        } else if (options.baselinePath) {
+            comparison = "new";
+        }
+        printf("%-36s %12.1f %10.2f %12.1f %12lld  %s\n", r.name.c_str(), r.nsPerOp, r.allocsPerOp, r.bytesPerOp,
+               (long long)r.peakBytes, comparison.c_str());
+    }
+
+    if (options.jsonPath && !writeBenchJson(options.jsonPath, results)) {
+        fprintf(stderr, "cannot write %s\n", options.jsonPath);
+        return 1;
+    }
+    if (regressions) fprintf(stderr, "%d regression(s) against %s\n", regressions, options.baselinePath);
+    return regressions ? 1 : 0;
+}
@@ -0,0 +1,182 @@
+// Host micro-benchmarks for the catalog, program and web paths.
+//
+// Each benchmark is one call the firmware makes, run against an SD card in a
+// temporary directory. See bench.h for what is measured and the options.
+//
+//   cmake -S host -B build/host && cmake --build build/host --target firmware_bench
+//   ./build/host/firmware_bench --json bench.json --baseline host/bench/baseline.json
+//
+// Refresh the baseline after an intended change, on the machine it is compared on:
+//   ./build/host/firmware_bench --json host/bench/baseline.json
+
+#include "bench.h"
+#include "host_fixtures.h"
+#include <Arduino.h>
+#include <SD.h>
+#include <WebServer.h>
+#include "config/config.h"
+#include "config/json_data.h"
+#include "hardware/volume_control.h"
+#include "managers/generative_manager.h"
+#include "managers/program_events.h"
+#include "managers/shuffle_manager.h"
+#include "web/asset_bundle.h"
+#include "web/json_writer.h"
+#include "web/template_renderer.h"
+#include "web/web_routes.h"
+#include "web/web_utils.h"
+
+extern WebServer server;
+
+/**
+ * @brief data.json with `musicFiles` entries in "music", as scan_sd_card.py writes it
+ */
+static std::string makeDataJson(size_t musicFiles) {
+    std::string json = "{\n    \"field\": {\"files\": [\"rain.mp3\"]},\n    \"music\": {\"files\": [";
+    char name[48];
+    for (size_t i = 0; i < musicFiles; i++) {
+        snprintf(name, sizeof(name), "%s\"track_%05zu.mp3\"", i ? ", " : "", i);
+        json += name;
+    }
+    json += "]},\n    \"soundfont\": {\"piano\": {\"files\": [\"c4.mp3\", \"e4.mp3\", \"g4.mp3\"]}}\n}\n";
+    return json;
+}
+
+/**
+ * @brief SD card with data.json listing `entries` tracks and a /music folder of `tracks` files
+ */
+static std::string makeCard(size_t entries, size_t tracks) {
+    std::string root = hostMakeSdCard();
+    hostWriteFile(root, "/data.json", makeDataJson(entries));
+    char path[64];
+    for (size_t i = 0; i < tracks; i++) {
+        snprintf(path, sizeof(path), "/music/track_%05zu.mp3", i);
+        hostWriteFile(root, path, "");
+    }
+    return root;
+}
+
+static std::vector<Benchmark> catalogBenchmarks() {
+    std::vector<Benchmark> benchmarks;
+    for (size_t entries : {100, 1000, 10000}) {
+        std::string root = makeCard(entries, 0);
+        benchmarks.push_back({"getDataFilesFromJSON/" + std::to_string(entries),
+                              [] { getDataFilesFromJSON("music"); },
+                              [root] { hostSetSdRoot(root); }});
+    }
+    return benchmarks;
+}
+
+static std::vector<Benchmark> programBenchmarks() {
+    std::vector<Benchmark> benchmarks;
+    std::string soundfontCard = hostMakeSdCard();
+
+    // A new 120-note sequence and its first note, as after a field sound
+    benchmarks.push_back({"generative/sequence",
+                          [] {
+                              regenerateSequence();
+                              handleGenerativeEvent({PROGRAM_EVENT_TIMER, 0, nullptr});
+                          },
+                          [soundfontCard] { hostSetSdRoot(soundfontCard); }});
+
+    for (size_t tracks : {100, 1000}) {
+        std::string root = makeCard(0, tracks);
+        benchmarks.push_back({"shuffle/build/" + std::to_string(tracks),
+                              [] { buildShuffleQueue("/music"); },
+                              [root] { hostSetSdRoot(root); }});
+    }
+    std::string root = makeCard(0, 1000);
+    benchmarks.push_back({"shuffle/next/1000",
+                          [] { playNextShuffleTrack(); },
+                          [root] {
+                              hostSetSdRoot(root);
+                              buildShuffleQueue("/music");
+                          }});
+    return benchmarks;
+}
+
+static bool resolveBenchVariable(const char* name, char* value, size_t valueSize) {
+    if (strcmp(name, "VOLUME") == 0 || strcmp(name, "UPTIME") == 0 || strcmp(name, "FREE_HEAP") == 0) {
+        snprintf(value, valueSize, "%d", 12345);
+        return true;
+    }
+    return false;
+}
+
+static void countBytes(const char* data, size_t length, void* context) {
+    *(size_t*)context += length;
+}
+
+static std::vector<Benchmark> webBenchmarks() {
+    std::vector<Benchmark> benchmarks;
+
+    benchmarks.push_back({"getStatusJson/cached", [] {
+                              size_t length;
+                              getStatusJson(&length);
+                          }});
+    benchmarks.push_back({"getStatusJson/render", [] {
+                              static int volume = 0;
+                              setVolume(volume ^= 1);   // A new volume, so the cache misses
+                              size_t length;
+                              getStatusJson(&length);
+                          }});
+
+    benchmarks.push_back({"JsonWriter/object", [] {
+                              char buffer[STATUS_JSON_SIZE];
+                              JsonWriter json(buffer, sizeof(buffer));
+                              json.beginObject()
+                                  .numberField("volume", 12)
+                                  .stringFieldf("ip", "%u.%u.%u.%u", 192, 168, 4, 1)
+                                  .stringField("program", "GENERATIVE")
+                                  .boolField("audioRunning", true)
+                                  .key("recent")
+                                  .beginArray()
+                                  .stringValue("/music/one.mp3")
+                                  .stringValue("/music/two \"live\".mp3")
+                                  .endArray()
+                                  .endObject();
+                          }});
+
+    // The page handleRoot() serves, fed the way sendHTMLPage() feeds it
+    benchmarks.push_back({"TemplateRenderer/index.html", [] {
+                              const BundledAsset* page = findBundledAsset("/index.html");
+                              if (!page || page->gzip) return;
+                              size_t written = 0;
+                              TemplateRenderer renderer(resolveBenchVariable, countBytes, &written);
+                              for (uint32_t offset = 0; offset < page->length; offset += TEMPLATE_READ_CHUNK) {
+                                  uint32_t length = min((uint32_t)TEMPLATE_READ_CHUNK, page->length - offset);
+                                  renderer.feed((const char*)page->data + offset, length);
+                              }
+                              renderer.finish();
+                          }});
+
+    // Whole requests through the WebServer and the route table
+    const char* uris[] = {"/status", "/program/status", "/", "/no/such/file"};
+    for (const char* uri : uris) {
+        HostRequest request;
+        request.uri = uri;
+        benchmarks.push_back({std::string("dispatch") + uri, [request] { hostRequest(request); }});
+    }
+    // Neither a route nor a GET for a static file: the 404 handler
+    HostRequest post;
+    post.method = "POST";
+    post.uri = "/no/such/route";
+    benchmarks.push_back({"dispatch/POST/no/such/route", [post] { hostRequest(post); }});
+    return benchmarks;
+}
+
+int main(int argc, char** argv) {
+    hostReset();
+    hostSeedRandom(1);
+    std::string card = hostMakeSdCard();
+    hostSetSdRoot(card);
+    SD.begin(SS);
+    setupWebRoutes();
+    server.begin();
+
+    std::vector<Benchmark> benchmarks;
+    for (auto group : {catalogBenchmarks, programBenchmarks, webBenchmarks}) {
+        for (Benchmark& bench : group()) benchmarks.push_back(std::move(bench));
+    }
+    return runBenchmarks(argc, argv, benchmarks);
+}
@@ -0,0 +1,85 @@
+// Host benchmark for the meme overlay mix path.
+//
+// Runs OverlayMixer::push() and mix() the way the audio loop does, one program
+// block at a time, and reports the cost per block against the block's playing
+// time. The ESP32 runs this path at a fraction of host speed, so the budget
+// column is what matters: it must stay a small share of real time.
+//
+// Build and run from the repository root:
+//   cmake -S host -B build/host && cmake --build build/host --target overlay_mixer_bench
+//   ./build/host/overlay_mixer_bench
+
+#include "hardware/audio_mixer.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static const size_t BLOCK_FRAMES = 1152;   // One MP3 frame of program audio
+static const uint32_t PROGRAM_RATE = 44100;
+static const int BLOCKS = 20000;
+
+struct Scenario {
+    const char* name;
+    uint32_t memeRate;
+    int memeChannels;
+};
+
+static void fillSine(std::vector<int16_t>& samples, int channels, uint32_t rate, float hz) {
+    for (size_t i = 0; i < samples.size() / channels; i++) {
+        int16_t value = (int16_t)(12000 * sinf(2 * 3.14159265f * hz * i / rate));
+        for (int c = 0; c < channels; c++) samples[i * channels + c] = value;
+    }
+}
+
+int main() {
+    const Scenario scenarios[] = {
+        {"44.1 kHz stereo meme (no resampling)", 44100, 2},
+        {"22.05 kHz mono meme (upsampled)", 22050, 1},
+        {"48 kHz stereo meme (downsampled)", 48000, 2},
+    };
+
+    std::vector<int16_t> overlayBuffer(4608 * 2);
+    std::vector<int16_t> program(BLOCK_FRAMES * 2);
+    double blockUs = BLOCK_FRAMES * 1e6 / PROGRAM_RATE;
+
+    printf("%-40s %12s %12s %10s\n", "scenario", "ns/frame", "us/block", "budget");
+    for (const Scenario& scenario : scenarios) {
+        OverlayMixer mixer;
+        mixer.begin(overlayBuffer.data(), 4608);
+        mixer.setOutputRate(PROGRAM_RATE);
+        mixer.setDucking(attenuationToGainQ15(12.0f), PROGRAM_RATE * 30 / 1000, PROGRAM_RATE * 400 / 1000);
+
+        // Meme input in decoder-sized pieces, covering one program block per push
+        size_t memeFrames = BLOCK_FRAMES * scenario.memeRate / PROGRAM_RATE;
+        std::vector<int16_t> meme(memeFrames * scenario.memeChannels);
+        fillSine(meme, scenario.memeChannels, scenario.memeRate, 660.0f);
+
+        int64_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int block = 0; block < BLOCKS; block++) {
+            if (block % 200 == 0) mixer.start();  // A new meme every ~5 s, so attack ramps are included
+            fillSine(program, 2, PROGRAM_RATE, 220.0f);
+            if (mixer.freeFrames() >= BLOCK_FRAMES * 2) {
+                mixer.push(meme.data(), memeFrames, scenario.memeChannels, scenario.memeRate);
+            }
+            mixer.mix(program.data(), BLOCK_FRAMES);
+            checksum += program[block % program.size()];
+        }
+        double elapsedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        // Subtract the cost of generating the program block
+        auto fillStart = std::chrono::steady_clock::now();
+        for (int block = 0; block < BLOCKS; block++) {
+            fillSine(program, 2, PROGRAM_RATE, 220.0f);
+            checksum += program[block % program.size()];
+        }
+        double fillUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - fillStart).count();
+
+        double perBlockUs = (elapsedUs - fillUs) / BLOCKS;
+        printf("%-40s %12.2f %12.2f %9.3f%%   (dropped %u, checksum %lld)\n", scenario.name,
+               perBlockUs * 1000 / BLOCK_FRAMES, perBlockUs, 100 * perBlockUs / blockUs,
+               mixer.droppedFrames(), (long long)checksum);
+    }
+    return 0;
+}
@@ -0,0 +1,279 @@
+/**
+ * @file Arduino.cpp
+ * @brief Arduino core, ESP and ESP-IDF helpers for the host build
+ */
+
+#include "Arduino.h"
+#include "host_hal.h"
+#include "host_internal.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "esp_random.h"
+#include <chrono>
+#include <malloc.h>
+#include <string>
+
+#define HOST_INTERNAL_HEAP_BYTES (320 * 1024)
+#define HOST_PSRAM_BYTES (4 * 1024 * 1024)
+#define HOST_FLASH_BYTES (4 * 1024 * 1024)
+#define HOST_SKETCH_BYTES (1280 * 1024)
+#define HOST_SERIAL_KEEP (64 * 1024)
+
+EspClass ESP;
+HardwareSerial Serial;
+
+static bool serialEcho = false;
+static std::string serialOutput;
+static size_t heapBaseline = 0;
+static size_t minFreeHeap = HOST_INTERNAL_HEAP_BYTES;
+static uint32_t restarts = 0;
+
+// --- Timing ----------------------------------------------------------------
+
+uint32_t millis() {
+    return (uint32_t)(hostNowUs() / 1000);
+}
+
+uint32_t micros() {
+    return (uint32_t)hostNowUs();
+}
+
+void delay(uint32_t ms) {
+    hostSleepUs((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+    // Busy-waits on the device, so other tasks do not get to run
+    hostAdvanceUs(us);
+}
+
+void yield() {
+    taskYIELD();
+}
+
+uint32_t getCpuFrequencyMhz() {
+    return 1000;
+}
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count() {
+    return (esp_cpu_cycle_count_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1, const char* server2,
+                const char* server3) {}
+
+// --- Random ----------------------------------------------------------------
+
+long random(long max) {
+    return max > 0 ? (long)(hostRandom32() % (uint32_t)max) : 0;
+}
+
+long random(long min, long max) {
+    return min >= max ? min : min + random(max - min);
+}
+
+void randomSeed(unsigned long seed) {
+    // Sessions stay reproducible: the seed comes from esp_random(), which is seeded by hostSeedRandom()
+    if (seed) hostSeedRandom((uint32_t)seed);
+}
+
+uint32_t esp_random() {
+    return hostRandom32();
+}
+
+// --- Pins ------------------------------------------------------------------
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+void digitalWrite(uint8_t pin, uint8_t value) {}
+int digitalRead(uint8_t pin) {
+    return LOW;
+}
+
+#ifdef HOST_NEEDS_STRLCPY
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t length = strlen(src);
+    if (size) {
+        size_t n = length < size - 1 ? length : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = 0;
+    }
+    return length;
+}
+#endif
+
+// --- Heap ------------------------------------------------------------------
+
+// Internal RAM is the nominal ESP32 heap minus what the host process has
+// allocated since hostReset(), so leaks and growth show up in the numbers.
+// Task stacks count at the size the firmware asked for, as on the device.
+static size_t internalUsed() {
+    size_t used = mallinfo2().uordblks;
+    return (used > heapBaseline ? used - heapBaseline : 0) + hostTaskStackBytes();
+}
+
+static size_t freeSize(uint32_t caps) {
+    if (caps & MALLOC_CAP_SPIRAM) return HOST_PSRAM_BYTES;
+    size_t used = internalUsed();
+    size_t free = used < HOST_INTERNAL_HEAP_BYTES ? HOST_INTERNAL_HEAP_BYTES - used : 0;
+    if (free < minFreeHeap) minFreeHeap = free;
+    return free;
+}
+
+void* heap_caps_malloc(size_t size, uint32_t caps) {
+    return malloc(size);
+}
+
+void* heap_caps_calloc(size_t count, size_t size, uint32_t caps) {
+    return calloc(count, size);
+}
+
+void heap_caps_free(void* ptr) {
+    free(ptr);
+}
+
+size_t heap_caps_get_allocated_size(void* ptr) {
+    return malloc_usable_size(ptr);
+}
+
+size_t heap_caps_get_total_size(uint32_t caps) {
+    return caps & MALLOC_CAP_SPIRAM ? HOST_PSRAM_BYTES : HOST_INTERNAL_HEAP_BYTES;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    return freeSize(caps);
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+    return freeSize(caps);
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+    if (caps & MALLOC_CAP_SPIRAM) return HOST_PSRAM_BYTES;
+    freeSize(caps);
+    return minFreeHeap;
+}
+
+bool psramFound() {
+    return true;
+}
+
+void* ps_malloc(size_t size) {
+    return malloc(size);
+}
+
+void* ps_calloc(size_t count, size_t size) {
+    return calloc(count, size);
+}
+
+void* ps_realloc(void* ptr, size_t size) {
+    return realloc(ptr, size);
+}
+
+uint32_t esp_get_free_heap_size() {
+    return freeSize(MALLOC_CAP_INTERNAL);
+}
+
+uint32_t esp_get_minimum_free_heap_size() {
+    return heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+}
+
+// --- ESP -------------------------------------------------------------------
+
+uint32_t EspClass::getHeapSize() {
+    return HOST_INTERNAL_HEAP_BYTES;
+}
+
+uint32_t EspClass::getFreeHeap() {
+    return freeSize(MALLOC_CAP_INTERNAL);
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+    return heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+    return freeSize(MALLOC_CAP_INTERNAL);
+}
+
+uint32_t EspClass::getPsramSize() {
+    return HOST_PSRAM_BYTES;
+}
+
+uint32_t EspClass::getFreePsram() {
+    return HOST_PSRAM_BYTES;
+}
+
+uint32_t EspClass::getFlashChipSize() {
+    return HOST_FLASH_BYTES;
+}
+
+uint32_t EspClass::getSketchSize() {
+    return HOST_SKETCH_BYTES;
+}
+
+uint32_t EspClass::getFreeSketchSpace() {
+    return HOST_FLASH_BYTES / 2 - HOST_SKETCH_BYTES;
+}
+
+void EspClass::restart() {
+    esp_restart();
+}
+
+void esp_restart() {
+    restarts++;
+    fprintf(stderr, "[host] restart requested at %llu ms, stopping all tasks\n",
+            (unsigned long long)(hostNowUs() / 1000));
+    hostHaltTasks();
+}
+
+uint32_t hostGetRestarts() {
+    return restarts;
+}
+
+// --- Serial ----------------------------------------------------------------
+
+size_t HardwareSerial::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    serialOutput.append((const char*)buffer, size);
+    if (serialOutput.size() > 2 * HOST_SERIAL_KEEP) {
+        serialOutput.erase(0, serialOutput.size() - HOST_SERIAL_KEEP);
+    }
+    if (serialEcho) fwrite(buffer, 1, size, stdout);
+    return size;
+}
+
+void hostSetSerialEcho(bool echo) {
+    serialEcho = echo;
+}
+
+std::string hostTakeSerialOutput() {
+    std::string output;
+    output.swap(serialOutput);
+    if (output.size() > HOST_SERIAL_KEEP) output.erase(0, output.size() - HOST_SERIAL_KEEP);
+    return output;
+}
+
+void hostResetSerial() {
+    serialOutput.clear();
+    serialEcho = false;
+}
+
+// --- Reset -----------------------------------------------------------------
+
+void hostReset() {
+    hostResetScheduler();
+    hostResetFaults();
+    hostResetSd();
+    hostResetAudio();
+    hostResetNetwork();
+    hostResetWebServer();
+    hostResetSerial();
+    hostResetPreferences();
+    restarts = 0;
+    heapBaseline = mallinfo2().uordblks;
+    minFreeHeap = HOST_INTERNAL_HEAP_BYTES;
+}
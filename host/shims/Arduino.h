@@ -0,0 +1,138 @@
+/**
+ * @file Arduino.h
+ * @brief Arduino core for the host build
+ * @details Pulls in what the ESP32 core's Arduino.h makes visible to the
+ *          firmware: the C library, String, Print/Stream, FreeRTOS and the
+ *          ESP, Serial and timing helpers.
+ */
+
+#pragma once
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <type_traits>
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "IPAddress.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_system.h"
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define LED_BUILTIN 2   // NodeMCU-32S
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(s))
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#define strlen_P strlen
+#define memcpy_P memcpy
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// The ESP32 core uses std::min/max, where uint32_t and unsigned long are the
+// same type. On a 64-bit host they are not, so mixed arguments meet at their
+// common type instead of failing to deduce.
+template <typename A, typename B>
+constexpr typename std::common_type<A, B>::type min(const A& a, const B& b) {
+    return b < a ? b : a;
+}
+template <typename A, typename B>
+constexpr typename std::common_type<A, B>::type max(const A& a, const B& b) {
+    return a < b ? b : a;
+}
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+// 32-bit like the target, so differences wrap the way they do on the device (micros() every 71 min)
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+bool psramFound();
+void* ps_malloc(size_t size);
+void* ps_calloc(size_t count, size_t size);
+void* ps_realloc(void* ptr, size_t size);
+
+uint32_t getCpuFrequencyMhz();
+
+// SNTP is not modelled: time() is the host's wall clock
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char* server1, const char* server2 = nullptr,
+                const char* server3 = nullptr);
+
+// glibc has strlcpy from 2.38 on
+#if defined(__GLIBC__)
+#if !__GLIBC_PREREQ(2, 38)
+#define HOST_NEEDS_STRLCPY 1
+size_t strlcpy(char* dst, const char* src, size_t size);
+#endif
+#endif
+
+class EspClass {
+public:
+    uint32_t getHeapSize();
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getPsramSize();
+    uint32_t getFreePsram();
+    uint32_t getFlashChipSize();
+    uint32_t getSketchSize();
+    uint32_t getFreeSketchSpace();
+    uint32_t getCpuFreqMHz() { return getCpuFrequencyMhz(); }
+    const char* getSdkVersion() { return "host"; }
+    void restart();
+};
+
+extern EspClass ESP;
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) {}
+    void end() {}
+    operator bool() const { return true; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+    int availableForWrite() override { return 4096; }
+};
+
+extern HardwareSerial Serial;
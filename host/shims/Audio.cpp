@@ -0,0 +1,439 @@
+/**
+ * @file Audio.cpp
+ * @brief Timing model of ESP32-audioI2S on the virtual clock
+ */
+
+#include "Audio.h"
+#include "host_hal.h"
+#include "host_internal.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+// Defined by the firmware's audio pipeline; weak like the library's own hook
+extern void audio_process_extern(int16_t* buff, uint16_t len, bool* continueI2S) __attribute__((weak));
+
+#define BLOCK_FRAMES 1152                 // One MP3 frame
+#define IN_BUFFER_BYTES (64 * 1024)      // Compressed input buffer of the library
+#define DEFAULT_RATE 44100
+
+enum DecodeResult { DECODE_STARVED = 0, DECODE_ENDED = -1, DECODE_LOST = -2, DECODE_SKIPPED = -3 };
+
+static uint32_t dmaFrames = 8192;
+static uint32_t bitrate = 128000;
+static HostAudioStats stats = {};
+static std::string sinkPath;
+static FILE* sink = nullptr;
+static uint32_t sinkRate = 0;
+static uint64_t sinkFrames = 0;
+static HostAudioEventHook eventHook = nullptr;
+static uint64_t silentRunFrames = 0;     // Frames of silence since the last frame played
+static uint32_t silentRunRate = DEFAULT_RATE;
+static bool silentRunIdle = false;       // Some of that silence was between tracks
+
+// --- WAV sink --------------------------------------------------------------
+
+static void put32(uint8_t* p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static void writeWavHeader() {
+    uint8_t header[44] = {'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ', 16, 0, 0, 0, 1, 0, 2, 0};
+    uint32_t dataBytes = (uint32_t)(sinkFrames * 4);
+    put32(header + 4, 36 + dataBytes);
+    put32(header + 24, sinkRate);
+    put32(header + 28, sinkRate * 4);
+    header[32] = 4;
+    header[34] = 16;
+    memcpy(header + 36, "data", 4);
+    put32(header + 40, dataBytes);
+    fseek(sink, 0, SEEK_SET);
+    fwrite(header, 1, sizeof(header), sink);
+    fseek(sink, 0, SEEK_END);
+}
+
+static void closeSink() {
+    if (!sink) return;
+    writeWavHeader();
+    fclose(sink);
+    sink = nullptr;
+}
+
+static void writeSink(const int16_t* frames, size_t count, uint32_t rate) {
+    if (sinkPath.empty()) return;
+    if (!sink) {
+        sink = fopen(sinkPath.c_str(), "wb");
+        if (!sink) {
+            fprintf(stderr, "[host] cannot open audio sink %s\n", sinkPath.c_str());
+            sinkPath.clear();
+            return;
+        }
+        sinkRate = rate;   // The file keeps the first track's rate
+        sinkFrames = 0;
+        writeWavHeader();
+    }
+    if (frames) {
+        fwrite(frames, 4, count, sink);
+    } else {
+        static const int16_t silence[2 * 256] = {};
+        for (size_t left = count; left > 0;) {
+            size_t n = left < 256 ? left : 256;
+            fwrite(silence, 4, n, sink);
+            left -= n;
+        }
+    }
+    sinkFrames += count;
+}
+
+void hostSetAudioSink(const std::string& path) {
+    closeSink();
+    sinkPath = path;
+}
+
+void hostSetAudioDmaFrames(uint32_t frames) {
+    dmaFrames = frames >= BLOCK_FRAMES ? frames : BLOCK_FRAMES;
+}
+
+void hostSetAudioBitrate(uint32_t bitsPerSecond) {
+    bitrate = bitsPerSecond ? bitsPerSecond : 128000;
+}
+
+uint32_t hostGetAudioBitrate() {
+    return bitrate;
+}
+
+HostAudioStats hostGetAudioStats() {
+    return stats;
+}
+
+void hostSetAudioEventHook(HostAudioEventHook hook) {
+    eventHook = hook;
+}
+
+static void reportEvent(HostAudioEvent::Type type, const char* source = "", uint64_t gapUs = 0, bool dropout = false) {
+    if (eventHook) eventHook({type, hostNowUs(), gapUs, source, dropout});
+}
+
+void hostResetAudio() {
+    closeSink();
+    sinkPath.clear();
+    dmaFrames = 8192;
+    bitrate = 128000;
+    stats = {};
+    eventHook = nullptr;
+    silentRunFrames = 0;
+    silentRunIdle = false;
+}
+
+static uint32_t compressedBlockBytes() {
+    return bitrate / 8 * BLOCK_FRAMES / DEFAULT_RATE;
+}
+
+// --- Audio -----------------------------------------------------------------
+
+Audio::Audio(bool internalDAC, uint8_t channelEnabled, uint8_t i2sPort) {}
+
+Audio::~Audio() {
+    close();
+}
+
+bool Audio::connecttoFS(fs::FS& fs, const char* path, int32_t fileStartPos) {
+    stopSong();
+    file_ = fs.open(path);
+    if (!file_) {
+        stats.connectFailures++;
+        return false;
+    }
+
+    String name(path);
+    name.toLowerCase();
+    if (name.endsWith(".wav") && parseWavHeader()) {
+        source_ = FILE_WAV;
+    } else {
+        source_ = FILE_COMPRESSED;
+        sampleRate_ = DEFAULT_RATE;
+        channels_ = 2;
+        dataStart_ = 0;
+        dataEnd_ = file_.size();
+    }
+    if (fileStartPos > 0) file_.seek(fileStartPos);
+
+    running_ = true;
+    decodedFrames_ = 0;
+    stats.tracksStarted++;
+    reportEvent(HostAudioEvent::TRACK_STARTED, path);
+    return true;
+}
+
+bool Audio::parseWavHeader() {
+    uint8_t riff[12];
+    if (file_.read(riff, 12) != 12 || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) return false;
+
+    bool haveFormat = false;
+    uint8_t chunk[8];
+    while (file_.read(chunk, 8) == 8) {
+        uint32_t size = chunk[4] | chunk[5] << 8 | chunk[6] << 16 | (uint32_t)chunk[7] << 24;
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t format[16];
+            if (size < 16 || file_.read(format, 16) != 16) return false;
+            uint16_t encoding = format[0] | format[1] << 8;
+            channels_ = format[2] | format[3] << 8;
+            sampleRate_ = format[4] | format[5] << 8 | format[6] << 16 | (uint32_t)format[7] << 24;
+            uint16_t bits = format[14] | format[15] << 8;
+            if (encoding != 1 || bits != 16 || channels_ < 1 || channels_ > 2) return false;
+            file_.seek(size - 16, fs::SeekCur);
+            haveFormat = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            dataStart_ = file_.position();
+            dataEnd_ = dataStart_ + size;
+            return haveFormat;
+        } else {
+            file_.seek(size + (size & 1), fs::SeekCur);
+        }
+    }
+    return false;
+}
+
+bool Audio::connecttohost(const char* host, const char* user, const char* pwd) {
+    stopSong();
+    if (!hostNetworkUp()) {
+        stats.connectFailures++;
+        return false;
+    }
+
+    HostHttpResponse response;
+    if (hostFetch(host, response)) {
+        if (response.code < 200 || response.code >= 300) {
+            stats.connectFailures++;
+            return false;
+        }
+        stream_ = WiFiClient(hostOpenConnection(response));
+    } else if (!hostNetworkUp()) {
+        stats.connectFailures++;
+        return false;
+    } else {
+        // Nobody answers for this URL: an endless station of silence
+        stream_ = WiFiClient();
+    }
+
+    source_ = STREAM;
+    sampleRate_ = DEFAULT_RATE;
+    channels_ = 2;
+    running_ = true;
+    decodedFrames_ = 0;
+    stats.tracksStarted++;
+    reportEvent(HostAudioEvent::TRACK_STARTED, host);
+    return true;
+}
+
+bool Audio::pauseResume() {
+    if (source_ == NONE) return false;
+    drainOutput();
+    running_ = !running_;
+    return true;
+}
+
+uint32_t Audio::stopSong() {
+    uint32_t pos = getFilePos();
+    drainOutput();
+    if (running_) {
+        reportEvent(HostAudioEvent::TRACK_STOPPED);
+        // Stopping flushes what the DMA ring still holds; a track that ended plays out
+        ringFrames_ = 0;
+    }
+    close();
+    running_ = false;
+    return pos;
+}
+
+void Audio::close() {
+    if (file_) file_.close();
+    stream_.stop();
+    source_ = NONE;
+}
+
+void Audio::endTrack(bool lost) {
+    close();
+    running_ = false;
+    if (lost) {
+        stats.streamsLost++;
+    } else {
+        stats.tracksEnded++;
+    }
+    reportEvent(lost ? HostAudioEvent::STREAM_LOST : HostAudioEvent::TRACK_ENDED);
+}
+
+uint32_t Audio::getFilePos() {
+    return file_ ? file_.position() : 0;
+}
+
+bool Audio::setFilePos(uint32_t pos) {
+    if (!file_) return false;
+    if (pos < dataStart_) pos = dataStart_;
+    return file_.seek(pos);
+}
+
+uint32_t Audio::getFileSize() {
+    return file_ ? file_.size() : 0;
+}
+
+uint32_t Audio::getBitRate() {
+    return source_ == FILE_WAV ? sampleRate_ * channels_ * 16 : bitrate;
+}
+
+uint32_t Audio::getAudioCurrentTime() {
+    return sampleRate_ ? (uint32_t)(decodedFrames_ / sampleRate_) : 0;
+}
+
+uint32_t Audio::getAudioFileDuration() {
+    if (!file_) return 0;
+    uint32_t bytes = dataEnd_ - dataStart_;
+    if (source_ == FILE_WAV) return sampleRate_ ? bytes / (sampleRate_ * channels_ * 2) : 0;
+    return bytes * 8 / bitrate;
+}
+
+uint32_t Audio::inBufferFilled() {
+    uint32_t filled = 0;
+    if (file_) {
+        uint32_t pos = file_.position();
+        filled = pos < dataEnd_ ? dataEnd_ - pos : 0;
+    } else if (stream_.hostConnection()) {
+        filled = stream_.available();
+    }
+    return filled < IN_BUFFER_BYTES ? filled : IN_BUFFER_BYTES;
+}
+
+uint32_t Audio::inBufferFree() {
+    return IN_BUFFER_BYTES - inBufferFilled();
+}
+
+void Audio::drainOutput() {
+    uint64_t now = hostNowUs();
+    if (ring_.size() != (size_t)dmaFrames * 2) {
+        ring_.assign((size_t)dmaFrames * 2, 0);
+        ringHead_ = 0;
+        ringFrames_ = 0;
+    }
+    if (now <= lastDrainUs_) {
+        lastDrainUs_ = now;
+        return;
+    }
+
+    uint32_t rate = sampleRate_ ? sampleRate_ : DEFAULT_RATE;
+    uint64_t total = (now - lastDrainUs_) * rate + drainRemainder_;
+    uint64_t frames = total / 1000000;
+    drainRemainder_ = total % 1000000;
+    lastDrainUs_ = now;
+
+    uint64_t played = frames < ringFrames_ ? frames : ringFrames_;
+    if (played) {
+        // Played frames come first in this span, so the silence before them has ended
+        if (silentRunFrames && stats.framesOut) {
+            reportEvent(HostAudioEvent::GAP, "", silentRunFrames * 1000000 / silentRunRate, !silentRunIdle);
+        }
+        silentRunFrames = 0;
+        silentRunIdle = false;
+        stats.lastSoundUs = now - (frames - played) * 1000000 / rate;
+    }
+    stats.framesOut += played;
+    for (uint64_t left = played; left > 0;) {
+        size_t n = dmaFrames - ringHead_;
+        if (n > left) n = left;
+        writeSink(&ring_[ringHead_ * 2], n, rate);
+        ringHead_ = (ringHead_ + n) % dmaFrames;
+        left -= n;
+    }
+    ringFrames_ -= played;
+
+    uint64_t silent = frames - played;
+    silentRunFrames += silent;
+    silentRunRate = rate;
+    if (running_ && decodedFrames_ > 0) {
+        stats.silentFrames += silent;
+        if (silent && !starved_) stats.underruns++;
+        starved_ = silent > 0;
+        if (silent) writeSink(nullptr, silent, rate);
+    } else {
+        // Silence between tracks, or before a new track's first frame, is not an underrun; the sink skips it
+        stats.idleFrames += silent;
+        if (silent) silentRunIdle = true;
+        starved_ = false;
+    }
+}
+
+int Audio::decodeBlock(int16_t* block) {
+    if (source_ == FILE_WAV) {
+        uint32_t pos = file_.position();
+        uint32_t frameBytes = channels_ * 2;
+        uint32_t want = BLOCK_FRAMES * frameBytes;
+        if (pos + want > dataEnd_) want = pos < dataEnd_ ? (dataEnd_ - pos) / frameBytes * frameBytes : 0;
+        size_t got = want ? file_.read((uint8_t*)block, want) : 0;
+        size_t frames = got / frameBytes;
+        if (frames == 0) return DECODE_ENDED;
+        if (channels_ == 1) {
+            for (size_t i = frames; i-- > 0;) {
+                block[i * 2 + 1] = block[i];
+                block[i * 2] = block[i];
+            }
+        }
+        return (int)frames;
+    }
+
+    uint32_t blockBytes = compressedBlockBytes();
+    uint8_t scratch[4096];
+    if (blockBytes > sizeof(scratch)) blockBytes = sizeof(scratch);
+
+    if (source_ == FILE_COMPRESSED) {
+        uint32_t corruptReads = hostGetFaultStats().sdCorruptReads;
+        size_t got = file_.read(scratch, blockBytes);
+        if (got == 0) return DECODE_ENDED;
+        // A frame that fails to decode is dropped and the decoder resyncs on the next one
+        if (hostGetFaultStats().sdCorruptReads != corruptReads) return DECODE_SKIPPED;
+        memset(block, 0, BLOCK_FRAMES * 4);
+        return (int)(BLOCK_FRAMES * got / blockBytes);
+    }
+
+    // Stream
+    memset(block, 0, BLOCK_FRAMES * 4);
+    if (!stream_.hostConnection()) return BLOCK_FRAMES;
+    if ((uint32_t)stream_.available() >= blockBytes) {
+        stream_.read(scratch, blockBytes);
+        return BLOCK_FRAMES;
+    }
+    if (!stream_.connected()) {
+        return stream_.hostConnection()->live ? DECODE_LOST : DECODE_ENDED;
+    }
+    return DECODE_STARVED;
+}
+
+void Audio::loop() {
+    drainOutput();
+    if (!running_) return;
+
+    static int16_t block[BLOCK_FRAMES * 2];
+    while (ringFrames_ + BLOCK_FRAMES <= dmaFrames) {
+        int result = decodeBlock(block);
+        if (result == DECODE_ENDED || result == DECODE_LOST) {
+            endTrack(result == DECODE_LOST);
+            return;
+        }
+        if (result == DECODE_STARVED) return;
+        if (result == DECODE_SKIPPED) continue;
+
+        size_t frames = (size_t)result;
+        decodedFrames_ += frames;
+        bool continueI2S = true;
+        if (audio_process_extern) audio_process_extern(block, (uint16_t)frames, &continueI2S);
+        if (!continueI2S) continue;
+        // Into the ring at its tail, wrapping at most once
+        size_t tail = (ringHead_ + ringFrames_) % dmaFrames;
+        size_t first = std::min(frames, (size_t)dmaFrames - tail);
+        memcpy(&ring_[tail * 2], block, first * 4);
+        memcpy(&ring_[0], block + first * 2, (frames - first) * 4);
+        ringFrames_ += frames;
+    }
+}
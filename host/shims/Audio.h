@@ -0,0 +1,76 @@
+/**
+ * @file Audio.h
+ * @brief ESP32-audioI2S for the host build
+ * @details Models the library's timing rather than its decoder. loop()
+ *          "decodes" 1152-frame blocks while the I2S DMA ring has room and
+ *          passes each to audio_process_extern(), and the ring drains at the
+ *          sample rate on the virtual clock. WAV files play their real PCM;
+ *          other files and streams play silence, consuming input at the
+ *          assumed bit rate so positions and durations come out right.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "FS.h"
+#include "WiFi.h"
+#include <memory>
+#include <vector>
+
+class Audio {
+public:
+    Audio(bool internalDAC = false, uint8_t channelEnabled = 3, uint8_t i2sPort = 0);
+    ~Audio();
+
+    bool setPinout(uint8_t BCLK, uint8_t LRC, uint8_t DOUT, int8_t MCLK = -1) { return true; }
+    void setVolume(uint8_t volume, uint8_t curve = 0) { volume_ = volume > 21 ? 21 : volume; }
+    uint8_t getVolume() { return volume_; }
+    uint8_t maxVolume() { return 21; }
+
+    bool connecttoFS(fs::FS& fs, const char* path, int32_t fileStartPos = -1);
+    bool connecttohost(const char* host, const char* user = "", const char* pwd = "");
+    void loop();
+    bool isRunning() { return running_; }
+    bool pauseResume();
+    uint32_t stopSong();
+
+    uint32_t getFilePos();
+    bool setFilePos(uint32_t pos);
+    uint32_t getFileSize();
+    uint32_t getSampleRate() { return sampleRate_; }
+    uint8_t getBitsPerSample() { return 16; }
+    uint8_t getChannels() { return channels_; }
+    uint32_t getBitRate();
+    uint32_t getAudioCurrentTime();
+    uint32_t getAudioFileDuration();
+    uint32_t inBufferFilled();
+    uint32_t inBufferFree();
+
+private:
+    enum Source { NONE, FILE_WAV, FILE_COMPRESSED, STREAM };
+
+    void drainOutput();
+    int decodeBlock(int16_t* block);
+    void endTrack(bool lost);
+    void close();
+    bool parseWavHeader();
+
+    Source source_ = NONE;
+    File file_;
+    WiFiClient stream_;
+    bool running_ = false;
+    uint8_t volume_ = 21;
+    uint32_t sampleRate_ = 0;
+    uint8_t channels_ = 2;
+    uint32_t dataStart_ = 0;        // WAV: first PCM byte
+    uint32_t dataEnd_ = 0;
+    uint64_t decodedFrames_ = 0;    // Of the current track
+
+    // Modelled I2S DMA ring
+    std::vector<int16_t> ring_;
+    size_t ringHead_ = 0;
+    size_t ringFrames_ = 0;
+    uint64_t lastDrainUs_ = 0;
+    uint64_t drainRemainder_ = 0;
+    bool starved_ = false;
+};
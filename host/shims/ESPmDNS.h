@@ -0,0 +1,17 @@
+/**
+ * @file ESPmDNS.h
+ * @brief mDNS responder for the host build; announces nothing
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class MDNSResponder {
+public:
+    bool begin(const char* hostName) { return true; }
+    void end() {}
+    void addService(const char* service, const char* proto, uint16_t port) {}
+};
+
+extern MDNSResponder MDNS;
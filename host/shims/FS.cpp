@@ -0,0 +1,130 @@
+/**
+ * @file FS.cpp
+ * @brief File and FS handles for the host build, as in the ESP32 core
+ */
+
+#include "FS.h"
+#include "FSImpl.h"
+
+using namespace fs;
+
+size_t File::write(uint8_t c) {
+    return _p ? _p->write(&c, 1) : 0;
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+    return _p ? _p->write(buf, size) : 0;
+}
+
+int File::available() {
+    return _p ? (int)(_p->size() - _p->position()) : 0;
+}
+
+int File::read() {
+    uint8_t c;
+    return _p && _p->read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+    return _p ? _p->read(buf, size) : 0;
+}
+
+int File::peek() {
+    if (!_p) return -1;
+    size_t pos = _p->position();
+    int c = read();
+    _p->seek(pos, SeekSet);
+    return c;
+}
+
+void File::flush() {
+    if (_p) _p->flush();
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    return _p ? _p->seek(pos, mode) : false;
+}
+
+size_t File::position() const {
+    return _p ? _p->position() : 0;
+}
+
+size_t File::size() const {
+    return _p ? _p->size() : 0;
+}
+
+bool File::setBufferSize(size_t size) {
+    return _p ? _p->setBufferSize(size) : false;
+}
+
+void File::close() {
+    if (_p) {
+        _p->close();
+        _p = nullptr;
+    }
+}
+
+File::operator bool() const {
+    return _p && (bool)*_p;
+}
+
+time_t File::getLastWrite() {
+    return _p ? _p->getLastWrite() : 0;
+}
+
+const char* File::path() const {
+    return _p ? _p->path() : nullptr;
+}
+
+const char* File::name() const {
+    return _p ? _p->name() : nullptr;
+}
+
+boolean File::isDirectory() {
+    return _p ? _p->isDirectory() : false;
+}
+
+boolean File::seekDir(long position) {
+    return _p ? _p->seekDir(position) : false;
+}
+
+File File::openNextFile(const char* mode) {
+    return _p ? File(_p->openNextFile(mode)) : File();
+}
+
+String File::getNextFileName() {
+    return _p ? _p->getNextFileName() : String();
+}
+
+String File::getNextFileName(bool* isDir) {
+    return _p ? _p->getNextFileName(isDir) : String();
+}
+
+void File::rewindDirectory() {
+    if (_p) _p->rewindDirectory();
+}
+
+File FS::open(const char* path, const char* mode, const bool create) {
+    if (!_impl || !path || path[0] != '/') return File();
+    return File(_impl->open(path, mode, create));
+}
+
+bool FS::exists(const char* path) {
+    return _impl && path && _impl->exists(path);
+}
+
+bool FS::remove(const char* path) {
+    return _impl && path && _impl->remove(path);
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+    return _impl && pathFrom && pathTo && _impl->rename(pathFrom, pathTo);
+}
+
+bool FS::mkdir(const char* path) {
+    return _impl && path && _impl->mkdir(path);
+}
+
+bool FS::rmdir(const char* path) {
+    return _impl && path && _impl->rmdir(path);
+}
@@ -0,0 +1,132 @@
+/**
+ * @file Faults.cpp
+ * @brief Injected SD and network faults, on the virtual clock
+ */
+
+#include "host_hal.h"
+#include "host_internal.h"
+#include <math.h>
+
+#define NEVER_US UINT64_MAX
+
+static HostFaultProfile profile;
+static HostFaultStats stats = {};
+static uint64_t faultState = 1;
+
+// WiFi dropouts, scheduled lazily as the clock passes them
+static uint64_t nextDropUs = NEVER_US;
+static uint64_t downUntilUs = 0;
+
+// Stream stalls: the current (or last) window, and the total of the ones before it
+static uint64_t nextStallUs = NEVER_US;
+static uint64_t stallStartUs = 0;
+static uint64_t stallEndUs = 0;
+static uint64_t stalledBeforeUs = 0;
+
+static uint32_t next32() {
+    // splitmix64, like the generator behind random(), but with a state of its own
+    uint64_t z = (faultState += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return (uint32_t)((z ^ (z >> 31)) >> 32);
+}
+
+static double unit() {
+    return next32() / 4294967296.0;
+}
+
+static bool chance(double p) {
+    return p > 0 && unit() < p;
+}
+
+static uint64_t uniformUs(uint64_t minUs, uint64_t maxUs) {
+    return maxUs > minUs ? minUs + (uint64_t)(unit() * (maxUs - minUs)) : minUs;
+}
+
+static uint64_t exponentialUs(uint32_t meanSec) {
+    return (uint64_t)(-log(1 - unit()) * meanSec * 1e6);
+}
+
+static uint64_t spikeUs() {
+    double low = profile.sdSpikeMinUs ? profile.sdSpikeMinUs : 1;
+    double high = profile.sdSpikeMaxUs > low ? profile.sdSpikeMaxUs : low;
+    uint64_t us = (uint64_t)(low * exp(unit() * log(high / low)));
+    stats.sdSpikes++;
+    stats.sdStallUs += us;
+    return us;
+}
+
+void hostSetFaultProfile(const HostFaultProfile& newProfile) {
+    profile = newProfile;
+    stats = {};
+    faultState = profile.seed;
+    uint64_t now = hostNowUs();
+    nextDropUs = profile.wifiDropMeanSec ? now + exponentialUs(profile.wifiDropMeanSec) : NEVER_US;
+    downUntilUs = 0;
+    nextStallUs = profile.streamStallMeanSec ? now + exponentialUs(profile.streamStallMeanSec) : NEVER_US;
+    stallStartUs = stallEndUs = stalledBeforeUs = 0;
+}
+
+HostFaultStats hostGetFaultStats() {
+    // Dropouts and stalls are scheduled as the clock passes them; catch up first
+    hostFaultWifiDown();
+    hostFaultStreamStalledUs();
+    return stats;
+}
+
+void hostResetFaults() {
+    hostSetFaultProfile(HostFaultProfile());
+}
+
+uint64_t hostFaultSdReadUs() {
+    uint64_t us = profile.sdReadLatencyUs;
+    if (profile.sdReadJitterUs) us += uniformUs(0, profile.sdReadJitterUs);
+    if (chance(profile.sdReadSpikeChance)) us += spikeUs();
+    return us;
+}
+
+uint64_t hostFaultSdWriteUs() {
+    return chance(profile.sdWriteSpikeChance) ? spikeUs() : 0;
+}
+
+bool hostFaultSdOpenFails() {
+    if (!chance(profile.sdOpenFailChance)) return false;
+    stats.sdOpenFailures++;
+    return true;
+}
+
+bool hostFaultCorrupt(uint8_t* data, size_t size) {
+    if (size == 0 || !chance(profile.sdCorruptChance)) return false;
+    uint32_t r = next32();
+    data[r % size] ^= (uint8_t)(1 << (r >> 29));
+    stats.sdCorruptReads++;
+    return true;
+}
+
+bool hostFaultWifiDown() {
+    uint64_t now = hostNowUs();
+    while (now >= nextDropUs) {
+        uint64_t downUs = uniformUs(profile.wifiDownMinSec * 1000000ULL, profile.wifiDownMaxSec * 1000000ULL);
+        downUntilUs = nextDropUs + downUs;
+        nextDropUs = downUntilUs + exponentialUs(profile.wifiDropMeanSec);
+        stats.wifiDrops++;
+        stats.wifiDownUs += downUs;
+        hostBreakLiveConnections();
+    }
+    return now < downUntilUs;
+}
+
+uint64_t hostFaultStreamStalledUs() {
+    uint64_t now = hostNowUs();
+    while (now >= nextStallUs) {
+        stalledBeforeUs += stallEndUs - stallStartUs;
+        uint64_t stallUs = uniformUs(profile.streamStallMinMs * 1000ULL, profile.streamStallMaxMs * 1000ULL);
+        stallStartUs = nextStallUs;
+        stallEndUs = stallStartUs + stallUs;
+        nextStallUs = stallEndUs + exponentialUs(profile.streamStallMeanSec);
+        stats.streamStalls++;
+        stats.streamStallUs += stallUs;
+    }
+    if (now <= stallStartUs) return stalledBeforeUs;
+    return stalledBeforeUs + (now < stallEndUs ? now - stallStartUs : stallEndUs - stallStartUs);
+}
@@ -0,0 +1,65 @@
+/**
+ * @file HTTPClient.h
+ * @brief HTTP client for the host build
+ * @details Requests are answered by the handler set with hostSetHttpHandler().
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "WiFi.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+typedef enum {
+    HTTP_CODE_OK = 200,
+    HTTP_CODE_PARTIAL_CONTENT = 206,
+    HTTP_CODE_MOVED_PERMANENTLY = 301,
+    HTTP_CODE_FOUND = 302,
+    HTTP_CODE_NOT_MODIFIED = 304,
+    HTTP_CODE_BAD_REQUEST = 400,
+    HTTP_CODE_NOT_FOUND = 404,
+    HTTP_CODE_INTERNAL_SERVER_ERROR = 500,
+    HTTP_CODE_SERVICE_UNAVAILABLE = 503
+} t_http_codes;
+
+typedef enum {
+    HTTPC_DISABLE_FOLLOW_REDIRECTS,
+    HTTPC_STRICT_FOLLOW_REDIRECTS,
+    HTTPC_FORCE_FOLLOW_REDIRECTS
+} followRedirects_t;
+
+class HTTPClient {
+public:
+    bool begin(WiFiClient& client, const String& url);
+    bool begin(const String& url);
+    void end();
+    void setTimeout(uint16_t timeoutMs) { timeoutMs_ = timeoutMs; }
+    void setConnectTimeout(int32_t timeoutMs) {}
+    void setFollowRedirects(followRedirects_t follow) {}
+    void setUserAgent(const String& userAgent) {}
+    void addHeader(const String& name, const String& value) {}
+    int GET();
+    int getSize();
+    String getString();
+    WiFiClient& getStream();
+    WiFiClient* getStreamPtr();
+    static String errorToString(int error);
+
+private:
+    WiFiClient* client_ = nullptr;
+    WiFiClient ownClient_;
+    String url_;
+    uint16_t timeoutMs_ = 5000;
+    int size_ = -1;
+};
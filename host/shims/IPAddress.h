@@ -0,0 +1,33 @@
+/**
+ * @file IPAddress.h
+ * @brief Arduino IPAddress for the host build
+ */
+
+#pragma once
+
+#include "WString.h"
+#include <stdint.h>
+#include <stdio.h>
+
+class IPAddress {
+public:
+    IPAddress() : address_(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+        : address_((uint32_t)a | (uint32_t)b << 8 | (uint32_t)c << 16 | (uint32_t)d << 24) {}
+    IPAddress(uint32_t address) : address_(address) {}
+
+    // Network byte order, first octet in the low byte, as on the ESP32
+    operator uint32_t() const { return address_; }
+    uint8_t operator[](int index) const { return (address_ >> (index * 8)) & 0xff; }
+    bool operator==(const IPAddress& other) const { return address_ == other.address_; }
+    bool operator!=(const IPAddress& other) const { return address_ != other.address_; }
+
+    String toString() const {
+        char text[16];
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+        return String(text);
+    }
+
+private:
+    uint32_t address_;
+};
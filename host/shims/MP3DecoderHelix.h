@@ -0,0 +1,65 @@
+/**
+ * @file MP3DecoderHelix.h
+ * @brief arduino-libhelix MP3 decoder for the host build
+ * @details Paces like the real decoder: one 1152-frame block of stereo
+ *          silence per frame's worth of input at the assumed bit rate.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+uint32_t hostGetAudioBitrate();
+
+namespace libhelix {
+
+struct MP3FrameInfo {
+    int bitrate;
+    int nChans;
+    int samprate;
+    int bitsPerSample;
+    int outputSamps;
+    int layer;
+    int version;
+};
+
+typedef void (*MP3DataCallback)(MP3FrameInfo& info, short* pcm, size_t len, void* ref);
+
+class MP3DecoderHelix {
+public:
+    static const int FRAME_SAMPLES = 1152;
+
+    MP3DecoderHelix(MP3DataCallback callback = nullptr) : callback_(callback), pcm_(FRAME_SAMPLES * 2) {}
+
+    void setDataCallback(MP3DataCallback callback) { callback_ = callback; }
+    bool begin() {
+        pending_ = 0;
+        active_ = true;
+        return true;
+    }
+    void end() { active_ = false; }
+    operator bool() { return active_; }
+
+    size_t write(const void* data, size_t length) {
+        if (!active_) return 0;
+        uint32_t frameBytes = hostGetAudioBitrate() / 8 * FRAME_SAMPLES / 44100;
+        if (frameBytes == 0) frameBytes = 1;
+        pending_ += length;
+        while (pending_ >= frameBytes) {
+            pending_ -= frameBytes;
+            MP3FrameInfo info = {(int)hostGetAudioBitrate(), 2, 44100, 16, FRAME_SAMPLES * 2, 3, 0};
+            if (callback_) callback_(info, pcm_.data(), pcm_.size(), nullptr);
+        }
+        return length;
+    }
+
+private:
+    MP3DataCallback callback_;
+    std::vector<short> pcm_;
+    size_t pending_ = 0;
+    bool active_ = false;
+};
+
+}  // namespace libhelix
@@ -0,0 +1,309 @@
+/**
+ * @file Network.cpp
+ * @brief WiFi, TCP and HTTP clients on the host network
+ */
+
+#include "WiFi.h"
+#include "ESPmDNS.h"
+#include "HTTPClient.h"
+#include "WiFiManager.h"
+#include "host_hal.h"
+#include "host_internal.h"
+#include <algorithm>
+#include <vector>
+
+#define HOST_CONNECTION_OUTPUT_KEEP (256 * 1024)   // Nobody may read a kept-open connection
+#define HOST_WIFI_CONNECT_MS 1500
+
+WiFiClass WiFi;
+MDNSResponder MDNS;
+
+static bool networkUp = true;      // As set by hostSetNetworkUp(); fault dropouts come on top
+static HostHttpHandler httpHandler = nullptr;
+static bool stationConnected = false;
+static bool softApStarted = false;
+static wifi_mode_t wifiMode = WIFI_OFF;
+static std::vector<std::weak_ptr<HostConnection>> liveConnections;
+
+void hostSetHttpHandler(HostHttpHandler handler) {
+    httpHandler = handler;
+}
+
+void hostSetNetworkUp(bool up) {
+    networkUp = up;
+    if (!up) hostBreakLiveConnections();
+}
+
+void hostBreakLiveConnections() {
+    // Every stream in flight breaks
+    for (auto& weak : liveConnections) {
+        if (auto connection = weak.lock()) connection->open = false;
+    }
+    liveConnections.clear();
+}
+
+bool hostNetworkUp() {
+    return networkUp && !hostFaultWifiDown();
+}
+
+bool hostFetch(const std::string& url, HostHttpResponse& response) {
+    if (!hostNetworkUp() || !httpHandler) return false;
+    response = httpHandler(url);
+    if (response.latencyMs) hostSleepUs((uint64_t)response.latencyMs * 1000);
+    return hostNetworkUp();
+}
+
+std::shared_ptr<HostConnection> hostOpenConnection(const HostHttpResponse& response) {
+    auto connection = std::make_shared<HostConnection>();
+    connection->input = response.body;
+    connection->live = response.live;
+    connection->endsWithInput = !response.live;
+    connection->startUs = hostNowUs();
+    connection->bytesPerSecond = hostGetAudioBitrate() / 8;
+    connection->burstBytes = response.live ? connection->bytesPerSecond * 2 : 0;
+    connection->stalledAtStartUs = response.live ? hostFaultStreamStalledUs() : 0;
+    if (response.live) {
+        // Forget connections that are gone so the list stays short
+        liveConnections.erase(std::remove_if(liveConnections.begin(), liveConnections.end(),
+                                             [](const std::weak_ptr<HostConnection>& weak) { return weak.expired(); }),
+                              liveConnections.end());
+        liveConnections.push_back(connection);
+    }
+    return connection;
+}
+
+void hostResetNetwork() {
+    networkUp = true;
+    httpHandler = nullptr;
+    stationConnected = false;
+    softApStarted = false;
+    wifiMode = WIFI_OFF;
+    liveConnections.clear();
+}
+
+std::string hostConnectionRead(const std::shared_ptr<HostConnection>& connection) {
+    std::string output;
+    if (connection) output.swap(connection->output);
+    return output;
+}
+
+void hostConnectionClose(const std::shared_ptr<HostConnection>& connection) {
+    if (connection) connection->open = false;
+}
+
+// --- WiFiClient ------------------------------------------------------------
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    if (!hostNetworkUp()) return 0;
+    connection_ = std::make_shared<HostConnection>();
+    return 1;
+}
+
+size_t WiFiClient::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+    if (!connection_ || !connection_->open) return 0;
+    std::string& output = connection_->output;
+    output.append((const char*)buffer, size);
+    if (output.size() > 2 * HOST_CONNECTION_OUTPUT_KEEP) {
+        output.erase(0, output.size() - HOST_CONNECTION_OUTPUT_KEEP);
+    }
+    return size;
+}
+
+int WiFiClient::available() {
+    if (!connection_) return 0;
+    HostConnection& c = *connection_;
+    if (c.live) {
+        if (!hostNetworkUp() || !c.open) return 0;
+        // Nothing arrives while the stream is stalled, and it does not catch up afterwards
+        uint64_t stalledUs = hostFaultStreamStalledUs();
+        stalledUs = stalledUs > c.stalledAtStartUs ? stalledUs - c.stalledAtStartUs : 0;
+        uint64_t elapsedUs = hostNowUs() - c.startUs;
+        elapsedUs -= std::min(elapsedUs, stalledUs);
+        uint64_t arrived = c.burstBytes + elapsedUs * c.bytesPerSecond / 1000000;
+        return (int)std::min<uint64_t>(arrived - std::min<uint64_t>(arrived, c.consumed), INT32_MAX);
+    }
+    return (int)(c.input.size() - std::min(c.consumed, c.input.size()));
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+    size_t count = std::min(size, (size_t)available());
+    HostConnection* c = connection_.get();
+    for (size_t i = 0; i < count; i++) {
+        buffer[i] = c->input.empty() ? 0 : c->input[(c->consumed + i) % c->input.size()];
+    }
+    if (c) c->consumed += count;
+    return (int)count;
+}
+
+int WiFiClient::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::peek() {
+    if (available() <= 0) return -1;
+    const HostConnection& c = *connection_;
+    return c.input.empty() ? 0 : (uint8_t)c.input[c.consumed % c.input.size()];
+}
+
+void WiFiClient::stop() {
+    if (connection_) connection_->open = false;
+    connection_.reset();
+}
+
+uint8_t WiFiClient::connected() {
+    if (!connection_) return 0;
+    if (connection_->live) hostNetworkUp();   // A dropout due by now breaks the connection first
+    if (!connection_->open) return 0;
+    if (connection_->endsWithInput && connection_->consumed >= connection_->input.size()) return 0;
+    return 1;
+}
+
+// --- HTTPClient ------------------------------------------------------------
+
+bool HTTPClient::begin(WiFiClient& client, const String& url) {
+    client_ = &client;
+    url_ = url;
+    return url.startsWith("http://") || url.startsWith("https://");
+}
+
+bool HTTPClient::begin(const String& url) {
+    return begin(ownClient_, url);
+}
+
+void HTTPClient::end() {
+    if (client_) client_->stop();
+    client_ = nullptr;
+    size_ = -1;
+}
+
+int HTTPClient::GET() {
+    if (!client_) return HTTPC_ERROR_NOT_CONNECTED;
+    HostHttpResponse response;
+    if (!hostFetch(url_.c_str(), response)) return HTTPC_ERROR_CONNECTION_REFUSED;
+    if (response.code < 0) return response.code;
+
+    std::shared_ptr<HostConnection> connection = hostOpenConnection(response);
+    client_->hostAttach(connection);
+    size_ = response.live ? -1 : (int)response.body.size();
+    return response.code;
+}
+
+int HTTPClient::getSize() {
+    return size_;
+}
+
+String HTTPClient::getString() {
+    if (!client_ || !client_->hostConnection() || size_ < 0) return String();
+    HostConnection& c = *client_->hostConnection();
+    String body(c.input.data() + std::min(c.consumed, c.input.size()), c.input.size() - std::min(c.consumed, c.input.size()));
+    c.consumed = c.input.size();
+    return body;
+}
+
+WiFiClient& HTTPClient::getStream() {
+    return client_ ? *client_ : ownClient_;
+}
+
+WiFiClient* HTTPClient::getStreamPtr() {
+    return client_;
+}
+
+String HTTPClient::errorToString(int error) {
+    switch (error) {
+        case HTTPC_ERROR_CONNECTION_REFUSED:
+            return "connection refused";
+        case HTTPC_ERROR_NOT_CONNECTED:
+            return "not connected";
+        case HTTPC_ERROR_CONNECTION_LOST:
+            return "connection lost";
+        case HTTPC_ERROR_READ_TIMEOUT:
+            return "read Timeout";
+    }
+    return String();
+}
+
+// --- WiFi ------------------------------------------------------------------
+
+wl_status_t WiFiClass::status() {
+    if (!stationConnected) return WL_DISCONNECTED;
+    // The station reconnects by itself once a dropout ends, as the ESP32 does
+    return hostNetworkUp() ? WL_CONNECTED : WL_CONNECTION_LOST;
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+    wifiMode = mode;
+    if (mode == WIFI_OFF || mode == WIFI_AP) stationConnected = false;
+    if (mode == WIFI_OFF || mode == WIFI_STA) softApStarted = false;
+    return true;
+}
+
+wifi_mode_t WiFiClass::getMode() {
+    return wifiMode;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase) {
+    if (wifiMode == WIFI_OFF || wifiMode == WIFI_AP) wifiMode = wifiMode == WIFI_AP ? WIFI_AP_STA : WIFI_STA;
+    hostSleepUs((uint64_t)HOST_WIFI_CONNECT_MS * 1000);
+    stationConnected = hostNetworkUp();
+    return status();
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp) {
+    stationConnected = false;
+    if (wifiOff) mode(WIFI_OFF);
+    return true;
+}
+
+IPAddress WiFiClass::localIP() {
+    return status() == WL_CONNECTED ? IPAddress(192, 168, 1, 50) : IPAddress();
+}
+
+bool WiFiClass::softAP(const char* ssid, const char* passphrase, int channel, int hidden, int maxConnections) {
+    if (passphrase && *passphrase && strlen(passphrase) < 8) return false;   // WPA2 minimum, as on the device
+    softApStarted = true;
+    if (wifiMode == WIFI_OFF || wifiMode == WIFI_STA) wifiMode = wifiMode == WIFI_STA ? WIFI_AP_STA : WIFI_AP;
+    return true;
+}
+
+IPAddress WiFiClass::softAPIP() {
+    return softApStarted ? IPAddress(192, 168, 4, 1) : IPAddress();
+}
+
+bool WiFiClass::softAPsetHostname(const char* hostname) {
+    return softApStarted;
+}
+
+String WiFiClass::SSID() {
+    return status() == WL_CONNECTED ? String("host") : String();
+}
+
+int32_t WiFiClass::RSSI() {
+    return status() == WL_CONNECTED ? -55 : 0;
+}
+
+// --- WiFiManager -----------------------------------------------------------
+
+bool WiFiManager::autoConnect(const char* apName, const char* apPassword) {
+    WiFi.mode(WIFI_STA);
+    if (WiFi.begin(NULL) == WL_CONNECTED) return true;
+    // The library falls back to its portal, which nobody visits here
+    return startConfigPortal(apName, apPassword);
+}
+
+bool WiFiManager::startConfigPortal(const char* apName, const char* apPassword) {
+    WiFi.mode(WIFI_AP_STA);
+    WiFi.softAP(apName, apPassword);
+    if (portalTimeoutSec_) {
+        hostSleepUs((uint64_t)portalTimeoutSec_ * 1000000);
+    } else {
+        // No timeout blocks forever on the device; give up after a day of virtual time
+        hostSleepUs(24ULL * 3600 * 1000000);
+    }
+    WiFi.mode(WIFI_STA);
+    return false;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file Preferences.cpp
+ * @brief In-memory NVS for the host build
+ */
+
+#include "Preferences.h"
+#include "host_internal.h"
+#include <map>
+
+static std::map<std::string, std::map<std::string, std::string>> storage;
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel) {
+    if (!name || strlen(name) > 15) return false;   // NVS namespace limit
+    namespace_ = name;
+    readOnly_ = readOnly;
+    open_ = true;
+    return true;
+}
+
+void Preferences::end() {
+    open_ = false;
+}
+
+bool Preferences::clear() {
+    if (!open_ || readOnly_) return false;
+    storage[namespace_].clear();
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (!open_ || readOnly_) return false;
+    return storage[namespace_].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    return open_ && storage[namespace_].count(key) > 0;
+}
+
+size_t Preferences::putRaw(const char* key, const void* value, size_t length) {
+    if (!open_ || readOnly_ || !key) return 0;
+    storage[namespace_][key] = std::string((const char*)value, length);
+    return length;
+}
+
+bool Preferences::getRaw(const char* key, std::string& value) {
+    if (!open_ || !key) return false;
+    auto& entries = storage[namespace_];
+    auto found = entries.find(key);
+    if (found == entries.end()) return false;
+    value = found->second;
+    return true;
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+    std::string raw;
+    return getRaw(key, raw) ? String(raw.c_str(), raw.size()) : defaultValue;
+}
+
+void hostResetPreferences() {
+    storage.clear();
+}
@@ -0,0 +1,51 @@
+/**
+ * @file Preferences.h
+ * @brief NVS preferences for the host build, kept in memory
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include <string>
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = NULL);
+    void end();
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putUChar(const char* key, uint8_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putBool(const char* key, bool value) { return putUChar(key, value ? 1 : 0); }
+    size_t putInt(const char* key, int32_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putULong64(const char* key, uint64_t value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putFloat(const char* key, float value) { return putRaw(key, &value, sizeof(value)); }
+    size_t putString(const char* key, const String& value) { return putRaw(key, value.c_str(), value.length()); }
+
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return get(key, defaultValue); }
+    bool getBool(const char* key, bool defaultValue = false) { return getUChar(key, defaultValue ? 1 : 0) != 0; }
+    int32_t getInt(const char* key, int32_t defaultValue = 0) { return get(key, defaultValue); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return get(key, defaultValue); }
+    uint64_t getULong64(const char* key, uint64_t defaultValue = 0) { return get(key, defaultValue); }
+    float getFloat(const char* key, float defaultValue = NAN) { return get(key, defaultValue); }
+    String getString(const char* key, const String& defaultValue = String());
+
+private:
+    size_t putRaw(const char* key, const void* value, size_t length);
+    bool getRaw(const char* key, std::string& value);
+
+    template <typename T>
+    T get(const char* key, T defaultValue) {
+        std::string raw;
+        if (!getRaw(key, raw) || raw.size() != sizeof(T)) return defaultValue;
+        T value;
+        memcpy(&value, raw.data(), sizeof(T));
+        return value;
+    }
+
+    std::string namespace_;
+    bool open_ = false;
+    bool readOnly_ = false;
+};
@@ -0,0 +1,60 @@
+/**
+ * @file Print.cpp
+ * @brief Arduino Print and Stream for the host build
+ */
+
+#include "Print.h"
+#include "Stream.h"
+#include <stdio.h>
+#include <vector>
+
+size_t Print::printf(const char* format, ...) {
+    char small[128];
+    va_list args;
+    va_start(args, format);
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(small, sizeof(small), format, args);
+    va_end(args);
+    if (length < 0) {
+        va_end(copy);
+        return 0;
+    }
+    if ((size_t)length < sizeof(small)) {
+        va_end(copy);
+        return write((const uint8_t*)small, length);
+    }
+    std::vector<char> large(length + 1);
+    vsnprintf(large.data(), large.size(), format, copy);
+    va_end(copy);
+    return write((const uint8_t*)large.data(), length);
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = read();
+        if (c < 0) break;
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+String Stream::readString() {
+    String text;
+    char chunk[256];
+    size_t n;
+    while ((n = readBytes(chunk, sizeof(chunk))) > 0) {
+        text.concat(chunk, n);
+    }
+    return text;
+}
+
+String Stream::readStringUntil(char terminator) {
+    String text;
+    int c;
+    while ((c = read()) >= 0 && c != terminator) {
+        text += (char)c;
+    }
+    return text;
+}
@@ -0,0 +1,231 @@
+/**
+ * @file SD.cpp
+ * @brief SD card on a host directory
+ */
+
+#include "SD.h"
+#include "FSImpl.h"
+#include "host_hal.h"
+#include "host_internal.h"
+#include <dirent.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+
+#define SD_SECTOR_BYTES 512
+
+SPIClass SPI;
+
+static std::string sdRoot = ".";
+static bool sdPresent = true;
+static bool sdMounted = false;
+
+static std::string hostPath(const char* path) {
+    return sdRoot + path;
+}
+
+class HostFileImpl : public fs::FileImpl {
+public:
+    HostFileImpl(const char* path, FILE* file, DIR* dir) : path_(path), file_(file), dir_(dir) {
+        const char* slash = strrchr(path_.c_str(), '/');
+        name_ = slash ? slash + 1 : path_.c_str();
+    }
+    ~HostFileImpl() override { close(); }
+
+    size_t write(const uint8_t* buf, size_t size) override {
+        if (!file_) return 0;
+        size_t written = fwrite(buf, 1, size, file_);
+        sizeKnown_ = false;
+        size_t end = (size_t)ftell(file_);     // Appends land at the end, wherever the position was
+        uint64_t stallUs = 0;
+        for (size_t n = sectorAccesses(end - written, written); n > 0; n--) stallUs += hostFaultSdWriteUs();
+        position_ = end;
+        if (stallUs) hostSleepUs(stallUs);
+        return written;
+    }
+    size_t read(uint8_t* buf, size_t size) override {
+        if (!file_) return 0;
+        size_t got = fread(buf, 1, size, file_);
+        uint64_t latencyUs = 0;
+        for (size_t n = sectorAccesses(position_, got); n > 0; n--) {
+            latencyUs += hostFaultSdReadUs();
+            hostFaultCorrupt(buf, got);
+        }
+        position_ += got;
+        if (latencyUs) hostSleepUs(latencyUs);
+        return got;
+    }
+    void flush() override {
+        if (file_) fflush(file_);
+    }
+    bool seek(uint32_t pos, fs::SeekMode mode) override {
+        static const int WHENCE[] = {SEEK_SET, SEEK_CUR, SEEK_END};
+        // Like the ESP32 VFS, SeekEnd counts back from the end
+        long offset = mode == fs::SeekEnd ? -(long)pos : (long)pos;
+        if (!file_ || fseek(file_, offset, WHENCE[mode]) != 0) return false;
+        position_ = (size_t)ftell(file_);
+        return true;
+    }
+    size_t position() const override { return file_ ? position_ : 0; }
+    size_t size() const override {
+        if (!file_) return 0;
+        if (!sizeKnown_) {
+            fflush(file_);
+            struct stat info;
+            size_ = fstat(fileno(file_), &info) == 0 ? (size_t)info.st_size : 0;
+            sizeKnown_ = true;
+        }
+        return size_;
+    }
+    bool setBufferSize(size_t size) override { return file_ && setvbuf(file_, NULL, _IOFBF, size) == 0; }
+    void close() override {
+        if (file_) fclose(file_);
+        if (dir_) closedir(dir_);
+        file_ = nullptr;
+        dir_ = nullptr;
+    }
+    time_t getLastWrite() override {
+        struct stat info;
+        return stat(hostPath(path_.c_str()).c_str(), &info) == 0 ? info.st_mtime : 0;
+    }
+    const char* path() const override { return path_.c_str(); }
+    const char* name() const override { return name_; }
+    boolean isDirectory(void) override { return dir_ != nullptr; }
+
+    fs::FileImplPtr openNextFile(const char* mode) override {
+        std::string child;
+        bool isDir;
+        if (!nextEntry(child, isDir)) return fs::FileImplPtr();
+        std::string full = hostPath(child.c_str());
+        if (isDir) return std::make_shared<HostFileImpl>(child.c_str(), nullptr, opendir(full.c_str()));
+        FILE* file = fopen(full.c_str(), strcmp(mode, FILE_READ) == 0 ? "rb" : "r+b");
+        return file ? std::make_shared<HostFileImpl>(child.c_str(), file, nullptr) : fs::FileImplPtr();
+    }
+    boolean seekDir(long position) override {
+        if (!dir_) return false;
+        seekdir(dir_, position);
+        return true;
+    }
+    String getNextFileName(void) override {
+        bool isDir;
+        return getNextFileName(&isDir);
+    }
+    String getNextFileName(bool* isDir) override {
+        std::string child;
+        return nextEntry(child, *isDir) ? String(child.c_str()) : String();
+    }
+    void rewindDirectory(void) override {
+        if (dir_) rewinddir(dir_);
+    }
+    operator bool() override { return file_ || dir_; }
+
+private:
+    // Sectors of [start, start + size) the card has to be asked for; the FS
+    // buffer holds the last one, so byte-wise reads cost one access per sector
+    size_t sectorAccesses(size_t start, size_t size) {
+        if (size == 0) return 0;
+        size_t first = start / SD_SECTOR_BYTES;
+        size_t last = (start + size - 1) / SD_SECTOR_BYTES;
+        size_t accesses = last - first + 1 - (first == bufferedSector_ ? 1 : 0);
+        bufferedSector_ = last;
+        return accesses;
+    }
+
+    bool nextEntry(std::string& child, bool& isDir) {
+        if (!dir_) return false;
+        while (struct dirent* entry = readdir(dir_)) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+            child = path_ == "/" ? "/" + std::string(entry->d_name) : path_ + "/" + entry->d_name;
+            struct stat info;
+            isDir = stat(hostPath(child.c_str()).c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+            return true;
+        }
+        return false;
+    }
+
+    std::string path_;
+    const char* name_;
+    FILE* file_;
+    DIR* dir_;
+    // Kept here so available(), called for every byte read, needs no system calls
+    size_t position_ = 0;
+    mutable size_t size_ = 0;
+    mutable bool sizeKnown_ = false;
+    size_t bufferedSector_ = SIZE_MAX;
+};
+
+class HostSDImpl : public fs::FSImpl {
+public:
+    fs::FileImplPtr open(const char* path, const char* mode, const bool create) override {
+        if (!sdMounted) return fs::FileImplPtr();
+        std::string full = hostPath(path);
+        struct stat info;
+        if (stat(full.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+            DIR* dir = opendir(full.c_str());
+            return dir ? std::make_shared<HostFileImpl>(path, nullptr, dir) : fs::FileImplPtr();
+        }
+        if (hostFaultSdOpenFails()) return fs::FileImplPtr();
+        const char* hostMode = strcmp(mode, FILE_WRITE) == 0 ? "w+b" : strcmp(mode, FILE_APPEND) == 0 ? "a+b" : "rb";
+        FILE* file = fopen(full.c_str(), hostMode);
+        return file ? std::make_shared<HostFileImpl>(path, file, nullptr) : fs::FileImplPtr();
+    }
+    bool exists(const char* path) override {
+        struct stat info;
+        return sdMounted && stat(hostPath(path).c_str(), &info) == 0;
+    }
+    bool rename(const char* pathFrom, const char* pathTo) override {
+        return sdMounted && ::rename(hostPath(pathFrom).c_str(), hostPath(pathTo).c_str()) == 0;
+    }
+    bool remove(const char* path) override { return sdMounted && unlink(hostPath(path).c_str()) == 0; }
+    bool mkdir(const char* path) override { return sdMounted && ::mkdir(hostPath(path).c_str(), 0755) == 0; }
+    bool rmdir(const char* path) override { return sdMounted && ::rmdir(hostPath(path).c_str()) == 0; }
+};
+
+fs::SDFS SD(fs::FSImplPtr(new HostSDImpl()));
+
+bool fs::SDFS::begin(uint8_t ssPin, SPIClass& spi, uint32_t frequency, const char* mountpoint, uint8_t maxFiles,
+                     bool formatIfEmpty) {
+    struct stat info;
+    sdMounted = sdPresent && stat(sdRoot.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+    return sdMounted;
+}
+
+void fs::SDFS::end() {
+    sdMounted = false;
+}
+
+sdcard_type_t fs::SDFS::cardType() {
+    return sdMounted ? CARD_SDHC : CARD_NONE;
+}
+
+uint64_t fs::SDFS::cardSize() {
+    return sdMounted ? 16ULL << 30 : 0;
+}
+
+uint64_t fs::SDFS::totalBytes() {
+    return cardSize();
+}
+
+uint64_t fs::SDFS::usedBytes() {
+    return 0;
+}
+
+void hostSetSdRoot(const std::string& directory) {
+    sdRoot = directory;
+    while (sdRoot.size() > 1 && sdRoot.back() == '/') sdRoot.pop_back();
+}
+
+const std::string& hostGetSdRoot() {
+    return sdRoot;
+}
+
+void hostSetSdPresent(bool present) {
+    sdPresent = present;
+    if (!present) sdMounted = false;
+}
+
+void hostResetSd() {
+    sdPresent = true;
+    sdMounted = false;
+}
@@ -0,0 +1,33 @@
+/**
+ * @file SD.h
+ * @brief SD card for the host build
+ * @details Paths resolve against a host directory, see hostSetSdRoot().
+ */
+
+#pragma once
+
+#include "FS.h"
+#include "SPI.h"
+
+#define SS 5
+
+typedef enum { CARD_NONE, CARD_MMC, CARD_SD, CARD_SDHC, CARD_UNKNOWN } sdcard_type_t;
+
+namespace fs {
+
+class SDFS : public FS {
+public:
+    SDFS(FSImplPtr impl) : FS(impl) {}
+    bool begin(uint8_t ssPin = SS, SPIClass& spi = SPI, uint32_t frequency = 4000000, const char* mountpoint = "/sd",
+               uint8_t maxFiles = 5, bool formatIfEmpty = false);
+    void end();
+    sdcard_type_t cardType();
+    uint64_t cardSize();
+    uint64_t totalBytes();
+    uint64_t usedBytes();
+};
+
+}  // namespace fs
+
+extern fs::SDFS SD;
+using namespace fs;
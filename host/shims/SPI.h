@@ -0,0 +1,16 @@
+/**
+ * @file SPI.h
+ * @brief SPI bus for the host build; nothing is attached to it
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class SPIClass {
+public:
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {}
+    void end() {}
+};
+
+extern SPIClass SPI;
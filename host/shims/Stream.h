@@ -0,0 +1,27 @@
+/**
+ * @file Stream.h
+ * @brief Arduino Stream for the host build
+ */
+
+#pragma once
+
+#include "Print.h"
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeoutMs) { timeout_ = timeoutMs; }
+    unsigned long getTimeout() const { return timeout_; }
+
+    // Host streams never wait for data: what is not there now will not arrive
+    virtual size_t readBytes(char* buffer, size_t length);
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+    String readString();
+    String readStringUntil(char terminator);
+
+protected:
+    unsigned long timeout_ = 1000;
+};
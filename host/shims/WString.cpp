@@ -0,0 +1,191 @@
+/**
+ * @file WString.cpp
+ * @brief Arduino String for the host build
+ */
+
+#include "WString.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static std::string formatInteger(unsigned long long value, bool negative, unsigned char base) {
+    if (base < 2 || base > 36) base = 10;
+    char digits[72];
+    size_t n = 0;
+    do {
+        unsigned digit = value % base;
+        digits[n++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+        value /= base;
+    } while (value);
+    std::string text = negative ? "-" : "";
+    while (n) text += digits[--n];
+    return text;
+}
+
+String::String(unsigned char value, unsigned char base) : s_(formatInteger(value, false, base)) {}
+String::String(unsigned int value, unsigned char base) : s_(formatInteger(value, false, base)) {}
+String::String(unsigned long value, unsigned char base) : s_(formatInteger(value, false, base)) {}
+String::String(unsigned long long value, unsigned char base) : s_(formatInteger(value, false, base)) {}
+
+// Like the ESP32 core, negative numbers only get a sign in base 10
+String::String(int value, unsigned char base)
+    : s_(base == 10 ? formatInteger(value < 0 ? -(long long)value : value, value < 0, 10)
+                    : formatInteger((unsigned int)value, false, base)) {}
+String::String(long value, unsigned char base)
+    : s_(base == 10 ? formatInteger(value < 0 ? -(long long)value : value, value < 0, 10)
+                    : formatInteger((unsigned long)value, false, base)) {}
+String::String(long long value, unsigned char base)
+    : s_(base == 10 ? formatInteger(value < 0 ? -(unsigned long long)value : value, value < 0, 10)
+                    : formatInteger((unsigned long long)value, false, base)) {}
+
+String::String(float value, unsigned int decimalPlaces) : String((double)value, decimalPlaces) {}
+
+String::String(double value, unsigned int decimalPlaces) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+    s_ = buf;
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+    if (s_.size() != other.s_.size()) return false;
+    for (size_t i = 0; i < s_.size(); i++) {
+        if (tolower((unsigned char)s_[i]) != tolower((unsigned char)other.s_[i])) return false;
+    }
+    return true;
+}
+
+bool String::startsWith(const String& prefix, unsigned int offset) const {
+    if (offset > s_.size() || prefix.s_.size() > s_.size() - offset) return false;
+    return s_.compare(offset, prefix.s_.size(), prefix.s_) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+    if (suffix.s_.size() > s_.size()) return false;
+    return s_.compare(s_.size() - suffix.s_.size(), suffix.s_.size(), suffix.s_) == 0;
+}
+
+void String::getBytes(unsigned char* buf, unsigned int size, unsigned int index) const {
+    if (!size || !buf) return;
+    if (index >= s_.size()) {
+        buf[0] = 0;
+        return;
+    }
+    size_t n = std::min((size_t)size - 1, s_.size() - index);
+    memcpy(buf, s_.data() + index, n);
+    buf[n] = 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    if (from >= s_.size()) return -1;
+    size_t pos = s_.find(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::indexOf(const String& text, unsigned int from) const {
+    if (from >= s_.size()) return -1;
+    size_t pos = s_.find(text.s_, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(char c) const {
+    return s_.empty() ? -1 : lastIndexOf(c, s_.size() - 1);
+}
+
+int String::lastIndexOf(char c, unsigned int from) const {
+    if (s_.empty()) return -1;
+    size_t pos = s_.rfind(c, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+int String::lastIndexOf(const String& text) const {
+    return s_.empty() ? -1 : lastIndexOf(text, s_.size() - 1);
+}
+
+int String::lastIndexOf(const String& text, unsigned int from) const {
+    if (text.s_.size() > s_.size()) return -1;
+    size_t pos = s_.rfind(text.s_, from);
+    return pos == std::string::npos ? -1 : (int)pos;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= s_.size()) return String();
+    if (to > s_.size()) to = s_.size();
+    return String(s_.data() + from, to - from);
+}
+
+void String::replace(char find, char with) {
+    for (char& c : s_) {
+        if (c == find) c = with;
+    }
+}
+
+void String::replace(const String& find, const String& with) {
+    if (find.s_.empty()) return;
+    size_t pos = 0;
+    while ((pos = s_.find(find.s_, pos)) != std::string::npos) {
+        s_.replace(pos, find.s_.size(), with.s_);
+        pos += with.s_.size();
+    }
+}
+
+void String::remove(unsigned int index) {
+    if (index < s_.size()) s_.erase(index);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index < s_.size()) s_.erase(index, count);
+}
+
+void String::toLowerCase() {
+    for (char& c : s_) c = tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+    for (char& c : s_) c = toupper((unsigned char)c);
+}
+
+void String::trim() {
+    size_t start = 0;
+    while (start < s_.size() && isspace((unsigned char)s_[start])) start++;
+    size_t end = s_.size();
+    while (end > start && isspace((unsigned char)s_[end - 1])) end--;
+    s_ = s_.substr(start, end - start);
+}
+
+long String::toInt() const {
+    return atol(s_.c_str());
+}
+
+float String::toFloat() const {
+    return (float)atof(s_.c_str());
+}
+
+double String::toDouble() const {
+    return atof(s_.c_str());
+}
+
+String operator+(const String& a, const String& b) {
+    String result(a);
+    result += b;
+    return result;
+}
+
+String operator+(const String& a, const char* b) {
+    String result(a);
+    result += b;
+    return result;
+}
+
+String operator+(const char* a, const String& b) {
+    String result(a);
+    result += b;
+    return result;
+}
+
+String operator+(const String& a, char b) {
+    String result(a);
+    result += b;
+    return result;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file WString.h
+ * @brief Arduino String for the host build
+ * @details Same interface as the ESP32 core's String, backed by std::string.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+
+class __FlashStringHelper;
+
+class String {
+public:
+    String() {}
+    String(const char* text) : s_(text ? text : "") {}
+    String(const char* text, size_t length) : s_(text, length) {}
+    String(const __FlashStringHelper* text) : String(reinterpret_cast<const char*>(text)) {}
+    String(const String& other) = default;
+    String(String&& other) noexcept = default;
+    explicit String(char c) : s_(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(long long value, unsigned char base = 10);
+    explicit String(unsigned long long value, unsigned char base = 10);
+    explicit String(float value, unsigned int decimalPlaces = 2);
+    explicit String(double value, unsigned int decimalPlaces = 2);
+
+    String& operator=(const String& other) = default;
+    String& operator=(String&& other) noexcept = default;
+    String& operator=(const char* text) {
+        s_ = text ? text : "";
+        return *this;
+    }
+
+    bool reserve(size_t size) {
+        s_.reserve(size);
+        return true;
+    }
+    size_t length() const { return s_.size(); }
+    bool isEmpty() const { return s_.empty(); }
+    const char* c_str() const { return s_.c_str(); }
+    char* begin() { return &s_[0]; }
+    char* end() { return &s_[0] + s_.size(); }
+    const char* begin() const { return s_.data(); }
+    const char* end() const { return s_.data() + s_.size(); }
+
+    bool concat(const String& other) {
+        s_ += other.s_;
+        return true;
+    }
+    bool concat(const char* text) {
+        if (text) s_ += text;
+        return true;
+    }
+    bool concat(const char* text, size_t length) {
+        s_.append(text, length);
+        return true;
+    }
+    bool concat(char c) {
+        s_ += c;
+        return true;
+    }
+    template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+    bool concat(T value) {
+        return concat(String(value));
+    }
+
+    String& operator+=(const String& other) {
+        concat(other);
+        return *this;
+    }
+    String& operator+=(const char* text) {
+        concat(text);
+        return *this;
+    }
+    String& operator+=(char c) {
+        concat(c);
+        return *this;
+    }
+    template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+    String& operator+=(T value) {
+        concat(String(value));
+        return *this;
+    }
+
+    int compareTo(const String& other) const { return s_.compare(other.s_); }
+    bool equals(const String& other) const { return s_ == other.s_; }
+    bool equals(const char* text) const { return s_ == (text ? text : ""); }
+    bool equalsIgnoreCase(const String& other) const;
+    bool operator==(const String& other) const { return s_ == other.s_; }
+    bool operator==(const char* text) const { return equals(text); }
+    bool operator!=(const String& other) const { return s_ != other.s_; }
+    bool operator!=(const char* text) const { return !equals(text); }
+    bool operator<(const String& other) const { return s_ < other.s_; }
+    bool operator>(const String& other) const { return s_ > other.s_; }
+    bool operator<=(const String& other) const { return s_ <= other.s_; }
+    bool operator>=(const String& other) const { return s_ >= other.s_; }
+
+    bool startsWith(const String& prefix) const { return startsWith(prefix, 0); }
+    bool startsWith(const String& prefix, unsigned int offset) const;
+    bool endsWith(const String& suffix) const;
+
+    char charAt(unsigned int index) const { return index < s_.size() ? s_[index] : 0; }
+    void setCharAt(unsigned int index, char c) {
+        if (index < s_.size()) s_[index] = c;
+    }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index) { return s_[index]; }
+    void getBytes(unsigned char* buf, unsigned int size, unsigned int index = 0) const;
+    void toCharArray(char* buf, unsigned int size, unsigned int index = 0) const {
+        getBytes((unsigned char*)buf, size, index);
+    }
+
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& text, unsigned int from = 0) const;
+    int indexOf(const char* text, unsigned int from = 0) const { return indexOf(String(text), from); }
+    int lastIndexOf(char c) const;
+    int lastIndexOf(char c, unsigned int from) const;
+    int lastIndexOf(const String& text) const;
+    int lastIndexOf(const String& text, unsigned int from) const;
+    String substring(unsigned int from) const { return substring(from, s_.size()); }
+    String substring(unsigned int from, unsigned int to) const;
+
+    void replace(char find, char with);
+    void replace(const String& find, const String& with);
+    void remove(unsigned int index);
+    void remove(unsigned int index, unsigned int count);
+    void toLowerCase();
+    void toUpperCase();
+    void trim();
+
+    long toInt() const;
+    float toFloat() const;
+    double toDouble() const;
+
+private:
+    std::string s_;
+};
+
+String operator+(const String& a, const String& b);
+String operator+(const String& a, const char* b);
+String operator+(const char* a, const String& b);
+String operator+(const String& a, char b);
+
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+String operator+(const String& a, T value) {
+    String result(a);
+    result += value;
+    return result;
+}
+
+inline bool operator==(const char* a, const String& b) {
+    return b == a;
+}
+inline bool operator!=(const char* a, const String& b) {
+    return b != a;
+}
@@ -0,0 +1,238 @@
+/**
+ * @file WebServer.cpp
+ * @brief In-process ESP32 WebServer for the host build
+ */
+
+#include "WebServer.h"
+#include "host_hal.h"
+#include "host_internal.h"
+#include <deque>
+
+static WebServer* activeServer = nullptr;
+static std::deque<HostRequest> pendingRequests;
+static std::vector<HostResponse> finishedResponses;
+
+static HTTPMethod parseMethod(const std::string& method) {
+    static const struct {
+        const char* name;
+        HTTPMethod method;
+    } METHODS[] = {{"GET", HTTP_GET},     {"HEAD", HTTP_HEAD},     {"POST", HTTP_POST},      {"PUT", HTTP_PUT},
+                   {"PATCH", HTTP_PATCH}, {"DELETE", HTTP_DELETE}, {"OPTIONS", HTTP_OPTIONS}};
+    for (const auto& entry : METHODS) {
+        if (method == entry.name) return entry.method;
+    }
+    return HTTP_GET;
+}
+
+static String urlDecode(const std::string& text) {
+    String decoded;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '+') {
+            decoded += ' ';
+        } else if (text[i] == '%' && i + 2 < text.size()) {
+            decoded += (char)strtol(text.substr(i + 1, 2).c_str(), nullptr, 16);
+            i += 2;
+        } else {
+            decoded += text[i];
+        }
+    }
+    return decoded;
+}
+
+WebServer::WebServer(int port) {
+    activeServer = this;
+}
+
+WebServer::~WebServer() {
+    if (activeServer == this) activeServer = nullptr;
+}
+
+void WebServer::begin() {
+    started_ = true;
+}
+
+void WebServer::stop() {
+    started_ = false;
+}
+
+void WebServer::handleClient() {
+    // One client per call, as on the device
+    if (!started_ || pendingRequests.empty()) return;
+    HostRequest request = pendingRequests.front();
+    pendingRequests.pop_front();
+    finishedResponses.push_back(hostHandle(request));
+}
+
+void WebServer::addHandler(RequestHandler* handler) {
+    handlers_.push_back(handler);
+}
+
+String WebServer::arg(const String& name) {
+    for (const auto& arg : args_) {
+        if (arg.first == name) return arg.second;
+    }
+    return String();
+}
+
+String WebServer::arg(int index) {
+    return index >= 0 && index < (int)args_.size() ? args_[index].second : String();
+}
+
+String WebServer::argName(int index) {
+    return index >= 0 && index < (int)args_.size() ? args_[index].first : String();
+}
+
+bool WebServer::hasArg(const String& name) {
+    for (const auto& arg : args_) {
+        if (arg.first == name) return true;
+    }
+    return false;
+}
+
+void WebServer::collectHeaders(const char* headerKeys[], const size_t count) {
+    collected_.clear();
+    for (size_t i = 0; i < count; i++) collected_.push_back(headerKeys[i]);
+}
+
+String WebServer::header(const String& name) {
+    for (const auto& header : headers_) {
+        if (header.first.equalsIgnoreCase(name)) return header.second;
+    }
+    return String();
+}
+
+bool WebServer::hasHeader(const String& name) {
+    for (const auto& header : headers_) {
+        if (header.first.equalsIgnoreCase(name)) return true;
+    }
+    return false;
+}
+
+void WebServer::startResponse(int code, const char* contentType, size_t contentLength) {
+    if (!response_) return;
+    response_->code = code;
+    response_->contentType = contentType ? contentType : "";
+    response_->headers = pendingHeaders_;
+    pendingHeaders_.clear();
+    if (contentLength != CONTENT_LENGTH_UNKNOWN && contentLength != CONTENT_LENGTH_NOT_SET) {
+        response_->headers.push_back({"Content-Length", std::to_string(contentLength)});
+    }
+    contentLength_ = CONTENT_LENGTH_NOT_SET;
+}
+
+void WebServer::send(int code, const char* contentType, const String& content) {
+    startResponse(code, contentType, contentLength_ == CONTENT_LENGTH_NOT_SET ? content.length() : contentLength_);
+    if (content.length()) client_.write((const uint8_t*)content.c_str(), content.length());
+}
+
+void WebServer::send(int code, const char* contentType, const char* content) {
+    send(code, contentType, String(content));
+}
+
+void WebServer::send_P(int code, PGM_P contentType, PGM_P content) {
+    send_P(code, contentType, content, content ? strlen(content) : 0);
+}
+
+void WebServer::send_P(int code, PGM_P contentType, PGM_P content, size_t contentLength) {
+    startResponse(code, contentType, contentLength);
+    if (contentLength) client_.write((const uint8_t*)content, contentLength);
+}
+
+void WebServer::sendHeader(const String& name, const String& value, bool first) {
+    std::pair<std::string, std::string> header(name.c_str(), value.c_str());
+    if (first) {
+        pendingHeaders_.insert(pendingHeaders_.begin(), header);
+    } else {
+        pendingHeaders_.push_back(header);
+    }
+}
+
+void WebServer::sendContent(const char* content, size_t contentLength) {
+    if (contentLength) client_.write((const uint8_t*)content, contentLength);
+}
+
+HostResponse WebServer::hostHandle(const HostRequest& request) {
+    HostResponse response;
+    response_ = &response;
+    pendingHeaders_.clear();
+    contentLength_ = CONTENT_LENGTH_NOT_SET;
+
+    // Path and query string
+    method_ = parseMethod(request.method);
+    size_t query = request.uri.find('?');
+    uri_ = request.uri.substr(0, query).c_str();
+    args_.clear();
+    if (query != std::string::npos) {
+        std::string rest = request.uri.substr(query + 1);
+        size_t start = 0;
+        while (start <= rest.size()) {
+            size_t end = rest.find('&', start);
+            if (end == std::string::npos) end = rest.size();
+            std::string pair = rest.substr(start, end - start);
+            if (!pair.empty()) {
+                size_t equals = pair.find('=');
+                args_.push_back({urlDecode(pair.substr(0, equals)),
+                                 equals == std::string::npos ? String() : urlDecode(pair.substr(equals + 1))});
+            }
+            start = end + 1;
+        }
+    }
+    for (const auto& arg : request.args) args_.push_back({arg.first.c_str(), arg.second.c_str()});
+    if (!request.body.empty()) args_.push_back({"plain", request.body.c_str()});
+
+    headers_.clear();
+    for (const auto& header : request.headers) {
+        for (const String& key : collected_) {
+            if (key.equalsIgnoreCase(header.first.c_str())) headers_.push_back({key, header.second.c_str()});
+        }
+    }
+
+    client_ = WiFiClient(std::make_shared<HostConnection>());
+
+    bool handled = false;
+    for (RequestHandler* handler : handlers_) {
+        if (handler->canHandle(method_, uri_) && handler->handle(*this, method_, uri_)) {
+            handled = true;
+            break;
+        }
+    }
+    if (!handled) {
+        if (notFound_) {
+            notFound_();
+        } else {
+            send(404, "text/plain", String("Not found: ") + uri_);
+        }
+    }
+
+    // The server lets go of the client; a handler that copied it keeps the connection open
+    std::shared_ptr<HostConnection> connection = client_.hostConnection();
+    client_ = WiFiClient();
+    response.body.swap(connection->output);
+    if (connection.use_count() > 1 && connection->open) {
+        response.keptOpen = true;
+        response.connection = connection;
+    } else {
+        connection->open = false;
+    }
+    response_ = nullptr;
+    return response;
+}
+
+HostResponse hostRequest(const HostRequest& request) {
+    return activeServer ? activeServer->hostHandle(request) : HostResponse();
+}
+
+void hostQueueRequest(const HostRequest& request) {
+    pendingRequests.push_back(request);
+}
+
+std::vector<HostResponse> hostTakeResponses() {
+    std::vector<HostResponse> responses;
+    responses.swap(finishedResponses);
+    return responses;
+}
+
+void hostResetWebServer() {
+    pendingRequests.clear();
+    finishedResponses.clear();
+}
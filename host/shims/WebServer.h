@@ -0,0 +1,103 @@
+/**
+ * @file WebServer.h
+ * @brief ESP32 WebServer for the host build
+ * @details Requests are injected in-process with hostRequest() or
+ *          hostQueueRequest() and responses captured as HostResponse. Only
+ *          headers registered with collectHeaders() are visible to handlers,
+ *          as on the device.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "WiFi.h"
+#include <functional>
+#include <vector>
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+class WebServer;
+struct HostRequest;
+struct HostResponse;
+
+class RequestHandler {
+public:
+    virtual ~RequestHandler() {}
+    virtual bool canHandle(HTTPMethod method, const String& uri) { return false; }
+    virtual bool canUpload(const String& uri) { return false; }
+    virtual bool handle(WebServer& server, HTTPMethod requestMethod, const String& requestUri) { return false; }
+    RequestHandler* next() { return next_; }
+    void next(RequestHandler* handler) { next_ = handler; }
+
+private:
+    RequestHandler* next_ = nullptr;
+};
+
+class WebServer {
+public:
+    typedef std::function<void()> THandlerFunction;
+
+    WebServer(int port = 80);
+    ~WebServer();
+
+    void begin();
+    void begin(uint16_t port) { begin(); }
+    void stop();
+    void close() { stop(); }
+    void handleClient();
+
+    void addHandler(RequestHandler* handler);
+    void onNotFound(THandlerFunction handler) { notFound_ = handler; }
+
+    String uri() { return uri_; }
+    HTTPMethod method() { return method_; }
+    WiFiClient& client() { return client_; }
+
+    String arg(const String& name);
+    String arg(int index);
+    String argName(int index);
+    int args() { return (int)args_.size(); }
+    bool hasArg(const String& name);
+
+    void collectHeaders(const char* headerKeys[], const size_t count);
+    String header(const String& name);
+    bool hasHeader(const String& name);
+
+    void send(int code, const char* contentType = NULL, const String& content = String(""));
+    void send(int code, char* contentType, const String& content) { send(code, (const char*)contentType, content); }
+    void send(int code, const String& contentType, const String& content) { send(code, contentType.c_str(), content); }
+    void send(int code, const char* contentType, const char* content);
+    void send_P(int code, PGM_P contentType, PGM_P content);
+    void send_P(int code, PGM_P contentType, PGM_P content, size_t contentLength);
+    void setContentLength(const size_t contentLength) { contentLength_ = contentLength; }
+    void sendHeader(const String& name, const String& value, bool first = false);
+    void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+    void sendContent(const char* content, size_t contentLength);
+    void sendContent_P(PGM_P content) { sendContent(content, strlen(content)); }
+
+    // Host side: run one request through the handlers
+    HostResponse hostHandle(const HostRequest& request);
+
+private:
+    void startResponse(int code, const char* contentType, size_t contentLength);
+
+    bool started_ = false;
+    std::vector<RequestHandler*> handlers_;
+    THandlerFunction notFound_;
+    std::vector<String> collected_;
+
+    // Current request
+    String uri_;
+    HTTPMethod method_ = HTTP_GET;
+    std::vector<std::pair<String, String>> args_;
+    std::vector<std::pair<String, String>> headers_;
+    WiFiClient client_;
+
+    // Current response
+    HostResponse* response_ = nullptr;
+    std::vector<std::pair<std::string, std::string>> pendingHeaders_;
+    size_t contentLength_ = CONTENT_LENGTH_NOT_SET;
+};
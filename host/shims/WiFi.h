@@ -0,0 +1,80 @@
+/**
+ * @file WiFi.h
+ * @brief WiFi and TCP clients for the host build
+ * @details The station is "connected" whenever the host network is up, see
+ *          hostSetNetworkUp(). A WiFiClient is a handle on an in-process
+ *          connection; copies share it, like copies of a socket do.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include <memory>
+
+typedef enum {
+    WL_NO_SHIELD = 255,
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_SCAN_COMPLETED = 2,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+
+struct HostConnection;
+
+class WiFiClient : public Stream {
+public:
+    WiFiClient() {}
+    explicit WiFiClient(std::shared_ptr<HostConnection> connection) : connection_(connection) {}
+    virtual ~WiFiClient() {}
+
+    int connect(const char* host, uint16_t port);
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buffer, size_t size);
+    int peek() override;
+    size_t readBytes(char* buffer, size_t length) override { return read((uint8_t*)buffer, length); }
+    using Stream::readBytes;
+    void flush() override {}
+    void stop();
+    uint8_t connected();
+    operator bool() { return connected(); }
+    void setNoDelay(bool noDelay) {}
+    int setTimeout(uint32_t seconds) { return 0; }
+
+    // Host side: the connection this client is a handle on
+    const std::shared_ptr<HostConnection>& hostConnection() const { return connection_; }
+    void hostAttach(std::shared_ptr<HostConnection> connection) { connection_ = connection; }
+
+protected:
+    std::shared_ptr<HostConnection> connection_;
+};
+
+class WiFiClass {
+public:
+    wl_status_t status();
+    bool mode(wifi_mode_t mode);
+    wifi_mode_t getMode();
+    wl_status_t begin(const char* ssid, const char* passphrase = NULL);
+    bool disconnect(bool wifiOff = false, bool eraseAp = false);
+    bool isConnected() { return status() == WL_CONNECTED; }
+    IPAddress localIP();
+    bool softAP(const char* ssid, const char* passphrase = NULL, int channel = 1, int hidden = 0,
+                int maxConnections = 4);
+    IPAddress softAPIP();
+    bool softAPsetHostname(const char* hostname);
+    bool setHostname(const char* hostname) { return true; }
+    String SSID();
+    int32_t RSSI();
+    String macAddress() { return "24:0A:C4:00:00:01"; }
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,14 @@
+/**
+ * @file WiFiClientSecure.h
+ * @brief TLS client for the host build; the host network has no TLS layer
+ */
+
+#pragma once
+
+#include "WiFi.h"
+
+class WiFiClientSecure : public WiFiClient {
+public:
+    void setInsecure() {}
+    void setCACert(const char* rootCA) {}
+};
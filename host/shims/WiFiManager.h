@@ -0,0 +1,24 @@
+/**
+ * @file WiFiManager.h
+ * @brief WiFiManager for the host build
+ * @details Stored credentials "work" whenever the host network is up. The
+ *          configuration portal never gets a visitor: it waits out its timeout
+ *          in virtual time.
+ */
+
+#pragma once
+
+#include "WiFi.h"
+
+class WiFiManager {
+public:
+    bool autoConnect(const char* apName = NULL, const char* apPassword = NULL);
+    bool startConfigPortal(const char* apName = NULL, const char* apPassword = NULL);
+    void resetSettings() {}
+    void setConfigPortalTimeout(unsigned long seconds) { portalTimeoutSec_ = seconds; }
+    void setConnectTimeout(unsigned long seconds) {}
+    void setDebugOutput(bool debug) {}
+
+private:
+    unsigned long portalTimeoutSec_ = 0;
+};
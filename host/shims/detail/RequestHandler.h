@@ -0,0 +1,8 @@
+/**
+ * @file RequestHandler.h
+ * @brief WebServer request handler interface for the host build
+ */
+
+#pragma once
+
+#include "../WebServer.h"
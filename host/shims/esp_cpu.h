@@ -0,0 +1,15 @@
+/**
+ * @file esp_cpu.h
+ * @brief CPU cycle counter for the host build
+ * @details Counts host nanoseconds at a nominal 1000 MHz, so profiles and
+ *          timings show how long the code really takes on this machine, while
+ *          millis() follows the virtual clock.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count();
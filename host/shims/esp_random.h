@@ -0,0 +1,11 @@
+/**
+ * @file esp_random.h
+ * @brief Hardware random number generator for the host build
+ * @details Reproducible: draws from the seeded generator behind random().
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+uint32_t esp_random();
@@ -0,0 +1,17 @@
+/**
+ * @file esp_task_wdt.h
+ * @brief Task watchdog for the host build
+ * @details Checked against the virtual clock whenever it moves; a trigger is
+ *          reported rather than resetting, see hostGetWatchdogTriggers().
+ */
+
+#pragma once
+
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+esp_err_t esp_task_wdt_init(uint32_t timeoutSeconds, bool panic);
+esp_err_t esp_task_wdt_add(TaskHandle_t task);
+esp_err_t esp_task_wdt_delete(TaskHandle_t task);
+esp_err_t esp_task_wdt_reset();
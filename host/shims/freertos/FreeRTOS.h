@@ -0,0 +1,42 @@
+/**
+ * @file FreeRTOS.h
+ * @brief FreeRTOS types for the host build
+ * @details Tasks are cooperative coroutines on the host thread, see
+ *          host_hal.h. Only one runs at a time and it runs until it blocks,
+ *          so critical sections have nothing to exclude.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define tskNO_AFFINITY 0x7fffffff
+#define configMAX_TASK_NAME_LEN 16
+
+uint32_t hostGetTickRate();
+#define configTICK_RATE_HZ (hostGetTickRate())
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+
+typedef struct {
+    int unused;
+} portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portENTER_CRITICAL_SAFE(mux) ((void)(mux))
+#define portEXIT_CRITICAL_SAFE(mux) ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux) ((void)(mux))
+
+BaseType_t xPortGetCoreID();
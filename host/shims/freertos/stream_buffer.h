@@ -0,0 +1,20 @@
+/**
+ * @file stream_buffer.h
+ * @brief FreeRTOS stream buffers for the host build
+ */
+
+#pragma once
+
+#include "FreeRTOS.h"
+
+struct HostStreamBuffer;
+typedef HostStreamBuffer* StreamBufferHandle_t;
+
+StreamBufferHandle_t xStreamBufferCreate(size_t size, size_t triggerLevel);
+void vStreamBufferDelete(StreamBufferHandle_t buffer);
+size_t xStreamBufferSend(StreamBufferHandle_t buffer, const void* data, size_t length, TickType_t ticks);
+size_t xStreamBufferReceive(StreamBufferHandle_t buffer, void* data, size_t length, TickType_t ticks);
+size_t xStreamBufferBytesAvailable(StreamBufferHandle_t buffer);
+size_t xStreamBufferSpacesAvailable(StreamBufferHandle_t buffer);
+BaseType_t xStreamBufferIsEmpty(StreamBufferHandle_t buffer);
+BaseType_t xStreamBufferReset(StreamBufferHandle_t buffer);
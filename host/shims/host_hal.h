@@ -0,0 +1,318 @@
+/**
+ * @file host_hal.h
+ * @brief Controls for the Linux shims that stand in for the ESP32 libraries
+ * @details The firmware talks to the hardware through the Arduino core and
+ *          the libraries it links (Audio, SD, WiFi, WebServer, FreeRTOS). On
+ *          Linux, the headers in host/shims provide the same API on top of:
+ *
+ *          - a virtual clock: millis()/micros() only move when a task sleeps
+ *            and nothing else can run, so runs are deterministic and hours of
+ *            device time pass in seconds
+ *          - cooperative tasks: every FreeRTOS task is a coroutine on the one
+ *            host thread, scheduled by priority, switched only when it blocks
+ *          - the real filesystem: SD is a directory on the host
+ *          - a null or WAV audio sink, drained at the sample rate
+ *          - an in-process web server that requests are injected into
+ *
+ *          Nothing in src/ includes this header; tests and tools do.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// --- Virtual clock ---------------------------------------------------------
+
+/**
+ * @brief Virtual time since boot in microseconds
+ */
+uint64_t hostNowUs();
+
+/**
+ * @brief Move the virtual clock forward (tests without a scheduler)
+ */
+void hostAdvanceUs(uint64_t us);
+
+/**
+ * @brief Reset the clock, the random generator and all shim state to power-on
+ */
+void hostReset();
+
+/**
+ * @brief Seed the generator behind random() and esp_random()
+ */
+void hostSeedRandom(uint32_t seed);
+
+// --- Tasks -----------------------------------------------------------------
+
+/**
+ * @brief FreeRTOS tick rate; vTaskDelay(1) sleeps 1000 / hz ms of virtual time
+ * @details The device runs at 1000 Hz. Long simulations can use a lower rate
+ *          so per-tick loops cost fewer host cycles.
+ */
+void hostSetTickRate(uint32_t hz);
+uint32_t hostGetTickRate();
+
+/**
+ * @brief Run the tasks until the virtual clock reaches `untilUs`
+ * @return false if every task has ended
+ */
+bool hostRunUntil(uint64_t untilUs);
+
+/**
+ * @brief Run the tasks for a span of virtual time
+ */
+bool hostRunFor(uint64_t us);
+
+/**
+ * @brief Number of tasks that have not ended
+ */
+size_t hostTaskCount();
+
+/**
+ * @brief Delete all tasks without running them further
+ */
+void hostKillTasks();
+
+// Per-task accounting, for simulation reports
+struct HostTaskInfo {
+    std::string name;
+    int priority;
+    int core;
+    uint64_t switches;      // Times the task was resumed
+    uint64_t hostNs;        // Host time spent running it
+};
+
+std::vector<HostTaskInfo> hostGetTaskInfo();
+
+/**
+ * @brief Create the Arduino loopTask: setup() once, then loop() forever
+ * @details One tick passes between loop() calls so the clock can move.
+ */
+void hostStartArduino(void (*setupFunction)(), void (*loopFunction)());
+
+/**
+ * @brief Times a task subscribed to the task watchdog went unfed past its timeout
+ * @details The device would reset; the host reports it on stderr and carries on.
+ */
+uint32_t hostGetWatchdogTriggers(std::string* lastTask = nullptr);
+
+/**
+ * @brief Times ESP.restart() was called; each call ends every task
+ */
+uint32_t hostGetRestarts();
+
+// --- SD card ---------------------------------------------------------------
+
+/**
+ * @brief Host directory that SD paths are resolved against
+ */
+void hostSetSdRoot(const std::string& directory);
+const std::string& hostGetSdRoot();
+
+/**
+ * @brief Make SD.begin() fail, as with no card inserted
+ */
+void hostSetSdPresent(bool present);
+
+// --- Audio -----------------------------------------------------------------
+
+/**
+ * @brief Write everything the audio hook passes on to a 16-bit stereo WAV file
+ * @param path Host path, or empty for the null sink (the default)
+ */
+void hostSetAudioSink(const std::string& path);
+
+/**
+ * @brief Size of the modelled I2S DMA ring that the decoder fills ahead of playback
+ */
+void hostSetAudioDmaFrames(uint32_t frames);
+
+/**
+ * @brief Assumed bit rate of compressed files and streams, for durations and positions
+ */
+void hostSetAudioBitrate(uint32_t bitsPerSecond);
+
+// Output accounting of the audio shim
+struct HostAudioStats {
+    uint64_t framesOut;         // Decoded frames played
+    uint64_t silentFrames;      // Frames played as silence during a track because nothing was queued
+    uint64_t idleFrames;        // Frames of silence with no track running
+    uint32_t underruns;         // Times the output ran dry during a track
+    uint32_t tracksStarted;
+    uint32_t tracksEnded;       // Ended by reaching the end of the input
+    uint32_t streamsLost;       // Streams that ended because the connection dropped
+    uint32_t connectFailures;
+    uint64_t lastSoundUs;       // Virtual time the last decoded frame played
+};
+
+HostAudioStats hostGetAudioStats();
+
+// What the audio shim reports as it happens
+struct HostAudioEvent {
+    enum Type {
+        TRACK_STARTED,      // `source` is the path or URL
+        TRACK_ENDED,        // Decoder reached the end of the input
+        TRACK_STOPPED,      // stopSong() or a new connect while running
+        STREAM_LOST,        // Connection dropped mid-stream
+        GAP                 // Output was silent for `gapUs` and has just resumed
+    };
+    Type type;
+    uint64_t atUs;
+    uint64_t gapUs;
+    const char* source;
+    bool dropout;           // GAP: a track was running throughout, so the output underran
+};
+
+typedef void (*HostAudioEventHook)(const HostAudioEvent& event);
+
+/**
+ * @brief Receive audio events (one hook, nullptr to stop)
+ * @details Gaps are measured at the output, so they cover the time between
+ *          tracks as heard and underruns within a track. Silence before the
+ *          first sound is not reported.
+ */
+void hostSetAudioEventHook(HostAudioEventHook hook);
+
+// --- Network ---------------------------------------------------------------
+
+/**
+ * @brief Decide whether the host "network" answers a URL
+ * @details Without a handler, http(s) URLs connect and stream silence and
+ *          HTTPClient requests fail with HTTPC_ERROR_CONNECTION_REFUSED.
+ */
+struct HostHttpResponse {
+    int code = 200;             // HTTP status, or a negative HTTPClient error
+    std::string body;           // Whole body; live streams repeat it
+    bool live = false;          // Endless stream arriving at the audio bit rate, like a radio station
+    uint32_t latencyMs = 0;     // Virtual time the request takes before the first byte
+};
+
+typedef HostHttpResponse (*HostHttpHandler)(const std::string& url);
+
+void hostSetHttpHandler(HostHttpHandler handler);
+
+/**
+ * @brief Network up or down: WiFi.status() and every connect follow this
+ */
+void hostSetNetworkUp(bool up);
+
+// --- Faults ----------------------------------------------------------------
+
+/**
+ * @brief Faults the SD and network shims inject; everything is off by default
+ * @details Chances are per card access or per call, between 0 and 1. A card
+ *          access is a read or write touching a new 512-byte sector, so
+ *          byte-wise reads through the FS buffer cost one access per sector.
+ *          Latencies block the calling task for that much virtual time while
+ *          the others run, as a slow SPI transfer does. Faults draw from a
+ *          generator of their own seeded by the profile, not from random().
+ */
+struct HostFaultProfile {
+    uint32_t seed = 1;
+
+    // Every SD read access takes readLatencyUs plus up to readJitterUs; with
+    // spikeChance an access stalls on top, log-uniformly between spikeMinUs
+    // and spikeMaxUs, so short stalls are common and long ones rare
+    uint32_t sdReadLatencyUs = 0;
+    uint32_t sdReadJitterUs = 0;
+    double sdReadSpikeChance = 0;
+    double sdWriteSpikeChance = 0;
+    uint32_t sdSpikeMinUs = 0;
+    uint32_t sdSpikeMaxUs = 0;
+    double sdOpenFailChance = 0;        // Opening a file finds nothing
+    double sdCorruptChance = 0;         // A read access returns one byte flipped
+
+    // The station drops on average every wifiDropMeanSec and comes back after
+    // wifiDownMinSec..wifiDownMaxSec; live streams break with it
+    uint32_t wifiDropMeanSec = 0;       // 0: never
+    uint32_t wifiDownMinSec = 0;
+    uint32_t wifiDownMaxSec = 0;
+
+    // Live streams stop delivering on average every streamStallMeanSec for
+    // streamStallMinMs..streamStallMaxMs, then carry on where they were
+    uint32_t streamStallMeanSec = 0;    // 0: never
+    uint32_t streamStallMinMs = 0;
+    uint32_t streamStallMaxMs = 0;
+};
+
+void hostSetFaultProfile(const HostFaultProfile& profile);
+
+// What was injected since the profile was set
+struct HostFaultStats {
+    uint32_t sdSpikes;
+    uint64_t sdStallUs;         // Spikes only, not the base latency
+    uint32_t sdOpenFailures;
+    uint32_t sdCorruptReads;
+    uint32_t wifiDrops;
+    uint64_t wifiDownUs;
+    uint32_t streamStalls;
+    uint64_t streamStallUs;
+};
+
+HostFaultStats hostGetFaultStats();
+
+// --- Web server ------------------------------------------------------------
+
+struct HostRequest {
+    std::string method = "GET";
+    std::string uri = "/";
+    std::vector<std::pair<std::string, std::string>> args;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;           // Sent as the "plain" argument, like the ESP32 server does
+};
+
+struct HostConnection;
+
+struct HostResponse {
+    int code = 0;
+    std::string contentType;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;           // Content-Length, chunked and raw client writes, in order
+    bool keptOpen = false;      // Handler kept the client, e.g. an event stream
+    std::shared_ptr<HostConnection> connection;   // Set when keptOpen
+};
+
+/**
+ * @brief Run one request through the WebServer instance, as handleClient() would
+ * @details Runs on the calling context. Call from a test directly, or let the
+ *          web task pick it up with hostQueueRequest().
+ */
+HostResponse hostRequest(const HostRequest& request);
+
+/**
+ * @brief What the firmware wrote to a kept-open connection since the last call
+ */
+std::string hostConnectionRead(const std::shared_ptr<HostConnection>& connection);
+
+/**
+ * @brief Close a kept-open connection from the client side
+ */
+void hostConnectionClose(const std::shared_ptr<HostConnection>& connection);
+
+/**
+ * @brief Queue a request for the next server.handleClient()
+ */
+void hostQueueRequest(const HostRequest& request);
+
+/**
+ * @brief Responses to queued requests, oldest first, and clears them
+ */
+std::vector<HostResponse> hostTakeResponses();
+
+// --- Serial ----------------------------------------------------------------
+
+/**
+ * @brief Copy Serial output to stdout (off by default)
+ */
+void hostSetSerialEcho(bool echo);
+
+/**
+ * @brief Serial output since the last call, up to the last 64 KB
+ */
+std::string hostTakeSerialOutput();
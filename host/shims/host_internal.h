@@ -0,0 +1,116 @@
+/**
+ * @file host_internal.h
+ * @brief Glue between the host shims; not part of the firmware-facing API
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Next value of the reproducible generator behind random()
+ */
+uint32_t hostRandom32();
+
+/**
+ * @brief Whether the caller runs inside a scheduled task
+ */
+bool hostInTask();
+
+/**
+ * @brief Let `us` of virtual time pass for the caller, running other tasks meanwhile
+ */
+void hostSleepUs(uint64_t us);
+
+/**
+ * @brief End every task, the caller included; used for ESP.restart()
+ */
+void hostHaltTasks();
+
+/**
+ * @brief Stack the live tasks would take from the device heap
+ */
+size_t hostTaskStackBytes();
+
+/**
+ * @brief One end-to-end connection behind a WiFiClient
+ * @details The firmware writes `output`. It reads `input`; a live connection
+ *          repeats `input` forever, arriving at `bytesPerSecond` of virtual time.
+ */
+struct HostConnection {
+    bool open = true;
+    std::string output;
+    std::string input;
+    size_t consumed = 0;
+    bool live = false;
+    bool endsWithInput = false;     // Peer closes once `input` has been read
+    uint64_t startUs = 0;
+    uint32_t bytesPerSecond = 0;
+    uint32_t burstBytes = 0;        // Live: sent at once on connect, as stream servers do
+    uint64_t stalledAtStartUs = 0;  // Live: injected stall time before the connection opened
+};
+
+/**
+ * @brief Assumed bit rate of compressed audio, shared by the audio and network shims
+ */
+uint32_t hostGetAudioBitrate();
+
+/**
+ * @brief Whether the host network is up
+ */
+bool hostNetworkUp();
+
+/**
+ * @brief Ask the HTTP handler for a URL
+ * @return false if the network is down or nobody answers
+ */
+bool hostFetch(const std::string& url, struct HostHttpResponse& response);
+
+/**
+ * @brief Connection carrying a fetched response; live ones break when the network goes down
+ */
+std::shared_ptr<HostConnection> hostOpenConnection(const struct HostHttpResponse& response);
+
+/**
+ * @brief Drop every live stream, as losing the station does
+ */
+void hostBreakLiveConnections();
+
+/**
+ * @brief Virtual time a card read or write access takes, spikes included
+ */
+uint64_t hostFaultSdReadUs();
+uint64_t hostFaultSdWriteUs();
+
+/**
+ * @brief Whether this file open fails
+ */
+bool hostFaultSdOpenFails();
+
+/**
+ * @brief Flip a byte of a read access that comes back corrupted
+ * @return true if it did
+ */
+bool hostFaultCorrupt(uint8_t* data, size_t size);
+
+/**
+ * @brief Whether the station is in a dropout now
+ */
+bool hostFaultWifiDown();
+
+/**
+ * @brief Time live streams have been stalled since boot, up to now
+ */
+uint64_t hostFaultStreamStalledUs();
+
+// Per-shim resets, called by hostReset()
+void hostResetFaults();
+void hostResetScheduler();
+void hostResetSd();
+void hostResetAudio();
+void hostResetNetwork();
+void hostResetWebServer();
+void hostResetSerial();
+void hostResetPreferences();
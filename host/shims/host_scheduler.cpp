@@ -0,0 +1,578 @@
+/**
+ * @file host_scheduler.cpp
+ * @brief Virtual clock and cooperative FreeRTOS tasks for the host build
+ * @details Each task is a ucontext coroutine with its own stack, entered
+ *          once with swapcontext() and switched with _setjmp()/_longjmp()
+ *          after that, which skip the signal mask system calls. The
+ *          scheduler resumes the highest-priority task that can run, round
+ *          robin within a priority, and the task runs until it blocks. When no
+ *          task can run, the clock jumps to the earliest wake-up. Code between
+ *          blocking calls takes no virtual time.
+ *
+ *          Outside hostRunUntil() there is no current task: blocking calls
+ *          made straight from a test advance the clock by their timeout and
+ *          return, so single-threaded tests need no scheduler.
+ */
+
+// Jumps between task stacks look like jumps into dead frames to the fortified longjmp
+#undef _FORTIFY_SOURCE
+
+#include "host_hal.h"
+#include "host_internal.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/stream_buffer.h"
+#include "esp_task_wdt.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+#define HOST_TASK_STACK_BYTES (512 * 1024)   // Host frames are larger than Xtensa ones
+#define WAIT_FOREVER UINT64_MAX
+
+struct HostTask {
+    std::string name;
+    TaskFunction_t function;
+    void* parameter;
+    int priority;
+    int core;
+    ucontext_t context;                 // First entry
+    jmp_buf jump;                       // Where it resumes after that
+    bool entered;
+    char* stack;
+    uint32_t stackDepth;     // What the firmware asked for, which the device takes from its heap
+    enum { READY, WAITING, DONE } state;
+    uint64_t wakeAtUs;                  // WAITING: end of the timeout
+    std::function<bool()> wakeWhen;     // WAITING: ends the wait early once true
+    uint32_t notifications;
+    uint64_t lastRun;                   // Round robin within a priority
+    uint64_t switches;
+    uint64_t hostNs;
+    // Task watchdog
+    bool watched;
+    uint64_t lastFeedUs;
+};
+
+struct HostSemaphore {
+    UBaseType_t count;
+    UBaseType_t maxCount;
+};
+
+struct HostStreamBuffer {
+    std::vector<uint8_t> data;
+    size_t head;        // Next byte to read
+    size_t used;
+    size_t triggerLevel;
+};
+
+static uint64_t nowUs = 0;
+static uint32_t tickRateHz = 1000;
+static std::vector<HostTask*> tasks;
+static size_t taskStackBytes = 0;        // Sum of the stack depths the firmware asked for
+static HostTask* current = nullptr;
+static ucontext_t schedulerContext;
+static jmp_buf schedulerJump;
+static uint64_t runCounter = 0;
+static uint32_t mainNotifications = 0;
+
+// Task watchdog state
+static uint64_t watchdogTimeoutUs = 5000000;
+static bool watchdogPanic = false;
+static uint32_t watchdogTriggers = 0;
+static std::string lastWatchdogTask;
+
+// Small, fast and reproducible; random() on the device is not reproducible at all
+static uint64_t randomState = 0x9e3779b97f4a7c15ULL;
+
+uint64_t hostNowUs() {
+    return nowUs;
+}
+
+void hostAdvanceUs(uint64_t us) {
+    nowUs += us;
+}
+
+void hostSeedRandom(uint32_t seed) {
+    randomState = 0x9e3779b97f4a7c15ULL ^ ((uint64_t)seed << 1 | 1);
+}
+
+uint32_t hostRandom32() {
+    // splitmix64
+    uint64_t z = (randomState += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return (uint32_t)((z ^ (z >> 31)) >> 32);
+}
+
+void hostSetTickRate(uint32_t hz) {
+    tickRateHz = hz ? hz : 1000;
+}
+
+uint32_t hostGetTickRate() {
+    return tickRateHz;
+}
+
+static uint64_t ticksToUs(TickType_t ticks) {
+    if (ticks == portMAX_DELAY) return WAIT_FOREVER;
+    return (uint64_t)ticks * 1000000 / tickRateHz;
+}
+
+// --- Switching -------------------------------------------------------------
+
+/**
+ * @brief Suspend the running task and return to the scheduler loop
+ */
+static void switchToScheduler(HostTask* self) {
+    if (_setjmp(self->jump) == 0) _longjmp(schedulerJump, 1);
+}
+
+/**
+ * @brief Run `task` until it switches back
+ */
+static void switchToTask(HostTask* task) {
+    if (_setjmp(schedulerJump) != 0) return;
+    if (!task->entered) {
+        task->entered = true;
+        swapcontext(&schedulerContext, &task->context);
+    } else {
+        _longjmp(task->jump, 1);
+    }
+}
+
+// --- Blocking --------------------------------------------------------------
+
+bool hostInTask() {
+    return current != nullptr;
+}
+
+/**
+ * @brief Block the calling task until `condition` holds or the timeout passes.
+ * @return true if the condition holds (always true without a condition)
+ */
+static bool blockUntil(uint64_t timeoutUs, std::function<bool()> condition) {
+    if (condition && condition()) return true;
+
+    if (!current) {
+        // No scheduler: nobody else can make the condition true, so just let the time pass
+        if (timeoutUs != WAIT_FOREVER) nowUs += timeoutUs;
+        return condition ? condition() : true;
+    }
+
+    HostTask* self = current;
+    self->state = HostTask::WAITING;
+    self->wakeAtUs = timeoutUs == WAIT_FOREVER ? WAIT_FOREVER : nowUs + timeoutUs;
+    self->wakeWhen = std::move(condition);
+    switchToScheduler(self);
+    bool satisfied = self->wakeWhen ? self->wakeWhen() : true;
+    self->wakeWhen = nullptr;
+    return satisfied;
+}
+
+void hostSleepUs(uint64_t us) {
+    blockUntil(us, nullptr);
+}
+
+// --- Tasks -----------------------------------------------------------------
+
+static void taskEntry() {
+    HostTask* self = current;
+    self->function(self->parameter);
+    // A FreeRTOS task must not return; here it simply ends
+    vTaskDelete(NULL);
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stackDepth, void* parameter,
+                                   UBaseType_t priority, TaskHandle_t* created, BaseType_t core) {
+    HostTask* task = new HostTask();
+    task->name = name ? name : "";
+    task->function = function;
+    task->parameter = parameter;
+    task->priority = priority;
+    task->core = core;
+    // Mapped rather than malloc'd, so the host stack stays out of the modelled heap
+    void* stack = mmap(nullptr, HOST_TASK_STACK_BYTES, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (stack == MAP_FAILED) {
+        delete task;
+        return pdFAIL;
+    }
+    task->stack = (char*)stack;
+    task->stackDepth = stackDepth;
+    taskStackBytes += stackDepth;
+    task->state = HostTask::READY;
+    task->wakeAtUs = 0;
+    task->notifications = 0;
+    task->lastRun = 0;
+    task->switches = 0;
+    task->hostNs = 0;
+    task->watched = false;
+    task->lastFeedUs = 0;
+    task->entered = false;
+
+    getcontext(&task->context);
+    task->context.uc_stack.ss_sp = task->stack;
+    task->context.uc_stack.ss_size = HOST_TASK_STACK_BYTES;
+    task->context.uc_link = &schedulerContext;
+    makecontext(&task->context, taskEntry, 0);
+
+    tasks.push_back(task);
+    if (created) *created = task;
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stackDepth, void* parameter,
+                       UBaseType_t priority, TaskHandle_t* created) {
+    return xTaskCreatePinnedToCore(function, name, stackDepth, parameter, priority, created, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    HostTask* target = task ? task : current;
+    if (!target) return;   // Called from a test, not from a task
+    target->state = HostTask::DONE;
+    target->watched = false;
+    if (target == current) {
+        switchToScheduler(target);
+        abort();   // A deleted task is never resumed
+    }
+}
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) {
+        taskYIELD();
+        return;
+    }
+    blockUntil(ticksToUs(ticks), nullptr);
+}
+
+void taskYIELD() {
+    if (!current) return;
+    HostTask* self = current;
+    self->state = HostTask::READY;
+    switchToScheduler(self);
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)(nowUs * tickRateHz / 1000000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return current;
+}
+
+const char* pcTaskGetName(TaskHandle_t task) {
+    HostTask* target = task ? task : current;
+    return target ? target->name.c_str() : "main";
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    return HOST_TASK_STACK_BYTES;
+}
+
+BaseType_t xPortGetCoreID() {
+    return current && current->core != tskNO_AFFINITY ? current->core : 0;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    if (task) {
+        task->notifications++;
+    } else {
+        mainNotifications++;
+    }
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+    uint32_t* counter = current ? &current->notifications : &mainNotifications;
+    blockUntil(ticksToUs(ticks), [counter] { return *counter > 0; });
+    uint32_t value = *counter;
+    if (value) *counter = clearOnExit ? 0 : value - 1;
+    return value;
+}
+
+// --- Scheduler -------------------------------------------------------------
+
+static bool canRun(HostTask* task) {
+    if (task->state == HostTask::READY) return true;
+    if (task->state != HostTask::WAITING) return false;
+    return task->wakeAtUs <= nowUs || (task->wakeWhen && task->wakeWhen());
+}
+
+static void reapTasks() {
+    for (size_t i = 0; i < tasks.size();) {
+        if (tasks[i]->state == HostTask::DONE) {
+            munmap(tasks[i]->stack, HOST_TASK_STACK_BYTES);
+            taskStackBytes -= tasks[i]->stackDepth;
+            delete tasks[i];
+            tasks.erase(tasks.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+/**
+ * @brief Raise the task watchdog for every watched task that went unfed for too long.
+ */
+static void checkWatchdog() {
+    for (HostTask* task : tasks) {
+        if (!task->watched || nowUs - task->lastFeedUs < watchdogTimeoutUs) continue;
+        watchdogTriggers++;
+        lastWatchdogTask = task->name;
+        fprintf(stderr, "[host] task watchdog: %s not fed for %llu ms at %llu ms\n", task->name.c_str(),
+                (unsigned long long)((nowUs - task->lastFeedUs) / 1000), (unsigned long long)(nowUs / 1000));
+        if (watchdogPanic && getenv("HOST_WDT_ABORT")) abort();
+        task->lastFeedUs = nowUs;   // Report again only after another full timeout
+    }
+}
+
+bool hostRunUntil(uint64_t untilUs) {
+    for (;;) {
+        reapTasks();
+        if (tasks.empty()) {
+            if (nowUs < untilUs) nowUs = untilUs;
+            return false;
+        }
+        if (nowUs >= untilUs) return true;
+
+        HostTask* next = nullptr;
+        for (HostTask* task : tasks) {
+            if (!canRun(task)) continue;
+            if (!next || task->priority > next->priority ||
+                (task->priority == next->priority && task->lastRun < next->lastRun)) {
+                next = task;
+            }
+        }
+
+        if (!next) {
+            // Everyone is asleep: jump to the first wake-up
+            uint64_t wake = WAIT_FOREVER;
+            for (HostTask* task : tasks) {
+                if (task->state == HostTask::WAITING) wake = std::min(wake, task->wakeAtUs);
+                // Stop where a watchdog would bite, so it is reported at the right time
+                if (task->watched) wake = std::min(wake, task->lastFeedUs + watchdogTimeoutUs);
+            }
+            nowUs = std::min(wake, untilUs);
+            checkWatchdog();
+            continue;
+        }
+
+        next->state = HostTask::READY;
+        next->lastRun = ++runCounter;
+        next->switches++;
+        current = next;
+        auto started = std::chrono::steady_clock::now();
+        switchToTask(next);
+        next->hostNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - started).count();
+        current = nullptr;
+    }
+}
+
+bool hostRunFor(uint64_t us) {
+    return hostRunUntil(nowUs + us);
+}
+
+size_t hostTaskCount() {
+    size_t count = 0;
+    for (HostTask* task : tasks) {
+        if (task->state != HostTask::DONE) count++;
+    }
+    return count;
+}
+
+void hostKillTasks() {
+    for (HostTask* task : tasks) task->state = HostTask::DONE;
+    reapTasks();
+}
+
+size_t hostTaskStackBytes() {
+    return taskStackBytes;
+}
+
+void hostHaltTasks() {
+    for (HostTask* task : tasks) task->state = HostTask::DONE;
+    if (current) {
+        switchToScheduler(current);
+        abort();
+    }
+}
+
+std::vector<HostTaskInfo> hostGetTaskInfo() {
+    std::vector<HostTaskInfo> info;
+    for (HostTask* task : tasks) {
+        if (task->state == HostTask::DONE) continue;
+        info.push_back({task->name, task->priority, task->core, task->switches, task->hostNs});
+    }
+    return info;
+}
+
+// --- Arduino loop task -----------------------------------------------------
+
+static void (*arduinoSetup)() = nullptr;
+static void (*arduinoLoop)() = nullptr;
+
+static void loopTask(void* parameter) {
+    arduinoSetup();
+    for (;;) {
+        arduinoLoop();
+        // The device calls loop() back to back; here one tick passes so the clock can move
+        vTaskDelay(1);
+    }
+}
+
+void hostStartArduino(void (*setupFunction)(), void (*loopFunction)()) {
+    arduinoSetup = setupFunction;
+    arduinoLoop = loopFunction;
+    xTaskCreatePinnedToCore(loopTask, "loopTask", 8192, nullptr, 1, nullptr, 1);
+}
+
+// --- Semaphores ------------------------------------------------------------
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new HostSemaphore{1, 1};
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return new HostSemaphore{0, 1};
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+    return new HostSemaphore{initialCount, maxCount};
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+    if (!blockUntil(ticksToUs(ticks), [semaphore] { return semaphore->count > 0; })) return pdFALSE;
+    semaphore->count--;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    if (semaphore->count >= semaphore->maxCount) return pdFALSE;
+    semaphore->count++;
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
+
+// --- Stream buffers --------------------------------------------------------
+
+StreamBufferHandle_t xStreamBufferCreate(size_t size, size_t triggerLevel) {
+    HostStreamBuffer* buffer = new HostStreamBuffer();
+    buffer->data.resize(size);
+    buffer->head = 0;
+    buffer->used = 0;
+    buffer->triggerLevel = triggerLevel ? triggerLevel : 1;
+    return buffer;
+}
+
+void vStreamBufferDelete(StreamBufferHandle_t buffer) {
+    delete buffer;
+}
+
+size_t xStreamBufferSend(StreamBufferHandle_t buffer, const void* data, size_t length, TickType_t ticks) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    size_t sent = 0;
+    uint64_t deadline = ticks == portMAX_DELAY ? WAIT_FOREVER : nowUs + ticksToUs(ticks);
+    for (;;) {
+        size_t capacity = buffer->data.size();
+        while (sent < length && buffer->used < capacity) {
+            buffer->data[(buffer->head + buffer->used) % capacity] = bytes[sent++];
+            buffer->used++;
+        }
+        if (sent == length || nowUs >= deadline) return sent;
+        if (!blockUntil(deadline == WAIT_FOREVER ? WAIT_FOREVER : deadline - nowUs,
+                        [buffer] { return buffer->used < buffer->data.size(); })) {
+            return sent;
+        }
+    }
+}
+
+size_t xStreamBufferReceive(StreamBufferHandle_t buffer, void* data, size_t length, TickType_t ticks) {
+    blockUntil(ticksToUs(ticks), [buffer] { return buffer->used >= buffer->triggerLevel; });
+    uint8_t* bytes = (uint8_t*)data;
+    size_t count = std::min(length, buffer->used);
+    for (size_t i = 0; i < count; i++) {
+        bytes[i] = buffer->data[buffer->head];
+        buffer->head = (buffer->head + 1) % buffer->data.size();
+    }
+    buffer->used -= count;
+    return count;
+}
+
+size_t xStreamBufferBytesAvailable(StreamBufferHandle_t buffer) {
+    return buffer->used;
+}
+
+size_t xStreamBufferSpacesAvailable(StreamBufferHandle_t buffer) {
+    return buffer->data.size() - buffer->used;
+}
+
+BaseType_t xStreamBufferIsEmpty(StreamBufferHandle_t buffer) {
+    return buffer->used == 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xStreamBufferReset(StreamBufferHandle_t buffer) {
+    buffer->head = 0;
+    buffer->used = 0;
+    return pdPASS;
+}
+
+// --- Task watchdog ---------------------------------------------------------
+
+esp_err_t esp_task_wdt_init(uint32_t timeoutSeconds, bool panic) {
+    watchdogTimeoutUs = (uint64_t)timeoutSeconds * 1000000;
+    watchdogPanic = panic;
+    return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_add(TaskHandle_t task) {
+    HostTask* target = task ? task : current;
+    if (!target) return ESP_OK;   // Tests run without a task to watch
+    if (target->watched) return ESP_ERR_INVALID_ARG;
+    target->watched = true;
+    target->lastFeedUs = nowUs;
+    return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_delete(TaskHandle_t task) {
+    HostTask* target = task ? task : current;
+    if (!target) return ESP_OK;
+    if (!target->watched) return ESP_ERR_INVALID_ARG;
+    target->watched = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_reset() {
+    if (!current) return ESP_OK;
+    if (!current->watched) return ESP_ERR_NOT_FOUND;
+    current->lastFeedUs = nowUs;
+    return ESP_OK;
+}
+
+uint32_t hostGetWatchdogTriggers(std::string* lastTask) {
+    if (lastTask) *lastTask = lastWatchdogTask;
+    return watchdogTriggers;
+}
+
+// --- Reset -----------------------------------------------------------------
+
+void hostResetScheduler() {
+    hostKillTasks();
+    nowUs = 0;
+    tickRateHz = 1000;
+    runCounter = 0;
+    mainNotifications = 0;
+    watchdogTimeoutUs = 5000000;
+    watchdogPanic = false;
+    watchdogTriggers = 0;
+    lastWatchdogTask.clear();
+    hostSeedRandom(0);
+}
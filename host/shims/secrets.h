@@ -0,0 +1,11 @@
+/**
+ * @file secrets.h
+ * @brief Placeholder credentials for the host build
+ * @details The device build reads the real ones from src/managers/secrets.h,
+ *          which is kept out of the repository.
+ */
+
+#pragma once
+
+#define WIFI_SSID_NAME "GhostWhisper"
+#define OFFLINE_AP_PASSWORD "ghostwhisper"
@@ -0,0 +1,703 @@
+// Long-run simulation of the firmware on the host build.
+//
+// Boots the firmware through setup()/loop() on the virtual clock and lets it
+// play for hours of device time: files play for the duration their size gives
+// at the shim's bit rate, scripted web requests arrive at set times, and the
+// run ends with statistics and pass/fail checks on what was heard:
+//
+//   - gaps: silences at the output, between tracks and within them
+//   - repeats: the same file started twice in a row
+//   - heap: free heap sampled every minute, and its trend
+//   - notes per minute: soundfont notes started, and all tracks started
+//
+// With --faults the SD and network shims inject a named fault profile (SD
+// latency spikes, failed opens, corrupted reads, WiFi dropouts, stream
+// stalls) and the report adds dropouts: silences inside a running track.
+// Several profiles, or "all", run one after the other from the same seed and
+// end with a table of the gaps under each. Faults are expected to cost audio,
+// so under a profile other than "none" only an explicit --max-gap fails the
+// run on gaps; the firmware must still not stall, restart or leak.
+//
+// With --trace the firmware's flight recorder runs for every category from
+// boot, and its ring - the last events before the end of the run - is written
+// to the file as Chrome Trace Event JSON, like a /trace download.
+//
+//   cmake -S host -B build/host && cmake --build build/host --target firmware_sim
+//   ./build/host/firmware_sim --hours 10 --program shuffle --json sim.json
+//   ./build/host/firmware_sim --hours 2 --program stream --faults all
+//   ./build/host/firmware_sim --hours 1 --program stream --faults venue --trace venue.trace.json
+//
+// Script files have one request per line, "<seconds> <METHOD> <uri>", e.g.
+//   3600 GET /volume/set?level=5
+//   7200 POST /program/generative
+
+#include "config/config.h"
+#include "host_fixtures.h"
+#include "host_hal.h"
+#include "managers/tracer.h"
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <math.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+void setup();
+void loop();
+
+static const uint64_t US_PER_SECOND = 1000000;
+static const uint64_t US_PER_MINUTE = 60 * US_PER_SECOND;
+
+struct ScriptedRequest {
+    uint64_t atUs;
+    HostRequest request;
+};
+
+struct SimOptions {
+    double hours = 10;
+    std::string program = "generative";
+    std::string sdRoot;                 // Empty: the fixture card
+    uint32_t seed = 1;
+    uint32_t tickHz = 100;
+    double maxGapSeconds = -1;          // Negative: the program's default
+    bool maxGapGiven = false;
+    int64_t maxHeapDrop = 32 * 1024;    // Bytes lost between the first and last hour
+    const char* jsonPath = nullptr;
+    bool echoSerial = false;
+    std::string wavPath;
+    std::string tracePath;
+    std::vector<ScriptedRequest> requests;
+    std::vector<std::string> faults = {"none"};
+};
+
+// --- Fault profiles --------------------------------------------------------
+
+static const char* const FAULT_PROFILES[] = {"none", "slow-sd", "flaky-sd", "wifi-drops", "stalls", "venue"};
+
+static bool faultProfile(const std::string& name, uint32_t seed, HostFaultProfile& profile) {
+    profile = HostFaultProfile();
+    profile.seed = seed;
+    bool venue = name == "venue";
+    if (name == "slow-sd" || venue) {
+        // A worn card: slow sectors, and writes that stall for hundreds of milliseconds
+        profile.sdReadLatencyUs = 1500;
+        profile.sdReadJitterUs = 2000;
+        profile.sdReadSpikeChance = 0.002;
+        profile.sdWriteSpikeChance = 0.05;
+        profile.sdSpikeMinUs = 20000;
+        profile.sdSpikeMaxUs = 600000;
+    }
+    if (name == "flaky-sd") {
+        // A card that is failing: rare long stalls, opens that fail and bits that flip
+        profile.sdReadSpikeChance = 0.002;
+        profile.sdWriteSpikeChance = 0.05;
+        profile.sdSpikeMinUs = 50000;
+        profile.sdSpikeMaxUs = 1500000;
+        profile.sdOpenFailChance = 0.02;
+        profile.sdCorruptChance = 0.001;
+    }
+    if (venue) {
+        profile.sdOpenFailChance = 0.005;
+        profile.sdCorruptChance = 0.0005;
+    }
+    if (name == "wifi-drops" || venue) {
+        profile.wifiDropMeanSec = 20 * 60;
+        profile.wifiDownMinSec = 5;
+        profile.wifiDownMaxSec = 90;
+    }
+    if (name == "stalls" || venue) {
+        profile.streamStallMeanSec = 5 * 60;
+        profile.streamStallMinMs = 500;
+        profile.streamStallMaxMs = 8000;
+    }
+    return std::find(std::begin(FAULT_PROFILES), std::end(FAULT_PROFILES), name) != std::end(FAULT_PROFILES);
+}
+
+// --- Observations ----------------------------------------------------------
+
+struct Start {
+    uint64_t atUs;
+    uint32_t source;        // Index into sources
+};
+
+struct Minute {
+    uint32_t freeHeap;
+    uint16_t starts;
+    uint16_t notes;
+};
+
+static std::vector<std::string> sources;
+static std::map<std::string, uint32_t> sourceIds;
+static std::vector<Start> starts;
+static std::vector<uint64_t> gaps;
+static uint64_t longestGapUs = 0;
+static uint64_t longestGapEndUs = 0;
+static std::vector<uint64_t> dropouts;  // Gaps inside a running track
+static uint32_t eventCounts[HostAudioEvent::GAP + 1] = {};
+
+static void onAudioEvent(const HostAudioEvent& event) {
+    eventCounts[event.type]++;
+    if (event.type == HostAudioEvent::TRACK_STARTED) {
+        auto found = sourceIds.find(event.source);
+        uint32_t id;
+        if (found == sourceIds.end()) {
+            id = sources.size();
+            sources.push_back(event.source);
+            sourceIds[event.source] = id;
+        } else {
+            id = found->second;
+        }
+        starts.push_back({event.atUs, id});
+    } else if (event.type == HostAudioEvent::GAP) {
+        gaps.push_back(event.gapUs);
+        if (event.dropout) dropouts.push_back(event.gapUs);
+        if (event.gapUs > longestGapUs) {
+            longestGapUs = event.gapUs;
+            longestGapEndUs = event.atUs;
+        }
+    }
+}
+
+// Every station URL is a live stream at the audio bit rate; the upstream
+// catalog is not modelled, so the firmware keeps the catalog on the card
+static HostHttpResponse answerUrl(const std::string& url) {
+    HostHttpResponse response;
+    if (url == CATALOG_SOURCE_URL) {
+        response.code = 404;
+        return response;
+    }
+    response.body = std::string(4096, '\x55');
+    response.live = true;
+    response.latencyMs = 300;
+    return response;
+}
+
+static bool isNote(uint32_t source) {
+    return sources[source].rfind("/soundfont/", 0) == 0;
+}
+
+// --- Options ---------------------------------------------------------------
+
+static bool parseRequest(const std::string& line, ScriptedRequest& scripted) {
+    char method[16], uri[512];
+    double seconds;
+    if (sscanf(line.c_str(), "%lf %15s %511s", &seconds, method, uri) != 3) return false;
+    scripted.atUs = (uint64_t)(seconds * US_PER_SECOND);
+    scripted.request.method = method;
+    scripted.request.uri = uri;
+    return true;
+}
+
+static bool loadScript(const char* path, std::vector<ScriptedRequest>& requests) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+    char line[600];
+    int number = 0;
+    bool ok = true;
+    while (fgets(line, sizeof(line), file)) {
+        number++;
+        std::string text = line;
+        if (text.find_first_not_of(" \t\r\n") == std::string::npos || text[text.find_first_not_of(" \t")] == '#') {
+            continue;
+        }
+        ScriptedRequest scripted;
+        if (!parseRequest(text, scripted)) {
+            fprintf(stderr, "%s:%d: expected \"<seconds> <METHOD> <uri>\"\n", path, number);
+            ok = false;
+            continue;
+        }
+        requests.push_back(scripted);
+    }
+    fclose(file);
+    return ok;
+}
+
+static void printUsage(const char* program) {
+    fprintf(stderr,
+            "usage: %s [--hours N] [--program generative|shuffle|stream] [--sd DIR] [--seed N]\n"
+            "          [--tick-hz N] [--script FILE] [--request \"SECONDS METHOD URI\"]...\n"
+            "          [--max-gap SECONDS] [--max-heap-drop BYTES] [--json FILE] [--wav FILE] [--trace FILE]\n"
+            "          [--serial] [--faults none|slow-sd|flaky-sd|wifi-drops|stalls|venue[,...]|all]\n",
+            program);
+}
+
+static bool parseOptions(int argc, char** argv, SimOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--hours" && hasValue) {
+            options.hours = atof(argv[++i]);
+        } else if (arg == "--program" && hasValue) {
+            options.program = argv[++i];
+        } else if (arg == "--sd" && hasValue) {
+            options.sdRoot = argv[++i];
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--tick-hz" && hasValue) {
+            options.tickHz = strtoul(argv[++i], nullptr, 0);
+        } else if (arg == "--script" && hasValue) {
+            if (!loadScript(argv[++i], options.requests)) return false;
+        } else if (arg == "--request" && hasValue) {
+            ScriptedRequest scripted;
+            if (!parseRequest(argv[++i], scripted)) {
+                fprintf(stderr, "bad --request \"%s\"\n", argv[i]);
+                return false;
+            }
+            options.requests.push_back(scripted);
+        } else if (arg == "--max-gap" && hasValue) {
+            options.maxGapSeconds = atof(argv[++i]);
+            options.maxGapGiven = true;
+        } else if (arg == "--max-heap-drop" && hasValue) {
+            options.maxHeapDrop = atoll(argv[++i]);
+        } else if (arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        } else if (arg == "--wav" && hasValue) {
+            options.wavPath = argv[++i];
+        } else if (arg == "--trace" && hasValue) {
+            options.tracePath = argv[++i];
+        } else if (arg == "--faults" && hasValue) {
+            std::string list = argv[++i];
+            options.faults.clear();
+            if (list == "all") list = "none,slow-sd,flaky-sd,wifi-drops,stalls,venue";
+            for (size_t start = 0; start <= list.size();) {
+                size_t comma = std::min(list.find(',', start), list.size());
+                std::string name = list.substr(start, comma - start);
+                HostFaultProfile profile;
+                if (!faultProfile(name, options.seed, profile)) {
+                    fprintf(stderr, "unknown fault profile \"%s\"\n", name.c_str());
+                    return false;
+                }
+                options.faults.push_back(name);
+                start = comma + 1;
+            }
+        } else if (arg == "--serial") {
+            options.echoSerial = true;
+        } else {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    // The firmware's shortest waits are 10 ms, which must stay at least one tick
+    if (options.tickHz < 100 || options.tickHz > 1000) {
+        fprintf(stderr, "--tick-hz must be between 100 and 1000\n");
+        return false;
+    }
+
+    // The firmware boots into GENERATIVE; other programs are picked from the web UI
+    if (options.program == "shuffle") {
+        ScriptedRequest scripted;
+        parseRequest("10 GET /program/shuffle?folder=/music", scripted);
+        options.requests.push_back(scripted);
+        if (options.maxGapSeconds < 0) options.maxGapSeconds = 2;
+    } else if (options.program == "stream") {
+        ScriptedRequest scripted;
+        parseRequest("10 GET /program/stream", scripted);
+        options.requests.push_back(scripted);
+        if (options.maxGapSeconds < 0) options.maxGapSeconds = 5;
+    } else if (options.program == "generative") {
+        // Notes are 5-50 s apart; a field sound follows every sequence
+        if (options.maxGapSeconds < 0) options.maxGapSeconds = 60;
+    } else {
+        fprintf(stderr, "unknown program \"%s\"\n", options.program.c_str());
+        return false;
+    }
+    std::stable_sort(options.requests.begin(), options.requests.end(),
+                     [](const ScriptedRequest& a, const ScriptedRequest& b) { return a.atUs < b.atUs; });
+    return true;
+}
+
+// --- Report ----------------------------------------------------------------
+
+struct Summary {
+    double hostSeconds;
+    uint64_t simulatedUs;
+    HostAudioStats audio;
+    uint32_t watchdogTriggers;
+    uint32_t restarts;
+    size_t tasks;
+    uint32_t responses;
+    uint32_t failedResponses;
+    uint64_t trailingSilenceUs;
+    uint32_t immediateRepeats;
+    uint32_t distinctSources;
+    uint32_t minPlays, maxPlays;     // Over the sources of the program's folder
+    double notesPerMinute;
+    uint32_t quietestMinuteNotes;
+    double startsPerMinute;
+    uint64_t gapP50Us, gapP99Us;
+    uint64_t dropoutP99Us, dropoutLongestUs, dropoutTotalUs;
+    HostFaultStats faults;
+    uint32_t heapFirst, heapMin, heapLast;
+    double heapSlopePerHour;         // Least-squares trend after the first hour
+};
+
+static uint64_t percentile(std::vector<uint64_t> values, double fraction) {
+    if (values.empty()) return 0;
+    size_t index = std::min(values.size() - 1, (size_t)(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+static Summary summarize(const SimOptions& options, const std::vector<Minute>& minutes, double hostSeconds,
+                         uint32_t responses, uint32_t failedResponses) {
+    Summary s = {};
+    s.hostSeconds = hostSeconds;
+    s.simulatedUs = hostNowUs();
+    s.audio = hostGetAudioStats();
+    s.watchdogTriggers = hostGetWatchdogTriggers();
+    s.restarts = hostGetRestarts();
+    s.tasks = hostTaskCount();
+    s.responses = responses;
+    s.failedResponses = failedResponses;
+    s.trailingSilenceUs = s.audio.framesOut ? s.simulatedUs - s.audio.lastSoundUs : s.simulatedUs;
+
+    std::vector<uint32_t> plays(sources.size());
+    for (size_t i = 0; i < starts.size(); i++) {
+        plays[starts[i].source]++;
+        if (i > 0 && starts[i].source == starts[i - 1].source) s.immediateRepeats++;
+    }
+    s.distinctSources = sources.size();
+    const char* folder = options.program == "shuffle" ? "/music/" : options.program == "generative" ? "/soundfont/" : "";
+    s.minPlays = UINT32_MAX;
+    for (size_t i = 0; i < sources.size(); i++) {
+        if (sources[i].rfind(folder, 0) != 0) continue;
+        s.minPlays = std::min(s.minPlays, plays[i]);
+        s.maxPlays = std::max(s.maxPlays, plays[i]);
+    }
+    if (s.minPlays == UINT32_MAX) s.minPlays = 0;
+
+    // Per-minute rates skip the boot minute
+    uint64_t notes = 0, startCount = 0;
+    s.quietestMinuteNotes = UINT32_MAX;
+    for (size_t i = 1; i < minutes.size(); i++) {
+        notes += minutes[i].notes;
+        startCount += minutes[i].starts;
+    }
+    size_t counted = minutes.size() > 1 ? minutes.size() - 1 : 1;
+    s.notesPerMinute = (double)notes / counted;
+    s.startsPerMinute = (double)startCount / counted;
+    // Notes come 5-50 s apart, so a single minute can be empty; judge ten-minute windows
+    for (size_t i = 1; i + 10 <= minutes.size(); i += 10) {
+        uint32_t window = 0;
+        for (size_t j = i; j < i + 10; j++) window += minutes[j].notes;
+        s.quietestMinuteNotes = std::min(s.quietestMinuteNotes, window);
+    }
+    if (s.quietestMinuteNotes == UINT32_MAX) s.quietestMinuteNotes = 0;
+
+    s.gapP50Us = percentile(gaps, 0.5);
+    s.gapP99Us = percentile(gaps, 0.99);
+    s.dropoutP99Us = percentile(dropouts, 0.99);
+    for (uint64_t us : dropouts) {
+        s.dropoutLongestUs = std::max(s.dropoutLongestUs, us);
+        s.dropoutTotalUs += us;
+    }
+    s.faults = hostGetFaultStats();
+
+    s.heapMin = UINT32_MAX;
+    for (const Minute& minute : minutes) s.heapMin = std::min(s.heapMin, minute.freeHeap);
+    if (!minutes.empty()) {
+        s.heapFirst = minutes[std::min<size_t>(60, minutes.size() - 1)].freeHeap;
+        s.heapLast = minutes.back().freeHeap;
+    }
+    double n = 0, sumX = 0, sumY = 0, sumXY = 0, sumXX = 0;
+    for (size_t i = 60; i < minutes.size(); i++) {
+        double x = i / 60.0, y = minutes[i].freeHeap;
+        n++, sumX += x, sumY += y, sumXY += x * y, sumXX += x * x;
+    }
+    if (n > 1 && n * sumXX != sumX * sumX) s.heapSlopePerHour = (n * sumXY - sumX * sumY) / (n * sumXX - sumX * sumX);
+    return s;
+}
+
+static void check(bool passed, const char* what, std::string& failures) {
+    if (!passed) failures += std::string("  FAIL ") + what + "\n";
+}
+
+static void printReport(const SimOptions& options, const std::string& faults, const Summary& s) {
+    printf("Simulated %.2f h of %s%s%s in %.1f s (%.0fx real time)\n", s.simulatedUs / 3.6e9, options.program.c_str(),
+           faults == "none" ? "" : " with faults ", faults == "none" ? "" : faults.c_str(), s.hostSeconds,
+           s.hostSeconds > 0 ? s.simulatedUs / 1e6 / s.hostSeconds : 0);
+    printf("  audio: %.2f h played, %u underruns (%.1f s silent in tracks), %u tracks started, %u ended, "
+           "%u stopped, %u streams lost, %u connect failures\n",
+           s.audio.framesOut / 44100.0 / 3600, s.audio.underruns, s.audio.silentFrames / 44100.0,
+           s.audio.tracksStarted, eventCounts[HostAudioEvent::TRACK_ENDED], eventCounts[HostAudioEvent::TRACK_STOPPED],
+           s.audio.streamsLost, s.audio.connectFailures);
+    printf("  gaps: %zu, median %.1f s, p99 %.1f s, longest %.1f s ending at %.2f h, %.1f s silent at the end\n",
+           gaps.size(), s.gapP50Us / 1e6, s.gapP99Us / 1e6, longestGapUs / 1e6, longestGapEndUs / 3.6e9,
+           s.trailingSilenceUs / 1e6);
+    printf("  dropouts: %zu, p99 %.2f s, longest %.2f s, %.1f s in all\n", dropouts.size(), s.dropoutP99Us / 1e6,
+           s.dropoutLongestUs / 1e6, s.dropoutTotalUs / 1e6);
+    if (faults != "none") {
+        printf("  faults: %u SD stalls (%.1f s), %u failed opens, %u corrupt reads, %u WiFi dropouts (%.0f s down), "
+               "%u stream stalls (%.1f s)\n",
+               s.faults.sdSpikes, s.faults.sdStallUs / 1e6, s.faults.sdOpenFailures, s.faults.sdCorruptReads,
+               s.faults.wifiDrops, s.faults.wifiDownUs / 1e6, s.faults.streamStalls, s.faults.streamStallUs / 1e6);
+    }
+    printf("  starts: %.2f/min, notes %.2f/min (quietest 10 min: %u), %u distinct files, plays per file %u-%u, "
+           "%u immediate repeats\n",
+           s.startsPerMinute, s.notesPerMinute, s.quietestMinuteNotes, s.distinctSources, s.minPlays, s.maxPlays,
+           s.immediateRepeats);
+    printf("  heap: %u free after 1 h, %u at the end, %u lowest, trend %+.0f bytes/h\n", s.heapFirst, s.heapLast,
+           s.heapMin, s.heapSlopePerHour);
+    printf("  system: %zu tasks running, %u watchdog triggers, %u restarts, %u requests (%u failed)\n", s.tasks,
+           s.watchdogTriggers, s.restarts, s.responses, s.failedResponses);
+}
+
+static bool writeJson(const char* path, const SimOptions& options, const std::string& faults, const Summary& s,
+                      const std::vector<Minute>& minutes, const std::string& failures) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file,
+            "{\n  \"program\": \"%s\", \"faults\": \"%s\", \"seed\": %u, \"hours\": %.3f, \"host_seconds\": %.3f,\n",
+            options.program.c_str(), faults.c_str(), options.seed, s.simulatedUs / 3.6e9, s.hostSeconds);
+    fprintf(file,
+            "  \"audio\": {\"frames_out\": %llu, \"silent_frames\": %llu, \"idle_frames\": %llu, \"underruns\": %u, "
+            "\"tracks_started\": %u, \"tracks_ended\": %u, \"tracks_stopped\": %u, \"streams_lost\": %u, "
+            "\"connect_failures\": %u},\n",
+            (unsigned long long)s.audio.framesOut, (unsigned long long)s.audio.silentFrames,
+            (unsigned long long)s.audio.idleFrames, s.audio.underruns, s.audio.tracksStarted,
+            eventCounts[HostAudioEvent::TRACK_ENDED], eventCounts[HostAudioEvent::TRACK_STOPPED], s.audio.streamsLost,
+            s.audio.connectFailures);
+    fprintf(file,
+            "  \"gaps\": {\"count\": %zu, \"p50_s\": %.3f, \"p99_s\": %.3f, \"longest_s\": %.3f, \"longest_end_h\": %.3f, "
+            "\"trailing_s\": %.3f},\n",
+            gaps.size(), s.gapP50Us / 1e6, s.gapP99Us / 1e6, longestGapUs / 1e6, longestGapEndUs / 3.6e9,
+            s.trailingSilenceUs / 1e6);
+    fprintf(file, "  \"dropouts\": {\"count\": %zu, \"p99_s\": %.3f, \"longest_s\": %.3f, \"total_s\": %.3f},\n",
+            dropouts.size(), s.dropoutP99Us / 1e6, s.dropoutLongestUs / 1e6, s.dropoutTotalUs / 1e6);
+    fprintf(file,
+            "  \"injected\": {\"sd_stalls\": %u, \"sd_stall_s\": %.3f, \"sd_open_failures\": %u, "
+            "\"sd_corrupt_reads\": %u, \"wifi_drops\": %u, \"wifi_down_s\": %.3f, \"stream_stalls\": %u, "
+            "\"stream_stall_s\": %.3f},\n",
+            s.faults.sdSpikes, s.faults.sdStallUs / 1e6, s.faults.sdOpenFailures, s.faults.sdCorruptReads,
+            s.faults.wifiDrops, s.faults.wifiDownUs / 1e6, s.faults.streamStalls, s.faults.streamStallUs / 1e6);
+    fprintf(file,
+            "  \"starts\": {\"per_minute\": %.3f, \"notes_per_minute\": %.3f, \"quietest_10min_notes\": %u, "
+            "\"distinct\": %u, \"min_plays\": %u, \"max_plays\": %u, \"immediate_repeats\": %u},\n",
+            s.startsPerMinute, s.notesPerMinute, s.quietestMinuteNotes, s.distinctSources, s.minPlays, s.maxPlays,
+            s.immediateRepeats);
+    fprintf(file, "  \"heap\": {\"after_1h\": %u, \"last\": %u, \"min\": %u, \"slope_per_hour\": %.1f, \"per_minute\": [",
+            s.heapFirst, s.heapLast, s.heapMin, s.heapSlopePerHour);
+    for (size_t i = 0; i < minutes.size(); i++) fprintf(file, "%s%u", i ? ", " : "", minutes[i].freeHeap);
+    fprintf(file, "]},\n  \"notes_per_minute\": [");
+    for (size_t i = 0; i < minutes.size(); i++) fprintf(file, "%s%u", i ? ", " : "", minutes[i].notes);
+    fprintf(file,
+            "],\n  \"system\": {\"tasks\": %zu, \"watchdog_triggers\": %u, \"restarts\": %u, \"requests\": %u, "
+            "\"failed_requests\": %u},\n",
+            s.tasks, s.watchdogTriggers, s.restarts, s.responses, s.failedResponses);
+    fprintf(file, "  \"passed\": %s\n}\n", failures.empty() ? "true" : "false");
+    fclose(file);
+    return true;
+}
+
+static void writeTraceChunk(const char* data, size_t length, void* context) {
+    fwrite(data, 1, length, (FILE*)context);
+}
+
+static bool writeTrace(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+    size_t events = exportTrace(writeTraceChunk, file);
+    bool written = !ferror(file);
+    written = fclose(file) == 0 && written;
+    printf("  trace: %zu events in %s\n", events, path);
+    return written;
+}
+
+// --- Run -------------------------------------------------------------------
+
+// What a run under one fault profile reports back for the comparison table
+struct GapRow {
+    double playedPercent;
+    size_t gaps;
+    uint64_t gapP99Us, longestGapUs, trailingSilenceUs;
+    size_t dropouts;
+    uint64_t dropoutP99Us, dropoutLongestUs, dropoutTotalUs;
+    uint32_t streamsLost;
+    bool passed;
+};
+
+// "run.json" becomes "run.slow-sd.json" when several profiles run
+static std::string profilePath(const std::string& path, const std::string& faults, bool several) {
+    if (!several || path.empty()) return path;
+    size_t dot = path.rfind('.');
+    size_t slash = path.rfind('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) dot = path.size();
+    return path.substr(0, dot) + "." + faults + path.substr(dot);
+}
+
+static int runProfile(const SimOptions& options, const std::string& faults, bool several, GapRow& row) {
+    std::string sdRoot = options.sdRoot.empty() ? hostMakeSdCard() : options.sdRoot;
+
+    // Everything the run records is reserved before the heap baseline is taken,
+    // so the free heap the firmware sees only moves with its own allocations
+    uint64_t endUs = (uint64_t)(options.hours * 3600 * US_PER_SECOND);
+    std::vector<Minute> minutes;
+    minutes.reserve(endUs / US_PER_MINUTE + 2);
+    starts.reserve(endUs / US_PER_SECOND + 16);
+    gaps.reserve(endUs / US_PER_SECOND + 16);
+    dropouts.reserve(endUs / US_PER_SECOND + 16);
+
+    // The trace ring sits in PSRAM on the device, so it is allocated before the
+    // baseline too rather than showing up as internal heap
+    std::string tracePath = profilePath(options.tracePath, faults, several);
+    if (!tracePath.empty() && !startTrace(TRACE_ALL_CATEGORIES)) {
+        fprintf(stderr, "tracing is not available\n");
+        return 2;
+    }
+
+    hostReset();
+    hostSeedRandom(options.seed);
+    hostSetTickRate(options.tickHz);
+    hostSetSerialEcho(options.echoSerial);
+    std::string wavPath = profilePath(options.wavPath, faults, several);
+    if (!wavPath.empty()) hostSetAudioSink(wavPath);
+    hostSetSdRoot(sdRoot);
+    hostSetAudioEventHook(onAudioEvent);
+    hostSetHttpHandler(answerUrl);
+    HostFaultProfile profile;
+    faultProfile(faults, options.seed, profile);
+    hostSetFaultProfile(profile);
+
+    auto hostStart = std::chrono::steady_clock::now();
+    hostStartArduino(setup, loop);
+
+    size_t nextRequest = 0;
+    uint32_t responses = 0, failedResponses = 0;
+    size_t startsSeen = 0;
+    for (uint64_t minuteEnd = US_PER_MINUTE; hostNowUs() < endUs; minuteEnd += US_PER_MINUTE) {
+        uint64_t until = std::min(minuteEnd, endUs);
+        while (nextRequest < options.requests.size() && options.requests[nextRequest].atUs <= until) {
+            if (!hostRunUntil(options.requests[nextRequest].atUs)) break;
+            hostQueueRequest(options.requests[nextRequest].request);
+            nextRequest++;
+        }
+        if (!hostRunUntil(until)) {
+            fprintf(stderr, "all tasks ended at %.2f h\n", hostNowUs() / 3.6e9);
+            break;
+        }
+        for (const HostResponse& response : hostTakeResponses()) {
+            responses++;
+            if (response.code < 200 || response.code >= 400) failedResponses++;
+            if (response.keptOpen) hostConnectionClose(response.connection);
+        }
+        hostTakeSerialOutput();
+
+        Minute minute = {ESP.getFreeHeap(), 0, 0};
+        for (; startsSeen < starts.size(); startsSeen++) {
+            minute.starts++;
+            if (isNote(starts[startsSeen].source)) minute.notes++;
+        }
+        minutes.push_back(minute);
+    }
+    std::chrono::duration<double> hostSeconds = std::chrono::steady_clock::now() - hostStart;
+
+    Summary summary = summarize(options, minutes, hostSeconds.count(), responses, failedResponses);
+    hostSetAudioEventHook(nullptr);
+    hostKillTasks();
+    hostSetAudioSink("");
+
+    std::string failures;
+    uint64_t maxGapUs = (uint64_t)(options.maxGapSeconds * US_PER_SECOND);
+    bool judgeGaps = faults == "none" || options.maxGapGiven;
+    check(summary.watchdogTriggers == 0, "task watchdog triggered", failures);
+    check(summary.restarts == 0, "firmware restarted", failures);
+    check(summary.tasks > 0, "all tasks ended", failures);
+    check(!judgeGaps || summary.audio.underruns == 0, "output underran during a track", failures);
+    check(!judgeGaps || (longestGapUs <= maxGapUs && summary.trailingSilenceUs <= maxGapUs),
+          "silence longer than --max-gap", failures);
+    check((int64_t)summary.heapFirst - (int64_t)summary.heapLast <= options.maxHeapDrop,
+          "free heap dropped more than --max-heap-drop", failures);
+    if (options.program == "generative") {
+        check(options.hours < 0.5 || summary.quietestMinuteNotes > 0, "ten minutes without a note", failures);
+    }
+    if (options.program == "shuffle") {
+        check(summary.immediateRepeats == 0, "a track repeated back to back", failures);
+    }
+
+    row = {summary.audio.framesOut * 100.0 / 44100 / (summary.simulatedUs / 1e6),
+           gaps.size(),
+           summary.gapP99Us,
+           longestGapUs,
+           summary.trailingSilenceUs,
+           dropouts.size(),
+           summary.dropoutP99Us,
+           summary.dropoutLongestUs,
+           summary.dropoutTotalUs,
+           summary.audio.streamsLost,
+           failures.empty()};
+    printReport(options, faults, summary);
+    if (!tracePath.empty() && !writeTrace(tracePath.c_str())) {
+        fprintf(stderr, "cannot write %s\n", tracePath.c_str());
+        return 2;
+    }
+    std::string jsonPath = profilePath(options.jsonPath ? options.jsonPath : "", faults, several);
+    if (!jsonPath.empty() && !writeJson(jsonPath.c_str(), options, faults, summary, minutes, failures)) {
+        fprintf(stderr, "cannot write %s\n", jsonPath.c_str());
+        return 2;
+    }
+    if (!failures.empty()) {
+        printf("%s", failures.c_str());
+        return 1;
+    }
+    printf("  all checks passed\n");
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    SimOptions options;
+    if (!parseOptions(argc, argv, options)) return 2;
+
+    GapRow row;
+    if (options.faults.size() == 1) return runProfile(options, options.faults[0], false, row);
+
+    // The firmware's globals only boot once per process, so each profile runs
+    // in a child of its own and sends its row back through a pipe
+    std::vector<GapRow> rows;
+    int worst = 0;
+    for (const std::string& faults : options.faults) {
+        int pipeFds[2];
+        fflush(stdout);
+        if (pipe(pipeFds) != 0) return 2;
+        pid_t child = fork();
+        if (child < 0) return 2;
+        if (child == 0) {
+            close(pipeFds[0]);
+            GapRow childRow = {};
+            int code = runProfile(options, faults, true, childRow);
+            fflush(stdout);
+            if (write(pipeFds[1], &childRow, sizeof(childRow)) != (ssize_t)sizeof(childRow)) code = 2;
+            _exit(code);
+        }
+        close(pipeFds[1]);
+        GapRow childRow = {};
+        bool received = read(pipeFds[0], &childRow, sizeof(childRow)) == (ssize_t)sizeof(childRow);
+        close(pipeFds[0]);
+        int status = 0;
+        waitpid(child, &status, 0);
+        int code = WIFEXITED(status) ? WEXITSTATUS(status) : 2;
+        if (!received) {
+            fprintf(stderr, "profile %s did not finish\n", faults.c_str());
+            code = 2;
+        }
+        worst = std::max(worst, code);
+        rows.push_back(childRow);
+        printf("\n");
+    }
+
+    printf("Audio gaps by fault profile (%s, %.2f h, seed %u):\n", options.program.c_str(), options.hours,
+           options.seed);
+    printf("  %-12s %7s  %6s %7s %9s %8s  %8s %7s %9s %8s  %5s  %s\n", "profile", "played", "gaps", "p99 s",
+           "longest s", "at end s", "dropouts", "p99 s", "longest s", "total s", "lost", "checks");
+    for (size_t i = 0; i < rows.size(); i++) {
+        const GapRow& r = rows[i];
+        printf("  %-12s %6.1f%%  %6zu %7.2f %9.2f %8.1f  %8zu %7.2f %9.2f %8.1f  %5u  %s\n", options.faults[i].c_str(),
+               r.playedPercent, r.gaps, r.gapP99Us / 1e6, r.longestGapUs / 1e6, r.trailingSilenceUs / 1e6, r.dropouts,
+               r.dropoutP99Us / 1e6, r.dropoutLongestUs / 1e6, r.dropoutTotalUs / 1e6, r.streamsLost,
+               r.passed ? "passed" : "FAILED");
+    }
+    return worst;
+}
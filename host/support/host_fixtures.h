@@ -0,0 +1,102 @@
+/**
+ * @file host_fixtures.h
+ * @brief SD card contents for the host tests and benchmarks
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Scratch directory for an SD card, removed at exit
+ */
+inline std::string hostTempDir() {
+    char path[] = "/tmp/ghostwhisper-host-XXXXXX";
+    if (!mkdtemp(path)) abort();
+    static std::vector<std::string> created;
+    static bool cleanupRegistered = false;
+    created.push_back(path);
+    if (!cleanupRegistered) {
+        cleanupRegistered = true;
+        atexit([] {
+            for (const std::string& dir : created) {
+                std::string command = "rm -rf '" + dir + "'";
+                if (system(command.c_str()) != 0) fprintf(stderr, "could not remove %s\n", dir.c_str());
+            }
+        });
+    }
+    return path;
+}
+
+/**
+ * @brief Write a file below `root`, creating its directories
+ */
+inline void hostWriteFile(const std::string& root, const std::string& path, const std::string& content) {
+    std::string full = root + path;
+    for (size_t slash = root.size() + 1; (slash = full.find('/', slash)) != std::string::npos; slash++) {
+        if (mkdir(full.substr(0, slash).c_str(), 0755) != 0 && errno != EEXIST) abort();
+    }
+    FILE* file = fopen(full.c_str(), "wb");
+    if (!file) abort();
+    fwrite(content.data(), 1, content.size(), file);
+    fclose(file);
+}
+
+/**
+ * @brief Stand-in compressed track: `seconds` of input at the shims' 128 kbps
+ */
+inline std::string hostFakeMp3(uint32_t seconds) {
+    return std::string((size_t)seconds * 128000 / 8, '\0');
+}
+
+/**
+ * @brief 16-bit PCM WAV with a constant sample value
+ */
+inline std::string hostWav(uint32_t sampleRate, uint16_t channels, uint32_t frames, int16_t value) {
+    std::string wav = "RIFF....WAVEfmt ";
+    auto put16 = [&wav](uint16_t v) { wav += (char)(v & 0xff), wav += (char)(v >> 8); };
+    auto put32 = [&wav, &put16](uint32_t v) { put16(v & 0xffff), put16(v >> 16); };
+    put32(16);
+    put16(1);
+    put16(channels);
+    put32(sampleRate);
+    put32(sampleRate * channels * 2);
+    put16(channels * 2);
+    put16(16);
+    wav += "data";
+    put32(frames * channels * 2);
+    for (uint32_t i = 0; i < frames * channels; i++) put16((uint16_t)value);
+    uint32_t riffSize = wav.size() - 8;
+    memcpy(&wav[4], &riffSize, 4);
+    return wav;
+}
+
+/**
+ * @brief SD card layout the firmware expects, as scan_sd_card.py would describe it
+ */
+inline std::string hostMakeSdCard() {
+    std::string root = hostTempDir();
+    const char* notes[] = {"c4", "d4", "e4", "g4", "a4", "c5"};
+    for (const char* note : notes) hostWriteFile(root, std::string("/soundfont/piano/") + note + ".mp3", hostFakeMp3(2));
+    hostWriteFile(root, "/field/rain.mp3", hostFakeMp3(8));
+    hostWriteFile(root, "/music/one.mp3", hostFakeMp3(20));
+    hostWriteFile(root, "/music/two.mp3", hostFakeMp3(25));
+    hostWriteFile(root, "/music/three.wav", hostWav(44100, 2, 44100 * 15, 1000));
+    hostWriteFile(root, "/meme/airhorn.mp3", hostFakeMp3(3));
+    hostWriteFile(root, "/data.json",
+                  "{\n"
+                  "    \"field\": {\"files\": [\"rain.mp3\"]},\n"
+                  "    \"meme\": {\"files\": [\"airhorn.mp3\"]},\n"
+                  "    \"music\": {\"files\": [\"one.mp3\", \"two.mp3\", \"three.wav\"]},\n"
+                  "    \"soundfont\": {\"piano\": {\"files\": [\"c4.mp3\", \"d4.mp3\", \"e4.mp3\", \"g4.mp3\", "
+                  "\"a4.mp3\", \"c5.mp3\"]}}\n"
+                  "}\n");
+    return root;
+}
@@ -0,0 +1,92 @@
+// Gain stage: the volume and attenuation curves, and GainRamp steps, retargets and steady gain
+
+#include "host_test.h"
+#include "config/config.h"
+#include "hardware/audio_gain.h"
+
+TEST(volumeFollowsTheDbCurve) {
+    CHECK_EQ(volumeToGainQ15(0), 0);
+    CHECK_EQ(volumeToGainQ15(-5), 0);
+    CHECK_EQ(volumeToGainQ15(MAX_VOLUME), GAIN_UNITY_Q15);
+    CHECK_EQ(volumeToGainQ15(MAX_VOLUME + 20), GAIN_UNITY_Q15);
+    // 50% sits VOLUME_RANGE_DB / 2 below full scale: 32768 * 10^(-25/20)
+    CHECK_EQ(volumeToGainQ15(50), 1843);
+    CHECK(volumeToGainQ15(1) > 0);
+    for (int percent = 1; percent <= MAX_VOLUME; percent++) {
+        CHECK(volumeToGainQ15(percent) > volumeToGainQ15(percent - 1));
+    }
+}
+
+TEST(attenuationNeverExceedsUnity) {
+    CHECK_EQ(attenuationToGainQ15(0.0f), GAIN_UNITY_Q15);
+    CHECK_EQ(attenuationToGainQ15(-6.0f), GAIN_UNITY_Q15);
+    CHECK_EQ(attenuationToGainQ15(6.0206f), 16384);
+    CHECK_EQ(attenuationToGainQ15(20.0f), 3277);
+}
+
+TEST(rampStepsEveryFrameThenHolds) {
+    GainRamp ramp;
+    CHECK_EQ(ramp.current(), GAIN_UNITY_Q15);
+    ramp.setTarget(16384, 4);
+    CHECK(ramp.ramping());
+
+    int16_t samples[] = {10000, 10000, 10000, 10000, 10000, -10000};
+    ramp.process(samples, 6, 1);
+    CHECK_EQ(samples[0], (int16_t)8750);    // 28672
+    CHECK_EQ(samples[1], (int16_t)7500);    // 24576
+    CHECK_EQ(samples[2], (int16_t)6250);    // 20480
+    CHECK_EQ(samples[3], (int16_t)5000);    // 16384, the target
+    CHECK_EQ(samples[4], (int16_t)5000);
+    CHECK_EQ(samples[5], (int16_t)-5000);
+    CHECK(!ramp.ramping());
+    CHECK_EQ(ramp.current(), 16384);
+}
+
+TEST(rampAppliesOneGainToEveryChannel) {
+    GainRamp ramp;
+    ramp.setTarget(0, 2);
+    int16_t samples[] = {1000, -1000, 1000, -1000, 1000, -1000};
+    ramp.process(samples, 3, 2);
+    CHECK_EQ(samples[0], (int16_t)500);
+    CHECK_EQ(samples[1], (int16_t)-500);
+    for (int i = 2; i < 6; i++) CHECK_EQ(samples[i], (int16_t)0);
+}
+
+TEST(rampRetargetsFromWhereItIs) {
+    GainRamp ramp;
+    ramp.setTarget(0, 4);
+    int16_t samples[8] = {};
+    ramp.process(samples, 2, 1);
+    CHECK_EQ(ramp.current(), 16384);
+
+    // Back up over two frames from halfway, not from the old target
+    ramp.setTarget(GAIN_UNITY_Q15, 2);
+    int16_t more[] = {10000, 10000, 10000};
+    ramp.process(more, 3, 1);
+    CHECK_EQ(more[0], (int16_t)7500);
+    CHECK_EQ(more[1], (int16_t)10000);
+    CHECK_EQ(more[2], (int16_t)10000);
+    CHECK(!ramp.ramping());
+}
+
+TEST(rampReachesTinyChangesAndJumps) {
+    GainRamp ramp;
+    // A step that rounds to zero still moves, and stops at the target
+    ramp.setTarget(GAIN_UNITY_Q15 - 1, 100);
+    int16_t samples[10] = {};
+    ramp.process(samples, 10, 1);
+    CHECK_EQ(ramp.current(), GAIN_UNITY_Q15 - 1);
+    CHECK(!ramp.ramping());
+
+    ramp.setTarget(1000, 0);
+    CHECK_EQ(ramp.current(), 1000);
+    CHECK(!ramp.ramping());
+    ramp.reset(GAIN_UNITY_Q15);
+    CHECK_EQ(ramp.target(), GAIN_UNITY_Q15);
+
+    // Unity leaves full-scale samples alone
+    int16_t loud[] = {INT16_MIN, INT16_MAX};
+    ramp.process(loud, 1, 2);
+    CHECK_EQ(loud[0], (int16_t)INT16_MIN);
+    CHECK_EQ(loud[1], (int16_t)INT16_MAX);
+}
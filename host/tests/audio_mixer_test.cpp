@@ -0,0 +1,128 @@
+// OverlayMixer: queueing, the linear resampler across pushes, saturation and ducking
+
+#include "host_test.h"
+#include "hardware/audio_mixer.h"
+
+static int16_t overlayBuffer[64 * 2];
+
+static void startMixer(OverlayMixer& mixer, size_t capacityFrames = 64) {
+    mixer.begin(overlayBuffer, capacityFrames);
+    mixer.setOutputRate(44100);
+    mixer.setDucking(GAIN_UNITY_Q15, 0, 0);
+    mixer.start();
+}
+
+// Mix the queue into silence, so the program block ends up holding the overlay frames
+static std::vector<int16_t> drain(OverlayMixer& mixer) {
+    std::vector<int16_t> program(mixer.queuedFrames() * 2, 0);
+    CHECK_EQ(mixer.mix(program.data(), program.size() / 2), program.size() / 2);
+    return program;
+}
+
+TEST(queuesSameRateFramesAsIs) {
+    OverlayMixer mixer;
+    startMixer(mixer);
+    int16_t stereo[] = {1, -1, 2, -2, 3, -3};
+    CHECK_EQ(mixer.push(stereo, 3, 2, 44100), (size_t)3);
+    int16_t mono[] = {7, 8};
+    CHECK_EQ(mixer.push(mono, 2, 1, 44100), (size_t)2);
+    CHECK(drain(mixer) == std::vector<int16_t>({1, -1, 2, -2, 3, -3, 7, 7, 8, 8}));
+    CHECK_EQ(mixer.queuedFrames(), (size_t)0);
+}
+
+TEST(dropsFramesThatDoNotFit) {
+    OverlayMixer mixer;
+    startMixer(mixer, 8);
+    int16_t mono[10] = {};
+    CHECK_EQ(mixer.push(mono, 10, 1, 44100), (size_t)8);
+    CHECK_EQ(mixer.droppedFrames(), (uint32_t)2);
+    CHECK_EQ(mixer.freeFrames(), (size_t)0);
+
+    OverlayMixer idle;
+    CHECK_EQ(idle.push(mono, 10, 1, 44100), (size_t)0);   // Nothing queues before start()
+}
+
+TEST(upsamplesByInterpolatingAcrossPushes) {
+    OverlayMixer mixer;
+    startMixer(mixer);
+    // 22050 Hz doubles: each input frame after the first yields two output frames
+    int16_t first[] = {0, 1000, 2000, 3000};
+    CHECK_EQ(mixer.push(first, 4, 1, 22050), (size_t)6);
+    int16_t second[] = {4000};
+    CHECK_EQ(mixer.push(second, 1, 1, 22050), (size_t)2);
+    std::vector<int16_t> out = drain(mixer);
+    const int16_t expected[] = {0, 500, 1000, 1500, 2000, 2500, 3000, 3500};
+    CHECK_EQ(out.size(), (size_t)16);
+    for (size_t i = 0; i < out.size() && i < 16; i += 2) {
+        CHECK_EQ(out[i], expected[i / 2]);
+        CHECK_EQ(out[i + 1], expected[i / 2]);
+    }
+}
+
+TEST(downsamplesToTheOutputRate) {
+    OverlayMixer mixer;
+    static int16_t buffer[600 * 2];
+    mixer.begin(buffer, 600);
+    mixer.setOutputRate(44100);
+    mixer.start();
+    std::vector<int16_t> input(481 * 2, 100);
+    size_t queued = mixer.push(input.data(), 481, 2, 48000);
+    // 480 input intervals at 48 kHz are 441 frames at 44.1 kHz
+    CHECK(queued >= 440 && queued <= 442);
+    CHECK_EQ(mixer.droppedFrames(), (uint32_t)0);
+}
+
+TEST(interpolatesFullScaleSwingsWithoutOverflow) {
+    OverlayMixer mixer;
+    startMixer(mixer);
+    int16_t swing[] = {INT16_MIN, INT16_MAX, INT16_MIN};
+    CHECK_EQ(mixer.push(swing, 3, 1, 22050), (size_t)4);
+    std::vector<int16_t> out = drain(mixer);
+    CHECK_EQ(out.size(), (size_t)8);
+    if (out.size() == 8) {
+        CHECK_EQ(out[0], (int16_t)INT16_MIN);
+        CHECK(out[2] >= -1 && out[2] <= 0);
+        CHECK_EQ(out[4], (int16_t)INT16_MAX);
+        CHECK(out[6] >= -1 && out[6] <= 0);
+    }
+}
+
+TEST(mixSaturatesInsteadOfWrapping) {
+    OverlayMixer mixer;
+    startMixer(mixer);
+    int16_t overlay[] = {20000, -20000, 100, -100};
+    mixer.push(overlay, 2, 2, 44100);
+    int16_t program[] = {20000, -20000, 30000, -30000, 5, 6};
+    CHECK_EQ(mixer.mix(program, 3), (size_t)2);
+    CHECK_EQ(program[0], (int16_t)INT16_MAX);
+    CHECK_EQ(program[1], (int16_t)INT16_MIN);
+    CHECK_EQ(program[2], (int16_t)30100);
+    CHECK_EQ(program[3], (int16_t)-30100);
+    CHECK_EQ(program[4], (int16_t)5);   // Past the queued frames the program is untouched
+    CHECK_EQ(program[5], (int16_t)6);
+}
+
+TEST(ducksWhilePlayingAndReleasesAfterFinish) {
+    OverlayMixer mixer;
+    mixer.begin(overlayBuffer, 64);
+    mixer.setDucking(16384, 0, 2);
+    mixer.start();
+    CHECK(mixer.ducked());
+    int16_t overlay[] = {0, 0};
+    mixer.push(overlay, 1, 2, 44100);
+    mixer.finish();
+
+    int16_t program[] = {1000, 1000, 1000, 1000};
+    mixer.mix(program, 2);
+    CHECK_EQ(program[0], (int16_t)500);
+    CHECK_EQ(program[2], (int16_t)500);
+    CHECK(!mixer.active());
+
+    // The release ramps back to unity over two frames
+    int16_t after[] = {1000, 1000, 1000, 1000, 1000, 1000};
+    mixer.mix(after, 3);
+    CHECK_EQ(after[0], (int16_t)750);
+    CHECK_EQ(after[2], (int16_t)1000);
+    CHECK_EQ(after[4], (int16_t)1000);
+    CHECK(!mixer.ducked());
+}
@@ -0,0 +1,123 @@
+// POST /api/batch: parsing, per-command validation, program requirements and all-or-nothing queueing
+
+#include "host_test.h"
+#include <Arduino.h>
+#include "managers/audio_commands.h"
+#include "web/batch_commands.h"
+
+struct BatchResult {
+    int code;
+    std::string body;
+};
+
+static BatchResult runBatch(const char* body) {
+    char buffer[BATCH_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    int code = runCommandBatch(body, json);
+    CHECK(!json.overflowed());
+    return {code, json.c_str()};
+}
+
+static bool contains(const BatchResult& result, const char* text) {
+    return result.body.find(text) != std::string::npos;
+}
+
+// Rejected before validation, with the reader's message (as escaped in JSON) and no per-command results
+static void checkMalformed(const char* body, const char* message) {
+    size_t pending = getPendingAudioCommands();
+    BatchResult result = runBatch(body);
+    CHECK_EQ(result.code, 400);
+    CHECK_EQ(result.body, "{\"status\":\"error\",\"message\":\"" + std::string(message) + "\"}");
+    CHECK_EQ(getPendingAudioCommands(), pending);
+}
+
+// Parsed, but one command is invalid: nothing is queued and that command carries the error
+static void checkInvalid(const char* body, const char* message) {
+    size_t pending = getPendingAudioCommands();
+    BatchResult result = runBatch(body);
+    CHECK_EQ(result.code, 400);
+    CHECK(contains(result, "\"queued\":0"));
+    CHECK(contains(result, ("\"status\":\"error\",\"message\":\"" + std::string(message) + "\"").c_str()));
+    CHECK_EQ(getPendingAudioCommands(), pending);
+}
+
+// The audio command queue is shared by every case, so they run in this order
+TEST(queuesAValidBatchInOrder) {
+    CHECK_EQ(getPendingAudioCommands(), (size_t)0);
+    BatchResult result = runBatch(" [ {\"cmd\":\"volume\",\"arg\":60}, {\"cmd\":\"shuffle\",\"arg\":\"/music/dub\"},"
+                                  "{\"arg\":\"a\\/b\",\"cmd\":\"folder\"}, {\"cmd\":\"next\"} ]\n");
+    CHECK_EQ(result.code, 200);
+    CHECK(contains(result, "\"status\":\"success\""));
+    CHECK(contains(result, "\"queued\":4"));
+    CHECK(contains(result, "{\"cmd\":\"next\",\"status\":\"queued\"}"));
+    CHECK_EQ(getPendingAudioCommands(), (size_t)4);
+
+    result = runBatch("[]");
+    CHECK_EQ(result.code, 200);
+    CHECK(contains(result, "\"queued\":0"));
+    CHECK_EQ(getPendingAudioCommands(), (size_t)4);
+}
+
+TEST(rejectsMalformedBodies) {
+    checkMalformed("", "Malformed JSON");
+    checkMalformed("{\"cmd\":\"stop\"}", "Malformed JSON");
+    checkMalformed("[{\"cmd\":\"stop\"}", "Malformed JSON");
+    checkMalformed("[{\"cmd\":\"stop\"}] x", "Trailing data after the array");
+    checkMalformed("[{}]", "Command without \\\"cmd\\\"");
+    checkMalformed("[{\"arg\":1}]", "Command without \\\"cmd\\\"");
+    checkMalformed("[{\"cmd\":\"stop\",\"extra\":1}]", "Unknown key");
+    checkMalformed("[{\"cmd\":\"stop", "Unterminated string");
+    checkMalformed("[{\"cmd\":\"st\\nop\"}]", "Unsupported escape in string");
+    checkMalformed("[{\"cmd\":\"volume\",\"arg\":4294967296}]", "Number out of range");
+    checkMalformed("[{\"cmd\":\"volume\",\"arg\":1.5}]", "Malformed JSON");
+    checkMalformed("[{\"cmd\":\"volume\",\"arg\":true}]", "Malformed JSON");
+
+    std::string tooMany = "[";
+    for (int i = 0; i <= BATCH_MAX_COMMANDS; i++) tooMany += i ? ",{\"cmd\":\"stop\"}" : "{\"cmd\":\"stop\"}";
+    checkMalformed((tooMany + "]").c_str(), "Too many commands");
+    std::string longName = "[{\"cmd\":\"" + std::string(64, 'x') + "\"}]";
+    checkMalformed(longName.c_str(), "String too long");
+}
+
+TEST(validatesEveryCommandBeforeQueueing) {
+    checkInvalid("[{\"cmd\":\"stop\"},{\"cmd\":\"dance\"}]", "Unknown command");
+    checkInvalid("[{\"cmd\":\"stop\",\"arg\":1}]", "Takes no argument");
+    checkInvalid("[{\"cmd\":\"shuffle\",\"arg\":3}]", "Argument must be a string");
+    checkInvalid("[{\"cmd\":\"folder\"}]", "Needs a string argument");
+    checkInvalid("[{\"cmd\":\"connect\",\"arg\":\"\"}]", "Needs a string argument");
+    checkInvalid("[{\"cmd\":\"volume\",\"arg\":\"60\"}]", "Needs a number argument");
+    checkInvalid("[{\"cmd\":\"volume\",\"arg\":101}]", "Volume out of range");
+    checkInvalid("[{\"cmd\":\"volume\",\"arg\":-1}]", "Volume out of range");
+    checkInvalid("[{\"cmd\":\"meme\",\"arg\":1}]", "Meme not found");
+
+    // Valid commands in a rejected batch are reported but not queued
+    BatchResult result = runBatch("[{\"cmd\":\"stop\"},{\"cmd\":\"volume\",\"arg\":500}]");
+    CHECK(contains(result, "{\"cmd\":\"stop\",\"status\":\"valid\"}"));
+    CHECK(contains(result, "Invalid command in batch, nothing was queued"));
+}
+
+TEST(checksProgramsAsTheBatchSwitchesThem) {
+    // The firmware boots into the generative program
+    checkInvalid("[{\"cmd\":\"next\"}]", "Not in shuffle mode");
+    checkInvalid("[{\"cmd\":\"record_start\"}]", "Not in stream mode");
+    checkInvalid("[{\"cmd\":\"stream\"},{\"cmd\":\"timeshift_seek\",\"arg\":-5}]",
+                 "Seek position must not be negative");
+    checkInvalid("[{\"cmd\":\"shuffle\"},{\"cmd\":\"regenerate\"}]", "Not in generative mode");
+
+    size_t pending = getPendingAudioCommands();
+    BatchResult result = runBatch("[{\"cmd\":\"regenerate\"},{\"cmd\":\"stream\"},{\"cmd\":\"record_start\"},"
+                                  "{\"cmd\":\"timeshift_seek\",\"arg\":30}]");
+    CHECK_EQ(result.code, 200);
+    CHECK_EQ(getPendingAudioCommands(), pending + 4);
+}
+
+TEST(queuesNothingWhenTheAudioQueueIsFull) {
+    while (enqueueAudioCommand(CMD_STOP)) {
+    }
+    size_t pending = getPendingAudioCommands();
+    BatchResult result = runBatch("[{\"cmd\":\"stop\"},{\"cmd\":\"resume\"}]");
+    CHECK_EQ(result.code, 503);
+    CHECK(contains(result, "Audio engine busy, nothing was queued"));
+    CHECK(contains(result, "{\"cmd\":\"resume\",\"status\":\"valid\"}"));
+    CHECK_EQ(getPendingAudioCommands(), pending);
+}
@@ -0,0 +1,28 @@
+// Station catalog: the SD cache is parsed with its JSON escapes decoded
+
+#include "host_test.h"
+#include <Arduino.h>
+#include <SD.h>
+#include "managers/catalog_manager.h"
+
+TEST(decodesEscapesInTheCachedCatalog) {
+    std::string root = hostTempDir();
+    hostWriteFile(root, "/catalog.json",
+                  "{\"version\":3,\"updated\":0,\"stations\":{"
+                  "\"Caf\\u00E9 FM\":\"http://a.example/caf\\u00e9\","
+                  "\"Rock \\ud83c\\udfb8\":\"http:\\/\\/b.example\\/rock\","
+                  "\"Tab\\there\\r\\b\\f\":\"http://c.example/\\u0041\\u0000\","
+                  "\"Lone \\ud800 high\":\"http://d.example/\\\"q\\\"\"}}");
+    hostSetSdRoot(root);
+    SD.begin(SS);
+    initializeCatalog();
+
+    CHECK_EQ(getCatalogStationCount(), (size_t)4);
+    std::string body = getCatalogJson().c_str();
+    CHECK(body.find("\"Caf\xc3\xa9 FM\":\"http://a.example/caf\xc3\xa9\"") != std::string::npos);
+    CHECK(body.find("\"Rock \xf0\x9f\x8e\xb8\":\"http://b.example/rock\"") != std::string::npos);
+    // Control characters decode, and are left out when the catalog is served again
+    CHECK(body.find("\"Tabhere\":\"http://c.example/A\"") != std::string::npos);
+    CHECK(body.find("\"Lone \xef\xbf\xbd high\":\"http://d.example/\\\"q\\\"\"") != std::string::npos);
+    CHECK(body.find("u00") == std::string::npos);
+}
@@ -0,0 +1,77 @@
+// The whole firmware on the host: boot, play for a while and answer the web UI
+
+#include "host_test.h"
+#include <Arduino.h>
+
+void setup();
+void loop();
+
+TEST(bootsPlaysAndServesTheWebUi) {
+    std::string sdRoot = hostMakeSdCard();
+    hostWriteFile(sdRoot, "/view/assets.json", "{}\n");
+    hostSetSdRoot(sdRoot);
+    hostSeedRandom(1);
+    hostStartArduino(setup, loop);
+
+    CHECK(hostRunFor(90ULL * 1000000));
+    HostAudioStats audio = hostGetAudioStats();
+    CHECK(audio.tracksStarted > 0);
+    CHECK(audio.framesOut > 44100ULL * 30);
+    CHECK_EQ(hostGetWatchdogTriggers(), (uint32_t)0);
+    CHECK_EQ(hostGetRestarts(), (uint32_t)0);
+
+    HostRequest status;
+    status.uri = "/status";
+    hostQueueRequest(status);
+    HostRequest volume;
+    volume.uri = "/volume/set";
+    volume.args = {{"level", "7"}};
+    hostQueueRequest(volume);
+    CHECK(hostRunFor(2ULL * 1000000));
+
+    std::vector<HostResponse> responses = hostTakeResponses();
+    CHECK_EQ(responses.size(), (size_t)2);
+    if (responses.size() == 2) {
+        CHECK_EQ(responses[0].code, 200);
+        CHECK(responses[0].contentType.find("json") != std::string::npos);
+        CHECK(responses[0].body.find("\"volume\"") != std::string::npos);
+        CHECK_EQ(responses[1].code, 200);
+    }
+
+    // The audio task applies the command; the snapshot carries it back
+    CHECK(hostRunFor(1000000));
+    hostQueueRequest(status);
+    CHECK(hostRunFor(1000000));
+    responses = hostTakeResponses();
+    CHECK_EQ(responses.size(), (size_t)1);
+    if (!responses.empty()) CHECK(responses[0].body.find("\"volume\":7") != std::string::npos);
+
+    // Pages only go out rendered, and the SD manifest is not an asset
+    HostRequest page;
+    page.uri = "/index.html";
+    hostQueueRequest(page);
+    HostRequest manifest;
+    manifest.uri = "/assets.json";
+    hostQueueRequest(manifest);
+    // Bundled only as gzip and not on the card: sent compressed rather than a 404
+    HostRequest script;
+    script.uri = "/app.js";
+    hostQueueRequest(script);
+    CHECK(hostRunFor(1000000));
+    responses = hostTakeResponses();
+    CHECK_EQ(responses.size(), (size_t)3);
+    if (responses.size() == 3) {
+        CHECK_EQ(responses[0].code, 200);
+        CHECK(responses[0].body.find("%VOLUME%") == std::string::npos);
+        CHECK(responses[0].body.find("<html") != std::string::npos);
+        CHECK_EQ(responses[1].code, 404);
+        CHECK_EQ(responses[2].code, 200);
+        bool gzip = false;
+        for (const auto& header : responses[2].headers) {
+            gzip |= header.first == "Content-Encoding" && header.second == "gzip";
+        }
+        CHECK(gzip);
+    }
+
+    hostKillTasks();
+}
@@ -0,0 +1,91 @@
+/**
+ * @file host_test.h
+ * @brief Minimal test harness for the host build
+ * @details One executable per *_test.cpp file. TEST() cases run in order,
+ *          each from power-on state (hostReset()); CHECK() failures are
+ *          reported and the case carries on. The exit code is the number of
+ *          failed cases, which is what ctest looks at.
+ */
+
+#pragma once
+
+#include "host_fixtures.h"
+#include "host_hal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct HostTestCase {
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<HostTestCase>& hostTestCases() {
+    static std::vector<HostTestCase> cases;
+    return cases;
+}
+
+inline int& hostTestFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+struct HostTestRegistrar {
+    HostTestRegistrar(const char* name, void (*run)()) { hostTestCases().push_back({name, run}); }
+};
+
+#define TEST(name)                                                   \
+    static void name();                                              \
+    static HostTestRegistrar name##Registrar(#name, name);           \
+    static void name()
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            fprintf(stderr, "  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            hostTestFailures()++;                                               \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                              \
+    do {                                                                                        \
+        auto actualValue = (actual);                                                            \
+        auto expectedValue = (expected);                                                        \
+        if (!(actualValue == expectedValue)) {                                                  \
+            fprintf(stderr, "  %s:%d: CHECK_EQ(%s, %s) failed: got %s, expected %s\n", __FILE__, \
+                    __LINE__, #actual, #expected, hostTestText(actualValue).c_str(),             \
+                    hostTestText(expectedValue).c_str());                                        \
+            hostTestFailures()++;                                                               \
+        }                                                                                       \
+    } while (0)
+
+inline std::string hostTestText(const std::string& value) {
+    return "\"" + value + "\"";
+}
+inline std::string hostTestText(const char* value) {
+    return value ? hostTestText(std::string(value)) : "null";
+}
+inline std::string hostTestText(bool value) {
+    return value ? "true" : "false";
+}
+template <typename T>
+std::string hostTestText(const T& value) {
+    return std::to_string(value);
+}
+
+int main() {
+    int failedCases = 0;
+    for (const HostTestCase& test : hostTestCases()) {
+        hostReset();
+        int before = hostTestFailures();
+        test.run();
+        bool passed = hostTestFailures() == before;
+        printf("%s %s\n", passed ? "[ OK ]" : "[FAIL]", test.name);
+        if (!passed) failedCases++;
+    }
+    hostReset();
+    printf("%zu cases, %d failed\n", hostTestCases().size(), failedCases);
+    return failedCases;
+}
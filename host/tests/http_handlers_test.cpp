@@ -0,0 +1,57 @@
+// Control handlers: echoed request values never cut the JSON short, and numbers are range checked
+
+#include "host_test.h"
+#include <Arduino.h>
+#include <WebServer.h>
+#include "config/config.h"
+#include "managers/audio_commands.h"
+#include "web/web_routes.h"
+
+extern WebServer server;
+
+static HostResponse get(const char* uri, const char* name, const std::string& value) {
+    static bool routed = false;
+    if (!routed) {
+        setupWebRoutes();
+        routed = true;
+    }
+    server.begin();
+
+    HostRequest request;
+    request.uri = uri;
+    request.args = {{name, value}};
+    return hostRequest(request);
+}
+
+TEST(echoesLongEscapedValuesAsCompleteJson) {
+    // Every byte escapes to \" or \u0001; the longest value a command takes would need ~1 KB
+    std::string hostile;
+    for (int i = 0; i < AUDIO_COMMAND_TEXT_LEN - 1; i++) hostile += i % 2 ? '"' : '\x01';
+
+    const char* routes[][2] = {{"/program/stream", "url"}, {"/stream/connect", "url"},
+                               {"/shuffle/folder", "path"}, {"/random", "folder"}};
+    for (const auto& route : routes) {
+        size_t pending = getPendingAudioCommands();
+        HostResponse response = get(route[0], route[1], hostile);
+        CHECK_EQ(response.code, 200);
+        CHECK(response.body.size() < JSON_RESPONSE_SIZE);
+        CHECK(response.body.size() > 2 && response.body.compare(response.body.size() - 2, 2, "\"}") == 0);
+        CHECK_EQ(getPendingAudioCommands(), pending + 1);   // The full value is queued, only the echo is cut
+    }
+}
+
+TEST(cutsEchoesOnACharacterBoundary) {
+    // "é" straddles the cut, so it is left out rather than split
+    std::string value = std::string(JSON_ECHO_MAX - 1, 'a') + "\xc3\xa9" + "tail";
+    HostResponse response = get("/program/stream", "url", value);
+    CHECK_EQ(response.code, 200);
+    CHECK(response.body.find("\"url\":\"" + std::string(JSON_ECHO_MAX - 1, 'a') + "\"}") != std::string::npos);
+}
+
+TEST(rejectsNegativeSeekPositions) {
+    size_t pending = getPendingAudioCommands();
+    HostResponse response = get("/timeshift/seek", "seconds", "-5");
+    CHECK_EQ(response.code, 400);
+    CHECK(response.body.find("must not be negative") != std::string::npos);
+    CHECK_EQ(getPendingAudioCommands(), pending);
+}
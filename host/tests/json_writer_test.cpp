@@ -0,0 +1,44 @@
+// JsonWriter: structure, escaping and truncation
+
+#include "host_test.h"
+#include "web/json_writer.h"
+
+TEST(writesNestedStructure) {
+    char buffer[128];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject()
+        .numberField("volume", 12)
+        .boolField("running", true)
+        .key("tags").beginArray().stringValue("a").numberValue(-3).endArray()
+        .endObject();
+    CHECK_EQ(std::string(json.c_str()), std::string("{\"volume\":12,\"running\":true,\"tags\":[\"a\",-3]}"));
+    CHECK(!json.overflowed());
+}
+
+TEST(escapesStrings) {
+    char buffer[64];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject().stringField("name", "a\"b\\c\nd").endObject();
+    CHECK_EQ(std::string(json.c_str()), std::string("{\"name\":\"a\\\"b\\\\c\\u000ad\"}"));
+}
+
+TEST(formatsFields) {
+    char buffer[64];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject().stringFieldf("ip", "%u.%u.%u.%u", 192, 168, 4, 1).endObject();
+    CHECK_EQ(std::string(json.c_str()), std::string("{\"ip\":\"192.168.4.1\"}"));
+}
+
+TEST(reportsOverflowAndRequiredSize) {
+    char buffer[16];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject().stringField("message", "longer than the buffer").endObject();
+    CHECK(json.overflowed());
+    CHECK_EQ(strlen(json.c_str()), sizeof(buffer) - 1);
+
+    std::vector<char> bigger(json.requiredSize());
+    JsonWriter retry(bigger.data(), bigger.size());
+    retry.beginObject().stringField("message", "longer than the buffer").endObject();
+    CHECK(!retry.overflowed());
+    CHECK_EQ(retry.length(), bigger.size() - 1);
+}
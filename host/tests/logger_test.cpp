@@ -0,0 +1,82 @@
+// Logger: the ring drops when full, the log task drains it, and /log pages through the tail
+
+#include "host_test.h"
+#include <Arduino.h>
+#include "managers/logger.h"
+
+static constexpr LogTag LOG_TAG = LOG_TAG_SYSTEM;
+
+// The logger's state lives for the whole process, so everything runs in one case
+TEST(ringDropsDrainsAndPagesThroughTheTail) {
+    setLogFilter(LOG_LEVEL_DEBUG, 0xFFFFFFFFu);
+    CHECK_EQ(readLogTail(0, nullptr, 0), (size_t)0);   // Nothing before the log task exists
+    initializeLogger();
+
+    // Nothing drains until the task runs, so the ring fills and drops the rest
+    for (int i = 1; i <= LOG_RING_ENTRIES + 8; i++) LOG_I("message %d", i);
+    CHECK_EQ(getLogStats().dropped, (uint32_t)8);
+    CHECK(hostRunFor(2000000));
+    CHECK_EQ(getLogStats().written, (uint32_t)LOG_RING_ENTRIES);
+    std::string serial = hostTakeSerialOutput();
+    CHECK(serial.find("I system: message 1\r\n") != std::string::npos);
+    CHECK(serial.find("8 log messages dropped") != std::string::npos);
+    CHECK(serial.find("message 65") == std::string::npos);
+
+    // The tail keeps the newest LOG_TAIL_ENTRIES, oldest first
+    LogRecord records[LOG_TAIL_ENTRIES + 4];
+    size_t count = readLogTail(0, records, LOG_TAIL_ENTRIES + 4);
+    CHECK_EQ(count, (size_t)LOG_TAIL_ENTRIES);
+    uint32_t firstKept = LOG_RING_ENTRIES - LOG_TAIL_ENTRIES + 1;
+    if (count > 0) {
+        CHECK_EQ(records[0].id, firstKept);
+        CHECK_EQ(records[count - 1].id, (uint32_t)LOG_RING_ENTRIES);
+        CHECK_EQ(std::string(records[count - 1].text), std::string("message 64"));
+        CHECK_EQ(records[0].level, LOG_LEVEL_INFO);
+        CHECK_EQ(records[0].tag, LOG_TAG_SYSTEM);
+    }
+
+    // Paging by the last id seen walks forward without gaps or repeats
+    uint32_t since = 0;
+    uint32_t expected = firstKept;
+    size_t pages = 0;
+    while ((count = readLogTail(since, records, 10)) > 0) {
+        for (size_t i = 0; i < count; i++) CHECK_EQ(records[i].id, expected++);
+        since = records[count - 1].id;
+        pages++;
+    }
+    CHECK_EQ(expected, (uint32_t)LOG_RING_ENTRIES + 1);
+    CHECK_EQ(pages, (size_t)((LOG_TAIL_ENTRIES + 9) / 10));
+    CHECK_EQ(readLogTail(LOG_RING_ENTRIES, records, 10), (size_t)0);
+    CHECK_EQ(readLogTail(firstKept + 4, records, 2), (size_t)2);
+    CHECK_EQ(records[0].id, firstKept + 5);
+
+    // Filtered messages are never queued; long ones are cut and counted
+    setLogFilter(LOG_LEVEL_WARN, 0xFFFFFFFFu);
+    LOG_I("filtered by level");
+    setLogFilter(LOG_LEVEL_DEBUG, ~(1u << LOG_TAG_SYSTEM));
+    LOG_E("filtered by tag");
+    setLogFilter(LOG_LEVEL_DEBUG, 0xFFFFFFFFu);
+    std::string longText(LOG_TEXT_SIZE + 40, 'x');
+    LOG_W("%s", longText.c_str());
+    CHECK(hostRunFor(1000000));
+    CHECK_EQ(getLogStats().written, (uint32_t)LOG_RING_ENTRIES + 1);
+    CHECK_EQ(getLogStats().truncated, (uint32_t)1);
+    count = readLogTail(LOG_RING_ENTRIES, records, 10);
+    CHECK_EQ(count, (size_t)1);
+    if (count == 1) {
+        CHECK_EQ(strlen(records[0].text), (size_t)LOG_TEXT_SIZE - 1);
+        CHECK_EQ(records[0].level, LOG_LEVEL_WARN);
+    }
+}
+
+TEST(namesLevelsAndTags) {
+    LogLevel level = LOG_LEVEL_NONE;
+    CHECK(parseLogLevel("debug", &level));
+    CHECK_EQ(level, LOG_LEVEL_DEBUG);
+    CHECK(!parseLogLevel("verbose", &level));
+    CHECK_EQ(level, LOG_LEVEL_DEBUG);
+    CHECK_EQ(parseLogTag("stream"), LOG_TAG_STREAM);
+    CHECK_EQ(parseLogTag("nope"), LOG_TAG_COUNT);
+    CHECK_EQ(std::string(getLogTagName(LOG_TAG_MEMORY)), std::string("memory"));
+    CHECK_EQ(std::string(getLogLevelName((LogLevel)9)), std::string("unknown"));
+}
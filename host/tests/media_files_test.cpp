@@ -0,0 +1,102 @@
+// Range requests on /media: single ranges, suffix and open ranges, 416s and headers that are ignored
+
+#include "host_test.h"
+#include <Arduino.h>
+#include <SD.h>
+#include <WebServer.h>
+#include "web/web_routes.h"
+
+extern WebServer server;
+
+static const uint32_t FILE_SIZE = 1000;
+
+static std::string fileContent() {
+    std::string content;
+    for (uint32_t i = 0; i < FILE_SIZE; i++) content += (char)('a' + i % 26);
+    return content;
+}
+
+static HostResponse getMedia(const char* range) {
+    static bool routed = false;
+    if (!routed) {
+        setupWebRoutes();
+        routed = true;
+    }
+    std::string root = hostTempDir();
+    hostWriteFile(root, "/music/range.mp3", fileContent());
+    hostSetSdRoot(root);
+    SD.begin(SS);
+    server.begin();
+
+    HostRequest request;
+    request.uri = "/media";
+    request.args = {{"path", "/music/range.mp3"}};
+    if (range) request.headers = {{"Range", range}};
+    return hostRequest(request);
+}
+
+static std::string header(const HostResponse& response, const char* name) {
+    for (const auto& entry : response.headers) {
+        if (entry.first == name) return entry.second;
+    }
+    return "";
+}
+
+static void checkPartial(const char* range, uint32_t first, uint32_t last) {
+    HostResponse response = getMedia(range);
+    CHECK_EQ(response.code, 206);
+    CHECK_EQ(response.body, fileContent().substr(first, last - first + 1));
+    char expected[48];
+    snprintf(expected, sizeof(expected), "bytes %u-%u/%u", first, last, FILE_SIZE);
+    CHECK_EQ(header(response, "Content-Range"), std::string(expected));
+}
+
+static void checkWholeFile(const char* range) {
+    HostResponse response = getMedia(range);
+    CHECK_EQ(response.code, 200);
+    CHECK_EQ(response.body, fileContent());
+    CHECK_EQ(header(response, "Content-Range"), std::string(""));
+}
+
+static void checkUnsatisfiable(const char* range) {
+    HostResponse response = getMedia(range);
+    CHECK_EQ(response.code, 416);
+    CHECK_EQ(header(response, "Content-Range"), std::string("bytes */1000"));
+}
+
+TEST(sendsTheWholeFileWithoutRange) {
+    checkWholeFile(nullptr);
+    CHECK_EQ(header(getMedia(nullptr), "Accept-Ranges"), std::string("bytes"));
+}
+
+TEST(sendsClosedAndOpenRanges) {
+    checkPartial("bytes=0-99", 0, 99);
+    checkPartial("bytes=500-500", 500, 500);
+    checkPartial("bytes=900-", 900, 999);
+    checkPartial("bytes= 10 - 19 ", 10, 19);
+    checkPartial("bytes=990-5000", 990, 999);   // Last position is clamped to the file
+}
+
+TEST(sendsSuffixRanges) {
+    checkPartial("bytes=-100", 900, 999);
+    checkPartial("bytes=-1", 999, 999);
+    checkPartial("bytes=-5000", 0, 999);
+}
+
+TEST(rejectsUnsatisfiableRanges) {
+    checkUnsatisfiable("bytes=1000-");
+    checkUnsatisfiable("bytes=4294967295-");
+    checkUnsatisfiable("bytes=50-10");
+    checkUnsatisfiable("bytes=-0");
+}
+
+TEST(ignoresMalformedRanges) {
+    checkWholeFile("bytes=abc-def");
+    checkWholeFile("bytes=5-x");
+    checkWholeFile("bytes=-x");
+    checkWholeFile("bytes=1e3-");
+    checkWholeFile("bytes=-");
+    checkWholeFile("bytes=0-99,200-299");   // Multipart is not supported
+    checkWholeFile("items=0-99");
+    checkWholeFile("bytes=100");
+}
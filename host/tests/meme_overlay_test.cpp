@@ -0,0 +1,62 @@
+// Meme overlay: a meme outlives the program track it started over and only ends with its clip
+
+#include "host_test.h"
+#include <Arduino.h>
+#include <SD.h>
+#include "hardware/hardware_setup.h"
+#include "hardware/audio_pipeline.h"
+#include "managers/meme_overlay.h"
+
+// One audio task pass as far as the overlay is concerned: decode, then the overlay after the program
+static void runFor(uint64_t us) {
+    for (uint64_t elapsed = 0; elapsed < us; elapsed += 10000) {
+        audio.loop();
+        serviceMemeOverlay();
+        hostAdvanceUs(10000);
+    }
+}
+
+TEST(memeOutlivesTheProgramTrackUnderIt) {
+    std::string root = hostTempDir();
+    hostWriteFile(root, "/music/short.wav", hostWav(44100, 2, 22050, 1000));   // 0.5 s
+    hostWriteFile(root, "/meme/long.mp3", hostFakeMp3(2));
+    hostSetSdRoot(root);
+    SD.begin(SS);
+    CHECK(initializeMemeOverlay());
+
+    CHECK(audio.connecttoFS(SD, "/music/short.wav"));
+    runFor(100000);
+    CHECK(startMemeOverlay(SD, "/meme/long.mp3"));
+
+    // The program track ends about halfway through the meme; the meme goes on over silence
+    runFor(1000000);
+    CHECK(isMemeOverlayActive());
+    CHECK(audio.isRunning());
+    CHECK_EQ(hostGetAudioStats().tracksEnded, (uint32_t)1);
+    CHECK_EQ(hostGetAudioStats().underruns, (uint32_t)0);
+
+    // With the clip played out, the decoder is handed back idle
+    runFor(1500000);
+    CHECK(!isMemeOverlayActive());
+    CHECK(!audio.isRunning());
+    CHECK_EQ(getOverlayMixer().droppedFrames(), (uint32_t)0);
+}
+
+TEST(stoppingTheMemeStopsTheSilenceUnderIt) {
+    std::string root = hostTempDir();
+    hostWriteFile(root, "/music/short.wav", hostWav(44100, 2, 4410, 1000));
+    hostWriteFile(root, "/meme/long.mp3", hostFakeMp3(2));
+    hostSetSdRoot(root);
+    SD.begin(SS);
+    CHECK(initializeMemeOverlay());
+
+    CHECK(audio.connecttoFS(SD, "/music/short.wav"));
+    CHECK(startMemeOverlay(SD, "/meme/long.mp3"));
+    runFor(500000);
+    CHECK(isMemeOverlayActive());
+    CHECK(audio.isRunning());
+
+    stopMemeOverlay();
+    CHECK(!isMemeOverlayActive());
+    CHECK(!audio.isRunning());
+}
@@ -0,0 +1,70 @@
+// Host timing budgets for the hot paths. They are loose (the host is far faster
+// than the ESP32) and only catch order-of-magnitude regressions.
+
+#include "host_test.h"
+#include <Arduino.h>
+#include <chrono>
+#include "hardware/volume_control.h"
+#include "web/route_table.h"
+#include "web/web_utils.h"
+
+void audio_process_extern(int16_t* buff, uint16_t len, bool* continueI2S);
+
+static double nsPerOp(const std::chrono::steady_clock::time_point& start, size_t ops) {
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / ops;
+}
+
+TEST(audioHookKeepsFarAheadOfRealTime) {
+    static int16_t block[1152 * 2];
+    for (size_t i = 0; i < 1152 * 2; i++) block[i] = (int16_t)(i * 37);
+    const size_t blocks = 2000;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < blocks; i++) {
+        bool continueI2S = false;
+        audio_process_extern(block, 1152, &continueI2S);
+    }
+    double ns = nsPerOp(start, blocks);
+    printf("  audio_process_extern: %.0f ns per 1152-frame block\n", ns);
+    // A block is 26 ms of audio at 44.1 kHz; 1 ms is 4% of it
+    CHECK(ns < 1000000.0);
+}
+
+TEST(statusRendersQuickly) {
+    const size_t renders = 2000;
+    size_t total = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < renders; i++) {
+        setVolume(i & 1);   // A new volume each time, so the cache never hits
+        size_t length = 0;
+        getStatusJson(&length);
+        total += length;
+    }
+    double ns = nsPerOp(start, renders);
+    printf("  getStatusJson: %.0f ns per render\n", ns);
+    CHECK(total > 0);
+    CHECK(ns < 200000.0);
+}
+
+static void handler() {}
+
+static constexpr Route ROUTES[] = {
+    {"/", handler},       {"/status", handler},  {"/volume/set", handler}, {"/volume/up", handler},
+    {"/events", handler}, {"/metrics", handler}, {"/program/shuffle", handler}, {"/meme/play", handler},
+};
+
+static constexpr auto table = makeRouteTable<64>(ROUTES);
+
+TEST(routeLookupIsCheap) {
+    const char* paths[] = {"/status", "/volume/set", "/nope", "/meme/play", "/events", "/program/generative"};
+    const size_t lookups = 600000;
+    size_t hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < lookups; i++) {
+        if (table.find(paths[i % 6])) hits++;
+    }
+    double ns = nsPerOp(start, lookups);
+    printf("  RouteTable::find: %.1f ns per lookup\n", ns);
+    CHECK_EQ(hits, lookups / 6 * 4);
+    CHECK(ns < 2000.0);
+}
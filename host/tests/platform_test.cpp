@@ -0,0 +1,301 @@
+// Host shims: String, SD on a host directory, Preferences, the audio timing model and the web server
+
+#include "host_test.h"
+#include <Arduino.h>
+#include <Audio.h>
+#include <Preferences.h>
+#include <SD.h>
+#include <WebServer.h>
+
+TEST(stringBehavesLikeArduino) {
+    String text = "  Hello, World  ";
+    text.trim();
+    CHECK_EQ(std::string(text.c_str()), std::string("Hello, World"));
+    CHECK_EQ(text.indexOf(','), 5);
+    CHECK_EQ(text.lastIndexOf('o'), 8);
+    CHECK_EQ(std::string(text.substring(7).c_str()), std::string("World"));
+    CHECK_EQ(std::string(text.substring(7, 100).c_str()), std::string("World"));
+    CHECK(text.startsWith("Hello") && text.endsWith("World"));
+    CHECK(String("ABC").equalsIgnoreCase("abc"));
+    CHECK_EQ(String("-42").toInt(), -42L);
+    CHECK_EQ(std::string((String("n=") + 7 + ' ' + String(255, HEX)).c_str()), std::string("n=7 ff"));
+    CHECK_EQ(std::string(String(3.14159, 3).c_str()), std::string("3.142"));
+    String removed = "abcdef";
+    removed.remove(2, 2);
+    CHECK_EQ(std::string(removed.c_str()), std::string("abef"));
+    CHECK_EQ(String("x").charAt(5), '\0');
+}
+
+TEST(sdReadsAndWritesHostFiles) {
+    std::string root = hostTempDir();
+    hostWriteFile(root, "/dir/a.txt", "alpha");
+    hostWriteFile(root, "/dir/b.txt", "beta");
+    hostSetSdRoot(root);
+    CHECK(SD.begin(SS));
+
+    File file = SD.open("/dir/a.txt");
+    CHECK(file);
+    CHECK_EQ(file.size(), (size_t)5);
+    CHECK_EQ(std::string(file.readString().c_str()), std::string("alpha"));
+    file.close();
+
+    File out = SD.open("/dir/c.txt", FILE_WRITE);
+    out.print("gamma");
+    out.close();
+    CHECK(SD.exists("/dir/c.txt"));
+    CHECK(SD.rename("/dir/c.txt", "/dir/d.txt"));
+    CHECK(!SD.exists("/dir/c.txt"));
+
+    std::vector<std::string> names;
+    File dir = SD.open("/dir");
+    CHECK(dir.isDirectory());
+    for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile()) names.push_back(entry.name());
+    std::sort(names.begin(), names.end());
+    CHECK(names == std::vector<std::string>({"a.txt", "b.txt", "d.txt"}));
+    CHECK(SD.remove("/dir/d.txt"));
+    CHECK(!SD.open("/missing.txt"));
+}
+
+TEST(sdCanBeMissing) {
+    hostSetSdRoot(hostTempDir());
+    hostSetSdPresent(false);
+    CHECK(!SD.begin(SS));
+    CHECK(!SD.exists("/"));
+}
+
+TEST(preferencesKeepValuesPerNamespace) {
+    Preferences prefs;
+    CHECK(prefs.begin("ghostwhisper", false));
+    CHECK_EQ(prefs.getUChar("volume", 9), (uint8_t)9);
+    prefs.putUChar("volume", 14);
+    prefs.putString("name", "ghost");
+    prefs.end();
+    CHECK(prefs.begin("ghostwhisper", true));
+    CHECK_EQ(prefs.getUChar("volume", 9), (uint8_t)14);
+    CHECK_EQ(std::string(prefs.getString("name").c_str()), std::string("ghost"));
+    CHECK_EQ(prefs.putUChar("volume", 1), (size_t)0);   // Read-only
+    prefs.end();
+}
+
+TEST(audioPlaysWavAtTheSampleRate) {
+    std::string root = hostTempDir();
+    hostWriteFile(root, "/tone.wav", hostWav(22050, 1, 22050 * 2, 500));
+    hostSetSdRoot(root);
+    CHECK(SD.begin(SS));
+
+    Audio player;
+    CHECK(player.connecttoFS(SD, "/tone.wav"));
+    CHECK_EQ(player.getSampleRate(), (uint32_t)22050);
+    while (player.isRunning() && hostNowUs() < 5000000) {
+        player.loop();
+        hostAdvanceUs(10000);
+    }
+    CHECK(!player.isRunning());
+    // Decoding ends one DMA ring (8192 frames) ahead of the two seconds of playback
+    CHECK(hostNowUs() >= 1550000 && hostNowUs() <= 1700000);
+    for (int i = 0; i < 50; i++) {
+        player.loop();
+        hostAdvanceUs(10000);
+    }
+    HostAudioStats stats = hostGetAudioStats();
+    CHECK_EQ(stats.framesOut, (uint64_t)22050 * 2);
+    CHECK_EQ(stats.tracksEnded, (uint32_t)1);
+    CHECK_EQ(stats.underruns, (uint32_t)0);
+}
+
+TEST(audioStarvesWhenLoopRunsLate) {
+    std::string root = hostTempDir();
+    hostWriteFile(root, "/long.mp3", hostFakeMp3(10));
+    hostSetSdRoot(root);
+    CHECK(SD.begin(SS));
+
+    Audio player;
+    CHECK(player.connecttoFS(SD, "/long.mp3"));
+    player.loop();
+    hostAdvanceUs(500000);   // Far longer than the DMA ring lasts
+    player.loop();
+    HostAudioStats stats = hostGetAudioStats();
+    CHECK_EQ(stats.underruns, (uint32_t)1);
+    CHECK(stats.silentFrames > 44100 / 4);
+}
+
+TEST(audioStreamBreaksWithTheNetwork) {
+    hostSetHttpHandler([](const std::string& url) {
+        HostHttpResponse response;
+        response.body = std::string(4096, '\x55');
+        response.live = true;
+        return response;
+    });
+    Audio player;
+    CHECK(player.connecttohost("http://radio.example/live"));
+    for (int i = 0; i < 100; i++) {
+        player.loop();
+        hostAdvanceUs(10000);
+    }
+    CHECK(player.isRunning());
+    CHECK_EQ(hostGetAudioStats().underruns, (uint32_t)0);
+    hostSetNetworkUp(false);
+    // What is already in the DMA ring still plays
+    player.loop();
+    CHECK(player.isRunning());
+    for (int i = 0; i < 50 && player.isRunning(); i++) {
+        hostAdvanceUs(10000);
+        player.loop();
+    }
+    CHECK(!player.isRunning());
+    CHECK_EQ(hostGetAudioStats().streamsLost, (uint32_t)1);
+    CHECK(!player.connecttohost("http://radio.example/live"));
+}
+
+TEST(sdFaultsDelayFailAndCorrupt) {
+    std::string root = hostTempDir();
+    hostWriteFile(root, "/data.txt", std::string(2048, 'a'));
+    hostSetSdRoot(root);
+    CHECK(SD.begin(SS));
+
+    HostFaultProfile profile;
+    profile.sdReadLatencyUs = 1000;
+    hostSetFaultProfile(profile);
+    File file = SD.open("/data.txt");
+    CHECK_EQ(file.readString().length(), (size_t)2048);
+    file.close();
+    // Four sectors, however many calls the bytes took
+    CHECK_EQ(hostNowUs(), (uint64_t)4000);
+
+    profile = HostFaultProfile();
+    profile.sdCorruptChance = 1;
+    hostSetFaultProfile(profile);
+    uint8_t buffer[16];
+    file = SD.open("/data.txt");
+    CHECK_EQ(file.read(buffer, sizeof(buffer)), (size_t)16);
+    file.close();
+    CHECK_EQ((size_t)std::count(buffer, buffer + 16, 'a'), (size_t)15);
+    CHECK_EQ(hostGetFaultStats().sdCorruptReads, (uint32_t)1);
+
+    profile = HostFaultProfile();
+    profile.sdOpenFailChance = 1;
+    hostSetFaultProfile(profile);
+    CHECK(!SD.open("/data.txt"));
+    CHECK(SD.exists("/data.txt"));
+    CHECK_EQ(hostGetFaultStats().sdOpenFailures, (uint32_t)1);
+}
+
+TEST(sdStallStarvesAudio) {
+    std::string root = hostTempDir();
+    hostWriteFile(root, "/long.mp3", hostFakeMp3(10));
+    hostSetSdRoot(root);
+    CHECK(SD.begin(SS));
+
+    HostFaultProfile profile;
+    profile.sdReadSpikeChance = 1;
+    profile.sdSpikeMinUs = profile.sdSpikeMaxUs = 300000;
+    hostSetFaultProfile(profile);
+    Audio player;
+    CHECK(player.connecttoFS(SD, "/long.mp3"));
+    for (int i = 0; i < 3; i++) player.loop();
+    CHECK(hostGetFaultStats().sdSpikes >= 2);
+    CHECK(hostGetAudioStats().underruns >= 1);
+}
+
+TEST(wifiDropsOutAndStreamsStall) {
+    hostSetHttpHandler([](const std::string& url) {
+        HostHttpResponse response;
+        response.body = std::string(4096, '\x55');
+        response.live = true;
+        return response;
+    });
+    WiFi.mode(WIFI_STA);
+    CHECK_EQ(WiFi.begin("host"), WL_CONNECTED);
+
+    HostFaultProfile profile;
+    profile.streamStallMeanSec = 60;
+    profile.streamStallMinMs = profile.streamStallMaxMs = 5000;
+    hostSetFaultProfile(profile);
+    Audio player;
+    CHECK(player.connecttohost("http://radio.example/live"));
+    uint64_t endUs = hostNowUs() + 600 * 1000000ULL;
+    while (hostNowUs() < endUs) {
+        player.loop();
+        hostAdvanceUs(10000);
+    }
+    // The two seconds buffered on connect cannot cover a five-second stall
+    CHECK(player.isRunning());
+    CHECK(hostGetFaultStats().streamStalls >= 1);
+    CHECK(hostGetAudioStats().underruns >= 1);
+
+    profile = HostFaultProfile();
+    profile.wifiDropMeanSec = 60;
+    profile.wifiDownMinSec = profile.wifiDownMaxSec = 10;
+    hostSetFaultProfile(profile);
+    while (hostGetFaultStats().wifiDrops == 0) {
+        player.loop();
+        hostAdvanceUs(10000);
+    }
+    CHECK_EQ(WiFi.status(), WL_CONNECTION_LOST);
+    for (int i = 0; i < 50 && player.isRunning(); i++) {
+        hostAdvanceUs(10000);
+        player.loop();
+    }
+    CHECK(!player.isRunning());
+    CHECK_EQ(hostGetAudioStats().streamsLost, (uint32_t)1);
+    CHECK(!player.connecttohost("http://radio.example/live"));
+    hostAdvanceUs(10 * 1000000ULL);
+    CHECK_EQ(WiFi.status(), WL_CONNECTED);
+    CHECK(player.connecttohost("http://radio.example/live"));
+}
+
+class EchoHandler : public RequestHandler {
+public:
+    bool canHandle(HTTPMethod method, const String& uri) override { return uri.startsWith("/echo"); }
+    bool handle(WebServer& server, HTTPMethod method, const String& uri) override {
+        if (uri == "/echo/keep") {
+            kept = server.client();
+            kept.print("hello");
+            return true;
+        }
+        server.sendHeader("X-Seen", server.header("X-Token"));
+        server.send(200, "text/plain", server.arg("word") + "/" + server.arg("plain"));
+        return true;
+    }
+    WiFiClient kept;
+};
+
+TEST(webServerRunsInjectedRequests) {
+    WebServer server(80);
+    EchoHandler handler;
+    server.addHandler(&handler);
+    const char* headers[] = {"X-Token"};
+    server.collectHeaders(headers, 1);
+    server.begin();
+
+    HostRequest request;
+    request.method = "POST";
+    request.uri = "/echo?word=hi%20there";
+    request.headers = {{"x-token", "abc"}, {"X-Other", "hidden"}};
+    request.body = "payload";
+    HostResponse response = hostRequest(request);
+    CHECK_EQ(response.code, 200);
+    CHECK_EQ(response.body, std::string("hi there/payload"));
+    CHECK(response.headers.size() >= 1 && response.headers[0].second == "abc");
+    CHECK(!response.keptOpen);
+
+    HostRequest missing;
+    missing.uri = "/nothing";
+    CHECK_EQ(hostRequest(missing).code, 404);
+
+    HostRequest keep;
+    keep.uri = "/echo/keep";
+    hostQueueRequest(keep);
+    CHECK(hostTakeResponses().empty());
+    server.handleClient();
+    std::vector<HostResponse> responses = hostTakeResponses();
+    CHECK_EQ(responses.size(), (size_t)1);
+    if (!responses.empty()) {
+        CHECK(responses[0].keptOpen);
+        CHECK_EQ(responses[0].body, std::string("hello"));
+        handler.kept.print("more");
+        CHECK_EQ(hostConnectionRead(responses[0].connection), std::string("more"));
+        hostConnectionClose(responses[0].connection);
+        CHECK(!handler.kept.connected());
+    }
+}
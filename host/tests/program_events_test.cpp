@@ -0,0 +1,76 @@
+// Program events: queue order, the program timer, idle time, and posting without blocking the audio task
+
+#include "host_test.h"
+#include "managers/program_events.h"
+#include "managers/stream_manager.h"
+
+static ProgramEventType next() {
+    ProgramEvent event;
+    return nextProgramEvent(event) ? event.type : PROGRAM_EVENT_COUNT;
+}
+
+TEST(eventsComeOutInOrderBeforeTheTimer) {
+    clearProgramEvents();
+    scheduleProgramTimer(0);
+    postProgramEvent(PROGRAM_EVENT_STREAM_CONNECTED);
+    notePlaybackEnded();
+    CHECK_EQ((int)next(), (int)PROGRAM_EVENT_STREAM_CONNECTED);
+    CHECK_EQ((int)next(), (int)PROGRAM_EVENT_TRACK_ENDED);
+    CHECK_EQ((int)next(), (int)PROGRAM_EVENT_TIMER);
+    CHECK_EQ((int)next(), (int)PROGRAM_EVENT_COUNT);
+}
+
+TEST(timerFiresAtItsDeadline) {
+    clearProgramEvents();
+    CHECK_EQ(getProgramIdleMs(), UINT32_MAX);
+    scheduleProgramTimer(300);
+    CHECK_EQ(getProgramIdleMs(), (uint32_t)300);
+    hostAdvanceUs(299000);
+    CHECK_EQ((int)next(), (int)PROGRAM_EVENT_COUNT);
+    CHECK_EQ(getProgramIdleMs(), (uint32_t)1);
+    hostAdvanceUs(1000);
+    CHECK_EQ((int)next(), (int)PROGRAM_EVENT_TIMER);
+    CHECK_EQ((int)next(), (int)PROGRAM_EVENT_COUNT);   // One shot
+    CHECK_EQ(getProgramIdleMs(), UINT32_MAX);
+}
+
+TEST(cancelAndClearDropPendingWork) {
+    clearProgramEvents();
+    scheduleProgramTimer(10);
+    cancelProgramTimer();
+    hostAdvanceUs(20000);
+    CHECK_EQ((int)next(), (int)PROGRAM_EVENT_COUNT);
+
+    postProgramEvent(PROGRAM_EVENT_ERROR, PROGRAM_ERROR_NO_FILES);
+    CHECK_EQ(getProgramIdleMs(), (uint32_t)0);
+    clearProgramEvents();
+    CHECK_EQ((int)next(), (int)PROGRAM_EVENT_COUNT);
+}
+
+TEST(fullQueueCountsDrops) {
+    clearProgramEvents();
+    uint32_t droppedBefore = getProgramEventStats().dropped;
+    for (int i = 0; i < PROGRAM_EVENT_QUEUE_DEPTH + 3; i++) postProgramEvent(PROGRAM_EVENT_TIMER, i);
+    CHECK_EQ(getProgramEventStats().dropped - droppedBefore, (uint32_t)3);
+    ProgramEvent event;
+    int count = 0;
+    while (nextProgramEvent(event)) CHECK_EQ(event.arg, count++);
+    CHECK_EQ(count, PROGRAM_EVENT_QUEUE_DEPTH);
+}
+
+TEST(streamConnectPostsWithoutBlockingTheAudioTask) {
+    clearProgramEvents();
+    hostSetNetworkUp(true);
+    uint64_t started = hostNowUs();
+    connectToStream("http://radio.example/live");
+    CHECK_EQ(hostNowUs(), started);
+    CHECK(isStreamConnected());
+    CHECK_EQ((int)next(), (int)PROGRAM_EVENT_STREAM_CONNECTED);
+
+    getStreamState().reconnectAttempts = 1;
+    handleStreamReconnection();
+    CHECK_EQ(hostNowUs(), started);
+    CHECK_EQ((int)next(), (int)PROGRAM_EVENT_STREAM_CONNECTED);
+    clearStreamCache();
+    CHECK_EQ(hostNowUs(), started);
+}
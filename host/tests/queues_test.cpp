@@ -0,0 +1,69 @@
+// SpscQueue and MpscQueue: ordering, capacity and all-or-nothing batches
+
+#include "host_test.h"
+#include <Arduino.h>
+#include "managers/mpsc_queue.h"
+#include "managers/spsc_queue.h"
+
+TEST(spscKeepsOrderAndCapacity) {
+    SpscQueue<int, 4> queue;
+    CHECK_EQ(queue.capacity(), (size_t)4);
+    for (int i = 0; i < 4; i++) CHECK(queue.push(i));
+    CHECK(!queue.push(99));
+    int values[] = {7, 8};
+    CHECK(!queue.pushAll(values, 2));
+    int item = 0;
+    for (int i = 0; i < 4; i++) {
+        CHECK(queue.pop(item));
+        CHECK_EQ(item, i);
+    }
+    CHECK(!queue.pop(item));
+    CHECK(queue.pushAll(values, 2));
+    CHECK_EQ(queue.size(), (size_t)2);
+}
+
+TEST(mpscBatchIsAllOrNothing) {
+    MpscQueue<int, 4> queue;
+    int batch[] = {1, 2, 3};
+    CHECK(queue.pushAll(batch, 3));
+    CHECK(!queue.pushAll(batch, 3));   // Only one slot left
+    CHECK(queue.push(4));
+    int item = 0;
+    for (int expected = 1; expected <= 4; expected++) {
+        CHECK(queue.pop(item));
+        CHECK_EQ(item, expected);
+    }
+    CHECK(!queue.pop(item));
+}
+
+static MpscQueue<int, 64> shared;
+static int producedBy[3];
+
+static void producerTask(void* parameter) {
+    int id = (int)(uintptr_t)parameter;
+    for (int i = 0; i < 20; i++) {
+        int pair[] = {id * 1000 + i * 2, id * 1000 + i * 2 + 1};
+        while (!shared.pushAll(pair, 2)) vTaskDelay(1);
+        producedBy[id] += 2;
+        if (i % 3 == 0) vTaskDelay(1);
+    }
+    vTaskDelete(NULL);
+}
+
+TEST(mpscBatchesFromTasksStayTogether) {
+    for (int id = 0; id < 3; id++) {
+        producedBy[id] = 0;
+        xTaskCreatePinnedToCore(producerTask, "producer", 4096, (void*)(uintptr_t)id, 1, NULL, 0);
+    }
+    std::vector<int> seen;
+    int item;
+    while (hostTaskCount() > 0) {
+        hostRunFor(1000);
+        while (shared.pop(item)) seen.push_back(item);
+    }
+    CHECK_EQ(seen.size(), (size_t)120);
+    for (size_t i = 0; i + 1 < seen.size(); i += 2) {
+        CHECK_EQ(seen[i + 1], seen[i] + 1);   // A batch is never split
+    }
+    for (int id = 0; id < 3; id++) CHECK_EQ(producedBy[id], 40);
+}
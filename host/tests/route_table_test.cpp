@@ -0,0 +1,30 @@
+// RouteTable: every route resolves to itself, anything else misses
+
+#include "host_test.h"
+#include "web/route_table.h"
+
+static void handlerA() {}
+static void handlerB() {}
+
+static constexpr Route ROUTES[] = {
+    {"/", handlerA},          {"/status", handlerB},   {"/volume", handlerA}, {"/program", handlerB},
+    {"/events", handlerA},    {"/metrics", handlerB},  {"/trace", handlerA},  {"/catalog", handlerB},
+    {"/media", handlerA},     {"/batch", handlerB},    {"/meme", handlerA},   {"/restart", handlerB},
+};
+
+static constexpr auto table = makeRouteTable<256>(ROUTES);
+
+TEST(findsEveryRoute) {
+    for (const Route& route : ROUTES) {
+        const Route* found = table.find(route.path);
+        CHECK(found != nullptr);
+        if (found) CHECK_EQ(std::string(found->path), std::string(route.path));
+    }
+}
+
+TEST(missesUnknownPaths) {
+    CHECK(table.find("/nope") == nullptr);
+    CHECK(table.find("/statu") == nullptr);
+    CHECK(table.find("/status/") == nullptr);
+    CHECK(table.find("") == nullptr);
+}
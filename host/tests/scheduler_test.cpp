@@ -0,0 +1,146 @@
+// Host scheduler: virtual clock, priorities and the FreeRTOS primitives
+
+#include "host_test.h"
+#include <Arduino.h>
+#include <esp_task_wdt.h>
+#include <freertos/stream_buffer.h>
+
+static std::vector<std::string> trace;
+
+static void sleeper(void* parameter) {
+    uint32_t ms = (uint32_t)(uintptr_t)parameter;
+    for (int i = 0; i < 3; i++) {
+        vTaskDelay(pdMS_TO_TICKS(ms));
+        trace.push_back(std::string(pcTaskGetName(NULL)) + "@" + std::to_string(millis()));
+    }
+    vTaskDelete(NULL);
+}
+
+TEST(clockMovesOnlyWhenTasksSleep) {
+    trace.clear();
+    xTaskCreatePinnedToCore(sleeper, "fast", 4096, (void*)(uintptr_t)10, 1, NULL, 0);
+    xTaskCreatePinnedToCore(sleeper, "slow", 4096, (void*)(uintptr_t)25, 1, NULL, 1);
+    CHECK(!hostRunUntil(1000000));   // Both tasks end
+    std::vector<std::string> expected = {"fast@10", "fast@20", "slow@25", "fast@30", "slow@50", "slow@75"};
+    CHECK(trace == expected);
+    CHECK_EQ(hostNowUs(), (uint64_t)1000000);
+}
+
+static void spinner(void* parameter) {
+    for (;;) {
+        trace.push_back(pcTaskGetName(NULL));
+        vTaskDelay(1);
+    }
+}
+
+TEST(higherPriorityRunsFirst) {
+    trace.clear();
+    xTaskCreatePinnedToCore(spinner, "low", 4096, NULL, 1, NULL, 0);
+    xTaskCreatePinnedToCore(spinner, "high", 4096, NULL, 5, NULL, 1);
+    hostRunUntil(1);
+    CHECK(trace.size() >= 2);
+    if (trace.size() >= 2) {
+        CHECK_EQ(trace[0], std::string("high"));
+        CHECK_EQ(trace[1], std::string("low"));
+    }
+    CHECK_EQ(hostTaskCount(), (size_t)2);
+}
+
+static TaskHandle_t waiter = NULL;
+static uint32_t wokenAt = 0;
+
+static void notified(void* parameter) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(1000));
+    wokenAt = millis();
+    vTaskDelete(NULL);
+}
+
+static void notifier(void* parameter) {
+    vTaskDelay(pdMS_TO_TICKS(40));
+    xTaskNotifyGive(waiter);
+    vTaskDelete(NULL);
+}
+
+TEST(notificationWakesWaiterEarly) {
+    wokenAt = 0;
+    xTaskCreatePinnedToCore(notified, "waiter", 4096, NULL, 2, &waiter, 0);
+    xTaskCreatePinnedToCore(notifier, "notifier", 4096, NULL, 1, NULL, 0);
+    hostRunUntil(2000000);
+    CHECK_EQ(wokenAt, (uint32_t)40);
+}
+
+TEST(blockingOutsideTasksJustWaits) {
+    uint32_t start = millis();
+    CHECK_EQ(ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(250)), (uint32_t)0);
+    CHECK_EQ(millis() - start, (unsigned long)250);
+
+    SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+    CHECK(xSemaphoreTake(mutex, 0) == pdTRUE);
+    CHECK(xSemaphoreTake(mutex, pdMS_TO_TICKS(100)) == pdFALSE);
+    CHECK(xSemaphoreGive(mutex) == pdTRUE);
+    CHECK(xSemaphoreTake(mutex, 0) == pdTRUE);
+    vSemaphoreDelete(mutex);
+
+    delay(5);
+    CHECK_EQ(millis() - start, (unsigned long)355);
+}
+
+static StreamBufferHandle_t pipe = NULL;
+static std::string received;
+
+static void producer(void* parameter) {
+    for (int i = 0; i < 4; i++) {
+        xStreamBufferSend(pipe, "abcd", 4, portMAX_DELAY);
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    vTaskDelete(NULL);
+}
+
+static void consumer(void* parameter) {
+    char chunk[8];
+    for (;;) {
+        size_t n = xStreamBufferReceive(pipe, chunk, sizeof(chunk), pdMS_TO_TICKS(100));
+        if (n == 0) break;
+        received.append(chunk, n);
+    }
+    vTaskDelete(NULL);
+}
+
+TEST(streamBufferCarriesBytesBetweenTasks) {
+    received.clear();
+    pipe = xStreamBufferCreate(6, 1);
+    xTaskCreatePinnedToCore(producer, "producer", 4096, NULL, 1, NULL, 0);
+    xTaskCreatePinnedToCore(consumer, "consumer", 4096, NULL, 2, NULL, 1);
+    hostRunUntil(5000000);
+    CHECK_EQ(received, std::string("abcdabcdabcdabcd"));
+    vStreamBufferDelete(pipe);
+}
+
+static void hungTask(void* parameter) {
+    esp_task_wdt_add(NULL);
+    esp_task_wdt_reset();
+    vTaskDelay(pdMS_TO_TICKS(7000));   // Blocks past the timeout without feeding
+    esp_task_wdt_delete(NULL);
+    vTaskDelete(NULL);
+}
+
+TEST(watchdogCatchesUnfedTask) {
+    esp_task_wdt_init(5, true);
+    xTaskCreatePinnedToCore(hungTask, "hung", 4096, NULL, 1, NULL, 0);
+    hostRunUntil(10000000);
+    std::string task;
+    CHECK_EQ(hostGetWatchdogTriggers(&task), (uint32_t)1);
+    CHECK_EQ(task, std::string("hung"));
+}
+
+TEST(randomIsReproducible) {
+    hostSeedRandom(42);
+    long first[4];
+    for (long& value : first) value = random(1000);
+    hostSeedRandom(42);
+    for (long value : first) CHECK_EQ(random(1000), value);
+    for (int i = 0; i < 100; i++) {
+        long value = random(-3, 4);
+        CHECK(value >= -3 && value < 4);
+    }
+}
@@ -0,0 +1,44 @@
+// TemplateRenderer: placeholders, chunk boundaries and literal percent signs
+
+#include "host_test.h"
+#include "web/template_renderer.h"
+
+static bool resolve(const char* name, char* value, size_t valueSize) {
+    if (strcmp(name, "VOLUME") == 0) {
+        snprintf(value, valueSize, "%d", 15);
+        return true;
+    }
+    return false;
+}
+
+static void collect(const char* data, size_t length, void* context) {
+    ((std::string*)context)->append(data, length);
+}
+
+static std::string render(const std::vector<std::string>& chunks) {
+    std::string output;
+    TemplateRenderer renderer(resolve, collect, &output);
+    for (const std::string& chunk : chunks) renderer.feed(chunk.data(), chunk.size());
+    renderer.finish();
+    CHECK_EQ((size_t)renderer.bytesWritten(), output.size());
+    return output;
+}
+
+TEST(substitutesPlaceholders) {
+    CHECK_EQ(render({"Volume: %VOLUME%!"}), std::string("Volume: 15!"));
+}
+
+TEST(carriesPlaceholdersAcrossChunks) {
+    CHECK_EQ(render({"Volume: %VOL", "UME", "%!"}), std::string("Volume: 15!"));
+    CHECK_EQ(render({"a%", "VOLUME%b"}), std::string("a15b"));
+}
+
+TEST(keepsUnknownPlaceholdersAndPercentSigns) {
+    CHECK_EQ(render({"width: 100%; %NOPE% %VOLUME%"}), std::string("width: 100%; %NOPE% 15"));
+    CHECK_EQ(render({"50%"}), std::string("50%"));
+}
+
+TEST(flushesLongOutputInPieces) {
+    std::string text(TEMPLATE_OUTPUT_SIZE * 3 + 7, 'x');
+    CHECK_EQ(render({text}), text);
+}
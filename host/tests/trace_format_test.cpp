@@ -0,0 +1,138 @@
+// Trace encoding: event JSON, sizes for buffers that are too small, details, and chunked export
+
+#include "host_test.h"
+#include <Arduino.h>
+#include "managers/tracer.h"
+#include "web/trace_format.h"
+
+static TraceEvent makeEvent(char phase, uint32_t timeUs) {
+    TraceEvent event = {};
+    event.timeUs = timeUs;
+    event.name = "SD.open";
+    event.category = TRACE_SD;
+    event.phase = phase;
+    event.thread = 2;
+    return event;
+}
+
+static std::string encode(const TraceEvent& event, uint32_t originUs) {
+    char buffer[256];
+    size_t length = writeTraceEvent(buffer, sizeof(buffer), event, originUs);
+    CHECK(length < sizeof(buffer));
+    return std::string(buffer, length);
+}
+
+TEST(writesEventsRelativeToTheOrigin) {
+    CHECK_EQ(encode(makeEvent('B', 1500), 1000),
+             std::string(",{\"name\":\"SD.open\",\"cat\":\"sd\",\"ph\":\"B\",\"ts\":500,\"pid\":1,\"tid\":2}"));
+
+    TraceEvent instant = makeEvent('i', 5);
+    instant.hasValue = true;
+    instant.value = 42;
+    copyTraceDetail(instant.detail, "/music/a\"b.mp3");
+    CHECK_EQ(encode(instant, 0xFFFFFFF0u),   // micros() wrapped since the origin
+             std::string(",{\"name\":\"SD.open\",\"cat\":\"sd\",\"ph\":\"i\",\"ts\":21,\"pid\":1,\"tid\":2,\"s\":\"t\","
+                         "\"args\":{\"value\":42,\"detail\":\"/music/a\\\"b.mp3\"}}"));
+}
+
+TEST(reportsTheSizeNeededWhenTooSmall) {
+    TraceEvent event = makeEvent('E', 10);
+    std::string full = encode(event, 0);
+
+    for (size_t size : {(size_t)0, (size_t)1, (size_t)2, full.size() / 2, full.size()}) {
+        std::vector<char> buffer(size + 1, '#');
+        CHECK_EQ(writeTraceEvent(buffer.data(), size, event, 0), full.size());
+        CHECK_EQ(buffer[size], '#');   // Nothing written past the given size
+    }
+    std::vector<char> exact(full.size() + 1);
+    CHECK_EQ(writeTraceEvent(exact.data(), exact.size(), event, 0), full.size());
+    CHECK_EQ(std::string(exact.data()), full);
+
+    const char* names[] = {"loopTask", "audio"};
+    char header[512];
+    size_t headerLength = writeTraceHeader(header, sizeof(header), "GhostWhisper", names, 2);
+    CHECK_EQ(writeTraceHeader(header, 10, "GhostWhisper", names, 2), headerLength);
+    const std::string expectedFooter = "],\"otherData\":{\"droppedEvents\":7}}";
+    char footer[64];
+    CHECK_EQ(writeTraceFooter(footer, sizeof(footer), 7), expectedFooter.size());
+    CHECK_EQ(std::string(footer), expectedFooter);
+    CHECK_EQ(writeTraceFooter(footer, 4, 7), expectedFooter.size());
+}
+
+TEST(keepsTheEndOfLongDetails) {
+    char detail[TRACE_DETAIL_SIZE];
+    copyTraceDetail(detail, "/music/dub/very-long-name.mp3");
+    CHECK_EQ(std::string(detail), std::string("y-long-name.mp3"));
+    copyTraceDetail(detail, "short");
+    CHECK_EQ(std::string(detail), std::string("short"));
+    // The cut lands inside "é", which is skipped rather than split
+    copyTraceDetail(detail, "/music/\xc3\xa9" "abcdefghijklmn");
+    CHECK_EQ(std::string(detail), std::string("abcdefghijklmn"));
+}
+
+TEST(parsesCategoryLists) {
+    uint32_t mask = 0;
+    CHECK(parseTraceCategories("all", &mask));
+    CHECK_EQ(mask, (uint32_t)TRACE_ALL_CATEGORIES);
+    CHECK(parseTraceCategories("sd,web,,stream", &mask));
+    CHECK_EQ(mask, (uint32_t)((1u << TRACE_SD) | (1u << TRACE_WEB) | (1u << TRACE_STREAM)));
+    CHECK(!parseTraceCategories("sd,disk", &mask));
+    CHECK(!parseTraceCategories("s", &mask));
+}
+
+static void collectChunk(const char* data, size_t length, void* context) {
+    auto* chunks = (std::vector<std::string>*)context;
+    chunks->push_back(std::string(data, length));
+}
+
+static size_t countOf(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) count++;
+    return count;
+}
+
+TEST(exportSplitsTheDocumentOnEventBoundaries) {
+    CHECK(startTrace(TRACE_ALL_CATEGORIES));
+    const uint32_t events = 500;
+    for (uint32_t i = 0; i < events; i++) {
+        TRACE_INSTANT(TRACE_PROGRAM, "note", "/soundfont/piano/c4.mp3");
+        hostAdvanceUs(100);
+    }
+
+    std::vector<std::string> chunks;
+    CHECK_EQ(exportTrace(collectChunk, &chunks), (size_t)events);
+    CHECK(chunks.size() > 1);
+    std::string document;
+    for (const std::string& chunk : chunks) {
+        CHECK(chunk.size() < TRACE_SEND_CHUNK);
+        CHECK(chunk.find('\0') == std::string::npos);
+        document += chunk;
+    }
+    // Every chunk after the first starts a new event or the footer, never mid-object
+    for (size_t i = 1; i < chunks.size(); i++) CHECK(chunks[i][0] == ',' || chunks[i][0] == ']');
+
+    CHECK_EQ(document.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), (size_t)0);
+    CHECK_EQ(countOf(document, "\"name\":\"note\""), (size_t)events);
+    CHECK_EQ(countOf(document, "{"), countOf(document, "}"));
+    CHECK(document.find("\"ts\":0,") != std::string::npos);
+    CHECK(document.find("\"ts\":49900,") != std::string::npos);
+    const std::string footer = "],\"otherData\":{\"droppedEvents\":0}}";
+    CHECK_EQ(document.rfind(footer), document.size() - footer.size());
+}
+
+TEST(exportReportsEventsLostToTheRing) {
+    CHECK(startTrace(TRACE_ALL_CATEGORIES));
+    uint32_t capacity = getTraceStatus().capacity;
+    for (uint32_t i = 0; i < capacity + 10; i++) TRACE_VALUE(TRACE_AUDIO, "fill", i);
+    CHECK_EQ(getTraceStatus().dropped, (uint32_t)10);
+
+    std::vector<std::string> chunks;
+    CHECK_EQ(exportTrace(collectChunk, &chunks), (size_t)capacity);
+    std::string document;
+    for (const std::string& chunk : chunks) document += chunk;
+    CHECK(document.find("\"droppedEvents\":10}") != std::string::npos);
+    // The oldest ten were overwritten
+    CHECK(document.find("\"value\":9}") == std::string::npos);
+    CHECK(document.find("\"value\":10}") != std::string::npos);
+    CHECK(!getTraceStatus().running);
+}
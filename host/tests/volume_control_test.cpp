@@ -0,0 +1,41 @@
+// Volume control: the audio loop only ramps, the web task saves the volume once it has settled
+
+#include "host_test.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include "config/config.h"
+#include "hardware/volume_control.h"
+
+static int savedVolume() {
+    Preferences prefs;
+    prefs.begin("ghostwhisper", true);
+    int volume = prefs.getUChar("volume", 255);
+    prefs.end();
+    return volume;
+}
+
+TEST(savesOnlyFromTheWebTaskOnceSettled) {
+    initializeVolumeControl();
+    CHECK_EQ(savedVolume(), 255);
+
+    // The audio loop applies the change but never writes flash
+    CHECK(setVolume(40));
+    serviceVolumeControl();
+    hostAdvanceUs((VOLUME_PERSIST_DELAY_MS + 1000) * 1000ULL);
+    serviceVolumeControl();
+    CHECK_EQ(savedVolume(), 255);
+
+    // Changes inside the window restart it
+    serviceVolumePersistence();
+    hostAdvanceUs((VOLUME_PERSIST_DELAY_MS - 1000) * 1000ULL);
+    CHECK(setVolume(50));
+    serviceVolumePersistence();
+    hostAdvanceUs((VOLUME_PERSIST_DELAY_MS - 1000) * 1000ULL);
+    serviceVolumePersistence();
+    CHECK_EQ(savedVolume(), 255);
+
+    hostAdvanceUs(1000 * 1000ULL);
+    serviceVolumePersistence();
+    CHECK_EQ(savedVolume(), 50);
+    CHECK_EQ(getCurrentVolume(), 50);
+}
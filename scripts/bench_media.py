@@ -0,0 +1,88 @@
+import json
+import sys
+import threading
+import time
+import urllib.parse
+import urllib.request
+
+# Media transfer benchmark: concurrent Range downloads while the device plays.
+#
+# Each client downloads FILE in RANGE_SIZE pieces, the way a browser's audio
+# element does when seeking. Reports per-client throughput, then the device's
+# /media/stats (decoder back-offs, lowest decoder buffer fill) and any underrun
+# counters on /metrics, sampled before and after each run.
+#
+# Usage: python bench_media.py [host] [sd_path] [clients...]
+#   python bench_media.py ghostwhisper.local /music/track01.mp3 1 2 4
+
+HOST = sys.argv[1] if len(sys.argv) > 1 else "ghostwhisper.local"
+FILE = sys.argv[2] if len(sys.argv) > 2 else "/rec/timeshift.mp3"
+CLIENTS = [int(n) for n in sys.argv[3:]] or [1, 2, 4]
+RANGE_SIZE = 256 * 1024
+
+
+def get(path, headers=None):
+    request = urllib.request.Request(f"http://{HOST}{path}", headers=headers or {})
+    with urllib.request.urlopen(request, timeout=30) as response:
+        return response.status, response.headers, response.read()
+
+
+def get_json(path):
+    try:
+        return json.loads(get(path)[2])
+    except Exception:
+        return None
+
+
+def underruns():
+    metrics = get_json("/metrics")
+    found = {}
+
+    def walk(node, prefix=""):
+        if isinstance(node, dict):
+            for key, value in node.items():
+                walk(value, f"{prefix}{key}.")
+        elif isinstance(node, (int, float)) and "underrun" in prefix.lower():
+            found[prefix.rstrip(".")] = node
+
+    walk(metrics)
+    return found
+
+
+def download(results):
+    url = "/media?path=" + urllib.parse.quote(FILE)
+    started = time.time()
+    total = 0
+    offset = 0
+    while True:
+        status, headers, body = get(url, {"Range": f"bytes={offset}-{offset + RANGE_SIZE - 1}"})
+        if status not in (200, 206):
+            break
+        total += len(body)
+        size = int(headers.get("Content-Range", "/0").split("/")[-1] or 0)
+        offset += len(body)
+        if status == 200 or offset >= size or not body:
+            break
+    results.append((total, time.time() - started))
+
+
+print(f"Downloading {FILE} from http://{HOST} in {RANGE_SIZE // 1024} KB ranges")
+for clients in CLIENTS:
+    before = underruns()
+    results = []
+    threads = [threading.Thread(target=download, args=(results,)) for _ in range(clients)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    after = underruns()
+
+    rates = [total / elapsed / 1024 for total, elapsed in results if elapsed > 0]
+    line = f"{clients} client(s): " + ", ".join(f"{r:.0f} KB/s" for r in rates)
+    if rates:
+        line += f" (aggregate {sum(rates):.0f} KB/s)"
+    deltas = {key: after[key] - before.get(key, 0) for key in after}
+    line += ", underruns " + (", ".join(f"{k}=+{v}" for k, v in deltas.items()) or "not reported")
+    print(line)
+
+print("Device media stats:", get_json("/media/stats"))
@@ -0,0 +1,63 @@
+import json
+import statistics
+import sys
+import time
+import urllib.request
+
+# Meme soundboard latency benchmark.
+#
+# Taps every meme ROUNDS times and reports, per clip, the HTTP round trip of
+# /meme/play and the device's own tap-to-first-sample latency from /meme/stats
+# (request arrival to the first decoded block handed to I2S). Clips whose head
+# is preloaded are listed separately from clips streamed straight from SD, so
+# the two paths can be compared on the same card.
+#
+# Usage: python bench_meme_latency.py [host] [rounds] [gap_seconds]
+
+HOST = sys.argv[1] if len(sys.argv) > 1 else "ghostwhisper.local"
+ROUNDS = int(sys.argv[2]) if len(sys.argv) > 2 else 5
+GAP = float(sys.argv[3]) if len(sys.argv) > 3 else 1.0
+
+
+def get(path):
+    with urllib.request.urlopen(f"http://{HOST}{path}", timeout=10) as response:
+        return response.read()
+
+
+clips = json.loads(get("/meme/list"))["files"]
+if not clips:
+    sys.exit("No meme files on the device")
+
+before = {clip["path"]: clip for clip in json.loads(get("/meme/stats"))["clips"]}
+round_trips = {path: [] for path in clips}
+device = {path: [] for path in clips}
+
+print(f"Tapping {len(clips)} memes {ROUNDS} times on http://{HOST}/")
+for _ in range(ROUNDS):
+    for index, path in enumerate(clips, start=1):
+        start = time.perf_counter()
+        get(f"/meme/play?n={index}")
+        round_trips[path].append((time.perf_counter() - start) * 1000)
+        time.sleep(GAP)  # Let the first samples arrive before reading the probe
+        stats = {clip["path"]: clip for clip in json.loads(get("/meme/stats"))["clips"]}
+        if stats[path]["plays"] > before.get(path, {}).get("plays", 0):
+            device[path].append(stats[path]["lastUs"] / 1000)
+        before = stats
+
+for preloaded in (True, False):
+    group = [path for path in clips if before[path]["preloaded"] == preloaded]
+    if not group:
+        continue
+    print("\nPreloaded clips:" if preloaded else "\nClips streamed from SD:")
+    all_device = []
+    for path in group:
+        samples = device[path]
+        all_device += samples
+        line = f"  {path}: http median {statistics.median(round_trips[path]):.1f} ms"
+        if samples:
+            line += f", first sample median {statistics.median(samples):.1f} ms, max {max(samples):.1f} ms"
+        else:
+            line += ", no first-sample measurements"
+        print(line)
+    if all_device:
+        print(f"  overall first sample median {statistics.median(all_device):.1f} ms over {len(all_device)} taps")
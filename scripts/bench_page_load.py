@@ -0,0 +1,132 @@
+import json
+import re
+import statistics
+import sys
+import threading
+import time
+import urllib.request
+
+# Page-load benchmark for the GhostWhisper web UI.
+#
+# Loads "/" plus every asset it references (following JS imports) from several
+# concurrent clients, the way phones on the soft-AP do, and reports page load times.
+# If the firmware exposes /metrics, any counter with "underrun" in its name is
+# sampled before and after each round so audio dropouts can be compared between
+# the flash bundle and the SD override.
+#
+# Usage: python bench_page_load.py [host] [rounds]
+#   host   - device address, default ghostwhisper.local
+#   rounds - page loads per client per concurrency level, default 5
+
+HOST = sys.argv[1] if len(sys.argv) > 1 else "ghostwhisper.local"
+ROUNDS = int(sys.argv[2]) if len(sys.argv) > 2 else 5
+CONCURRENCY = [1, 2, 4, 8]
+
+REFERENCE_PATTERN = re.compile(r"""(?:from\s+|import\s+|src=|href=)["']([^"']+\.(?:js|css)(?:\?v=\w+)?)["']""")
+
+
+def fetch(path):
+    request = urllib.request.Request(f"http://{HOST}{path}", headers={"Accept-Encoding": "gzip"})
+    with urllib.request.urlopen(request, timeout=30) as response:
+        return response.read(), response.headers.get("Content-Encoding") == "gzip"
+
+
+def resolve(referrer, ref):
+    if ref.startswith("/"):
+        return ref
+    base = referrer.rsplit("/", 1)[0]
+    parts = []
+    for part in (base + "/" + ref).split("/"):
+        if part == "..":
+            parts.pop()
+        elif part not in ("", "."):
+            parts.append(part)
+    return "/" + "/".join(parts)
+
+
+def load_page():
+    # Browsers without a warm cache fetch the page then every referenced asset
+    start = time.perf_counter()
+    wire_bytes = 0
+    pending = ["/"]
+    seen = set()
+    while pending:
+        path = pending.pop()
+        if path in seen:
+            continue
+        seen.add(path)
+        body, gzipped = fetch(path)
+        wire_bytes += len(body)
+        if gzipped:
+            continue  # References inside gzipped assets are covered by the index imports
+        text = body.decode("utf-8", errors="ignore")
+        for ref in REFERENCE_PATTERN.findall(text):
+            pending.append(resolve("/index.html" if path == "/" else path, ref))
+    return time.perf_counter() - start, wire_bytes, len(seen)
+
+
+def read_underruns():
+    try:
+        body, _ = fetch("/metrics")
+        metrics = json.loads(body)
+    except Exception:
+        return None
+
+    def walk(node, prefix=""):
+        found = {}
+        if isinstance(node, dict):
+            for key, value in node.items():
+                found.update(walk(value, f"{prefix}{key}."))
+        elif isinstance(node, (int, float)) and "underrun" in prefix.lower():
+            found[prefix.rstrip(".")] = node
+        return found
+
+    return walk(metrics)
+
+
+def run_round(clients):
+    times = []
+    errors = []
+    lock = threading.Lock()
+    totals = {}
+
+    def client():
+        for _ in range(ROUNDS):
+            try:
+                elapsed, wire_bytes, requests = load_page()
+                with lock:
+                    times.append(elapsed)
+                    totals["bytes"] = wire_bytes
+                    totals["requests"] = requests
+            except Exception as e:
+                with lock:
+                    errors.append(str(e))
+
+    threads = [threading.Thread(target=client) for _ in range(clients)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    return times, errors, totals
+
+
+print(f"Benchmarking http://{HOST}/ with {ROUNDS} page loads per client")
+for clients in CONCURRENCY:
+    before = read_underruns()
+    times, errors, totals = run_round(clients)
+    after = read_underruns()
+
+    line = f"{clients} client(s): "
+    if times:
+        times.sort()
+        p95 = times[min(len(times) - 1, int(len(times) * 0.95))]
+        line += (f"median {statistics.median(times) * 1000:.0f} ms, p95 {p95 * 1000:.0f} ms, "
+                 f"{totals.get('requests', 0)} requests / {totals.get('bytes', 0)} bytes per page")
+    if errors:
+        line += f", {len(errors)} failed loads"
+    if before is not None and after is not None:
+        deltas = {key: after[key] - before.get(key, 0) for key in after}
+        line += ", underruns " + (", ".join(f"{k}=+{v}" for k, v in deltas.items()) or "not reported")
+    else:
+        line += ", underruns unavailable (no /metrics)"
+    print(line)
@@ -0,0 +1,145 @@
+import json
+import socket
+import sys
+import threading
+import time
+
+# Compares /status polling with the /events push channel.
+#
+# For 1, 4 and 8 clients, runs each mode for DURATION seconds and counts HTTP
+# requests, bytes on the wire and TCP segments. Airtime is estimated from those:
+# every segment costs a fixed 802.11 overhead (preamble, DIFS/backoff, ACK) plus
+# its payload at the PHY rate. Push clients beyond the device's subscriber cap get
+# a 503 and poll instead, as the UI does.
+#
+# Usage: python bench_status_push.py [host] [duration_seconds]
+
+HOST = sys.argv[1] if len(sys.argv) > 1 else "ghostwhisper.local"
+DURATION = float(sys.argv[2]) if len(sys.argv) > 2 else 60
+CLIENTS = [1, 4, 8]
+POLL_INTERVAL = 5.0
+
+PHY_RATE_BPS = 24e6          # Typical soft-AP rate for a phone at a few meters
+FRAME_OVERHEAD_US = 120      # Preamble + DIFS + average backoff + SIFS + ACK
+SEGMENTS_PER_REQUEST = 10    # Handshake, request, response, ACKs and close
+
+
+class Counters:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.requests = 0
+        self.bytes = 0
+        self.segments = 0
+        self.events = 0
+        self.rejected = 0
+
+    def add(self, requests=0, nbytes=0, segments=0, events=0, rejected=0):
+        with self.lock:
+            self.requests += requests
+            self.bytes += nbytes
+            self.segments += segments
+            self.events += events
+            self.rejected += rejected
+
+    def airtime_ms(self):
+        return (self.segments * FRAME_OVERHEAD_US + self.bytes * 8 / PHY_RATE_BPS * 1e6) / 1000
+
+
+def request(path):
+    sock = socket.create_connection((HOST, 80), timeout=10)
+    req = f"GET {path} HTTP/1.1\r\nHost: {HOST}\r\nConnection: close\r\n\r\n".encode()
+    sock.sendall(req)
+    return sock, len(req)
+
+
+def poll_once(counters):
+    sock, sent = request("/status")
+    received = 0
+    with sock:
+        while True:
+            chunk = sock.recv(2048)
+            if not chunk:
+                break
+            received += len(chunk)
+    counters.add(requests=1, nbytes=sent + received, segments=SEGMENTS_PER_REQUEST)
+
+
+def poll_client(counters, deadline):
+    while time.time() < deadline:
+        started = time.time()
+        try:
+            poll_once(counters)
+        except OSError:
+            pass
+        time.sleep(max(0, POLL_INTERVAL - (time.time() - started)))
+
+
+def push_client(counters, deadline):
+    try:
+        sock, sent = request("/events")
+    except OSError:
+        return
+    counters.add(requests=1, nbytes=sent, segments=SEGMENTS_PER_REQUEST - 2)
+    with sock:
+        sock.settimeout(1)
+        head = b""
+        while b"\r\n\r\n" not in head and time.time() < deadline:
+            try:
+                chunk = sock.recv(2048)
+            except socket.timeout:
+                continue
+            if not chunk:
+                break
+            head += chunk
+        counters.add(nbytes=len(head))
+        if not head.startswith(b"HTTP/1.1 200"):
+            counters.add(rejected=1)
+            sock.close()
+            poll_client(counters, deadline)
+            return
+        counters.add(events=head.count(b"\n\n") - 1)
+        while time.time() < deadline:
+            try:
+                chunk = sock.recv(2048)
+            except socket.timeout:
+                continue
+            if not chunk:
+                break
+            # One event per segment plus its ACK; the channel runs with Nagle disabled
+            events = chunk.count(b"\n\n")
+            counters.add(nbytes=len(chunk), segments=2 * max(1, events), events=events)
+
+
+def run(mode, clients):
+    counters = Counters()
+    deadline = time.time() + DURATION
+    target = poll_client if mode == "poll" else push_client
+    threads = [threading.Thread(target=target, args=(counters, deadline)) for _ in range(clients)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    return counters
+
+
+print(f"http://{HOST}/ - {DURATION:.0f} s per run")
+for clients in CLIENTS:
+    for mode in ("poll", "push"):
+        c = run(mode, clients)
+        line = (f"{clients} client(s) {mode}: {c.requests} requests, {c.bytes} bytes, "
+                f"~{c.segments} segments, ~{c.airtime_ms():.1f} ms airtime")
+        if mode == "push":
+            line += f", {c.events} events"
+            if c.rejected:
+                line += f", {c.rejected} over the cap fell back to polling"
+        print(line)
+
+try:
+    sock, _ = request("/events/stats")
+    with sock:
+        data = b""
+        while chunk := sock.recv(2048):
+            data += chunk
+    print("Device counters:", json.loads(data.split(b"\r\n\r\n", 1)[1]))
+except (OSError, ValueError, IndexError):
+    pass
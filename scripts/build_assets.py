@@ -0,0 +1,189 @@
+import gzip
+import hashlib
+import json
+import os
+import re
+import shutil
+import sys
+
+# Builds the web UI for the SD card:
+#   - rewrites local asset references to "<file>?v=<content hash>" so the device can
+#     serve them with an immutable Cache-Control
+#   - writes a .gz sibling next to every compressible asset
+#   - writes assets.json, the manifest the firmware loads at boot (hash + sizes)
+#   - writes src/web/asset_bundle_data.h, the same assets compiled into flash so the
+#     UI is served without touching the SD bus
+#
+# Usage: python build_assets.py [view_dir] [output_dir] [bundle_header]
+# The firmware serves the flash bundle by default. To serve a custom UI instead,
+# copy the output directory to the SD card as /view and add an empty /view/.override.
+#
+# Also runs automatically before a PlatformIO build when listed in extra_scripts.
+
+COMPRESSIBLE = ('.js', '.css', '.svg', '.json', '.ico', '.txt')
+TEXT_ASSETS = ('.html', '.js', '.css')
+
+CONTENT_TYPES = {
+    '.html': 'text/html',
+    '.css': 'text/css',
+    '.js': 'application/javascript',
+    '.json': 'application/json',
+    '.png': 'image/png',
+    '.jpg': 'image/jpeg',
+    '.svg': 'image/svg+xml',
+    '.ico': 'image/x-icon',
+}
+
+# import ... from './x.js'  |  import './x.js'  |  src="/app.js"  |  href="/style.css"
+REFERENCE_PATTERN = re.compile(
+    r"""(?P<prefix>(?:from\s+|import\s+|src=|href=)["'])(?P<ref>[^"'?#]+\.(?:js|css))(?P<suffix>["'])""")
+
+
+def content_hash(data):
+    return hashlib.sha256(data).hexdigest()[:12]
+
+
+class AssetBuilder:
+    def __init__(self, view_dir):
+        self.view_dir = os.path.abspath(view_dir)
+        self.built = {}        # web path -> final bytes
+        self.in_progress = set()
+
+    def web_path(self, fs_path):
+        rel = os.path.relpath(fs_path, self.view_dir).replace(os.sep, '/')
+        return '/' + rel
+
+    def resolve(self, referrer, ref):
+        if ref.startswith('/'):
+            return ref
+        base = os.path.dirname(referrer)
+        return os.path.normpath(os.path.join(base, ref)).replace(os.sep, '/')
+
+    def build(self, web_path):
+        # Imports are hashed before their importers, so a change anywhere busts every parent
+        if web_path in self.built:
+            return self.built[web_path]
+        if web_path in self.in_progress:
+            raise RuntimeError(f"Import cycle through {web_path}")
+        self.in_progress.add(web_path)
+
+        fs_path = os.path.join(self.view_dir, web_path.lstrip('/'))
+        with open(fs_path, 'rb') as f:
+            data = f.read()
+
+        if web_path.endswith(TEXT_ASSETS):
+            text = data.decode('utf-8')
+
+            def rewrite(match):
+                target = self.resolve(web_path, match.group('ref'))
+                target_fs = os.path.join(self.view_dir, target.lstrip('/'))
+                if not os.path.isfile(target_fs):
+                    return match.group(0)
+                version = content_hash(self.build(target))
+                return f"{match.group('prefix')}{match.group('ref')}?v={version}{match.group('suffix')}"
+
+            data = REFERENCE_PATTERN.sub(rewrite, text).encode('utf-8')
+
+        self.in_progress.discard(web_path)
+        self.built[web_path] = data
+        return data
+
+
+def write_flash_bundle(bundle, header_path):
+    # Pages stay uncompressed so the firmware can fill in template placeholders;
+    # everything else is stored only in its gzip form to save flash.
+    lines = [
+        '// Generated by scripts/build_assets.py - do not edit.',
+        '#pragma once',
+        '',
+        '#include "asset_bundle.h"',
+        '',
+    ]
+    entries = []
+    for index, (web_path, data, compressed, version) in enumerate(bundle):
+        payload = compressed if compressed is not None else data
+        lines.append(f'// {web_path}')
+        lines.append(f'alignas(4) static const uint8_t BUNDLE_ASSET_{index}[] PROGMEM = {{')
+        for offset in range(0, len(payload), 16):
+            chunk = payload[offset:offset + 16]
+            lines.append('    ' + ', '.join(f'0x{b:02x}' for b in chunk) + ',')
+        lines.append('};')
+        content_type = CONTENT_TYPES.get(os.path.splitext(web_path)[1], 'text/plain')
+        entries.append(f'    {{"{web_path}", "{content_type}", "{version}", BUNDLE_ASSET_{index}, '
+                       f'{len(payload)}, {len(data)}, {"true" if compressed is not None else "false"}}},')
+    lines.append('')
+    lines.append('static const BundledAsset BUNDLED_ASSETS[] = {')
+    lines.extend(entries)
+    lines.append('};')
+    lines.append('static const size_t BUNDLED_ASSET_COUNT = sizeof(BUNDLED_ASSETS) / sizeof(BUNDLED_ASSETS[0]);')
+    lines.append('')
+
+    content = '\n'.join(lines)
+    # Leave the header untouched when nothing changed so the firmware is not rebuilt
+    if os.path.isfile(header_path):
+        with open(header_path, 'r') as f:
+            if f.read() == content:
+                return
+    with open(header_path, 'w') as f:
+        f.write(content)
+
+
+def build_assets(view_dir, output_dir, bundle_header=None):
+    builder = AssetBuilder(view_dir)
+    manifest = {}
+    bundle = []
+    total_raw = 0
+    total_gz = 0
+
+    for root, _, files in os.walk(builder.view_dir):
+        for name in sorted(files):
+            if name.endswith('.gz') or name == 'assets.json':
+                continue
+            web_path = builder.web_path(os.path.join(root, name))
+            data = builder.build(web_path)
+
+            out_path = os.path.join(output_dir, web_path.lstrip('/'))
+            os.makedirs(os.path.dirname(out_path), exist_ok=True)
+            with open(out_path, 'wb') as f:
+                f.write(data)
+
+            entry = {'hash': content_hash(data), 'size': len(data), 'gz': 0}
+            compressed = None
+            if name.endswith(COMPRESSIBLE):
+                # mtime=0 keeps the .gz byte-identical across builds
+                compressed = gzip.compress(data, compresslevel=9, mtime=0)
+                if len(compressed) < len(data):
+                    with open(out_path + '.gz', 'wb') as f:
+                        f.write(compressed)
+                    entry['gz'] = len(compressed)
+                else:
+                    compressed = None
+            manifest[web_path] = entry
+            bundle.append((web_path, data, compressed, entry['hash']))
+            total_raw += len(data)
+            total_gz += entry['gz'] or len(data)
+
+    with open(os.path.join(output_dir, 'assets.json'), 'w') as f:
+        json.dump(manifest, f, indent=1, sort_keys=True)
+
+    print(f"Built {len(manifest)} assets into {output_dir}: "
+          f"{total_raw} bytes raw, {total_gz} bytes on the wire")
+
+    if bundle_header:
+        write_flash_bundle(bundle, bundle_header)
+        print(f"Flash bundle written to {bundle_header}")
+    return manifest
+
+
+if __name__ == "__main__" or __name__ == "SCons.Script":
+    project_dir = os.path.dirname(os.path.dirname(os.path.abspath(__file__))) \
+        if __name__ == "__main__" else os.getcwd()
+    args = sys.argv[1:] if __name__ == "__main__" else []
+    VIEW_DIR = args[0] if len(args) > 0 else os.path.join(project_dir, 'view')
+    OUTPUT_DIR = args[1] if len(args) > 1 else os.path.join(project_dir, 'build', 'view')
+    BUNDLE_HEADER = args[2] if len(args) > 2 else os.path.join(project_dir, 'src', 'web', 'asset_bundle_data.h')
+
+    if os.path.isdir(OUTPUT_DIR):
+        shutil.rmtree(OUTPUT_DIR)
+    os.makedirs(OUTPUT_DIR)
+    build_assets(VIEW_DIR, OUTPUT_DIR, BUNDLE_HEADER)
@@ -0,0 +1,46 @@
+import json
+import sys
+from http.server import BaseHTTPRequestHandler, HTTPServer
+
+# Local stand-in for the ghostwhisper_playlist API, used to test the station catalog
+# without upstream connectivity.
+#
+# Build the firmware against it with:
+#   build_flags = -DCATALOG_SOURCE_URL=\"http://<your-pc-ip>:8000/playlist\"
+#
+# Usage: python catalog_standin.py [port] [playlist.json]
+# Edit the playlist file while the device runs and hit /stream/refresh to see the
+# catalog version bump; leave it untouched and the version (and ETag) stays stable.
+
+DEFAULT_PLAYLIST = {
+    "Smooth Jazz": "http://jazz-wr04.ice.infomaniak.ch/jazz-wr04-128.mp3",
+    "Reggae": "http://reggae.stream.laut.fm/reggae",
+}
+
+port = int(sys.argv[1]) if len(sys.argv) > 1 else 8000
+playlist_path = sys.argv[2] if len(sys.argv) > 2 else None
+
+
+def load_playlist():
+    if playlist_path:
+        with open(playlist_path, 'r') as f:
+            return json.load(f)
+    return DEFAULT_PLAYLIST
+
+
+class PlaylistHandler(BaseHTTPRequestHandler):
+    def do_GET(self):
+        if self.path != '/playlist':
+            self.send_response(404)
+            self.end_headers()
+            return
+        body = json.dumps(load_playlist()).encode('utf-8')
+        self.send_response(200)
+        self.send_header('Content-Type', 'application/json')
+        self.send_header('Content-Length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+
+print(f"Serving playlist stand-in on http://0.0.0.0:{port}/playlist")
+HTTPServer(('0.0.0.0', port), PlaylistHandler).serve_forever()
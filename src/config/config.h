@@ -20,7 +20,20 @@
 
 // System Configuration
 #define SERIAL_BAUD_RATE 9600
-#define WATCHDOG_TIMEOUT_SEC 30
+#define WATCHDOG_TIMEOUT_SEC 30          // During setup
+#define TASK_WATCHDOG_TIMEOUT_SEC 10     // Every task subscribes once running
+
+// Task Configuration - the audio task has its core to itself, all other tasks share SYSTEM_TASK_CORE
+#define AUDIO_TASK_CORE 1
+#define AUDIO_TASK_PRIORITY 5            // Above every other application task
+#define AUDIO_TASK_STACK_SIZE 10240      // Arduino's 8192 loop stack plus headroom for TLS in connecttohost
+#define AUDIO_TASK_YIELD_TICKS 1
+#define AUDIO_IDLE_MAX_SLEEP_MS 100      // Longest sleep with nothing playing; bounds health checks and volume saves
+#define SYSTEM_TASK_CORE 0
+#define CATALOG_TASK_PRIORITY 1
+#define CATALOG_TASK_STACK_SIZE 8192
+#define RECORDER_NET_TASK_PRIORITY 2     // Drops data when late, so ahead of the SD writer
+#define RECORDER_WRITE_TASK_PRIORITY 1
 #define WIFI_TIMEOUT_SEC 180
 
 // Audio Configuration
@@ -28,18 +41,103 @@
 #define MAX_VOLUME 100
 #define MIN_VOLUME 0
 #define VOLUME_STEP 1
+#define VOLUME_RANGE_DB 50              // 1% is this many dB below full scale, 0% is silence
+#define VOLUME_RAMP_MS 40               // Gain changes are spread over this long to avoid zipper noise
+#define VOLUME_PERSIST_DELAY_MS 5000    // Volume is saved to NVS once it has been stable this long
+#define AUDIO_LIBRARY_UNITY_VOLUME 21   // Audio library volume at which its own gain is unity
+#define I2S_DMA_BUFFER_COUNT 16         // DMA ring of the audio library's I2S driver
+#define I2S_DMA_BUFFER_FRAMES 512       // Frames per DMA buffer, ~186 ms in total at 44.1 kHz
+#define I2S_GLITCH_HISTORY 16           // Recent underruns kept for /metrics
 
 // Web Server Configuration
 #define WEB_SERVER_PORT 80
 #define WEB_FILES_PATH "/view"
+#define ROUTE_TABLE_SLOTS 256    // Perfect-hash slots for the control routes
+#define WEB_TASK_CORE SYSTEM_TASK_CORE
+#define WEB_TASK_PRIORITY 1
+#define WEB_TASK_STACK_SIZE 8192
+#define TEMPLATE_READ_CHUNK 512  // HTML pages are read and templated in pieces of this size
+#define JSON_RESPONSE_SIZE 384   // Stack buffer for ordinary JSON responses
+#define JSON_ECHO_MAX 48         // Request values echoed in a response, escaped up to 6 bytes each
+#define STATUS_JSON_SIZE 384     // Cached /status body
+#define EVENT_MAX_SUBSCRIBERS 6  // /events streams; each holds one of the 16 lwIP sockets
+#define EVENT_MIN_INTERVAL_MS 250     // Changes inside this window are coalesced into one event
+#define EVENT_HEARTBEAT_MS 15000
+#define EVENT_HEAP_DELTA 4096         // Heap change that is worth an event on its own
+
+// Media Transfer Configuration (previews, downloads)
+#define MEDIA_READ_CHUNK 8192           // SD reads per chunk, a multiple of the 512-byte sector
+#define MEDIA_DECODER_LOW_WATER 40      // Decoder buffer fill (%) below which transfers back off
+#define MEDIA_BACKOFF_MS 5
+#define MEDIA_MAX_BACKOFF_MS 200        // Longest a chunk waits for the decoder before reading anyway
+
+// Meme Soundboard Configuration
+#define MEME_HEAD_BYTES 8192              // Clip start kept in RAM, ~0.5 s at 128 kbps
+#define MEME_WHOLE_CLIP_MAX 32768         // Clips up to this size are kept in RAM entirely
+#define MEME_PRELOAD_BUDGET_PSRAM 1048576 // Total preload budget with PSRAM
+#define MEME_PRELOAD_BUDGET_RAM 49152     // Total preload budget in internal RAM
+#define MEME_DUCK_DB 12                   // Program attenuation while a meme plays over it
+#define MEME_DUCK_ATTACK_MS 30
+#define MEME_DUCK_RELEASE_MS 400
+#define MEME_OVERLAY_FRAMES 4608          // Decoded meme frames queued ahead of the mix (~100 ms)
+#define MEME_OVERLAY_FEED_BYTES 512       // MP3 bytes handed to the meme decoder at a time
+#define MEME_OVERLAY_MAX_FEEDS 4          // Feeds per loop iteration, bounds the time taken from audio.loop()
 
 // Music Configuration
 #define MUSIC_FOLDER "/music"
 
+// Logging Configuration
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 4          // Messages above this level are compiled out: 1 error, 2 warn, 3 info, 4 debug
+#endif
+#ifndef LOG_COMPILE_TAGS
+#define LOG_COMPILE_TAGS 0xFFFFFFFFu // Bit per LogTag; cleared bits are compiled out
+#endif
+#define LOG_DEFAULT_LEVEL 3          // Runtime level at boot, changed with /log/config
+#define LOG_RING_ENTRIES 64          // Messages queued for the log task (power of two)
+#define LOG_TEXT_SIZE 120            // Longer messages are truncated
+#define LOG_TAIL_ENTRIES 32          // Recent messages kept for /log
+#define LOG_TASK_PRIORITY 1
+#define LOG_TASK_STACK_SIZE 3072
+
 // Debug Configuration
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1   // 0 compiles the loop profiler out entirely (-DPROFILER_ENABLED=0)
+#endif
+#ifndef MEMORY_TAGGING_ENABLED
+#define MEMORY_TAGGING_ENABLED 0   // Set to 1 by platformio.ini together with the -Wl,--wrap=malloc family
+#endif
+#ifndef TRACER_ENABLED
+#define TRACER_ENABLED 1   // 0 compiles the event tracer out; when compiled in it still only records after /trace/start
+#endif
+#define TRACE_RING_EVENTS_PSRAM 16384   // 512 KB flight recorder in PSRAM (power of two)
+#define TRACE_RING_EVENTS_RAM 512       // Without PSRAM (power of two)
+#define TRACE_MAX_THREADS 8             // Tasks told apart in a trace; later ones share the last id
+#define TRACE_SEND_CHUNK 1024           // Trace download is streamed in pieces of this size
 #define DEBUG_INTERVAL_MS 30000
 #define HEALTH_CHECK_INTERVAL_MS 30000
 #define LOW_MEMORY_THRESHOLD 10000
+#define LOW_LARGEST_BLOCK_THRESHOLD 16384   // TLS handshakes and decoder buffers need blocks this large
+#define MEMORY_HISTORY_SAMPLES 20           // Health check samples kept for /memory and trend alerts
+#define MEMORY_TREND_MIN_SAMPLES 6          // Samples needed before trends are trusted
+#define MEMORY_ALERT_HORIZON_MIN 30         // Alert when a trend reaches its threshold within this many minutes
+#define MEMORY_TAG_TABLE_SIZE 512           // Live tagged allocations tracked (power of two)
+
+// Station Catalog Configuration
+#ifndef CATALOG_SOURCE_URL
+#define CATALOG_SOURCE_URL "https://kolown.net/api/ghostwhisper_playlist"  // Override with a local stand-in for tests
+#endif
+#define CATALOG_CACHE_PATH "/catalog.json"
+#define CATALOG_REFRESH_INTERVAL_MS 1800000   // Refresh every 30 minutes when online
+#define CATALOG_RETRY_INTERVAL_MS 60000       // Retry sooner after a failed refresh
+#define CATALOG_HTTP_TIMEOUT_MS 8000
+
+// Time-shift / Recording Configuration
+#define TIMESHIFT_FILE_PATH "/rec/timeshift.mp3"
+#define TIMESHIFT_RING_BYTES 32768       // RAM between the network reader and the SD writer
+#define TIMESHIFT_WRITE_BLOCK 16384      // SD writes are whole blocks, a multiple of the 512-byte sector
+#define TIMESHIFT_MAX_BYTES 67108864UL   // Recording window cap (~70 minutes at 128 kbps)
+#define TIMESHIFT_DEFAULT_BYTES_PER_SEC 16000  // 128 kbps until a real rate has been measured
 
 // Connection Configuration
 #define DEFAULT_CONNECTION_MODE OFFLINE  // ONLINE or OFFLINE
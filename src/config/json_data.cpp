@@ -1,14 +1,17 @@
 // Reads a section from data.json and returns its file list
 #include "json_data.h"
+#include "../managers/logger.h"
 #include <vector>
 #include <Arduino.h>
 #include <SD.h>
 
+static constexpr LogTag LOG_TAG = LOG_TAG_DATA;
+
 std::vector<String> getDataFilesFromJSON(const String& sectionName, const String& subsection) {
     std::vector<String> files;
     File dataFile = SD.open("/data.json");
     if (!dataFile) {
-        Serial.println("ERROR: Unable to open data.json");
+        LOG_E("Unable to open data.json");
         return files;
     }
     String jsonContent = "";
@@ -21,7 +24,7 @@ std::vector<String> getDataFilesFromJSON(const String& sectionName, const String
     String searchKey = "\"" + sectionName + "\"";
     int sectionStart = jsonContent.indexOf(searchKey);
     if (sectionStart == -1) {
-        Serial.println("Section '" + sectionName + "' not found in data.json");
+        LOG_W("Section '%s' not found in data.json", sectionName.c_str());
         return files;
     }
 
@@ -33,7 +36,7 @@ std::vector<String> getDataFilesFromJSON(const String& sectionName, const String
         String subsectionKey = "\"" + subsection + "\"";
         int subsectionStart = jsonContent.indexOf(subsectionKey, sectionStart);
         if (subsectionStart == -1) {
-            Serial.println("Subsection '" + subsection + "' not found in '" + sectionName + "'");
+            LOG_W("Subsection '%s' not found in '%s'", subsection.c_str(), sectionName.c_str());
             return files;
         }
         searchStart = subsectionStart;
@@ -43,21 +46,21 @@ std::vector<String> getDataFilesFromJSON(const String& sectionName, const String
     // Find the "files" array
     int filesKeyStart = jsonContent.indexOf("\"files\"", searchStart);
     if (filesKeyStart == -1) {
-        Serial.println("No 'files' array found for section: " + logSection);
+        LOG_W("No 'files' array found for section: %s", logSection.c_str());
         return files;
     }
     
     int filesArrayStart = jsonContent.indexOf('[', filesKeyStart);
     int filesArrayEnd = jsonContent.indexOf(']', filesArrayStart);
     if (filesArrayStart == -1 || filesArrayEnd == -1) {
-        Serial.println("Invalid 'files' array for section: " + logSection);
+        LOG_W("Invalid 'files' array for section: %s", logSection.c_str());
         return files;
     }
     
     // Parse the files array
     String filesStr = jsonContent.substring(filesArrayStart + 1, filesArrayEnd);
     int start = 0;
-    while (start < filesStr.length()) {
+    while (start < (int)filesStr.length()) {
         int quoteStart = filesStr.indexOf('"', start);
         if (quoteStart == -1) break;
         int quoteEnd = filesStr.indexOf('"', quoteStart + 1);
@@ -67,7 +70,7 @@ std::vector<String> getDataFilesFromJSON(const String& sectionName, const String
         start = quoteEnd + 1;
     }
     
-    Serial.println("Loaded " + String(files.size()) + " files from section '" + logSection + "'");
+    LOG_D("Loaded %zu files from section '%s'", files.size(), logSection.c_str());
     return files;
 }
 
@@ -97,7 +100,7 @@ std::vector<String> getAvailableSubsections(const String& sectionName) {
     int pos = braceStart + 1;
     int sectionEnd = -1;
     
-    while (pos < jsonContent.length() && braceCount > 0) {
+    while (pos < (int)jsonContent.length() && braceCount > 0) {
         if (jsonContent.charAt(pos) == '{') braceCount++;
         else if (jsonContent.charAt(pos) == '}') braceCount--;
         if (braceCount == 0) sectionEnd = pos;
@@ -110,7 +113,7 @@ std::vector<String> getAvailableSubsections(const String& sectionName) {
     String sectionContent = jsonContent.substring(braceStart, sectionEnd);
     int searchPos = 0;
     
-    while (searchPos < sectionContent.length()) {
+    while (searchPos < (int)sectionContent.length()) {
         int keyStart = sectionContent.indexOf('"', searchPos);
         if (keyStart == -1) break;
         int keyEnd = sectionContent.indexOf('"', keyStart + 1);
@@ -140,13 +143,13 @@ std::vector<String> getAvailableSubsections(const String& sectionName) {
 std::vector<String> getRandomSoundfontFiles() {
     std::vector<String> subsections = getAvailableSubsections("soundfont");
     if (subsections.empty()) {
-        Serial.println("No soundfont subsections found");
+        LOG_I("No soundfont subsections found");
         return std::vector<String>();
     }
     
     int randomIndex = random(0, subsections.size());
     String randomSubsection = subsections[randomIndex];
     
-    Serial.println("Randomly selected soundfont collection: " + randomSubsection);
+    LOG_I("Randomly selected soundfont collection: %s", randomSubsection.c_str());
     return getDataFilesFromJSON("soundfont", randomSubsection);
 }
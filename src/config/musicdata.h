@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <SD.h>
+#include "../managers/logger.h"
 
 static const char* MUSIC_NOTES[] = {
     "A0.mp3", "A1.mp3", "A2.mp3", "A3.mp3", "A4.mp3", "A5.mp3", "A6.mp3", "A7.mp3",
@@ -66,7 +67,7 @@ inline std::vector<String> getSoundfontFilesFromSD() {
 
     File baseDir = SD.open(baseFolder);
     if (!baseDir || !baseDir.isDirectory()) {
-        Serial.println("ERROR: Unable to open SD base folder: " + String(baseFolder));
+        LOG_AT(LOG_LEVEL_ERROR, LOG_TAG_DATA, "Unable to open SD base folder: %s", baseFolder);
         return sounds;
     }
 
@@ -83,7 +84,7 @@ inline std::vector<String> getSoundfontFilesFromSD() {
     baseDir.close();
 
     if (subfolders.empty()) {
-        Serial.println("ERROR: No subfolders found in " + String(baseFolder));
+        LOG_AT(LOG_LEVEL_ERROR, LOG_TAG_DATA, "No subfolders found in %s", baseFolder);
         return sounds;
     }
 
@@ -93,7 +94,7 @@ inline std::vector<String> getSoundfontFilesFromSD() {
 
     File dir = SD.open(selectedFolder.c_str());
     if (!dir || !dir.isDirectory()) {
-        Serial.println("ERROR: Unable to open SD folder: " + selectedFolder);
+        LOG_AT(LOG_LEVEL_ERROR, LOG_TAG_DATA, "Unable to open SD folder: %s", selectedFolder.c_str());
         return sounds;
     }
 
@@ -108,7 +109,7 @@ inline std::vector<String> getSoundfontFilesFromSD() {
     }
     dir.close();
 
-    Serial.println("Found " + String(sounds.size()) + " soundfont files in " + selectedFolder);
+    LOG_AT(LOG_LEVEL_INFO, LOG_TAG_DATA, "Found %zu soundfont files in %s", sounds.size(), selectedFolder.c_str());
     return sounds;
 }
 
@@ -0,0 +1,73 @@
+/**
+ * @file audio_gain.cpp
+ * @brief Fixed-point gain stage implementation
+ */
+
+#include "audio_gain.h"
+#include "../config/config.h"
+#include <math.h>
+
+int32_t volumeToGainQ15(int percent) {
+    // Built once; the audio path only ever does the lookup
+    static int32_t table[MAX_VOLUME + 1];
+    static bool built = false;
+    if (!built) {
+        table[0] = 0;
+        for (int i = 1; i <= MAX_VOLUME; i++) {
+            float db = VOLUME_RANGE_DB * ((float)i / MAX_VOLUME - 1.0f);
+            table[i] = (int32_t)lroundf(GAIN_UNITY_Q15 * powf(10.0f, db / 20.0f));
+        }
+        built = true;
+    }
+    if (percent <= 0) return 0;
+    if (percent >= MAX_VOLUME) return table[MAX_VOLUME];
+    return table[percent];
+}
+
+int32_t attenuationToGainQ15(float db) {
+    if (db <= 0.0f) return GAIN_UNITY_Q15;
+    return (int32_t)lroundf(GAIN_UNITY_Q15 * powf(10.0f, -db / 20.0f));
+}
+
+void GainRamp::setTarget(int32_t gainQ15, uint32_t rampFrames) {
+    target_ = gainQ15;
+    if (rampFrames == 0 || gainQ15 == current_) {
+        current_ = gainQ15;
+        remaining_ = 0;
+        step_ = 0;
+        return;
+    }
+    step_ = (gainQ15 - current_) / (int32_t)rampFrames;
+    if (step_ == 0) step_ = gainQ15 > current_ ? 1 : -1;
+    remaining_ = rampFrames;
+}
+
+void GainRamp::reset(int32_t gainQ15) {
+    current_ = target_ = gainQ15;
+    step_ = 0;
+    remaining_ = 0;
+}
+
+void GainRamp::process(int16_t* samples, size_t frames, int channels) {
+    size_t frame = 0;
+
+    // Ramp portion: gain changes every frame
+    for (; frame < frames && remaining_ > 0; frame++) {
+        current_ += step_;
+        if (--remaining_ == 0 || (step_ > 0 ? current_ >= target_ : current_ <= target_)) {
+            current_ = target_;
+            remaining_ = 0;
+        }
+        for (int c = 0; c < channels; c++) {
+            int16_t& sample = samples[frame * channels + c];
+            sample = (int16_t)((sample * current_) >> 15);
+        }
+    }
+
+    // Steady portion: constant gain, nothing to do at unity
+    if (frame == frames || current_ == GAIN_UNITY_Q15) return;
+    int32_t gain = current_;
+    for (size_t i = frame * channels; i < frames * channels; i++) {
+        samples[i] = (int16_t)((samples[i] * gain) >> 15);
+    }
+}
@@ -0,0 +1,58 @@
+/**
+ * @file audio_gain.h
+ * @brief Fixed-point gain stage with click-free ramps
+ * @details Gains are Q15 (32768 = unity) and never exceed unity, so a sample
+ *          times a gain always fits in 32 bits. Volume percentages map to gain
+ *          on a dB curve, which sounds even across the whole slider range.
+ *          Plain C++ so it can be exercised on the host.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define GAIN_UNITY_Q15 32768
+
+/**
+ * @brief Q15 gain for a volume percentage
+ * @details 0% is silence; 1..100% spans VOLUME_RANGE_DB up to 0 dB in equal dB steps.
+ */
+int32_t volumeToGainQ15(int percent);
+
+/**
+ * @brief Q15 gain for an attenuation in dB (0 or more; 0 dB is unity)
+ */
+int32_t attenuationToGainQ15(float db);
+
+class GainRamp {
+public:
+    GainRamp() : current_(GAIN_UNITY_Q15), target_(GAIN_UNITY_Q15), step_(0), remaining_(0) {}
+
+    /**
+     * @brief Move towards a new gain over the given number of frames
+     * @details A new target mid-ramp starts from wherever the ramp got to,
+     *          so bursts of volume clicks stay smooth.
+     */
+    void setTarget(int32_t gainQ15, uint32_t rampFrames);
+
+    /**
+     * @brief Jump to a gain without ramping (startup only)
+     */
+    void reset(int32_t gainQ15);
+
+    /**
+     * @brief Apply the gain in place to interleaved frames
+     */
+    void process(int16_t* samples, size_t frames, int channels);
+
+    int32_t current() const { return current_; }
+    int32_t target() const { return target_; }
+    bool ramping() const { return remaining_ > 0; }
+
+private:
+    int32_t current_;
+    int32_t target_;
+    int32_t step_;         // Q15 change per frame while ramping
+    uint32_t remaining_;   // Frames left in the ramp
+};
@@ -0,0 +1,127 @@
+/**
+ * @file audio_mixer.cpp
+ * @brief Overlay mixer implementation
+ */
+
+#include "audio_mixer.h"
+#include <string.h>
+
+static inline int16_t saturate(int32_t sample) {
+    if (sample > INT16_MAX) return INT16_MAX;
+    if (sample < INT16_MIN) return INT16_MIN;
+    return (int16_t)sample;
+}
+
+OverlayMixer::OverlayMixer()
+    : buffer_(nullptr), capacity_(0), writePos_(0), readPos_(0), queued_(0), dropped_(0),
+      duckGain_(GAIN_UNITY_Q15), attackFrames_(0), releaseFrames_(0), active_(false), finishing_(false),
+      outputRate_(44100), sourceRate_(0), step_(1 << 16), phase_(0), primed_(false), previous_{0, 0} {}
+
+void OverlayMixer::begin(int16_t* buffer, size_t capacityFrames) {
+    buffer_ = buffer;
+    capacity_ = buffer ? capacityFrames : 0;
+    writePos_ = readPos_ = queued_ = 0;
+}
+
+void OverlayMixer::setDucking(int32_t duckGainQ15, uint32_t attackFrames, uint32_t releaseFrames) {
+    duckGain_ = duckGainQ15;
+    attackFrames_ = attackFrames;
+    releaseFrames_ = releaseFrames;
+}
+
+void OverlayMixer::start() {
+    readPos_ = writePos_;
+    queued_ = 0;
+    sourceRate_ = 0;
+    primed_ = false;
+    active_ = capacity_ > 0;
+    finishing_ = false;
+    if (active_) ducking_.setTarget(duckGain_, attackFrames_);
+}
+
+void OverlayMixer::finish() {
+    finishing_ = true;
+}
+
+void OverlayMixer::stop() {
+    readPos_ = writePos_;
+    queued_ = 0;
+    if (active_) ducking_.setTarget(GAIN_UNITY_Q15, releaseFrames_);
+    active_ = false;
+    finishing_ = false;
+}
+
+inline void OverlayMixer::queueFrame(int16_t left, int16_t right) {
+    if (queued_ >= capacity_) {
+        dropped_++;
+        return;
+    }
+    int16_t* frame = buffer_ + writePos_ * 2;
+    frame[0] = left;
+    frame[1] = right;
+    if (++writePos_ == capacity_) writePos_ = 0;
+    queued_++;
+}
+
+size_t OverlayMixer::push(const int16_t* pcm, size_t frames, int channels, uint32_t sampleRate) {
+    if (!active_ || frames == 0) return 0;
+    size_t before = queued_;
+
+    if (sampleRate != sourceRate_) {
+        sourceRate_ = sampleRate;
+        step_ = (uint32_t)(((uint64_t)sampleRate << 16) / (outputRate_ ? outputRate_ : sampleRate));
+    }
+
+    for (size_t i = 0; i < frames; i++) {
+        int16_t left = pcm[i * channels];
+        int16_t right = channels > 1 ? pcm[i * channels + 1] : left;
+
+        if (step_ == (1 << 16)) {
+            queueFrame(left, right);  // Same rate, no interpolation
+            continue;
+        }
+        if (!primed_) {
+            previous_[0] = left;
+            previous_[1] = right;
+            primed_ = true;
+            phase_ = 0;
+            continue;
+        }
+
+        // Emit every output frame that falls between the previous input frame and this one
+        while (phase_ < (1 << 16)) {
+            int32_t fraction = phase_ >> 1;  // Q15, so the product fits in 32 bits
+            queueFrame((int16_t)(previous_[0] + (((left - previous_[0]) * fraction) >> 15)),
+                       (int16_t)(previous_[1] + (((right - previous_[1]) * fraction) >> 15)));
+            phase_ += step_;
+        }
+        phase_ -= 1 << 16;
+        previous_[0] = left;
+        previous_[1] = right;
+    }
+    return queued_ - before;
+}
+
+size_t OverlayMixer::mix(int16_t* program, size_t frames) {
+    // Ducking ramps keep running after the overlay ends, until the release is complete
+    ducking_.process(program, frames, 2);
+    if (!active_) return 0;
+
+    size_t count = queuedFrames();
+    if (count > frames) count = frames;
+
+    for (size_t i = 0; i < count; i++) {
+        const int16_t* overlay = buffer_ + readPos_ * 2;
+        program[i * 2] = saturate(program[i * 2] + overlay[0]);
+        program[i * 2 + 1] = saturate(program[i * 2 + 1] + overlay[1]);
+        if (++readPos_ == capacity_) readPos_ = 0;
+    }
+    queued_ -= count;
+
+    if (finishing_ && queuedFrames() == 0) {
+        active_ = false;
+        finishing_ = false;
+        ducking_.setTarget(GAIN_UNITY_Q15, releaseFrames_);
+    }
+    return count;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file audio_mixer.h
+ * @brief Overlay mixer: a second source over the ducked program
+ * @details The program is decoded by the audio library and arrives block by
+ *          block in the pipeline hook. The overlay (a meme) is decoded
+ *          separately, resampled to the program rate and queued here; mix()
+ *          ducks the program with an attack/release ramp and adds the overlay
+ *          with saturation. Single-threaded: push() and mix() both run on the
+ *          audio loop. Plain C++ so it can be benchmarked on the host.
+ */
+
+#pragma once
+
+#include "audio_gain.h"
+
+class OverlayMixer {
+public:
+    OverlayMixer();
+
+    /**
+     * @brief Use the given memory for queued overlay frames
+     * @param buffer Room for capacityFrames interleaved stereo frames, owned by the caller
+     */
+    void begin(int16_t* buffer, size_t capacityFrames);
+
+    /**
+     * @brief Program ducking while the overlay plays
+     * @param duckGainQ15 Program gain under the overlay
+     * @param attackFrames Ramp down when the overlay starts
+     * @param releaseFrames Ramp back up after it ends
+     */
+    void setDucking(int32_t duckGainQ15, uint32_t attackFrames, uint32_t releaseFrames);
+
+    /**
+     * @brief Sample rate of the program, which overlay frames are resampled to
+     */
+    void setOutputRate(uint32_t sampleRate) { outputRate_ = sampleRate; }
+
+    /**
+     * @brief Start a new overlay, dropping whatever is still queued, and duck the program
+     */
+    void start();
+
+    /**
+     * @brief Queue decoded overlay PCM
+     * @param pcm Interleaved samples, mono or stereo
+     * @param frames Frames in pcm
+     * @param channels 1 or 2
+     * @param sampleRate Rate of pcm
+     * @return Output frames queued; frames that do not fit are counted as dropped
+     */
+    size_t push(const int16_t* pcm, size_t frames, int channels, uint32_t sampleRate);
+
+    /**
+     * @brief No more overlay input: release the ducking once the queue has played out
+     */
+    void finish();
+
+    /**
+     * @brief End the overlay now and release the ducking
+     */
+    void stop();
+
+    /**
+     * @brief Duck a program block in place and add queued overlay frames
+     * @param program Interleaved stereo frames
+     * @param frames Frames in program
+     * @return Overlay frames mixed into this block
+     */
+    size_t mix(int16_t* program, size_t frames);
+
+    size_t queuedFrames() const { return queued_; }
+    size_t freeFrames() const { return capacity_ - queuedFrames(); }
+    bool active() const { return active_; }
+    bool ducked() const { return ducking_.current() != GAIN_UNITY_Q15 || ducking_.ramping(); }
+    uint32_t droppedFrames() const { return dropped_; }
+
+private:
+    void queueFrame(int16_t left, int16_t right);
+
+    int16_t* buffer_;
+    size_t capacity_;
+    size_t writePos_;      // Frame index of the next push
+    size_t readPos_;       // Frame index of the next mix
+    size_t queued_;
+    uint32_t dropped_;
+
+    GainRamp ducking_;
+    int32_t duckGain_;
+    uint32_t attackFrames_;
+    uint32_t releaseFrames_;
+    bool active_;
+    bool finishing_;
+
+    // Linear interpolation resampler, Q16 position between previous and next input frame
+    uint32_t outputRate_;
+    uint32_t sourceRate_;
+    uint32_t step_;
+    uint32_t phase_;
+    bool primed_;
+    int16_t previous_[2];
+};
@@ -0,0 +1,60 @@
+/**
+ * @file audio_pipeline.cpp
+ * @brief Decoded PCM processing hook
+ */
+
+#include "audio_pipeline.h"
+#include "hardware_setup.h"
+#include "volume_control.h"
+#include "i2s_health.h"
+#include "../managers/profiler.h"
+
+// Audio loop only, like the hook itself
+static OverlayMixer overlayMixer;
+static FirstSampleCallback firstSampleCallback = nullptr;
+static uint32_t firstSampleStart = 0;
+static bool firstSampleOverlay = false;
+static AudioPipelineStats pipelineStats = {};
+
+void armFirstSampleProbe(uint32_t startMicros, FirstSampleCallback callback, bool overlay) {
+    firstSampleStart = startMicros;
+    firstSampleOverlay = overlay;
+    firstSampleCallback = callback;
+}
+
+OverlayMixer& getOverlayMixer() {
+    return overlayMixer;
+}
+
+AudioPipelineStats getAudioPipelineStats() {
+    return pipelineStats;
+}
+
+/**
+ * @brief Audio library hook for every decoded block.
+ * @details Frames are interleaved stereo. Setting continueI2S lets the library
+ *          play the modified samples itself.
+ */
+void audio_process_extern(int16_t* buff, uint16_t len, bool* continueI2S) {
+    PROFILE_SCOPE(PROFILE_AUDIO_HOOK);
+    uint32_t started = micros();
+
+    size_t overlayFrames = overlayMixer.mix(buff, len);
+
+    if (firstSampleCallback && (!firstSampleOverlay || overlayFrames > 0)) {
+        FirstSampleCallback callback = firstSampleCallback;
+        firstSampleCallback = nullptr;
+        callback(started - firstSampleStart);
+    }
+
+    applyVolumeGain(buff, len);
+    *continueI2S = true;
+
+    uint32_t sampleRate = audio.getSampleRate();
+    recordI2sBlock(len, sampleRate);
+    uint32_t elapsed = micros() - started;
+    pipelineStats.blocks++;
+    pipelineStats.totalUs += elapsed;
+    pipelineStats.audioUs += (uint64_t)len * 1000000 / (sampleRate ? sampleRate : 44100);
+    if (elapsed > pipelineStats.maxBlockUs) pipelineStats.maxBlockUs = elapsed;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file audio_pipeline.h
+ * @brief Processing applied to decoded PCM before it reaches I2S
+ * @details Owns the audio library's audio_process_extern() hook, which runs
+ *          inside audio.loop() on the audio loop for every decoded block.
+ *          Stages run in order: overlay mix (ducked program plus meme),
+ *          first-sample probe, then volume gain.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "audio_mixer.h"
+
+typedef void (*FirstSampleCallback)(uint32_t latencyUs);
+
+// Hook timing, to check the mix stays within the real-time budget.
+// Written by the audio loop; other tasks get a possibly torn copy, good enough for telemetry.
+struct AudioPipelineStats {
+    uint32_t blocks;
+    uint32_t maxBlockUs;       // Longest time spent in the hook for one block
+    uint64_t totalUs;          // Time spent in the hook
+    uint64_t audioUs;          // Playing time of the frames processed
+};
+
+/**
+ * @brief Time how long it takes until the next decoded samples appear (audio loop only)
+ * @param startMicros micros() timestamp the latency is measured from
+ * @param callback Called once, from the audio hook, with the latency in microseconds
+ * @param overlay Wait for the first overlay samples instead of any program samples
+ */
+void armFirstSampleProbe(uint32_t startMicros, FirstSampleCallback callback, bool overlay = false);
+
+/**
+ * @brief Mixer for the second source (audio loop only)
+ */
+OverlayMixer& getOverlayMixer();
+
+/**
+ * @brief Hook timing since boot
+ */
+AudioPipelineStats getAudioPipelineStats();
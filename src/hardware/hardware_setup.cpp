@@ -1,10 +1,13 @@
 #include "hardware_setup.h"
 #include "../config/config.h"
+#include "../managers/logger.h"
 #include <SPI.h>
 #include <SD.h>
 #include <esp_task_wdt.h>
 #include <esp_system.h>
 
+static constexpr LogTag LOG_TAG = LOG_TAG_SYSTEM;
+
 
 // Remove duplicate pin definitions - now in config.h
 Audio audio;
@@ -29,99 +32,100 @@ void initializeHardware() {
     while (!Serial) {
         ; // Wait for Serial to initialize
     }
+    initializeLogger();
 
     // Blink built-in LED to indicate startup
     blinkBuiltinLED(1, 200);
 
-    Serial.println("=== Hardware Initialization ===");
+    LOG_I("=== Hardware Initialization ===");
 
     // Initialize SD card with SPI pins
-    Serial.println("Initializing SD card...");
+    LOG_I("Initializing SD card...");
     delay(1000); // Longer delay for SD card to stabilize
     
     // Try multiple initialization attempts
     bool sdInitialized = false;
     for (int attempt = 1; attempt <= 3; attempt++) {
-        Serial.printf("SD init attempt %d/3...\n", attempt);
+        LOG_I("SD init attempt %d/3...", attempt);
         
         if (SD.begin(SD_CS)) {
             sdInitialized = true;
-            Serial.println("SD card initialization successful!");
+            LOG_I("SD card initialization successful!");
             blinkBuiltinLED(1, 200);
 
             // Check if data.json exists on SD card
             if (SD.exists("/data.json")) {
-                Serial.println("data.json found on SD card.");
+                LOG_I("data.json found on SD card.");
             } else {
-                Serial.println("data.json NOT found on SD card.");
+                LOG_W("data.json NOT found on SD card.");
             }
 
 
 
             break;
         } else {
-            Serial.printf("Attempt %d failed, retrying...\n", attempt);
+            LOG_W("Attempt %d failed, retrying...", attempt);
             delay(1000);
         }
     }
     
     if (!sdInitialized) {
-        Serial.println("SD card initialization failed after 3 attempts!");
-        Serial.println("Hardware troubleshooting:");
-        Serial.println("1. Check ALL connections:");
-        Serial.println("   CS   -> Pin 5");
-        Serial.println("   MOSI -> Pin 23");
-        Serial.println("   MISO -> Pin 19"); 
-        Serial.println("   SCK  -> Pin 18");
-        Serial.println("2. Power supply:");
-        Serial.println("   VCC -> 3.3V (NOT 5V!)");
-        Serial.println("   GND -> Ground");
-        Serial.println("3. SD card format: FAT32");
-        Serial.println("4. SD card size: ≤32GB");
-        Serial.println("Trying to format SD card...");
+        LOG_W("SD card initialization failed after 3 attempts!");
+        LOG_I("Hardware troubleshooting:");
+        LOG_I("1. Check ALL connections:");
+        LOG_I("   CS   -> Pin 5");
+        LOG_I("   MOSI -> Pin 23");
+        LOG_I("   MISO -> Pin 19"); 
+        LOG_I("   SCK  -> Pin 18");
+        LOG_I("2. Power supply:");
+        LOG_I("   VCC -> 3.3V (NOT 5V!)");
+        LOG_I("   GND -> Ground");
+        LOG_I("3. SD card format: FAT32");
+        LOG_I("4. SD card size: ≤32GB");
+        LOG_I("Trying to format SD card...");
         // Note: ESP32 SD library doesn't have format function
         // Card must be formatted on computer as FAT32
-        Serial.println("Continuing without SD card...");
+        LOG_I("Continuing without SD card...");
     } else {
         // Test SD card functionality
-        Serial.println("Testing SD card read/write...");
+        LOG_I("Testing SD card read/write...");
         File testFile = SD.open("/test.txt", FILE_WRITE);
         if (testFile) {
             testFile.println("GhostWhisper SD Test");
             testFile.close();
-            Serial.println("SD card test write successful.");
+            LOG_I("SD card test write successful.");
             
             // Try reading back
             testFile = SD.open("/test.txt");
             if (testFile) {
-                Serial.println("SD card test read successful:");
-                while (testFile.available()) {
-                    Serial.write(testFile.read());
-                }
+                char content[64];
+                size_t length = testFile.readBytes(content, sizeof(content) - 1);
+                content[length] = '\0';
+                LOG_I("SD card test read successful: %s", content);
                 testFile.close();
             }
         } else {
-            Serial.println("SD card write test failed - card may be read-only or corrupted.");
+            LOG_W("SD card write test failed - card may be read-only or corrupted.");
         }
     }
 
     // Initialize audio with I2S pinout
-    Serial.println("Initializing audio...");
+    LOG_I("Initializing audio...");
     audio.setPinout(I2S_BCLK, I2S_LRC, I2S_DOUT);
-    audio.setVolume(DEFAULT_VOLUME); // Set safer default volume
-    Serial.println("Audio initialized.");
+    audio.setVolume(AUDIO_LIBRARY_UNITY_VOLUME); // Volume is applied by the gain stage in volume_control
+    LOG_I("Audio initialized.");
 
     // Memory and stability improvements
-    Serial.println("=== System Information ===");
-    Serial.printf("Free heap: %d bytes\n", ESP.getFreeHeap());
-    Serial.printf("Total heap: %d bytes\n", ESP.getHeapSize());
-    Serial.printf("Free PSRAM: %d bytes\n", ESP.getFreePsram());
-    Serial.printf("CPU frequency: %d MHz\n", ESP.getCpuFreqMHz());
-    Serial.printf("Flash size: %d bytes\n", ESP.getFlashChipSize());
-    Serial.println("===========================");
+    LOG_I("=== System Information ===");
+    LOG_I("Free heap: %d bytes", ESP.getFreeHeap());
+    LOG_I("Total heap: %d bytes", ESP.getHeapSize());
+    LOG_I("Free PSRAM: %d bytes", ESP.getFreePsram());
+    LOG_I("CPU frequency: %d MHz", ESP.getCpuFreqMHz());
+    LOG_I("Flash size: %d bytes", ESP.getFlashChipSize());
+    LOG_I("===========================");
     
     // Enable watchdog timer for stability
     esp_task_wdt_init(WATCHDOG_TIMEOUT_SEC, true); // 30 second timeout
     esp_task_wdt_add(NULL); // Add current task to watchdog
-    Serial.println("Watchdog timer enabled (30s timeout)");
+    LOG_I("Watchdog timer enabled (30s timeout)");
 }
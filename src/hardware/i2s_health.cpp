@@ -0,0 +1,134 @@
+/**
+ * @file i2s_health.cpp
+ * @brief I2S output health implementation
+ */
+
+#include "i2s_health.h"
+#include "hardware_setup.h"
+#include "../config/config.h"
+#include "../managers/logger.h"
+#include "../managers/tracer.h"
+
+static constexpr LogTag LOG_TAG = LOG_TAG_AUDIO;
+
+static const uint32_t CAPACITY_FRAMES = I2S_DMA_BUFFER_COUNT * I2S_DMA_BUFFER_FRAMES;
+
+// Fill model, audio loop only
+static bool primed = false;         // A block went out since playback (re)started
+static int32_t fillFrames = 0;
+static uint32_t lastUpdateUs = 0;
+static uint32_t outputRate = 44100;
+static uint32_t remainderUs = 0;    // Elapsed time not yet worth a whole frame
+
+static I2sHealthStats healthStats = {0, 0, 0, CAPACITY_FRAMES, 0, CAPACITY_FRAMES, 0};
+static I2sGlitch glitches[I2S_GLITCH_HISTORY];
+static uint32_t glitchCount = 0;
+static I2sGlitch* openGlitch = nullptr;
+static uint32_t openGlitchUs = 0;
+
+static uint8_t readInputFill() {
+    uint32_t filled = audio.inBufferFilled();
+    uint32_t size = filled + audio.inBufferFree();
+    return size > 0 ? (uint8_t)((uint64_t)filled * 100 / size) : 0;
+}
+
+/**
+ * @brief Drain the model up to now and open a glitch if it ran dry.
+ */
+static void drainTo(uint32_t nowUs) {
+    uint32_t previousUs = lastUpdateUs;
+    uint64_t elapsedUs = (uint64_t)(nowUs - previousUs) + remainderUs;
+    uint64_t drained = elapsedUs * outputRate / 1000000;
+    remainderUs = elapsedUs - drained * 1000000 / outputRate;
+    lastUpdateUs = nowUs;
+
+    int32_t before = fillFrames;
+    fillFrames = (int32_t)max((int64_t)before - (int64_t)drained, (int64_t)0);
+    if (fillFrames > 0 || openGlitch) return;
+
+    // Back-date the glitch to when the last queued frame went out
+    uint32_t dryUs = previousUs + (uint32_t)((uint64_t)max(before, (int32_t)0) * 1000000 / outputRate);
+    uint32_t agoUs = nowUs - dryUs;
+
+    I2sGlitch& glitch = glitches[glitchCount++ % I2S_GLITCH_HISTORY];
+    glitch.timeMs = millis() - agoUs / 1000;
+#if PROFILER_ENABLED
+    glitch.stage = getLoopStageAt(esp_cpu_get_cycle_count() - agoUs * getCpuFrequencyMhz());
+#else
+    glitch.stage = PROFILE_STAGE_COUNT;
+#endif
+    glitch.inputFill = readInputFill();
+    glitch.gapUs = 0;
+    openGlitch = &glitch;
+    openGlitchUs = dryUs;
+
+    healthStats.underruns++;
+    healthStats.lastUnderrunMs = glitch.timeMs;
+    TRACE_VALUE(TRACE_AUDIO, "underrun", glitch.inputFill);
+}
+
+void recordI2sBlock(uint16_t frames, uint32_t sampleRate) {
+    uint32_t now = micros();
+    if (sampleRate) outputRate = sampleRate;
+
+    if (!primed) {
+        // Start of playback: the ring is empty by design, not underrunning
+        primed = true;
+        fillFrames = 0;
+        remainderUs = 0;
+        lastUpdateUs = now;
+    } else {
+        drainTo(now);
+        uint32_t fill = fillFrames > 0 ? fillFrames : 0;
+        if (fill < healthStats.minFillFrames) healthStats.minFillFrames = fill;
+    }
+
+    if (openGlitch) {
+        openGlitch->gapUs = max(now - openGlitchUs, (uint32_t)1);
+        healthStats.silentUs += openGlitch->gapUs;
+        LOG_W("I2S underrun: %lu us silent during %s, input %u%% full",
+              (unsigned long)openGlitch->gapUs, getProfileStageName(openGlitch->stage), openGlitch->inputFill);
+        openGlitch = nullptr;
+    }
+
+    fillFrames = min(fillFrames + (int32_t)frames, (int32_t)CAPACITY_FRAMES);
+    healthStats.fillFrames = fillFrames;
+    healthStats.blocks++;
+}
+
+void restartI2sHealthModel() {
+    primed = false;
+    openGlitch = nullptr;
+}
+
+void checkI2sHealth(bool playing) {
+    if (!playing) {
+        // Stopped, paused or between tracks: the ring may drain, and the next block starts over
+        primed = false;
+        openGlitch = nullptr;
+        healthStats.fillFrames = 0;
+        return;
+    }
+    if (primed) drainTo(micros());
+}
+
+I2sHealthStats getI2sHealthStats() {
+    return healthStats;
+}
+
+size_t getI2sGlitches(I2sGlitch* out, size_t maxGlitches) {
+    size_t count = min((size_t)min(glitchCount, (uint32_t)I2S_GLITCH_HISTORY), maxGlitches);
+    for (size_t i = 0; i < count; i++) {
+        out[i] = glitches[(glitchCount - 1 - i) % I2S_GLITCH_HISTORY];
+    }
+    return count;
+}
+
+void resetI2sHealth() {
+    healthStats.underruns = 0;
+    healthStats.silentUs = 0;
+    healthStats.lastUnderrunMs = 0;
+    healthStats.minFillFrames = CAPACITY_FRAMES;
+    healthStats.blocks = 0;
+    glitchCount = 0;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file i2s_health.h
+ * @brief I2S output underrun detection and DMA buffer health
+ * @details The audio library owns the I2S driver and exposes neither its DMA
+ *          fill level nor underrun events, so the fill is modelled: every block
+ *          leaving the audio hook adds its frames, capped at the DMA ring size,
+ *          and the ring drains at the sample rate. When the model runs dry while
+ *          a track is playing, the output underran. Each underrun is recorded
+ *          with its estimated start time, the audio loop stage running at that
+ *          moment and the decoder input fill, to tell CPU stalls (full input)
+ *          from starved streams or slow SD reads (empty input).
+ *
+ *          Updated on the audio loop only. Other tasks get a possibly torn
+ *          copy, good enough for telemetry.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "../managers/profiler.h"
+
+struct I2sGlitch {
+    uint32_t timeMs;       // millis() when the DMA ring ran dry (estimated)
+    uint32_t gapUs;        // Silence until the next block, 0 while still silent
+    ProfileStage stage;    // Audio loop stage running at that moment, PROFILE_STAGE_COUNT if unknown
+    uint8_t inputFill;     // Decoder input buffer fill in percent
+};
+
+struct I2sHealthStats {
+    uint32_t underruns;
+    uint64_t silentUs;         // Total underrun time
+    uint32_t lastUnderrunMs;   // 0 if none yet
+    uint32_t capacityFrames;   // DMA ring size
+    uint32_t fillFrames;       // Estimated fill after the last block
+    uint32_t minFillFrames;    // Lowest fill seen just before a block while playing
+    uint32_t blocks;
+};
+
+/**
+ * @brief Account for a block the audio hook hands to I2S (audio loop only)
+ * @param frames Stereo frames in the block
+ * @param sampleRate Output sample rate
+ */
+void recordI2sBlock(uint16_t frames, uint32_t sampleRate);
+
+/**
+ * @brief Detect underruns that are still going on, once per loop (audio loop only)
+ * @param playing Whether a track or stream is playing; stopping or pausing
+ *                drains the ring without counting as an underrun
+ */
+void checkI2sHealth(bool playing);
+
+/**
+ * @brief Start the model over for a new track or stream (audio loop only)
+ * @details The gap while the decoder reads the next file's header is a track
+ *          change, not an underrun.
+ */
+void restartI2sHealthModel();
+
+I2sHealthStats getI2sHealthStats();
+
+/**
+ * @brief Copy the most recent underruns, newest first
+ * @return Number of glitches copied
+ */
+size_t getI2sGlitches(I2sGlitch* glitches, size_t maxGlitches);
+
+/**
+ * @brief Clear the counters, the minimum fill and the glitch history
+ */
+void resetI2sHealth();
@@ -6,12 +6,39 @@
 #include "volume_control.h"
 #include "../config/config.h"
 #include "hardware_setup.h"
+#include "audio_gain.h"
+#include "../managers/logger.h"
+#include <Preferences.h>
+#include <atomic>
 
-static int currentVolume = DEFAULT_VOLUME;
-static bool isPaused = false;
+static constexpr LogTag LOG_TAG = LOG_TAG_AUDIO;
+
+// Target volume is written by any task; the audio loop turns it into a gain ramp.
+// Bursts of clicks only move the target, so they coalesce into one ramp.
+static std::atomic<int> currentVolume{DEFAULT_VOLUME};
+static int appliedVolume = -1;
+
+// Audio loop only: the ramp runs inside audio.loop() via the audio pipeline
+static GainRamp volumeRamp;
+
+// Debounced NVS persistence (web task only); stored volume is read elsewhere for diagnostics
+static Preferences volumePrefs;
+static std::atomic<int> storedVolume{-1};
+static int settlingVolume = -1;
+static uint32_t volumeChangedAt = 0;
+
+void applyVolumeGain(int16_t* samples, uint16_t frames) {
+    volumeRamp.process(samples, frames, 2);
+}
+
+static uint32_t rampFrames() {
+    uint32_t sampleRate = audio.getSampleRate();
+    if (sampleRate == 0) sampleRate = 44100;
+    return sampleRate * VOLUME_RAMP_MS / 1000;
+}
 
 int getCurrentVolume() {
-    return currentVolume;
+    return currentVolume.load(std::memory_order_relaxed);
 }
 
 bool setVolume(int volume) {
@@ -19,96 +46,107 @@ bool setVolume(int volume) {
         return false;
     }
     
-    currentVolume = volume;
-    audio.setVolume(currentVolume);
-    Serial.println("Volume set to: " + String(currentVolume) + "%");
+    currentVolume.store(volume, std::memory_order_relaxed);
     return true;
 }
 
+/**
+ * @brief Atomically move the target volume by delta, clamped to the valid range.
+ */
+static int stepVolume(int delta) {
+    int volume = currentVolume.load(std::memory_order_relaxed);
+    int next;
+    do {
+        next = constrain(volume + delta, MIN_VOLUME, MAX_VOLUME);
+    } while (!currentVolume.compare_exchange_weak(volume, next, std::memory_order_relaxed));
+    return next;
+}
+
 int increaseVolume() {
-    if (currentVolume < MAX_VOLUME) {
-        currentVolume += VOLUME_STEP;
-        if (currentVolume > MAX_VOLUME) currentVolume = MAX_VOLUME;
-        
-        Serial.println("Volume UP - Setting to: " + String(currentVolume) + "%");
-        audio.setVolume(currentVolume);
-        delay(100);
-    } else {
-        Serial.println("Volume UP - Already at maximum (" + String(MAX_VOLUME) + "%)");
+    if (getCurrentVolume() < MAX_VOLUME) {
+        return stepVolume(VOLUME_STEP);
     }
-    return currentVolume;
+    return MAX_VOLUME;
 }
 
 int decreaseVolume() {
-    if (currentVolume > MIN_VOLUME) {
-        currentVolume -= VOLUME_STEP;
-        if (currentVolume < MIN_VOLUME) currentVolume = MIN_VOLUME;
-        
-        Serial.println("Volume DOWN - Setting to: " + String(currentVolume) + "%");
-        audio.setVolume(currentVolume);
-        delay(100);
-    } else {
-        Serial.println("Volume DOWN - Already at minimum (" + String(MIN_VOLUME) + "%)");
+    if (getCurrentVolume() > MIN_VOLUME) {
+        return stepVolume(-VOLUME_STEP);
+    }
+    return MIN_VOLUME;
+}
+
+void serviceVolumeControl() {
+    int target = getCurrentVolume();
+    if (target != appliedVolume) {
+        volumeRamp.setTarget(volumeToGainQ15(target), rampFrames());
+        appliedVolume = target;
+    }
+}
+
+void serviceVolumePersistence() {
+    int stored = storedVolume.load(std::memory_order_relaxed);
+    if (stored < 0) return;
+
+    int target = getCurrentVolume();
+    if (target != settlingVolume) {
+        settlingVolume = target;
+        volumeChangedAt = millis();
+    }
+
+    // Flash writes stall both cores, so only save once the slider has come to rest
+    if (settlingVolume != stored && millis() - volumeChangedAt >= VOLUME_PERSIST_DELAY_MS) {
+        volumePrefs.putUChar("volume", settlingVolume);
+        storedVolume.store(settlingVolume, std::memory_order_relaxed);
+        LOG_D("Volume saved: %d%%", settlingVolume);
     }
-    return currentVolume;
 }
 
 void syncVolumeWithAudio() {
-    audio.setVolume(currentVolume);
-    Serial.println("Volume sync: Setting audio volume to " + String(currentVolume) + "%");
+    // The library stays at unity; all volume changes happen in the gain ramp
+    audio.setVolume(AUDIO_LIBRARY_UNITY_VOLUME);
+    appliedVolume = getCurrentVolume();
+    volumeRamp.setTarget(volumeToGainQ15(appliedVolume), rampFrames());
+    LOG_D("Volume sync: gain set for %d%%", appliedVolume);
 }
 
 void testVolumeControl() {
-    Serial.println("=== AUDIO VOLUME DIAGNOSTIC TEST ===");
-    
-    // Test if audio object exists and is responsive
-    Serial.println("Testing audio library responsiveness...");
+    LOG_I("=== AUDIO VOLUME DIAGNOSTIC TEST ===");
     
-    // Check current state
     bool audioIsRunning = audio.isRunning();
-    Serial.println("Audio status: " + String(audioIsRunning ? "RUNNING" : "STOPPED"));
-    
+    LOG_I("Audio status: %s", audioIsRunning ? "RUNNING" : "STOPPED");
     if (!audioIsRunning) {
-        Serial.println("WARNING: Audio is not running. Volume control effectiveness may be limited.");
-        Serial.println("For full testing, start audio playback first.");
+        LOG_I("Audio is not running. The gain ramp only advances during playback.");
     }
     
-    // Store current volume
-    int originalVolume = currentVolume;
-    Serial.println("Original volume setting: " + String(originalVolume) + "%");
+    LOG_I("Target volume: %d%%, saved: %d%%", getCurrentVolume(), storedVolume.load(std::memory_order_relaxed));
+    LOG_I("Gain: current %ld, target %ld (Q15, unity %d)%s",
+          (long)volumeRamp.current(), (long)volumeRamp.target(), GAIN_UNITY_Q15,
+          volumeRamp.ramping() ? ", ramping" : "");
     
-    // Test extreme volume changes to see if any change is detectable
-    Serial.println("Testing extreme volume changes:");
-    
-    Serial.println("Setting volume to 0% (mute)...");
-    audio.setVolume(0);
-    delay(100);
-    
-    Serial.println("Setting volume to 100% (maximum)...");
-    audio.setVolume(100);
-    delay(100);
-    
-    Serial.println("Setting volume to 50% (moderate)...");
-    audio.setVolume(50);
-    delay(100);
-    
-    // Restore original volume
-    Serial.println("Restoring original volume: " + String(originalVolume) + "%");
-    audio.setVolume(originalVolume);
-    currentVolume = originalVolume;
-    
-    Serial.println("=== DIAGNOSIS COMPLETE ===");
-    Serial.println("If you heard volume changes during this test, software volume control is working.");
-    Serial.println("If no volume changes were heard:");
-    Serial.println("1. Check I2S DAC hardware connections");
-    Serial.println("2. Verify I2S DAC supports software volume control");
-    Serial.println("3. Check if audio stream needs to be restarted for volume changes");
-    Serial.println("4. Consider using external volume control hardware");
-    Serial.println("============================");
+    // The curve is even in dB: every 10% step is VOLUME_RANGE_DB / 10 dB
+    LOG_I("Volume curve:");
+    for (int volume = 0; volume <= MAX_VOLUME; volume += 10) {
+        int32_t gain = volumeToGainQ15(volume);
+        if (gain > 0) {
+            LOG_I("  %3d%% -> %6ld (%.1f dB)", volume, (long)gain, 20.0f * log10f((float)gain / GAIN_UNITY_Q15));
+        } else {
+            LOG_I("  %3d%% -> %6ld (mute)", volume, (long)gain);
+        }
+    }
+    LOG_I("============================");
 }
 
 void initializeVolumeControl() {
-    currentVolume = DEFAULT_VOLUME;
-    audio.setVolume(currentVolume);
-    Serial.println("Volume control initialized to: " + String(currentVolume) + "%");
+    volumePrefs.begin("ghostwhisper", false);
+    int volume = volumePrefs.getUChar("volume", DEFAULT_VOLUME);
+    if (volume < MIN_VOLUME || volume > MAX_VOLUME) volume = DEFAULT_VOLUME;
+    storedVolume.store(volume);
+    settlingVolume = volume;
+
+    currentVolume.store(volume);
+    appliedVolume = volume;
+    volumeRamp.reset(volumeToGainQ15(volume));
+    audio.setVolume(AUDIO_LIBRARY_UNITY_VOLUME);
+    LOG_I("Volume control initialized to: %d%%", volume);
 }
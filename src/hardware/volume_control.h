@@ -33,6 +33,25 @@ int increaseVolume();
  */
 int decreaseVolume();
 
+/**
+ * @brief Start a gain ramp towards the target volume
+ * @details Called from the audio loop; the setters above only publish a target
+ *          and return immediately
+ */
+void serviceVolumeControl();
+
+/**
+ * @brief Save the target volume to NVS once it has been stable for VOLUME_PERSIST_DELAY_MS
+ * @details Called from the web task, so flash writes never run on the audio task
+ */
+void serviceVolumePersistence();
+
+/**
+ * @brief Scale decoded interleaved stereo PCM by the current volume gain
+ * @details Called from the audio pipeline hook (audio loop)
+ */
+void applyVolumeGain(int16_t* samples, uint16_t frames);
+
 /**
  * @brief Synchronize volume with audio library
  */
@@ -4,10 +4,23 @@
 #include "managers/connection_manager.h"
 #include "managers/radio_manager.h"
 #include "managers/debug_manager.h"
+#include "managers/catalog_manager.h"
+#include "managers/audio_commands.h"
+#include "managers/state_snapshot.h"
+#include "managers/program_events.h"
+#include "managers/meme_overlay.h"
+#include "managers/profiler.h"
+#include "managers/tracer.h"
+#include "hardware/volume_control.h"
+#include "hardware/i2s_health.h"
 #include "web/control.h"
+#include "managers/logger.h"
 #include <esp_task_wdt.h>
 #include <esp_random.h>
 
+static constexpr LogTag LOG_TAG = LOG_TAG_SYSTEM;
+
+static void audioTask(void* parameter);
 
 void setup() {
     // Configure watchdog with longer timeout for setup
@@ -22,6 +35,9 @@ void setup() {
     
     initializeConnection(OFFLINE);  // Change to OFFLINE for no WiFi
 
+    // Load the cached station catalog before the web server can serve it
+    initializeCatalog();
+
     // Reset watchdog before web init
     esp_task_wdt_reset();
 
@@ -29,36 +45,75 @@ void setup() {
     // In OFFLINE mode, it creates local AP for web access
     initializeWebControl();
     
-    // Reset watchdog before stream data fetch
-    esp_task_wdt_reset();
-    
-    // Stream data initialization removed for now
-    
     // Reset watchdog before program init
     esp_task_wdt_reset();
 
     // Set default program mode to generative (ambient music playback)
     setProgramMode(GENERATIVE_PROGRAM, "");
+    publishStateSnapshot();
     
     // Reconfigure watchdog for normal operation (shorter timeout)
-    esp_task_wdt_init(10, true); // 10 second timeout during normal operation
-    esp_task_wdt_add(NULL);
-    
-    Serial.println("Setup complete, starting program in loop...");
+    esp_task_wdt_init(TASK_WATCHDOG_TIMEOUT_SEC, true);
+
+    // From here on the audio task owns `audio` and the program managers
+    xTaskCreatePinnedToCore(audioTask, "audio", AUDIO_TASK_STACK_SIZE, NULL,
+                            AUDIO_TASK_PRIORITY, NULL, AUDIO_TASK_CORE);
+
+    LOG_I("Setup complete, audio task started on core %d", AUDIO_TASK_CORE);
 }
 
 void loop() {
-    // Reset watchdog timer
-    esp_task_wdt_reset();
-    
+    // Everything runs in tasks - the Arduino loop task is done after setup()
+    esp_task_wdt_delete(NULL);
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief One pass over audio and program work (audio task only).
+ */
+static void runAudioIteration() {
+    PROFILE_SCOPE(PROFILE_LOOP);
+    TRACE_SCOPE(TRACE_LOOP, "loop");
+
     // CRITICAL: Audio processing must be first and frequent
-    audio.loop();
+    {
+        PROFILE_SCOPE(PROFILE_AUDIO_LOOP);
+        TRACE_SCOPE(TRACE_AUDIO, "audio.loop");
+        bool wasRunning = audio.isRunning();
+        audio.loop();
+        bool running = audio.isRunning();
+        checkI2sHealth(running);
+        // Only the decoder itself stops inside audio.loop() - stops and pauses by commands happen elsewhere
+        if (wasRunning && !running) notePlaybackEnded();
+    }
     
-    // Handle web server requests for both ONLINE and OFFLINE modes
-    handleWebControl();
+    // Apply commands queued by the web server task
+    {
+        PROFILE_SCOPE(PROFILE_AUDIO_COMMANDS);
+        processAudioCommands();
+    }
+    {
+        PROFILE_SCOPE(PROFILE_VOLUME_CONTROL);
+        serviceVolumeControl();
+    }
     
-    // Handle program playback (new system)
-    handleProgramPlayback();
+    // Hand pending events to the program state machine
+    {
+        PROFILE_SCOPE(PROFILE_PROGRAM_PLAYBACK);
+        handleProgramPlayback();
+    }
+
+    // After the program, so a gap it leaves in the decoder is seen as one
+    {
+        PROFILE_SCOPE(PROFILE_MEME_OVERLAY);
+        serviceMemeOverlay();
+    }
+    
+    // Let the web task see the state this iteration left behind
+    {
+        PROFILE_SCOPE(PROFILE_STATE_SNAPSHOT);
+        publishStateSnapshot();
+    }
     
     // Reduced frequency debug and health checks
     static unsigned long lastDebugTime = 0;
@@ -69,3 +124,27 @@ void loop() {
     }
 }
 
+/**
+ * @brief High-priority task that owns `audio`, the decoder and the program managers.
+ * @details Pinned to AUDIO_TASK_CORE, which nothing else is pinned to. Other
+ *          tasks reach it through the audio command queue and read its state
+ *          from the published snapshot.
+ */
+static void audioTask(void* parameter) {
+    esp_task_wdt_add(NULL);
+    for (;;) {
+        esp_task_wdt_reset();
+        runAudioIteration();
+
+        // Nothing to decode: sleep until a command or the program timer, capped for the periodic checks
+        uint32_t idleMs = audio.isRunning() ? 0 : min(getProgramIdleMs(), (uint32_t)AUDIO_IDLE_MAX_SLEEP_MS);
+        if (idleMs == 0) {
+            // Lets the idle task on this core run; one tick per pass is far more than a decoded frame needs
+            vTaskDelay(AUDIO_TASK_YIELD_TICKS);
+            continue;
+        }
+        uint32_t start = millis();
+        waitForAudioCommand(idleMs);
+        noteProgramIdleSleep(millis() - start);
+    }
+}
@@ -0,0 +1,144 @@
+/**
+ * @file audio_commands.cpp
+ * @brief Lock-free command hand-off from other tasks to the audio task.
+ */
+
+#include "audio_commands.h"
+#include "mpsc_queue.h"
+#include "radio_manager.h"
+#include "shuffle_manager.h"
+#include "meme_manager.h"
+#include "meme_overlay.h"
+#include "timeshift_manager.h"
+#include "../hardware/hardware_setup.h"
+#include "../hardware/volume_control.h"
+#include "logger.h"
+#include <atomic>
+
+static constexpr LogTag LOG_TAG = LOG_TAG_AUDIO;
+
+// Producers: web task and background tasks. Consumer: audio task.
+static MpscQueue<AudioCommand, AUDIO_COMMAND_QUEUE_DEPTH> audioCommandQueue;
+// Set by the audio task the first time it waits, so producers can wake it
+static std::atomic<TaskHandle_t> consumerTask{nullptr};
+
+/**
+ * @brief Wake the audio task if it is sleeping in waitForAudioCommand().
+ */
+static void wakeConsumer() {
+    TaskHandle_t task = consumerTask.load(std::memory_order_acquire);
+    if (task) xTaskNotifyGive(task);
+}
+
+bool enqueueAudioCommand(AudioCommandType type, int32_t arg, const String& text) {
+    if (text.length() >= AUDIO_COMMAND_TEXT_LEN) {
+        LOG_W("Command text too long (%zu bytes), rejected", text.length());
+        return false;
+    }
+
+    AudioCommand command;
+    command.type = type;
+    command.arg = arg;
+    command.queuedAt = micros();
+    strlcpy(command.text, text.c_str(), sizeof(command.text));
+
+    if (!audioCommandQueue.push(command)) {
+        LOG_W("Audio command queue full, command dropped");
+        return false;
+    }
+    wakeConsumer();
+    return true;
+}
+
+bool enqueueAudioCommands(const AudioCommand* commands, size_t count) {
+    if (!audioCommandQueue.pushAll(commands, count)) {
+        LOG_W("Audio command queue full, batch of %zu dropped", count);
+        return false;
+    }
+    wakeConsumer();
+    return true;
+}
+
+/**
+ * @brief Run one command against the audio engine and the program managers.
+ */
+static void executeAudioCommand(const AudioCommand& command) {
+    String text = command.text;
+
+    switch (command.type) {
+        case CMD_SET_PROGRAM:
+            setProgramMode((RadioProgram)command.arg, text);
+            break;
+        case CMD_PLAY_RANDOM:
+            playRandomFile(text);
+            break;
+        case CMD_STOP:
+            stopMemeOverlay();
+            audio.stopSong();
+            stopPlayback();
+            break;
+        case CMD_PAUSE:
+            // A meme would go on over silence, taking the paused track off the decoder
+            stopMemeOverlay();
+            if (audio.isRunning()) audio.pauseResume();
+            break;
+        case CMD_RESUME:
+            audio.pauseResume();
+            break;
+        case CMD_SHUFFLE_NEXT:
+        case CMD_SHUFFLE_FOLDER:
+        case CMD_REGENERATE:
+        case CMD_STREAM_CONNECT:
+        case CMD_STREAM_RESET:
+            // Program commands are events for the active program's state machine
+            deliverProgramCommand(command);
+            break;
+        case CMD_PLAY_MEME:
+            playMeme(command.arg, command.queuedAt);
+            break;
+        case CMD_RECORD_START:
+            startRecording();
+            break;
+        case CMD_RECORD_STOP:
+            stopRecording();
+            break;
+        case CMD_TIMESHIFT_PAUSE:
+            pauseTimeshift();
+            break;
+        case CMD_TIMESHIFT_RESUME:
+            resumeTimeshift();
+            break;
+        case CMD_TIMESHIFT_SEEK:
+            seekTimeshift(command.arg);
+            break;
+        case CMD_TIMESHIFT_LIVE:
+            goLive();
+            break;
+        case CMD_VOLUME_TEST:
+            testVolumeControl();
+            break;
+        case CMD_SET_VOLUME:
+            setVolume(command.arg);
+            break;
+    }
+}
+
+void processAudioCommands() {
+    AudioCommand command;
+    while (audioCommandQueue.pop(command)) {
+        executeAudioCommand(command);
+    }
+}
+
+size_t getPendingAudioCommands() {
+    return audioCommandQueue.size();
+}
+
+bool waitForAudioCommand(uint32_t timeoutMs) {
+    if (!consumerTask.load(std::memory_order_relaxed)) {
+        consumerTask.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+    }
+    // A command queued before the handle was visible is caught here
+    if (audioCommandQueue.size() > 0) return true;
+    return ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs)) > 0;
+}
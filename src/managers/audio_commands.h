@@ -0,0 +1,77 @@
+/**
+ * @file audio_commands.h
+ * @brief Commands handed from other tasks to the audio task
+ * @details Web handlers and background tasks never call into the audio engine
+ *          directly. They enqueue a command, and the audio task that owns
+ *          `audio` executes it at a safe point.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+#define AUDIO_COMMAND_TEXT_LEN 192
+#define AUDIO_COMMAND_QUEUE_DEPTH 16
+
+// Commands understood by the audio task
+enum AudioCommandType : uint8_t {
+    CMD_SET_PROGRAM,        // arg = RadioProgram, text = folder or URL
+    CMD_PLAY_RANDOM,        // text = folder
+    CMD_STOP,
+    CMD_PAUSE,
+    CMD_RESUME,
+    CMD_SHUFFLE_NEXT,
+    CMD_SHUFFLE_FOLDER,     // text = folder
+    CMD_REGENERATE,
+    CMD_STREAM_CONNECT,     // text = URL
+    CMD_STREAM_RESET,
+    CMD_PLAY_MEME,          // arg = 1-based meme index
+    CMD_RECORD_START,
+    CMD_RECORD_STOP,
+    CMD_TIMESHIFT_PAUSE,
+    CMD_TIMESHIFT_RESUME,
+    CMD_TIMESHIFT_SEEK,     // arg = seconds from the start of the recording
+    CMD_TIMESHIFT_LIVE,
+    CMD_VOLUME_TEST,
+    CMD_SET_VOLUME          // arg = volume, ordered with the other commands of a batch
+};
+
+// A single queued command - fixed size so the queue never allocates
+struct AudioCommand {
+    AudioCommandType type;
+    int32_t arg;
+    uint32_t queuedAt;       // micros() when queued, for end-to-end latency measurements
+    char text[AUDIO_COMMAND_TEXT_LEN];
+};
+
+/**
+ * @brief Queue a command for the audio task (any task)
+ * @param type Command type
+ * @param arg Integer argument
+ * @param text Text argument, truncated to AUDIO_COMMAND_TEXT_LEN - 1
+ * @return false if the queue is full or the text does not fit
+ */
+bool enqueueAudioCommand(AudioCommandType type, int32_t arg = 0, const String& text = "");
+
+/**
+ * @brief Queue several commands as one unit (any task)
+ * @details The audio task sees all of them in the same drain, in order, or none.
+ * @return false if the queue cannot take all of them - nothing is queued
+ */
+bool enqueueAudioCommands(const AudioCommand* commands, size_t count);
+
+/**
+ * @brief Execute all queued commands (audio task only)
+ */
+void processAudioCommands();
+
+/**
+ * @brief Number of commands waiting for the audio task
+ */
+size_t getPendingAudioCommands();
+
+/**
+ * @brief Sleep until a command is queued or the timeout passes (audio task only)
+ * @return true if woken by a command
+ */
+bool waitForAudioCommand(uint32_t timeoutMs);
@@ -0,0 +1,437 @@
+/**
+ * @file catalog_manager.cpp
+ * @brief Station catalog cache, background refresh and local serving.
+ */
+
+#include "catalog_manager.h"
+#include "connection_manager.h"
+#include "memory_monitor.h"
+#include "../config/config.h"
+#include "logger.h"
+#include <SD.h>
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <WiFiClientSecure.h>
+#include <time.h>
+#include <atomic>
+#include <esp_task_wdt.h>
+
+static constexpr LogTag LOG_TAG = LOG_TAG_CATALOG;
+
+// Catalog state - guarded by catalogMutex, the web task only reads the serialized body
+struct CatalogState {
+    std::vector<StationEntry> stations;
+    uint32_t version;                 // Bumped every time the station list changes
+    uint32_t contentHash;             // FNV-1a of the station list, part of the ETag
+    unsigned long updatedAt;          // Epoch seconds of the last successful upstream fetch (0 = unknown)
+    unsigned long lastRefreshAttempt; // millis() of the last upstream attempt
+    bool lastRefreshOk;
+    bool loadedFromCache;
+};
+
+static CatalogState catalogState = {
+    .stations = std::vector<StationEntry>(),
+    .version = 0,
+    .contentHash = 0,
+    .updatedAt = 0,
+    .lastRefreshAttempt = 0,
+    .lastRefreshOk = false,
+    .loadedFromCache = false
+};
+
+static String catalogBody = "{\"version\":0,\"updated\":0,\"count\":0,\"stations\":{}}";
+static String catalogETag = "\"0-0\"";
+static SemaphoreHandle_t catalogMutex = NULL;
+static std::atomic<bool> refreshRequested{false};
+
+/**
+ * @brief FNV-1a hash over the station list, used to detect upstream changes.
+ */
+static uint32_t hashStations(const std::vector<StationEntry>& stations) {
+    uint32_t hash = 2166136261u;
+    for (const auto& station : stations) {
+        const String* fields[2] = { &station.name, &station.url };
+        for (const String* field : fields) {
+            for (size_t i = 0; i < field->length(); i++) {
+                hash ^= (uint8_t)field->charAt(i);
+                hash *= 16777619u;
+            }
+            hash ^= 0xFF; // Field separator so "ab"+"c" differs from "a"+"bc"
+            hash *= 16777619u;
+        }
+    }
+    return hash;
+}
+
+/**
+ * @brief Escape a string for inclusion in a JSON document.
+ */
+static String escapeJson(const String& value) {
+    String escaped;
+    escaped.reserve(value.length() + 8);
+    for (size_t i = 0; i < value.length(); i++) {
+        char c = value.charAt(i);
+        if (c == '"' || c == '\\') escaped += '\\';
+        if ((uint8_t)c < 0x20) continue; // Drop control characters
+        escaped += c;
+    }
+    return escaped;
+}
+
+/**
+ * @brief Read the four hex digits of a \u escape.
+ * @return The UTF-16 code unit, or -1 if the digits are malformed.
+ */
+static int readHex4(const String& json, int pos) {
+    if (pos + 4 > (int)json.length()) return -1;
+    int value = 0;
+    for (int i = pos; i < pos + 4; i++) {
+        char c = json.charAt(i);
+        int digit;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+        else return -1;
+        value = value * 16 + digit;
+    }
+    return value;
+}
+
+/**
+ * @brief Append a code point as UTF-8.
+ */
+static void appendUtf8(String& out, uint32_t codepoint) {
+    if (codepoint < 0x80) {
+        out += (char)codepoint;
+    } else if (codepoint < 0x800) {
+        out += (char)(0xC0 | (codepoint >> 6));
+        out += (char)(0x80 | (codepoint & 0x3F));
+    } else if (codepoint < 0x10000) {
+        out += (char)(0xE0 | (codepoint >> 12));
+        out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        out += (char)(0x80 | (codepoint & 0x3F));
+    } else {
+        out += (char)(0xF0 | (codepoint >> 18));
+        out += (char)(0x80 | ((codepoint >> 12) & 0x3F));
+        out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        out += (char)(0x80 | (codepoint & 0x3F));
+    }
+}
+
+/**
+ * @brief Read a JSON string literal starting at the opening quote.
+ * @details Escapes are decoded, \uXXXX (and surrogate pairs) to UTF-8. A
+ *          lone surrogate becomes U+FFFD and \u0000 is dropped.
+ * @return Index just past the closing quote, or -1 if unterminated or an escape is malformed.
+ */
+static int readJsonString(const String& json, int quoteStart, String& out) {
+    out = "";
+    int pos = quoteStart + 1;
+    while (pos < (int)json.length()) {
+        char c = json.charAt(pos);
+        if (c == '\\' && pos + 1 < (int)json.length()) {
+            char next = json.charAt(pos + 1);
+            pos += 2;
+            switch (next) {
+                case 'n': out += '\n'; break;
+                case 't': out += '\t'; break;
+                case 'r': out += '\r'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'u': {
+                    int unit = readHex4(json, pos);
+                    if (unit < 0) return -1;
+                    pos += 4;
+                    uint32_t codepoint = unit;
+                    // A high surrogate takes the low one from the escape that follows
+                    bool pairs = json.charAt(pos) == '\\' && json.charAt(pos + 1) == 'u';
+                    if (unit >= 0xD800 && unit <= 0xDBFF && pairs) {
+                        int low = readHex4(json, pos + 2);
+                        if (low >= 0xDC00 && low <= 0xDFFF) {
+                            codepoint = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                            pos += 6;
+                        }
+                    }
+                    if (codepoint >= 0xD800 && codepoint <= 0xDFFF) codepoint = 0xFFFD;
+                    if (codepoint != 0) appendUtf8(out, codepoint);
+                    break;
+                }
+                default: out += next; break;   // \" \\ and \/
+            }
+            continue;
+        }
+        if (c == '"') return pos + 1;
+        out += c;
+        pos++;
+    }
+    return -1;
+}
+
+/**
+ * @brief Parse a flat {"name":"url",...} object starting at the opening brace.
+ */
+static bool parseStationObject(const String& json, int braceStart, std::vector<StationEntry>& out) {
+    out.clear();
+    if (braceStart < 0 || json.charAt(braceStart) != '{') return false;
+
+    int pos = braceStart + 1;
+    while (pos < (int)json.length()) {
+        int keyStart = json.indexOf('"', pos);
+        int closing = json.indexOf('}', pos);
+        if (keyStart == -1 || (closing != -1 && closing < keyStart)) break;
+
+        StationEntry entry;
+        int keyEnd = readJsonString(json, keyStart, entry.name);
+        if (keyEnd == -1) return false;
+
+        int colon = json.indexOf(':', keyEnd);
+        int valueStart = json.indexOf('"', colon);
+        if (colon == -1 || valueStart == -1) return false;
+
+        int valueEnd = readJsonString(json, valueStart, entry.url);
+        if (valueEnd == -1) return false;
+
+        if (entry.name.length() > 0 && entry.url.length() > 0) {
+            out.push_back(entry);
+        }
+        pos = valueEnd;
+    }
+    return true;
+}
+
+/**
+ * @brief Serialize the catalog into the body served on /stream/list and stored on SD.
+ */
+static String serializeCatalog(const std::vector<StationEntry>& stations, uint32_t version, unsigned long updatedAt) {
+    String json;
+    json.reserve(64 + stations.size() * 96);
+    json += "{\"version\":" + String(version);
+    json += ",\"updated\":" + String(updatedAt);
+    json += ",\"count\":" + String(stations.size());
+    json += ",\"stations\":{";
+    for (size_t i = 0; i < stations.size(); i++) {
+        if (i > 0) json += ",";
+        json += "\"" + escapeJson(stations[i].name) + "\":\"" + escapeJson(stations[i].url) + "\"";
+    }
+    json += "}}";
+    return json;
+}
+
+/**
+ * @brief Swap in a new station list and its serialized body under the catalog lock.
+ */
+static void publishCatalog(const std::vector<StationEntry>& stations, uint32_t version,
+                           unsigned long updatedAt, const String& body) {
+    uint32_t hash = hashStations(stations);
+    String etag = "\"" + String(version) + "-" + String(hash, HEX) + "\"";
+
+    xSemaphoreTake(catalogMutex, portMAX_DELAY);
+    catalogState.stations = stations;
+    catalogState.version = version;
+    catalogState.contentHash = hash;
+    catalogState.updatedAt = updatedAt;
+    catalogBody = body;
+    catalogETag = etag;
+    xSemaphoreGive(catalogMutex);
+}
+
+/**
+ * @brief Persist the catalog body, writing to a temp file first so a power cut never leaves a torn cache.
+ */
+static bool saveCatalogToSD(const String& body) {
+    const char* tempPath = CATALOG_CACHE_PATH ".tmp";
+    File file = SD.open(tempPath, FILE_WRITE);
+    if (!file) {
+        LOG_E("Catalog: unable to open %s for writing", tempPath);
+        return false;
+    }
+    size_t written = file.print(body);
+    file.close();
+    if (written != body.length()) {
+        LOG_W("Catalog: short write to SD (%zu/%zu)", written, body.length());
+        SD.remove(tempPath);
+        return false;
+    }
+    SD.remove(CATALOG_CACHE_PATH);
+    return SD.rename(tempPath, CATALOG_CACHE_PATH);
+}
+
+/**
+ * @brief Load the cached catalog from SD.
+ */
+static bool loadCatalogFromSD() {
+    File file = SD.open(CATALOG_CACHE_PATH);
+    if (!file) {
+        LOG_I("Catalog: no cached catalog on SD");
+        return false;
+    }
+    String json = file.readString();
+    file.close();
+
+    int versionKey = json.indexOf("\"version\"");
+    int updatedKey = json.indexOf("\"updated\"");
+    int stationsKey = json.indexOf("\"stations\"");
+    if (versionKey == -1 || stationsKey == -1) {
+        LOG_I("Catalog: cached catalog is malformed, ignoring");
+        return false;
+    }
+
+    uint32_t version = json.substring(json.indexOf(':', versionKey) + 1).toInt();
+    unsigned long updatedAt = updatedKey == -1 ? 0 : json.substring(json.indexOf(':', updatedKey) + 1).toInt();
+
+    std::vector<StationEntry> stations;
+    if (!parseStationObject(json, json.indexOf('{', stationsKey), stations)) {
+        LOG_I("Catalog: cached station list is malformed, ignoring");
+        return false;
+    }
+
+    publishCatalog(stations, version, updatedAt, serializeCatalog(stations, version, updatedAt));
+    catalogState.loadedFromCache = true;
+    LOG_I("Catalog: loaded %zu stations from SD (version %u)", stations.size(), version);
+    return true;
+}
+
+/**
+ * @brief Fetch the raw playlist from the upstream API.
+ */
+static bool fetchUpstream(String& payload) {
+    String url = CATALOG_SOURCE_URL;
+    HTTPClient http;
+    WiFiClient plainClient;
+    WiFiClientSecure secureClient;
+
+    bool started;
+    if (url.startsWith("https://")) {
+        secureClient.setInsecure(); // Public playlist, no credentials involved
+        started = http.begin(secureClient, url);
+    } else {
+        started = http.begin(plainClient, url);
+    }
+    if (!started) {
+        LOG_W("Catalog: invalid upstream URL %s", url.c_str());
+        return false;
+    }
+
+    http.setTimeout(CATALOG_HTTP_TIMEOUT_MS);
+    int code = http.GET();
+    if (code != HTTP_CODE_OK) {
+        LOG_W("Catalog: upstream returned %d", code);
+        http.end();
+        return false;
+    }
+    payload = http.getString();
+    http.end();
+    return true;
+}
+
+bool refreshCatalogNow() {
+    MEMORY_TAG(MEM_TAG_CATALOG);
+    catalogState.lastRefreshAttempt = millis();
+    catalogState.lastRefreshOk = false;
+
+    String payload;
+    if (!fetchUpstream(payload)) {
+        return false;
+    }
+
+    std::vector<StationEntry> stations;
+    if (!parseStationObject(payload, payload.indexOf('{'), stations) || stations.empty()) {
+        LOG_I("Catalog: upstream payload has no stations, keeping cached catalog");
+        return false;
+    }
+    catalogState.lastRefreshOk = true;
+
+    time_t now = time(nullptr);
+    unsigned long updatedAt = now > 1600000000 ? (unsigned long)now : 0; // 0 until NTP has synced
+
+    if (hashStations(stations) == catalogState.contentHash && catalogState.version > 0) {
+        // Same stations - keep the version (and ETag) stable so clients stay cached
+        LOG_I("Catalog: upstream unchanged (%zu stations)", stations.size());
+        return true;
+    }
+
+    uint32_t version = catalogState.version + 1;
+    String body = serializeCatalog(stations, version, updatedAt);
+    publishCatalog(stations, version, updatedAt, body);
+
+    if (!saveCatalogToSD(body)) {
+        LOG_W("Catalog: failed to persist catalog to SD");
+    }
+    LOG_I("Catalog: refreshed %zu stations (version %u)", stations.size(), version);
+    return true;
+}
+
+void requestCatalogRefresh() {
+    refreshRequested = true;
+}
+
+/**
+ * @brief Low-priority background task that keeps the catalog fresh while ONLINE.
+ */
+static void catalogTask(void* parameter) {
+    esp_task_wdt_add(NULL);
+    for (;;) {
+        esp_task_wdt_reset();
+        bool online = getConnectionMode() == ONLINE && WiFi.status() == WL_CONNECTED;
+        unsigned long interval = catalogState.lastRefreshOk ? CATALOG_REFRESH_INTERVAL_MS : CATALOG_RETRY_INTERVAL_MS;
+        bool due = millis() - catalogState.lastRefreshAttempt >= interval;
+
+        if (online && (due || refreshRequested)) {
+            refreshRequested = false;
+            // Connect, TLS and read timeouts together can outlast the watchdog; they bound the fetch instead
+            esp_task_wdt_delete(NULL);
+            refreshCatalogNow();
+            esp_task_wdt_add(NULL);
+        }
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+}
+
+void initializeCatalog() {
+    MEMORY_TAG(MEM_TAG_CATALOG);
+    catalogMutex = xSemaphoreCreateMutex();
+
+    if (!loadCatalogFromSD()) {
+        LOG_I("Catalog: starting with an empty catalog");
+    }
+
+    if (getConnectionMode() == ONLINE) {
+        configTime(0, 0, "pool.ntp.org"); // Only used to timestamp the cache
+    }
+
+    // First pass of the task refreshes immediately when online
+    refreshRequested = true;
+    xTaskCreatePinnedToCore(catalogTask, "catalog", CATALOG_TASK_STACK_SIZE, NULL, CATALOG_TASK_PRIORITY, NULL,
+                            SYSTEM_TASK_CORE);
+}
+
+String getCatalogJson() {
+    xSemaphoreTake(catalogMutex, portMAX_DELAY);
+    String body = catalogBody;
+    xSemaphoreGive(catalogMutex);
+    return body;
+}
+
+String getCatalogETag() {
+    xSemaphoreTake(catalogMutex, portMAX_DELAY);
+    String etag = catalogETag;
+    xSemaphoreGive(catalogMutex);
+    return etag;
+}
+
+std::vector<String> getCatalogStationURLs() {
+    std::vector<String> urls;
+    xSemaphoreTake(catalogMutex, portMAX_DELAY);
+    for (const auto& station : catalogState.stations) {
+        urls.push_back(station.url);
+    }
+    xSemaphoreGive(catalogMutex);
+    return urls;
+}
+
+size_t getCatalogStationCount() {
+    xSemaphoreTake(catalogMutex, portMAX_DELAY);
+    size_t count = catalogState.stations.size();
+    xSemaphoreGive(catalogMutex);
+    return count;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file catalog_manager.h
+ * @brief Station catalog owned by the firmware
+ * @details Keeps the remote stream playlist cached on the SD card, refreshes it
+ *          in the background when ONLINE and serves it locally to the web UI.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include <vector>
+
+// A single catalog entry
+struct StationEntry {
+    String name;
+    String url;
+};
+
+/**
+ * @brief Load the cached catalog from SD and start the background refresh task
+ */
+void initializeCatalog();
+
+/**
+ * @brief Fetch the catalog from upstream and persist it if it changed
+ * @return true if the upstream responded with a valid station list
+ * @note Blocking - only call from the catalog task or during setup
+ */
+bool refreshCatalogNow();
+
+/**
+ * @brief Ask the background task to refresh at its next opportunity
+ */
+void requestCatalogRefresh();
+
+/**
+ * @brief Get the serialized catalog served on /stream/list
+ * @return JSON body with version, timestamp and stations
+ */
+String getCatalogJson();
+
+/**
+ * @brief Get the strong ETag for the current catalog body
+ * @return Quoted ETag value
+ */
+String getCatalogETag();
+
+/**
+ * @brief Get the URLs of all catalog stations in catalog order
+ * @return Vector of stream URLs
+ */
+std::vector<String> getCatalogStationURLs();
+
+/**
+ * @brief Get the number of stations in the catalog
+ */
+size_t getCatalogStationCount();
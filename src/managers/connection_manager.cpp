@@ -6,11 +6,14 @@
 #include "connection_manager.h"
 #include "../config/config.h"
 #include "secrets.h" // For WiFi credentials
+#include "logger.h"
 #include <WiFiManager.h>
 #include <WiFi.h>
 #include <ESPmDNS.h>
 #include <esp_task_wdt.h>
 
+static constexpr LogTag LOG_TAG = LOG_TAG_WIFI;
+
 // Global connection state
 ConnectionMode currentConnectionMode = DEFAULT_CONNECTION_MODE; // Use config default
 bool wifiConnected = false;
@@ -23,8 +26,7 @@ void initializeConnection(ConnectionMode mode) {
     
     // Give serial monitor time to connect and ensure Serial is ready
     delay(3000);
-    Serial.println(""); // Print blank line for clarity
-    Serial.println("==================================================");
+    LOG_I("==================================================");
     
     // Initialize status LED
     pinMode(STATUS_LED_PIN, OUTPUT);
@@ -33,18 +35,18 @@ void initializeConnection(ConnectionMode mode) {
     digitalWrite(STATUS_LED_PIN, LOW);
     
     if (mode == ONLINE) {
-        Serial.println("=== ONLINE MODE ===");
-        Serial.println("Connecting to existing WiFi network...");
+        LOG_I("=== ONLINE MODE ===");
+        LOG_I("Connecting to existing WiFi network...");
         
         // DISABLE WATCHDOG BEFORE WIFI OPERATIONS
-        Serial.println("Temporarily disabling watchdog for WiFi configuration...");
+        LOG_I("Temporarily disabling watchdog for WiFi configuration...");
         esp_task_wdt_delete(NULL);
         
         WiFiManager wifiManager;
         
         // Clear WiFi credentials if requested
         if (CLEAR_WIFI_ON_STARTUP) {
-            Serial.println("Clearing stored WiFi credentials...");
+            LOG_I("Clearing stored WiFi credentials...");
             wifiManager.resetSettings();
         }
         
@@ -53,38 +55,37 @@ void initializeConnection(ConnectionMode mode) {
         
         // Try to connect with saved credentials, or start config portal
         if (!wifiManager.autoConnect(WIFI_SSID_NAME, OFFLINE_AP_PASSWORD)) {
-            Serial.println("Failed to connect to existing WiFi.");
-            Serial.println("Starting WiFiManager configuration portal...");
-            Serial.println("Connect to: " + String(WIFI_SSID_NAME) + " (Password: " + String(OFFLINE_AP_PASSWORD) + ")");
-            Serial.println("Then open: http://ghostwhisper.local to configure WiFi");
+            LOG_W("Failed to connect to existing WiFi.");
+            LOG_I("Starting WiFiManager configuration portal...");
+            LOG_I("Connect to: %s (Password: %s)", WIFI_SSID_NAME, OFFLINE_AP_PASSWORD);
+            LOG_I("Then open: http://ghostwhisper.local to configure WiFi");
             
             wifiConnected = false;
             setConnectionStatusLED(false);
         } else {
-            Serial.println("WiFi connected successfully!");
-            Serial.print("IP address: ");
-            Serial.println(WiFi.localIP());
-            Serial.println("Access web interface at: http://" + WiFi.localIP().toString());
+            LOG_I("WiFi connected successfully!");
+            LOG_I("IP address: %s", WiFi.localIP().toString().c_str());
+            LOG_I("Access web interface at: http://%s", WiFi.localIP().toString().c_str());
             wifiConnected = true;
             setConnectionStatusLED(true);
             
             // Initialize mDNS
             if (MDNS.begin("ghostwhisper")) {
-                Serial.println("mDNS responder started");
+                LOG_I("mDNS responder started");
                 MDNS.addService("http", "tcp", 80);
-                Serial.println("Also accessible at: http://ghostwhisper.local");
+                LOG_I("Also accessible at: http://ghostwhisper.local");
             } else {
-                Serial.println("mDNS failed to start - use IP address only");
+                LOG_W("mDNS failed to start - use IP address only");
             }
         }
         
         // RE-ENABLE WATCHDOG AFTER WIFI OPERATIONS
-        Serial.println("Re-enabling watchdog timer...");
+        LOG_I("Re-enabling watchdog timer...");
         esp_task_wdt_init(10, true); // 10 second timeout for normal operation
         esp_task_wdt_add(NULL);
     } else {
-        Serial.println("=== OFFLINE MODE ===");
-        Serial.println("Creating secure WiFi Access Point...");
+        LOG_I("=== OFFLINE MODE ===");
+        LOG_I("Creating secure WiFi Access Point...");
         
         // Create Access Point
         WiFi.mode(WIFI_AP);
@@ -92,10 +93,10 @@ void initializeConnection(ConnectionMode mode) {
         delay(100);
         
         // Create secure Access Point
-        Serial.println("Attempting softAP with:");
-        Serial.println("  SSID length: " + String(strlen(WIFI_SSID_NAME)));
-        Serial.println("  Password length: " + String(strlen(OFFLINE_AP_PASSWORD)));
-        Serial.println("  Password: '" + String(OFFLINE_AP_PASSWORD) + "'");
+        LOG_I("Attempting softAP with:");
+        LOG_E("  SSID length: %zu", strlen(WIFI_SSID_NAME));
+        LOG_E("  Password length: %zu", strlen(OFFLINE_AP_PASSWORD));
+        LOG_E("  Password: '%s'", OFFLINE_AP_PASSWORD);
         
         bool apStarted = WiFi.softAP(WIFI_SSID_NAME, OFFLINE_AP_PASSWORD, 1, 0, 4);
         
@@ -105,33 +106,33 @@ void initializeConnection(ConnectionMode mode) {
         }
         
         if (apStarted) {
-            Serial.println("Secure Access Point created: " + String(WIFI_SSID_NAME));
-            Serial.println("Password: " + String(OFFLINE_AP_PASSWORD));
-            Serial.println("IP: " + WiFi.softAPIP().toString());
-            Serial.println("Web interface: http://192.168.4.1");
+            LOG_I("Secure Access Point created: %s", WIFI_SSID_NAME);
+            LOG_I("Password: %s", OFFLINE_AP_PASSWORD);
+            LOG_I("IP: %s", WiFi.softAPIP().toString().c_str());
+            LOG_I("Web interface: http://192.168.4.1");
             
             // Initialize mDNS for Access Point mode
             WiFi.softAPsetHostname("ghostwhisper");
             delay(100);
             if (MDNS.begin("ghostwhisper")) {
-                Serial.println("mDNS responder started");
+                LOG_I("mDNS responder started");
                 MDNS.addService("http", "tcp", 80);
-                Serial.println("Also accessible at: http://ghostwhisper.local");
+                LOG_I("Also accessible at: http://ghostwhisper.local");
             } else {
-                Serial.println("mDNS failed - use IP address only");
+                LOG_W("mDNS failed - use IP address only");
             }
             
             wifiConnected = true;
             setConnectionStatusLED(true);
         } else {
-            Serial.println("Failed to create Access Point");
+            LOG_W("Failed to create Access Point");
             wifiConnected = false;
             setConnectionStatusLED(false);
         }
     }
     
-    Serial.println("==================================================");
-    Serial.println("Connection initialization complete.");
+    LOG_I("==================================================");
+    LOG_I("Connection initialization complete.");
 }
 
 /**
@@ -180,10 +181,10 @@ void turnOffAllLEDs() {
  * @brief Reset WiFi settings and force configuration portal
  */
 void resetWiFiSettings() {
-    Serial.println("=== RESETTING WIFI SETTINGS ===");
+    LOG_I("=== RESETTING WIFI SETTINGS ===");
     WiFiManager wifiManager;
     wifiManager.resetSettings();
-    Serial.println("WiFi credentials cleared. Restarting...");
+    LOG_I("WiFi credentials cleared. Restarting...");
     delay(1000);
     ESP.restart();
 }
@@ -192,10 +193,10 @@ void resetWiFiSettings() {
  * @brief Start WiFiManager configuration portal on demand
  */
 void startWiFiConfigPortal() {
-    Serial.println("=== STARTING WIFI CONFIG PORTAL ===");
+    LOG_I("=== STARTING WIFI CONFIG PORTAL ===");
     
     // Disable watchdog during config portal
-    Serial.println("Disabling watchdog for config portal...");
+    LOG_I("Disabling watchdog for config portal...");
     esp_task_wdt_delete(NULL);
     
     WiFiManager wifiManager;
@@ -205,28 +206,27 @@ void startWiFiConfigPortal() {
     
     // Start configuration portal
     if (wifiManager.startConfigPortal(WIFI_SSID_NAME, OFFLINE_AP_PASSWORD)) {
-        Serial.println("WiFi configured successfully via config portal!");
-        Serial.print("New IP address: ");
-        Serial.println(WiFi.localIP());
+        LOG_I("WiFi configured successfully via config portal!");
+        LOG_I("New IP address: %s", WiFi.localIP().toString().c_str());
         wifiConnected = true;
         setConnectionStatusLED(true);
         
         // Initialize mDNS after successful configuration
         if (MDNS.begin("ghostwhisper")) {
-            Serial.println("mDNS responder started");
-            Serial.println("Device accessible at: http://ghostwhisper.local");
+            LOG_I("mDNS responder started");
+            LOG_I("Device accessible at: http://ghostwhisper.local");
         } else {
-            Serial.println("Error setting up mDNS responder!");
+            LOG_I("Error setting up mDNS responder!");
         }
     } else {
-        Serial.println("Config portal timed out or failed");
+        LOG_W("Config portal timed out or failed");
         wifiConnected = false;
         setConnectionStatusLED(false);
     }
     
     // Re-enable watchdog
-    Serial.println("Re-enabling watchdog timer...");
-    esp_task_wdt_init(10, true);
+    LOG_I("Re-enabling watchdog timer...");
+    esp_task_wdt_init(TASK_WATCHDOG_TIMEOUT_SEC, true);
     esp_task_wdt_add(NULL);
 }
 
@@ -234,9 +234,9 @@ void startWiFiConfigPortal() {
  * @brief Clear WiFi credentials stored on the ESP32
  */
 void clearWiFiCredentials() {
-    Serial.println("=== CLEARING WIFI CREDENTIALS ===");
+    LOG_I("=== CLEARING WIFI CREDENTIALS ===");
     WiFi.disconnect(true, true); // Erase WiFi credentials
     delay(1000);
-    Serial.println("WiFi credentials cleared. Restarting...");
+    LOG_I("WiFi credentials cleared. Restarting...");
     ESP.restart();
 }
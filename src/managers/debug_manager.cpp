@@ -1,36 +1,27 @@
 #include "debug_manager.h"
+#include "memory_monitor.h"
 #include "../config/config.h"
+#include "logger.h"
+
+static constexpr LogTag LOG_TAG = LOG_TAG_SYSTEM;
 
 void logAudioStatus() {
     // Add audio status debugging - reduced frequency
-    static unsigned long lastDebugTime = 0;
+    static uint32_t lastDebugTime = 0;
     if (millis() - lastDebugTime > DEBUG_INTERVAL_MS) {
-        Serial.println("Audio status - Current time: " + String(millis()));
+        LOG_D("Audio status - Current time: %lu", (unsigned long)millis());
         lastDebugTime = millis();
     }
 }
 
 /**
- * @brief Monitor system memory and log warnings if low.
+ * @brief Sample heap and fragmentation; warnings come from the trend and threshold alerts.
  */
 void monitorSystemHealth() {
     static unsigned long lastHealthCheck = 0;
-    static size_t minHeapSeen = SIZE_MAX;
     
     if (millis() - lastHealthCheck > HEALTH_CHECK_INTERVAL_MS) {
-        size_t freeHeap = ESP.getFreeHeap();
-        
-        if (freeHeap < minHeapSeen) {
-            minHeapSeen = freeHeap;
-        }
-        
-        Serial.printf("Health Check - Free heap: %d bytes (min seen: %d)\n", freeHeap, minHeapSeen);
-        
-        // Warn if memory is getting low
-        if (freeHeap < LOW_MEMORY_THRESHOLD) {
-            Serial.println("WARNING: Low memory detected!");
-        }
-        
+        sampleMemory();
         lastHealthCheck = millis();
     }
 }
@@ -4,14 +4,20 @@
  */
 
 #include "generative_manager.h"
+#include "state_snapshot.h"
 #include "../hardware/hardware_setup.h"
 #include "../config/musicdata.h"
 #include <SD.h>
 #include "../config/json_data.h"
+#include "logger.h"
+#include "tracer.h"
+
+static constexpr LogTag LOG_TAG = LOG_TAG_GENERATIVE;
 
 // Generative state with sequence management
 static GenerativeState generativeState = {
     .generativeActive = false,
+    .phase = GENERATIVE_IDLE,
     .lastNoteTime = 0,
     .nextNoteDelay = 2000
 };
@@ -19,7 +25,6 @@ static GenerativeState generativeState = {
 // Sequence management
 static std::vector<String> currentSequence;
 static size_t currentSequenceIndex = 0;
-static bool playingFieldSound = false;
 
 GenerativeState& getGenerativeState() {
     return generativeState;
@@ -30,17 +35,18 @@ GenerativeState& getGenerativeState() {
  * @brief Encapsulate note playback logic
  */
 bool playNote(const String& soundFile) {
-    Serial.println("Attempting to play file: " + soundFile);
+    LOG_D("Attempting to play file: %s", soundFile.c_str());
     if (!SD.exists(soundFile)) {
-        Serial.println("ERROR: File does not exist on SD card: " + soundFile);
+        LOG_E("File does not exist on SD card: %s", soundFile.c_str());
         return false;
     }
     
-    // Serial.println("Playing generative note: " + soundFile);
+    TRACE_SCOPE_DETAIL(TRACE_PROGRAM, "note", soundFile.c_str());
     if (audio.connecttoFS(SD, soundFile.c_str())) {
+        noteTrackStarted(soundFile.c_str());
         return true;
     } else {
-        Serial.println("Failed to play: " + soundFile);
+        LOG_W("Failed to play: %s", soundFile.c_str());
         return false;
     }
 }
@@ -48,137 +54,158 @@ bool playNote(const String& soundFile) {
 /**
  * @brief Encapsulate timing logic
  */
-void setNextNoteDelay(bool success) {
+static void setNextNoteDelay(bool success) {
     if (success) {
         // Random delay between 1-5 seconds for next note
         generativeState.nextNoteDelay = random(5000, 50000);
-        Serial.println("Next note in " + String(generativeState.nextNoteDelay / 1000) + " seconds");
+        LOG_D("Next note in %lu seconds", generativeState.nextNoteDelay / 1000);
     } else {
         // Try again sooner if failed
         generativeState.nextNoteDelay = 500;
     }
     generativeState.lastNoteTime = millis();
+    scheduleProgramTimer(generativeState.nextNoteDelay);
 }
 
 /**
  * @brief Encapsulate error handling
  */
-void handleNoFilesError() {
-    Serial.println("No soundfont files found. Retrying in 5 seconds.");
+static void handleNoFilesError() {
+    LOG_I("No soundfont files found. Retrying in 5 seconds.");
+    generativeState.phase = GENERATIVE_WAITING;
     generativeState.lastNoteTime = millis();
     generativeState.nextNoteDelay = 5000;
+    scheduleProgramTimer(generativeState.nextNoteDelay);
 }
 
 /**
- * @brief Handles GENERATIVE program logic.
+ * @brief Build a new harmonious sequence from the soundfont files.
  */
-void handleGenerativeProgram() {
-    if (generativeState.generativeActive &&
-        (millis() - generativeState.lastNoteTime >= generativeState.nextNoteDelay || !audio.isRunning())) {
+static void generateSequence(const std::vector<String>& soundfontFiles) {
+    currentSequence.clear();
+    currentSequenceIndex = 0;
+    LOG_I("Generating harmonious sequence with %zu available files", soundfontFiles.size());
+    
+    // Start with a random root note as the foundation of our harmony
+    int rootNote = random(0, soundfontFiles.size());
+    
+    for (int i = 0; i < 120; ++i) {
+        int noteIndex;
+        
+        // Create simple harmonic progression using musical intervals
+        int progressionStep = i % 8; // Create an 8-note repeating pattern
+        switch (progressionStep) {
+            case 0: case 4: 
+                noteIndex = rootNote; // Root note - foundation of the chord
+                break;                    
+            case 1: case 5: 
+                noteIndex = (rootNote + 4) % soundfontFiles.size(); // Major 3rd - adds sweetness
+                break;  
+            case 2: case 6: 
+                noteIndex = (rootNote + 7) % soundfontFiles.size(); // Perfect 5th - strong harmonic
+                break;  
+            case 3: case 7: 
+                noteIndex = (rootNote + 2) % soundfontFiles.size(); // Major 2nd - adds movement
+                break;  
+            default: 
+                noteIndex = rootNote; // Fallback to root
+                break;
+        }
+        
+        currentSequence.push_back(soundfontFiles[noteIndex]);
+        LOG_D("  [%d] Harmonic index: %d (pattern step: %d)", i + 1, noteIndex, progressionStep);
+        
+        // Change key every 32 notes for musical variety and progression
+        if (i > 0 && i % 32 == 0) {
+            // Modulate to a nearby key (within 3 semitones up or down)
+            rootNote = (rootNote + random(-3, 4)) % soundfontFiles.size();
+            // Handle negative indices by wrapping around
+            if (rootNote < 0) rootNote += soundfontFiles.size();
+            LOG_D("  >>> Key change to root note: %d", rootNote);
+        }
+    }
+    LOG_I("Generated harmonious sequence of %zu notes", currentSequence.size());
+}
 
-        // If we're currently playing a field sound, wait for it to complete
-        if (playingFieldSound) {
-            if (!audio.isRunning()) {
-                // Field sound finished, reset state and prepare for new sequence
-                playingFieldSound = false;
-                currentSequence.clear();
-                currentSequenceIndex = 0;
-                Serial.println("Field sound completed, generating new sequence...");
-            } else {
-                // Field sound still playing, don't do anything
+/**
+ * @brief Start what comes next: a field sound after a finished sequence, otherwise the next note.
+ */
+static void startNextStep() {
+    // Check if we just finished a sequence and need to play a field sound
+    if (!currentSequence.empty() && currentSequenceIndex >= currentSequence.size()) {
+        // Play a random MP3 from the 'field' subsection
+        std::vector<String> fieldFiles = getDataFilesFromJSON("field");
+        if (!fieldFiles.empty()) {
+            String randomFieldFile = fieldFiles[random(0, fieldFiles.size())];
+            LOG_I("Playing random field sound: %s", randomFieldFile.c_str());
+            if (playNote("/field/" + randomFieldFile)) {
+                // Field sounds always play to the end, so no timer
+                generativeState.phase = GENERATIVE_FIELD;
+                generativeState.lastNoteTime = millis();
+                cancelProgramTimer();
                 return;
             }
+        } else {
+            LOG_I("No files found in 'field' section");
         }
+    }
 
-        // Check if we need to generate a new sequence
-        if (currentSequence.empty() || currentSequenceIndex >= currentSequence.size()) {
-            // Check if we just finished a sequence and need to play a field sound
-            if (currentSequenceIndex >= currentSequence.size() && !currentSequence.empty()) {
-                // Play a random MP3 from the 'field' subsection
-                std::vector<String> fieldFiles = getDataFilesFromJSON("field");
-                if (!fieldFiles.empty()) {
-                    String randomFieldFile = fieldFiles[random(0, fieldFiles.size())];
-                    Serial.println("Playing random field sound: " + randomFieldFile);
-                    bool fieldSuccess = playNote("/field/" + randomFieldFile);
-                    if (fieldSuccess) {
-                        playingFieldSound = true;
-                        setNextNoteDelay(true); // Set a proper delay
-                        return; // Exit and wait for field sound to complete
-                    }
-                } else {
-                    Serial.println("No files found in 'field' section");
-                }
-            }
-            
-            // Generate new sequence (only if not playing field sound)
-            if (!playingFieldSound) {
-                // Retrieve soundfont files from SD card (using cached version)
-                const std::vector<String>& soundfontFiles = getSoundfontFiles();
-                if (soundfontFiles.empty()) {
-                    handleNoFilesError();
-                    return;
-                }
-
-                // Generate a harmonious sequence instead of random notes
+    // Check if we need to generate a new sequence
+    if (currentSequence.empty() || currentSequenceIndex >= currentSequence.size()) {
+        // Retrieve soundfont files from SD card (using cached version)
+        const std::vector<String>& soundfontFiles = getSoundfontFiles();
+        if (soundfontFiles.empty()) {
+            handleNoFilesError();
+            return;
+        }
+        generateSequence(soundfontFiles);
+    }
+
+    // Play the current note in the sequence
+    String selectedSound = currentSequence[currentSequenceIndex];
+    LOG_D("Sequence [%zu/%zu]", currentSequenceIndex + 1, currentSequence.size());
+    bool success = playNote(selectedSound);
+    
+    // Move to next note in sequence
+    currentSequenceIndex++;
+
+    // A note plays until it ends or its time is up, whichever comes first
+    generativeState.phase = success ? GENERATIVE_NOTE : GENERATIVE_WAITING;
+    setNextNoteDelay(success);
+}
+
+/**
+ * @brief GENERATIVE state machine.
+ * @details WAITING and NOTE move on when the timer expires, NOTE also when the
+ *          note ends. FIELD only moves on when the field sound ends, and then
+ *          starts a new sequence.
+ */
+bool handleGenerativeEvent(const ProgramEvent& event) {
+    switch (event.type) {
+        case PROGRAM_EVENT_TRACK_ENDED:
+            if (generativeState.phase == GENERATIVE_FIELD) {
+                // Field sound finished, reset state and prepare for new sequence
                 currentSequence.clear();
                 currentSequenceIndex = 0;
-                Serial.println("Generating harmonious sequence with " + String(soundfontFiles.size()) + " available files:");
-                
-                // Start with a random root note as the foundation of our harmony
-                int rootNote = random(0, soundfontFiles.size());
-                
-                for (int i = 0; i < 120; ++i) {
-                    int noteIndex;
-                    
-                    // Create simple harmonic progression using musical intervals
-                    int progressionStep = i % 8; // Create an 8-note repeating pattern
-                    switch (progressionStep) {
-                        case 0: case 4: 
-                            noteIndex = rootNote; // Root note - foundation of the chord
-                            break;                    
-                        case 1: case 5: 
-                            noteIndex = (rootNote + 4) % soundfontFiles.size(); // Major 3rd - adds sweetness
-                            break;  
-                        case 2: case 6: 
-                            noteIndex = (rootNote + 7) % soundfontFiles.size(); // Perfect 5th - strong harmonic
-                            break;  
-                        case 3: case 7: 
-                            noteIndex = (rootNote + 2) % soundfontFiles.size(); // Major 2nd - adds movement
-                            break;  
-                        default: 
-                            noteIndex = rootNote; // Fallback to root
-                            break;
-                    }
-                    
-                    currentSequence.push_back(soundfontFiles[noteIndex]);
-                    Serial.println("  [" + String(i + 1) + "] Harmonic index: " + String(noteIndex) + 
-                                  " (pattern step: " + String(progressionStep) + ")");
-                    
-                    // Change key every 32 notes for musical variety and progression
-                    if (i > 0 && i % 32 == 0) {
-                        // Modulate to a nearby key (within 3 semitones up or down)
-                        rootNote = (rootNote + random(-3, 4)) % soundfontFiles.size();
-                        // Handle negative indices by wrapping around
-                        if (rootNote < 0) rootNote += soundfontFiles.size();
-                        Serial.println("  >>> Key change to root note: " + String(rootNote));
-                    }
-                }
-                Serial.println("Generated harmonious sequence of " + String(currentSequence.size()) + " notes");
+                LOG_I("Field sound completed, generating new sequence...");
+                startNextStep();
+            } else if (generativeState.phase == GENERATIVE_NOTE) {
+                startNextStep();
             }
-        }
-
-        // Play the current note in the sequence (only if not playing field sound)
-        if (!playingFieldSound && !currentSequence.empty() && currentSequenceIndex < currentSequence.size()) {
-            String selectedSound = currentSequence[currentSequenceIndex];
-            Serial.println("Sequence [" + String(currentSequenceIndex + 1) + "/" + String(currentSequence.size()) + "]");
-            bool success = playNote(selectedSound);
-            
-            // Move to next note in sequence
-            currentSequenceIndex++;
-
-            // Set the delay for the next note
-            setNextNoteDelay(success);
-        }
+            return true;
+        case PROGRAM_EVENT_TIMER:
+            if (generativeState.phase != GENERATIVE_FIELD) {
+                startNextStep();
+            }
+            return true;
+        case PROGRAM_EVENT_COMMAND:
+            if (event.command->type == CMD_REGENERATE) {
+                regenerateSequence();
+                return true;
+            }
+            return false;
+        default:
+            return false;
     }
 }
 
@@ -187,28 +214,44 @@ void handleGenerativeProgram() {
  */
 void playSequence() {
     generativeState.generativeActive = true;
+    generativeState.phase = GENERATIVE_WAITING;
     generativeState.lastNoteTime = 0;
-    generativeState.nextNoteDelay = 2000;
+    generativeState.nextNoteDelay = 0;
     
     // Load soundfont files to make sure they're available
     const std::vector<String>& soundfontFiles = getSoundfontFiles();
-    Serial.println("Generative program activated with " + String(soundfontFiles.size()) + " soundfont files");
+    LOG_I("Generative program activated with %zu soundfont files", soundfontFiles.size());
+
+    // First note on the next dispatch
+    scheduleProgramTimer(0);
+}
+
+void enterGenerativeProgram(const String& parameter) {
+    playSequence();
+}
+
+void exitGenerativeProgram() {
+    generativeState.generativeActive = false;
+    generativeState.phase = GENERATIVE_IDLE;
+    cancelProgramTimer();
 }
 
 /**
  * @brief Force regeneration of the current sequence.
- * @details Clears the current sequence and resets the index, forcing a new sequence to be generated on the next playback cycle.
+ * @details Clears the current sequence and resets the index, so a new sequence starts after a short delay.
  */
 void regenerateSequence() {
-    Serial.println("Forcing regeneration of generative sequence...");
+    LOG_I("Forcing regeneration of generative sequence...");
     
     // Clear the current sequence to force regeneration
     currentSequence.clear();
     currentSequenceIndex = 0;
     
-    // Reset timing to trigger immediate regeneration
-    generativeState.lastNoteTime = 0;
-    generativeState.nextNoteDelay = 500; // Short delay to start new sequence quickly
+    // Short delay to start new sequence quickly, cutting a playing note or field sound
+    generativeState.phase = GENERATIVE_WAITING;
+    generativeState.lastNoteTime = millis();
+    generativeState.nextNoteDelay = 500;
+    scheduleProgramTimer(generativeState.nextNoteDelay);
     
-    Serial.println("Sequence cleared - new harmonious sequence will be generated on next cycle");
+    LOG_I("Sequence cleared - new harmonious sequence will start shortly");
 }
@@ -1,15 +1,29 @@
 #pragma once
 
 #include "Arduino.h"
+#include "program_events.h"
 
 // Generative playback functions
-void handleGenerativeProgram();
 void playSequence();
 void regenerateSequence(); // Force regeneration of current sequence
 
+// GENERATIVE program hooks, called by radio_manager
+void enterGenerativeProgram(const String& parameter);
+void exitGenerativeProgram();
+bool handleGenerativeEvent(const ProgramEvent& event);
+
+// Where the program is between events
+enum GenerativePhase : uint8_t {
+    GENERATIVE_IDLE,        // Program not running
+    GENERATIVE_WAITING,     // Nothing playing, the timer starts the next note (first note, retry, no files)
+    GENERATIVE_NOTE,        // Sequence note playing until it ends or its delay is up
+    GENERATIVE_FIELD        // Field sound playing, always to its end
+};
+
 // Generative state management
 struct GenerativeState {
     bool generativeActive;
+    GenerativePhase phase;
     unsigned long lastNoteTime;
     unsigned long nextNoteDelay;
 };
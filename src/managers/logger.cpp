@@ -0,0 +1,189 @@
+/**
+ * @file logger.cpp
+ * @brief Asynchronous logger implementation
+ */
+
+#include "logger.h"
+#include <stdarg.h>
+#include <esp_task_wdt.h>
+
+static_assert((LOG_RING_ENTRIES & (LOG_RING_ENTRIES - 1)) == 0, "LOG_RING_ENTRIES must be a power of two");
+
+std::atomic<uint8_t> logRuntimeLevel{LOG_DEFAULT_LEVEL};
+std::atomic<uint32_t> logRuntimeTags{0xFFFFFFFFu};
+
+static const char* const LEVEL_NAMES[] = {"none", "error", "warn", "info", "debug"};
+static const char LEVEL_LETTERS[] = {'-', 'E', 'W', 'I', 'D'};
+static const char* const TAG_NAMES[LOG_TAG_COUNT] = {
+    "system", "audio", "web", "wifi", "program", "shuffle", "generative",
+    "stream", "catalog", "timeshift", "meme", "data", "memory"
+};
+
+// Bounded multi-producer ring: each slot's sequence says whether it is free
+// for the producer at that position or filled for the consumer. Sequences are
+// stored relative to the slot index, so the zero-initialized ring is ready
+// before any constructor runs.
+struct LogSlot {
+    std::atomic<uint32_t> sequence;
+    LogRecord record;
+};
+
+static LogSlot ring[LOG_RING_ENTRIES];
+static std::atomic<uint32_t> enqueuePos{0};
+static uint32_t dequeuePos = 0;  // Log task only
+
+static std::atomic<uint32_t> droppedCount{0};
+static std::atomic<uint32_t> truncatedCount{0};
+static uint32_t writtenCount = 0;
+
+// Recent messages for /log, written by the log task
+static SemaphoreHandle_t tailMutex = NULL;
+static LogRecord tail[LOG_TAIL_ENTRIES];
+static uint32_t lastId = 0;
+
+void logMessage(LogLevel level, LogTag tag, const char* format, ...) {
+    // Claim a slot; a full ring drops the message rather than blocking the caller
+    uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+    LogSlot* slot;
+    uint32_t index;
+    for (;;) {
+        index = pos & (LOG_RING_ENTRIES - 1);
+        slot = &ring[index];
+        int32_t diff = (int32_t)(slot->sequence.load(std::memory_order_acquire) + index - pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    LogRecord& record = slot->record;
+    record.timeMs = millis();
+    record.level = level;
+    record.tag = tag;
+
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(record.text, sizeof(record.text), format, args);
+    va_end(args);
+    if (length >= (int)sizeof(record.text)) {
+        truncatedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    slot->sequence.store(pos + 1 - index, std::memory_order_release);
+}
+
+static bool popRecord(LogRecord& record) {
+    uint32_t index = dequeuePos & (LOG_RING_ENTRIES - 1);
+    LogSlot& slot = ring[index];
+    if (slot.sequence.load(std::memory_order_acquire) + index != dequeuePos + 1) {
+        return false;
+    }
+    record = slot.record;
+    slot.sequence.store(dequeuePos + LOG_RING_ENTRIES - index, std::memory_order_release);
+    dequeuePos++;
+    return true;
+}
+
+/**
+ * @brief Low-priority task: drain the ring to Serial and the tail.
+ * @details Serial.write blocks while the UART catches up, which only ever
+ *          stalls this task; producers drop instead of waiting.
+ */
+static void logTask(void* parameter) {
+    LogRecord record;
+    char line[LOG_TEXT_SIZE + 32];
+    uint32_t reportedDrops = 0;
+    esp_task_wdt_add(NULL);
+    for (;;) {
+        while (popRecord(record)) {
+            // At 9600 baud a full ring takes seconds to drain
+            esp_task_wdt_reset();
+            int length = snprintf(line, sizeof(line), "%6lu.%03lu %c %s: %s\r\n",
+                                  (unsigned long)(record.timeMs / 1000), (unsigned long)(record.timeMs % 1000),
+                                  LEVEL_LETTERS[record.level], TAG_NAMES[record.tag], record.text);
+            Serial.write((const uint8_t*)line, min(length, (int)sizeof(line) - 1));
+            writtenCount++;
+
+            xSemaphoreTake(tailMutex, portMAX_DELAY);
+            record.id = ++lastId;
+            tail[record.id % LOG_TAIL_ENTRIES] = record;
+            xSemaphoreGive(tailMutex);
+        }
+
+        // Say so once per burst when messages were lost
+        uint32_t dropped = droppedCount.load(std::memory_order_relaxed);
+        if (dropped != reportedDrops) {
+            uint32_t now = millis();
+            int length = snprintf(line, sizeof(line), "%6lu.%03lu W system: %lu log messages dropped\r\n",
+                                  (unsigned long)(now / 1000), (unsigned long)(now % 1000),
+                                  (unsigned long)(dropped - reportedDrops));
+            Serial.write((const uint8_t*)line, length);
+            reportedDrops = dropped;
+        }
+        esp_task_wdt_reset();
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+void initializeLogger() {
+    if (tailMutex) return;
+    tailMutex = xSemaphoreCreateMutex();
+    xTaskCreatePinnedToCore(logTask, "log", LOG_TASK_STACK_SIZE, NULL, LOG_TASK_PRIORITY, NULL, SYSTEM_TASK_CORE);
+}
+
+size_t readLogTail(uint32_t since, LogRecord* records, size_t maxRecords) {
+    if (!tailMutex) return 0;
+
+    xSemaphoreTake(tailMutex, portMAX_DELAY);
+    uint32_t first = lastId > LOG_TAIL_ENTRIES ? lastId - LOG_TAIL_ENTRIES + 1 : 1;
+    if (since + 1 > first) first = since + 1;
+    // Oldest first, so a client that follows "next" pages through a burst
+    uint32_t last = lastId;
+    if (last >= first && last - first + 1 > maxRecords) last = first + maxRecords - 1;
+
+    size_t count = 0;
+    for (uint32_t id = first; id <= last; id++) {
+        records[count++] = tail[id % LOG_TAIL_ENTRIES];
+    }
+    xSemaphoreGive(tailMutex);
+    return count;
+}
+
+LogStats getLogStats() {
+    return LogStats{writtenCount, droppedCount.load(std::memory_order_relaxed),
+                    truncatedCount.load(std::memory_order_relaxed)};
+}
+
+void setLogFilter(LogLevel level, uint32_t tags) {
+    logRuntimeLevel.store(level, std::memory_order_relaxed);
+    logRuntimeTags.store(tags, std::memory_order_relaxed);
+}
+
+const char* getLogLevelName(LogLevel level) {
+    return level <= LOG_LEVEL_DEBUG ? LEVEL_NAMES[level] : "unknown";
+}
+
+const char* getLogTagName(LogTag tag) {
+    return tag < LOG_TAG_COUNT ? TAG_NAMES[tag] : "unknown";
+}
+
+bool parseLogLevel(const char* name, LogLevel* level) {
+    for (uint8_t i = LOG_LEVEL_NONE; i <= LOG_LEVEL_DEBUG; i++) {
+        if (strcmp(name, LEVEL_NAMES[i]) == 0) {
+            *level = (LogLevel)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+LogTag parseLogTag(const char* name) {
+    for (uint8_t i = 0; i < LOG_TAG_COUNT; i++) {
+        if (strcmp(name, TAG_NAMES[i]) == 0) return (LogTag)i;
+    }
+    return LOG_TAG_COUNT;
+}
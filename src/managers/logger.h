@@ -0,0 +1,127 @@
+/**
+ * @file logger.h
+ * @brief Asynchronous ring-buffered logger
+ * @details LOG_E/W/I/D format straight into a slot of a lock-free ring, so
+ *          logging never builds a String and never waits for the 9600 baud
+ *          UART. A low-priority task drains the ring to Serial and keeps the
+ *          most recent messages for /log. When the ring is full, messages are
+ *          dropped and counted.
+ *
+ *          Messages above LOG_COMPILE_LEVEL, or with a tag outside
+ *          LOG_COMPILE_TAGS, compile to nothing. The runtime level and tag mask
+ *          are checked before formatting.
+ *
+ *          Each source file names its tag once:
+ *              static constexpr LogTag LOG_TAG = LOG_TAG_STREAM;
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "../config/config.h"
+#include <atomic>
+
+enum LogLevel : uint8_t {
+    LOG_LEVEL_NONE,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_DEBUG
+};
+
+enum LogTag : uint8_t {
+    LOG_TAG_SYSTEM,
+    LOG_TAG_AUDIO,
+    LOG_TAG_WEB,
+    LOG_TAG_WIFI,
+    LOG_TAG_PROGRAM,
+    LOG_TAG_SHUFFLE,
+    LOG_TAG_GENERATIVE,
+    LOG_TAG_STREAM,
+    LOG_TAG_CATALOG,
+    LOG_TAG_TIMESHIFT,
+    LOG_TAG_MEME,
+    LOG_TAG_DATA,
+    LOG_TAG_MEMORY,
+    LOG_TAG_COUNT
+};
+
+// One message as queued, and as kept for /log
+struct LogRecord {
+    uint32_t id;          // Sequence number, assigned when drained
+    uint32_t timeMs;
+    LogLevel level;
+    LogTag tag;
+    char text[LOG_TEXT_SIZE];
+};
+
+struct LogStats {
+    uint32_t written;     // Drained to Serial
+    uint32_t dropped;     // Ring was full
+    uint32_t truncated;   // Longer than LOG_TEXT_SIZE
+};
+
+extern std::atomic<uint8_t> logRuntimeLevel;
+extern std::atomic<uint32_t> logRuntimeTags;
+
+#define LOG_COMPILED(level, tag) ((level) <= LOG_COMPILE_LEVEL && ((LOG_COMPILE_TAGS >> (tag)) & 1u))
+
+inline bool logEnabled(LogLevel level, LogTag tag) {
+    return level <= logRuntimeLevel.load(std::memory_order_relaxed) &&
+           ((logRuntimeTags.load(std::memory_order_relaxed) >> tag) & 1u);
+}
+
+#define LOG_AT(level, tag, fmt, ...)                                      \
+    do {                                                                  \
+        if (LOG_COMPILED(level, tag) && logEnabled(level, tag)) {         \
+            logMessage(level, tag, fmt, ##__VA_ARGS__);                   \
+        }                                                                 \
+    } while (0)
+
+#define LOG_E(fmt, ...) LOG_AT(LOG_LEVEL_ERROR, LOG_TAG, fmt, ##__VA_ARGS__)
+#define LOG_W(fmt, ...) LOG_AT(LOG_LEVEL_WARN, LOG_TAG, fmt, ##__VA_ARGS__)
+#define LOG_I(fmt, ...) LOG_AT(LOG_LEVEL_INFO, LOG_TAG, fmt, ##__VA_ARGS__)
+#define LOG_D(fmt, ...) LOG_AT(LOG_LEVEL_DEBUG, LOG_TAG, fmt, ##__VA_ARGS__)
+
+/**
+ * @brief Queue a formatted message; use the LOG_ macros instead
+ */
+void logMessage(LogLevel level, LogTag tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+/**
+ * @brief Start the task that drains the ring to Serial (after Serial.begin)
+ */
+void initializeLogger();
+
+/**
+ * @brief Copy drained messages newer than a sequence number, oldest first
+ * @param since Return messages with id greater than this
+ * @param records Destination
+ * @param maxRecords Size of records
+ * @return Number of records copied
+ */
+size_t readLogTail(uint32_t since, LogRecord* records, size_t maxRecords);
+
+LogStats getLogStats();
+
+/**
+ * @brief Change the runtime filter
+ * @param level Highest level that is logged
+ * @param tags Bit per LogTag
+ */
+void setLogFilter(LogLevel level, uint32_t tags);
+
+const char* getLogLevelName(LogLevel level);
+const char* getLogTagName(LogTag tag);
+
+/**
+ * @brief Parse a level name ("none", "error", "warn", "info", "debug")
+ * @return false if the name is unknown
+ */
+bool parseLogLevel(const char* name, LogLevel* level);
+
+/**
+ * @brief Parse a tag name
+ * @return LOG_TAG_COUNT if unknown
+ */
+LogTag parseLogTag(const char* name);
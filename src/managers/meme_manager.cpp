@@ -4,21 +4,124 @@
  */
 
 #include "meme_manager.h"
+#include "meme_overlay.h"
+#include "preload_fs.h"
+#include "state_snapshot.h"
+#include "../config/config.h"
 #include "../hardware/hardware_setup.h"
+#include "../hardware/audio_pipeline.h"
+#include "../web/json_writer.h"
+#include "logger.h"
 #include <SD.h>
 
+static constexpr LogTag LOG_TAG = LOG_TAG_MEME;
+
 std::vector<String> memeFiles;
+static std::vector<MemeLatencyStats> memeLatency;
+static int playingMeme = 0;  // 1-based index awaiting its first samples, 0 if none
+
+// /meme/stats body, sized for the clips found by the last scan (web task only)
+static char* memeStatsBody = nullptr;
+static size_t memeStatsSize = 0;
+
+/**
+ * @brief Keep the start of each clip in memory, in scan order until the budget runs out.
+ */
+static void preloadMemeHeads() {
+    clearPreloadedClips();
+    uint32_t budget = psramFound() ? MEME_PRELOAD_BUDGET_PSRAM : MEME_PRELOAD_BUDGET_RAM;
+    size_t preloaded = 0;
+
+    memeLatency.assign(memeFiles.size(), MemeLatencyStats{false, 0, 0, UINT32_MAX, 0, 0});
+    for (size_t i = 0; i < memeFiles.size(); i++) {
+        if (preloadClip(memeFiles[i], MEME_HEAD_BYTES, MEME_WHOLE_CLIP_MAX, budget)) {
+            memeLatency[i].preloaded = true;
+            preloaded++;
+        }
+    }
+    LOG_I("Preloaded %zu of %zu meme clips (%u bytes in %s)", preloaded, memeFiles.size(),
+          getPreloadedBytes(), psramFound() ? "PSRAM" : "RAM");
+}
+
+/**
+ * @brief Render the /meme/stats body.
+ * @param widest Write every number and flag at its longest, to size the buffer
+ * @return Length written, or the size needed with widest set
+ */
+static size_t renderMemeStats(char* buffer, size_t size, bool widest) {
+    auto number = [widest](int64_t value) { return widest ? INT64_MAX : value; };
+    auto flag = [widest](bool value) { return widest ? false : value; };
+
+    // Hook load: time spent mixing against the playing time of the frames processed
+    AudioPipelineStats pipeline = getAudioPipelineStats();
+    JsonWriter json(buffer, size);
+    json.beginObject()
+        .numberField("preloadedBytes", number(getPreloadedBytes()))
+        .boolField("psram", flag(psramFound()))
+        .key("overlay").beginObject()
+            .boolField("active", flag(isMemeOverlayActive()))
+            .numberField("duckDb", MEME_DUCK_DB)
+            .numberField("droppedFrames", number(getOverlayMixer().droppedFrames()))
+            .numberField("blocks", number(pipeline.blocks))
+            .numberField("maxBlockUs", number(pipeline.maxBlockUs))
+            .numberField("loadPermille", number(pipeline.audioUs ? pipeline.totalUs * 1000 / pipeline.audioUs : 0))
+            .endObject()
+        .key("clips").beginArray();
+    for (size_t i = 0; i < memeLatency.size() && i < memeFiles.size(); i++) {
+        const MemeLatencyStats& stats = memeLatency[i];
+        json.beginObject()
+            .stringField("path", memeFiles[i].c_str())
+            .boolField("preloaded", flag(stats.preloaded))
+            .numberField("plays", number(stats.plays))
+            .numberField("lastUs", number(stats.lastUs))
+            .numberField("minUs", number(stats.plays ? stats.minUs : 0))
+            .numberField("maxUs", number(stats.maxUs))
+            .numberField("avgUs", number(stats.plays ? stats.totalUs / stats.plays : 0))
+            .endObject();
+    }
+    json.endArray().endObject();
+    return widest ? json.requiredSize() : json.length();
+}
+
+/**
+ * @brief Size the /meme/stats buffer for the current clip list, once per scan.
+ */
+static void allocateMemeStatsBody() {
+    free(memeStatsBody);
+    memeStatsSize = renderMemeStats(nullptr, 0, true);
+    memeStatsBody = (char*)malloc(memeStatsSize);
+    if (!memeStatsBody) {
+        LOG_E("No memory for the meme stats body (%zu bytes)", memeStatsSize);
+        memeStatsSize = 0;
+    }
+}
+
+/**
+ * @brief First-sample probe callback, runs in the audio hook.
+ */
+static void recordMemeLatency(uint32_t latencyUs) {
+    if (playingMeme < 1 || playingMeme > (int)memeLatency.size()) return;
+    MemeLatencyStats& stats = memeLatency[playingMeme - 1];
+    stats.plays++;
+    stats.lastUs = latencyUs;
+    stats.minUs = min(stats.minUs, latencyUs);
+    stats.maxUs = max(stats.maxUs, latencyUs);
+    stats.totalUs += latencyUs;
+    playingMeme = 0;
+}
 
 void scanMemeFiles() {
     memeFiles.clear();
-    Serial.println("Scanning for meme files...");
+    memeLatency.clear();
+    LOG_I("Scanning for meme files...");
     File dir = SD.open("/meme");
     if (!dir) {
-        Serial.println("/meme folder not found on SD card");
-        Serial.println("Make sure you have a 'meme' folder at the root of your SD card");
+        LOG_W("/meme folder not found on SD card");
+        LOG_I("Make sure you have a 'meme' folder at the root of your SD card");
+        allocateMemeStatsBody();
         return;
     }
-    Serial.println("Found /meme folder, scanning for .mp3 files...");
+    LOG_I("Found /meme folder, scanning for .mp3 files...");
     while (true) {
         File entry = dir.openNextFile();
         if (!entry) break;
@@ -31,28 +134,60 @@ void scanMemeFiles() {
         entry.close();
     }
     dir.close();
-    Serial.printf("Found %d meme files\n", memeFiles.size());
+    LOG_I("Found %zu meme files", memeFiles.size());
+    preloadMemeHeads();
+    allocateMemeStatsBody();
+    if (!memeFiles.empty()) initializeMemeOverlay();
 }
 
 const std::vector<String>& getMemeFiles() {
     return memeFiles;
 }
 
-bool playMeme(int index) {
-    if (index < 1 || index > memeFiles.size()) {
-        Serial.println("Invalid meme index: " + String(index));
+bool playMeme(int index, uint32_t tapMicros) {
+    if (index < 1 || index > (int)memeFiles.size()) {
+        LOG_W("Invalid meme index: %d", index);
         return false;
     }
     
     String memePath = memeFiles[index - 1];
-    Serial.println("Playing meme: " + memePath);
+    LOG_I("Playing meme: %s", memePath.c_str());
     
+    if (tapMicros == 0) tapMicros = micros();
+
+    // Preloaded clips open without touching the SD card; the tail is read once the head is decoded
+    fs::FS& source = memeLatency[index - 1].preloaded ? getPreloadFS() : SD;
+
+    // Over a running program the meme is mixed in and the program only ducks
+    if (audio.isRunning() && startMemeOverlay(source, memePath)) {
+        playingMeme = index;
+        armFirstSampleProbe(tapMicros, recordMemeLatency, true);
+        return true;
+    }
+
+    stopMemeOverlay();
     audio.stopSong();
-    audio.connecttoFS(SD, memePath.c_str());
+    if (!audio.connecttoFS(source, memePath.c_str())) {
+        LOG_W("Failed to open meme: %s", memePath.c_str());
+        return false;
+    }
+    playingMeme = index;
+    armFirstSampleProbe(tapMicros, recordMemeLatency);
+    noteTrackStarted(memePath.c_str());
     
     return true;
 }
 
+const std::vector<MemeLatencyStats>& getMemeLatencyStats() {
+    return memeLatency;
+}
+
+const char* getMemeStatsJson(size_t* length) {
+    if (!memeStatsBody) return nullptr;
+    *length = renderMemeStats(memeStatsBody, memeStatsSize, false);
+    return memeStatsBody;
+}
+
 size_t getMemeCount() {
     return memeFiles.size();
 }
@@ -1,7 +1,9 @@
 /**
  * @file meme_manager.h
  * @brief Meme soundboard management
- * @details Handles meme file scanning and playback
+ * @details Handles meme file scanning and playback. The start of every clip is
+ *          preloaded into PSRAM at scan time, so a tap starts decoding from
+ *          memory while the rest of the clip streams from the SD card.
  */
 
 #pragma once
@@ -12,6 +14,16 @@
 // External meme files list
 extern std::vector<String> memeFiles;
 
+// Tap-to-first-sample latency per clip. Written by the audio loop, read by the web task.
+struct MemeLatencyStats {
+    bool preloaded;          // Clip head is in memory
+    uint32_t plays;
+    uint32_t lastUs;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t totalUs;
+};
+
 /**
  * @brief Scan SD card for meme files
  */
@@ -26,9 +38,25 @@ const std::vector<String>& getMemeFiles();
 /**
  * @brief Play a specific meme file by index
  * @param index Meme file index (1-based)
+ * @param tapMicros micros() when the request arrived, 0 to measure from now
  * @return true if meme was played successfully
  */
-bool playMeme(int index);
+bool playMeme(int index, uint32_t tapMicros = 0);
+
+/**
+ * @brief Get latency statistics, one entry per meme file
+ */
+const std::vector<MemeLatencyStats>& getMemeLatencyStats();
+
+/**
+ * @brief Preload, overlay and per-clip latency statistics as JSON
+ * @details Rendered into a buffer that scanMemeFiles() sizes for the clips it
+ *          found, so a request never allocates.
+ * @param length Receives the body length
+ * @return Null-terminated JSON, valid until the next call (web task only), or
+ *         nullptr if the buffer could not be allocated
+ */
+const char* getMemeStatsJson(size_t* length);
 
 /**
  * @brief Get meme files count
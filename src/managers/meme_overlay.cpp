@@ -0,0 +1,227 @@
+/**
+ * @file meme_overlay.cpp
+ * @brief Meme overlay decoding
+ */
+
+#include "meme_overlay.h"
+#include "../config/config.h"
+#include "../hardware/hardware_setup.h"
+#include "../hardware/audio_pipeline.h"
+#include "logger.h"
+#include "tracer.h"
+#include <FSImpl.h>
+#include <MP3DecoderHelix.h>
+
+static constexpr LogTag LOG_TAG = LOG_TAG_MEME;
+
+using namespace libhelix;
+
+static void onMemePcm(MP3FrameInfo& info, short* pcm, size_t len, void* ref);
+
+// The library's own decoder is busy with the program, so memes get a second one
+static MP3DecoderHelix memeDecoder(onMemePcm);
+static int16_t* overlayBuffer = nullptr;
+static uint8_t feedBuffer[MEME_OVERLAY_FEED_BYTES];
+static File memeFile;
+static bool decoding = false;
+static uint32_t mixRate = 44100;    // Rate overlay frames are queued at
+static bool carrierOpen = false;    // The decoder is playing silence under the meme
+
+#define CARRIER_PATH "/silence.wav"
+#define CARRIER_HEADER_BYTES 44
+#define CARRIER_DATA_BYTES 0x7FFFFF00u   // Hours of silence, far longer than any meme
+
+/**
+ * @brief Endless silent WAV for the decoder while the program leaves it idle.
+ * @details The mix rides on decoded blocks, so during a gap in the program the
+ *          meme is mixed over silence instead of waiting for the next track.
+ */
+class CarrierFileImpl : public fs::FileImpl {
+public:
+    explicit CarrierFileImpl(uint32_t sampleRate) : position_(0), open_(true) {
+        static const uint8_t FORMAT[CARRIER_HEADER_BYTES] = {
+            'R', 'I', 'F', 'F', 0, 0, 0, 0, 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ', 16, 0, 0, 0, 1, 0, 2, 0,
+            0, 0, 0, 0, 0, 0, 0, 0, 4, 0, 16, 0, 'd', 'a', 't', 'a', 0, 0, 0, 0};
+        memcpy(header_, FORMAT, sizeof(header_));
+        put32(header_ + 4, CARRIER_HEADER_BYTES - 8 + CARRIER_DATA_BYTES);
+        put32(header_ + 24, sampleRate);
+        put32(header_ + 28, sampleRate * 4);
+        put32(header_ + 40, CARRIER_DATA_BYTES);
+        carrierOpen = true;
+    }
+    ~CarrierFileImpl() override { close(); }
+
+    size_t read(uint8_t* buf, size_t size) override {
+        if (!open_ || position_ >= this->size()) return 0;
+        size = min(size, this->size() - position_);
+        size_t header = position_ < CARRIER_HEADER_BYTES ? min(size, (size_t)(CARRIER_HEADER_BYTES - position_)) : 0;
+        memcpy(buf, header_ + position_, header);
+        memset(buf + header, 0, size - header);
+        position_ += size;
+        return size;
+    }
+
+    bool seek(uint32_t pos, fs::SeekMode mode) override {
+        int64_t target = pos;
+        if (mode == fs::SeekCur) target += position_;
+        if (mode == fs::SeekEnd) target = (int64_t)size() - pos;
+        if (target < 0 || target > (int64_t)size()) return false;
+        position_ = target;
+        return true;
+    }
+
+    size_t position() const override { return position_; }
+    size_t size() const override { return CARRIER_HEADER_BYTES + CARRIER_DATA_BYTES; }
+
+    void close() override {
+        if (open_) carrierOpen = false;
+        open_ = false;
+    }
+
+    const char* path() const override { return CARRIER_PATH; }
+    const char* name() const override { return CARRIER_PATH + 1; }
+
+    operator bool() override { return open_; }
+
+    // Read-only file, no directory operations
+    size_t write(const uint8_t* buf, size_t size) override { return 0; }
+    void flush() override {}
+    bool setBufferSize(size_t size) override { return false; }
+    time_t getLastWrite() override { return 0; }
+    boolean isDirectory(void) override { return false; }
+    fs::FileImplPtr openNextFile(const char* mode) override { return fs::FileImplPtr(); }
+    boolean seekDir(long position) override { return false; }
+    String getNextFileName(void) override { return String(); }
+    String getNextFileName(bool* isDir) override { return String(); }
+    void rewindDirectory(void) override {}
+
+private:
+    static void put32(uint8_t* p, uint32_t v) {
+        p[0] = v;
+        p[1] = v >> 8;
+        p[2] = v >> 16;
+        p[3] = v >> 24;
+    }
+
+    uint8_t header_[CARRIER_HEADER_BYTES];
+    size_t position_;
+    bool open_;
+};
+
+class CarrierFSImpl : public fs::FSImpl {
+public:
+    fs::FileImplPtr open(const char* path, const char* mode, const bool create) override {
+        if (strcmp(path, CARRIER_PATH) != 0 || strcmp(mode, FILE_READ) != 0) return fs::FileImplPtr();
+        return std::make_shared<CarrierFileImpl>(mixRate);
+    }
+
+    bool exists(const char* path) override { return strcmp(path, CARRIER_PATH) == 0; }
+    bool rename(const char* pathFrom, const char* pathTo) override { return false; }
+    bool remove(const char* path) override { return false; }
+    bool mkdir(const char* path) override { return false; }
+    bool rmdir(const char* path) override { return false; }
+};
+
+static fs::FS carrierFS(fs::FSImplPtr(new CarrierFSImpl()));
+
+static void onMemePcm(MP3FrameInfo& info, short* pcm, size_t len, void* ref) {
+    if (info.nChans < 1) return;
+    getOverlayMixer().push(pcm, len / info.nChans, info.nChans, info.samprate);
+}
+
+static uint32_t framesFor(uint32_t ms) {
+    uint32_t sampleRate = audio.getSampleRate();
+    if (sampleRate == 0) sampleRate = 44100;
+    return sampleRate * ms / 1000;
+}
+
+bool initializeMemeOverlay() {
+    if (overlayBuffer) return true;
+
+    size_t bytes = MEME_OVERLAY_FRAMES * 2 * sizeof(int16_t);
+    overlayBuffer = (int16_t*)(psramFound() ? ps_malloc(bytes) : malloc(bytes));
+    if (!overlayBuffer) {
+        LOG_I("No memory for meme overlay - memes will replace the program");
+        return false;
+    }
+    getOverlayMixer().begin(overlayBuffer, MEME_OVERLAY_FRAMES);
+    LOG_I("Meme overlay ready, ducking %d dB", MEME_DUCK_DB);
+    return true;
+}
+
+/**
+ * @brief Close the clip and its decoder, leaving the mixer and the carrier alone.
+ */
+static void closeMeme() {
+    if (!decoding) return;
+    memeFile.close();
+    memeDecoder.end();
+    decoding = false;
+}
+
+bool startMemeOverlay(fs::FS& source, const String& path) {
+    if (!overlayBuffer) return false;
+
+    // A carrier left by the previous meme stays under this one
+    closeMeme();
+    getOverlayMixer().stop();
+    {
+        TRACE_SCOPE_DETAIL(TRACE_SD, "SD.open", path.c_str());
+        memeFile = source.open(path);
+    }
+    if (!memeFile) return false;
+
+    OverlayMixer& mixer = getOverlayMixer();
+    mixRate = audio.getSampleRate();
+    mixer.setOutputRate(mixRate);
+    mixer.setDucking(attenuationToGainQ15(MEME_DUCK_DB), framesFor(MEME_DUCK_ATTACK_MS),
+                     framesFor(MEME_DUCK_RELEASE_MS));
+    mixer.start();
+    memeDecoder.begin();
+    decoding = true;
+    return true;
+}
+
+void serviceMemeOverlay() {
+    OverlayMixer& mixer = getOverlayMixer();
+    if (!decoding && !mixer.active()) {
+        // Played out: the program gets the decoder back
+        if (carrierOpen) audio.stopSong();
+        return;
+    }
+
+    if (!audio.isRunning()) {
+        // The program left the decoder idle - between tracks, or waiting on a timer or a
+        // reconnect - so the meme goes on over silence until the program starts something
+        if (!audio.connecttoFS(carrierFS, CARRIER_PATH)) {
+            stopMemeOverlay();
+            return;
+        }
+    } else if (!carrierOpen && audio.getSampleRate() != mixRate && audio.getSampleRate() > 0) {
+        // A new program track at another rate
+        mixRate = audio.getSampleRate();
+        mixer.setOutputRate(mixRate);
+    }
+    if (!decoding) return;
+
+    // Feed only while a decoded frame is sure to fit, so nothing is decoded just to be dropped
+    for (int i = 0; i < MEME_OVERLAY_MAX_FEEDS && mixer.freeFrames() >= MEME_OVERLAY_FRAMES / 2; i++) {
+        size_t length = memeFile.read(feedBuffer, sizeof(feedBuffer));
+        if (length == 0) {
+            closeMeme();
+            mixer.finish();
+            return;
+        }
+        memeDecoder.write(feedBuffer, length);
+    }
+}
+
+void stopMemeOverlay() {
+    closeMeme();
+    getOverlayMixer().stop();
+    if (carrierOpen) audio.stopSong();
+}
+
+bool isMemeOverlayActive() {
+    return decoding || getOverlayMixer().active();
+}
@@ -0,0 +1,45 @@
+/**
+ * @file meme_overlay.h
+ * @brief Meme playback over the running program
+ * @details Memes are decoded by their own MP3 decoder and mixed over the
+ *          program in the audio pipeline, which is ducked meanwhile. The
+ *          program keeps decoding (and streams keep buffering) underneath.
+ *          When the program leaves the decoder idle - between tracks, or
+ *          waiting on a timer or a reconnect - the meme goes on over silence
+ *          until the program starts its next track. A meme only ends with its
+ *          clip, or when it is stopped. All functions run on the audio loop.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include <FS.h>
+
+/**
+ * @brief Allocate the overlay buffer and decoder
+ * @return true if overlays are available
+ */
+bool initializeMemeOverlay();
+
+/**
+ * @brief Start a meme over the program, replacing any meme already playing
+ * @param source Filesystem to read from (preloaded clips or SD)
+ * @param path Clip path
+ * @return true if the clip was opened
+ */
+bool startMemeOverlay(fs::FS& source, const String& path);
+
+/**
+ * @brief Decode ahead of the mix; call once per loop, after the program has handled its events
+ */
+void serviceMemeOverlay();
+
+/**
+ * @brief Cut the current meme short, stopping the silence under it if the program was idle
+ */
+void stopMemeOverlay();
+
+/**
+ * @brief Check if a meme is playing over the program
+ */
+bool isMemeOverlayActive();
@@ -0,0 +1,331 @@
+/**
+ * @file memory_monitor.cpp
+ * @brief Heap monitoring and allocation accounting implementation
+ */
+
+#include "memory_monitor.h"
+#include "logger.h"
+#include <esp_heap_caps.h>
+
+static constexpr LogTag LOG_TAG = LOG_TAG_MEMORY;
+
+static const char* const TAG_NAMES[MEM_TAG_COUNT] = {
+    "other", "catalog", "shuffle", "generative", "stream", "web"
+};
+
+// Sample history, written by the audio loop and copied out by the web task
+static portMUX_TYPE historyLock = portMUX_INITIALIZER_UNLOCKED;
+static MemorySample history[MEMORY_HISTORY_SAMPLES];
+static size_t historyCount = 0;
+static size_t historyNext = 0;
+static MemoryTrend memoryTrend = {0, 0, false};
+static MemoryAlert lastAlert = {MEM_ALERT_NONE, 0, 0, 0};
+static uint32_t alertCount = 0;
+static bool alertActive[MEM_ALERT_FRAGMENTATION_TREND + 1] = {};
+
+/**
+ * @brief Least-squares slope in bytes per minute of one sample field over the history.
+ */
+static int32_t trendPerMinute(uint32_t MemorySample::*field) {
+    double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+    size_t oldest = (historyNext + MEMORY_HISTORY_SAMPLES - historyCount) % MEMORY_HISTORY_SAMPLES;
+    uint32_t start = history[oldest].at;
+    for (size_t i = 0; i < historyCount; i++) {
+        const MemorySample& sample = history[(oldest + i) % MEMORY_HISTORY_SAMPLES];
+        double x = (sample.at - start) / 60000.0;
+        double y = sample.*field;
+        sumX += x;
+        sumY += y;
+        sumXX += x * x;
+        sumXY += x * y;
+    }
+    double denominator = historyCount * sumXX - sumX * sumX;
+    if (denominator <= 0) return 0;
+    return (int32_t)((historyCount * sumXY - sumX * sumY) / denominator);
+}
+
+/**
+ * @brief Raise an alert when its condition starts to hold; stay quiet while it keeps holding.
+ */
+static void updateAlert(MemoryAlertType type, bool condition, int32_t slopePerMin, uint32_t minutesLeft) {
+    if (condition && !alertActive[type]) {
+        lastAlert = {type, millis(), slopePerMin, minutesLeft};
+        alertCount++;
+        if (slopePerMin != 0) {
+            LOG_W("memory alert %s (%d bytes/min, ~%u min left)",
+                  getMemoryAlertName(type), slopePerMin, minutesLeft);
+        } else {
+            LOG_W("memory alert %s", getMemoryAlertName(type));
+        }
+    }
+    alertActive[type] = condition;
+}
+
+/**
+ * @brief Minutes until a falling value reaches its threshold, or UINT32_MAX if it is not falling.
+ */
+static uint32_t minutesUntil(uint32_t value, uint32_t threshold, int32_t slopePerMin) {
+    if (slopePerMin >= 0) return UINT32_MAX;
+    if (value <= threshold) return 0;
+    return (value - threshold) / (uint32_t)(-slopePerMin);
+}
+
+void sampleMemory() {
+    MemorySample sample;
+    sample.at = millis();
+    sample.freeHeap = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    sample.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    sample.minFreeHeap = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    sample.freePsram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    sample.largestPsramBlock = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+    sample.fragmentation = sample.freeHeap ? 100 - (uint64_t)sample.largestBlock * 100 / sample.freeHeap : 0;
+
+    portENTER_CRITICAL(&historyLock);
+    history[historyNext] = sample;
+    historyNext = (historyNext + 1) % MEMORY_HISTORY_SAMPLES;
+    if (historyCount < MEMORY_HISTORY_SAMPLES) historyCount++;
+    portEXIT_CRITICAL(&historyLock);
+
+    MemoryTrend trend = {0, 0, historyCount >= MEMORY_TREND_MIN_SAMPLES};
+    if (trend.valid) {
+        trend.freeHeapPerMin = trendPerMinute(&MemorySample::freeHeap);
+        trend.largestBlockPerMin = trendPerMinute(&MemorySample::largestBlock);
+    }
+    memoryTrend = trend;
+
+    LOG_I("Memory - free %u, largest block %u (%u%% fragmented), min %u, PSRAM free %u",
+          sample.freeHeap, sample.largestBlock, sample.fragmentation, sample.minFreeHeap, sample.freePsram);
+
+    updateAlert(MEM_ALERT_LOW_HEAP, sample.freeHeap < LOW_MEMORY_THRESHOLD, 0, 0);
+    updateAlert(MEM_ALERT_LOW_BLOCK, sample.largestBlock < LOW_LARGEST_BLOCK_THRESHOLD, 0, 0);
+    if (trend.valid) {
+        uint32_t heapLeft = minutesUntil(sample.freeHeap, LOW_MEMORY_THRESHOLD, trend.freeHeapPerMin);
+        uint32_t blockLeft = minutesUntil(sample.largestBlock, LOW_LARGEST_BLOCK_THRESHOLD, trend.largestBlockPerMin);
+        updateAlert(MEM_ALERT_HEAP_TREND, heapLeft <= MEMORY_ALERT_HORIZON_MIN, trend.freeHeapPerMin, heapLeft);
+        updateAlert(MEM_ALERT_FRAGMENTATION_TREND, blockLeft <= MEMORY_ALERT_HORIZON_MIN,
+                    trend.largestBlockPerMin, blockLeft);
+    }
+}
+
+size_t getMemoryHistory(MemorySample* samples, size_t maxSamples) {
+    portENTER_CRITICAL(&historyLock);
+    size_t count = min(historyCount, maxSamples);
+    size_t first = (historyNext + MEMORY_HISTORY_SAMPLES - count) % MEMORY_HISTORY_SAMPLES;
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = history[(first + i) % MEMORY_HISTORY_SAMPLES];
+    }
+    portEXIT_CRITICAL(&historyLock);
+    return count;
+}
+
+MemoryTrend getMemoryTrend() {
+    return memoryTrend;
+}
+
+MemoryAlert getLastMemoryAlert(uint32_t* count) {
+    if (count) *count = alertCount;
+    return lastAlert;
+}
+
+const char* getMemoryAlertName(MemoryAlertType type) {
+    switch (type) {
+        case MEM_ALERT_LOW_HEAP: return "lowHeap";
+        case MEM_ALERT_HEAP_TREND: return "heapTrend";
+        case MEM_ALERT_LOW_BLOCK: return "lowLargestBlock";
+        case MEM_ALERT_FRAGMENTATION_TREND: return "fragmentationTrend";
+        default: return "none";
+    }
+}
+
+const char* getMemoryTagName(MemoryTag tag) {
+    return tag < MEM_TAG_COUNT ? TAG_NAMES[tag] : "unknown";
+}
+
+#if MEMORY_TAGGING_ENABLED
+
+// Per-task current tag. Few tasks ever set one, so a short scan beats any lookup structure.
+#define MEMORY_TAG_TASKS 8
+
+struct TaskTag {
+    TaskHandle_t task;
+    MemoryTag tag;
+};
+
+// Live tagged allocations: open addressing with linear probing, keyed by pointer
+struct TrackedAllocation {
+    void* ptr;
+    uint32_t size : 24;
+    uint32_t tag : 8;
+};
+
+static portMUX_TYPE tagLock = portMUX_INITIALIZER_UNLOCKED;
+static TaskTag taskTags[MEMORY_TAG_TASKS];
+static TrackedAllocation tracked[MEMORY_TAG_TABLE_SIZE];
+static size_t trackedCount = 0;
+static MemoryTagStats tagStats[MEM_TAG_COUNT];
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+}
+
+static inline size_t slotFor(void* ptr) {
+    return (((uintptr_t)ptr >> 3) * 2654435761u) & (MEMORY_TAG_TABLE_SIZE - 1);
+}
+
+// Callers hold tagLock
+static MemoryTag currentTag() {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    if (!task) return MEM_TAG_OTHER;
+    for (size_t i = 0; i < MEMORY_TAG_TASKS; i++) {
+        if (taskTags[i].task == task) return taskTags[i].tag;
+    }
+    return MEM_TAG_OTHER;
+}
+
+static void trackAllocation(void* ptr, MemoryTag tag) {
+    MemoryTagStats& stats = tagStats[tag];
+    stats.allocations++;
+    if (tag == MEM_TAG_OTHER) return;
+
+    // Keep the table at most 3/4 full so probes stay short
+    if (trackedCount >= MEMORY_TAG_TABLE_SIZE * 3 / 4) {
+        stats.untracked++;
+        return;
+    }
+    size_t size = heap_caps_get_allocated_size(ptr);
+    size_t slot = slotFor(ptr);
+    while (tracked[slot].ptr) slot = (slot + 1) & (MEMORY_TAG_TABLE_SIZE - 1);
+    tracked[slot] = {ptr, (uint32_t)min(size, (size_t)0xFFFFFF), tag};
+    trackedCount++;
+
+    stats.liveBytes += size;
+    if (stats.liveBytes > stats.peakBytes) stats.peakBytes = stats.liveBytes;
+}
+
+/**
+ * @brief Stop tracking ptr, crediting its tag.
+ * @return Tag of the allocation, MEM_TAG_OTHER if it was not tracked
+ */
+static MemoryTag untrackAllocation(void* ptr) {
+    if (trackedCount == 0) return MEM_TAG_OTHER;
+
+    size_t slot = slotFor(ptr);
+    while (tracked[slot].ptr && tracked[slot].ptr != ptr) slot = (slot + 1) & (MEMORY_TAG_TABLE_SIZE - 1);
+    if (!tracked[slot].ptr) return MEM_TAG_OTHER;
+
+    MemoryTag tag = (MemoryTag)tracked[slot].tag;
+    tagStats[tag].frees++;
+    tagStats[tag].liveBytes -= tracked[slot].size;
+    trackedCount--;
+
+    // Backward-shift deletion keeps every probe chain unbroken without tombstones
+    size_t hole = slot;
+    size_t next = (hole + 1) & (MEMORY_TAG_TABLE_SIZE - 1);
+    while (tracked[next].ptr) {
+        size_t home = slotFor(tracked[next].ptr);
+        bool movable = hole <= next ? (home <= hole || home > next) : (home <= hole && home > next);
+        if (movable) {
+            tracked[hole] = tracked[next];
+            hole = next;
+        }
+        next = (next + 1) & (MEMORY_TAG_TABLE_SIZE - 1);
+    }
+    tracked[hole].ptr = nullptr;
+    return tag;
+}
+
+extern "C" void* __wrap_malloc(size_t size) {
+    void* ptr = __real_malloc(size);
+    if (ptr) {
+        portENTER_CRITICAL_SAFE(&tagLock);
+        trackAllocation(ptr, currentTag());
+        portEXIT_CRITICAL_SAFE(&tagLock);
+    }
+    return ptr;
+}
+
+extern "C" void* __wrap_calloc(size_t count, size_t size) {
+    void* ptr = __real_calloc(count, size);
+    if (ptr) {
+        portENTER_CRITICAL_SAFE(&tagLock);
+        trackAllocation(ptr, currentTag());
+        portEXIT_CRITICAL_SAFE(&tagLock);
+    }
+    return ptr;
+}
+
+extern "C" void* __wrap_realloc(void* ptr, size_t size) {
+    // A reallocated block keeps the tag it was first allocated under
+    MemoryTag tag = MEM_TAG_OTHER;
+    if (ptr) {
+        portENTER_CRITICAL_SAFE(&tagLock);
+        tag = untrackAllocation(ptr);
+        if (tag == MEM_TAG_OTHER) tag = currentTag();
+        portEXIT_CRITICAL_SAFE(&tagLock);
+    }
+
+    void* resized = __real_realloc(ptr, size);
+
+    portENTER_CRITICAL_SAFE(&tagLock);
+    if (!ptr) tag = currentTag();
+    if (resized) {
+        trackAllocation(resized, tag);
+    } else if (ptr && size > 0) {
+        trackAllocation(ptr, tag);  // Failed realloc leaves the old block in place
+    }
+    portEXIT_CRITICAL_SAFE(&tagLock);
+    return resized;
+}
+
+extern "C" void __wrap_free(void* ptr) {
+    if (ptr) {
+        portENTER_CRITICAL_SAFE(&tagLock);
+        untrackAllocation(ptr);
+        portEXIT_CRITICAL_SAFE(&tagLock);
+    }
+    __real_free(ptr);
+}
+
+MemoryTag setMemoryTag(MemoryTag tag) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    MemoryTag previous = MEM_TAG_OTHER;
+
+    portENTER_CRITICAL(&tagLock);
+    TaskTag* unused = nullptr;
+    TaskTag* own = nullptr;
+    for (size_t i = 0; i < MEMORY_TAG_TASKS; i++) {
+        if (taskTags[i].task == task) own = &taskTags[i];
+        else if (!taskTags[i].task && !unused) unused = &taskTags[i];
+    }
+    if (own) {
+        previous = own->tag;
+        if (tag == MEM_TAG_OTHER) own->task = nullptr;  // Release the slot when leaving the outermost scope
+        else own->tag = tag;
+    } else if (unused && tag != MEM_TAG_OTHER) {
+        *unused = {task, tag};
+    }
+    portEXIT_CRITICAL(&tagLock);
+    return previous;
+}
+
+MemoryTagStats getMemoryTagStats(MemoryTag tag) {
+    portENTER_CRITICAL(&tagLock);
+    MemoryTagStats stats = tagStats[tag];
+    portEXIT_CRITICAL(&tagLock);
+    return stats;
+}
+
+#else
+
+MemoryTag setMemoryTag(MemoryTag tag) {
+    return MEM_TAG_OTHER;
+}
+
+MemoryTagStats getMemoryTagStats(MemoryTag tag) {
+    return MemoryTagStats{0, 0, 0, 0, 0};
+}
+
+#endif
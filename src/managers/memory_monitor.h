@@ -0,0 +1,120 @@
+/**
+ * @file memory_monitor.h
+ * @brief Heap fragmentation sampling, trend alerts and tagged allocation accounting
+ * @details sampleMemory() records free heap, largest free block and PSRAM use
+ *          into a short history and raises alerts when a least-squares trend
+ *          over that history will cross a threshold soon, before the threshold
+ *          itself is hit.
+ *
+ *          With MEMORY_TAGGING_ENABLED, malloc/calloc/realloc/free are wrapped
+ *          at link time. Allocations made inside a MEMORY_TAG(tag) scope are
+ *          counted against that subsystem and tracked until freed, wherever the
+ *          free happens. Tags are per task, so the web and audio tasks do not
+ *          see each other's scopes.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "../config/config.h"
+
+enum MemoryTag : uint8_t {
+    MEM_TAG_OTHER,          // Untagged; counted but not tracked
+    MEM_TAG_CATALOG,
+    MEM_TAG_SHUFFLE,
+    MEM_TAG_GENERATIVE,
+    MEM_TAG_STREAM,
+    MEM_TAG_WEB,
+    MEM_TAG_COUNT
+};
+
+struct MemoryTagStats {
+    uint32_t allocations;
+    uint32_t frees;
+    uint32_t liveBytes;
+    uint32_t peakBytes;
+    uint32_t untracked;     // Allocations not tracked because the table was full
+};
+
+struct MemorySample {
+    uint32_t at;                // millis()
+    uint32_t freeHeap;
+    uint32_t largestBlock;
+    uint32_t minFreeHeap;
+    uint32_t freePsram;
+    uint32_t largestPsramBlock;
+    uint8_t fragmentation;      // Percent of free heap not in the largest block
+};
+
+enum MemoryAlertType : uint8_t {
+    MEM_ALERT_NONE,
+    MEM_ALERT_LOW_HEAP,             // Free heap below LOW_MEMORY_THRESHOLD
+    MEM_ALERT_HEAP_TREND,           // Free heap falling towards it
+    MEM_ALERT_LOW_BLOCK,            // Largest block below LOW_LARGEST_BLOCK_THRESHOLD
+    MEM_ALERT_FRAGMENTATION_TREND   // Largest block shrinking towards it
+};
+
+struct MemoryAlert {
+    MemoryAlertType type;
+    uint32_t at;                // millis()
+    int32_t slopePerMin;        // Bytes per minute, trend alerts only
+    uint32_t minutesLeft;       // Until the threshold, trend alerts only
+};
+
+struct MemoryTrend {
+    int32_t freeHeapPerMin;
+    int32_t largestBlockPerMin;
+    bool valid;                 // Enough samples for a trend
+};
+
+/**
+ * @brief Take a sample, update trends and raise alerts (audio loop, from monitorSystemHealth)
+ */
+void sampleMemory();
+
+/**
+ * @brief Copy the sample history, oldest first
+ * @return Number of samples copied
+ */
+size_t getMemoryHistory(MemorySample* samples, size_t maxSamples);
+
+/**
+ * @brief Trend over the sample history
+ */
+MemoryTrend getMemoryTrend();
+
+/**
+ * @brief Most recent alert and total alert count
+ */
+MemoryAlert getLastMemoryAlert(uint32_t* alertCount);
+
+const char* getMemoryAlertName(MemoryAlertType type);
+const char* getMemoryTagName(MemoryTag tag);
+
+/**
+ * @brief Allocation counters for a subsystem
+ */
+MemoryTagStats getMemoryTagStats(MemoryTag tag);
+
+/**
+ * @brief Set the calling task's allocation tag
+ * @return Previous tag
+ */
+MemoryTag setMemoryTag(MemoryTag tag);
+
+class MemoryTagScope {
+public:
+    explicit MemoryTagScope(MemoryTag tag) : previous_(setMemoryTag(tag)) {}
+    ~MemoryTagScope() { setMemoryTag(previous_); }
+
+private:
+    MemoryTag previous_;
+};
+
+#define MEMORY_TAG_CONCAT_(a, b) a##b
+#define MEMORY_TAG_CONCAT(a, b) MEMORY_TAG_CONCAT_(a, b)
+#if MEMORY_TAGGING_ENABLED
+#define MEMORY_TAG(tag) MemoryTagScope MEMORY_TAG_CONCAT(memoryTag, __LINE__)(tag)
+#else
+#define MEMORY_TAG(tag) ((void)0)
+#endif
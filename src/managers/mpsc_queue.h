@@ -0,0 +1,109 @@
+/**
+ * @file mpsc_queue.h
+ * @brief Bounded lock-free multi-producer/single-consumer queue
+ * @details Any number of tasks push, one task pops; no locks and no
+ *          allocation. Each slot carries a sequence number that says whether
+ *          it is free for the producer at that position or filled for the
+ *          consumer, so producers only contend on one atomic add per item.
+ *          Capacity must be a power of two.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+
+template <typename T, size_t Capacity>
+class MpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    MpscQueue() {
+        for (size_t i = 0; i < Capacity; i++) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Push an item (any task)
+     * @return false if the queue is full
+     */
+    bool push(const T& item) {
+        return pushAll(&item, 1);
+    }
+
+    /**
+     * @brief Push several items as one unit (any task)
+     * @details The consumer sees either none or all of them, in order, with
+     *          no other producer's items in between.
+     * @return false if there is not room for all items - nothing is pushed
+     */
+    bool pushAll(const T* items, size_t count) {
+        if (count == 0) return true;
+        if (count > Capacity) return false;
+
+        size_t head = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            // Slots are freed in order, so the last one being free means all of them are
+            Slot& last = slots_[(head + count - 1) & (Capacity - 1)];
+            size_t sequence = last.sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)(head + count - 1);
+            if (diff < 0) {
+                return false;
+            }
+            if (diff > 0) {
+                head = head_.load(std::memory_order_relaxed);   // Another producer claimed it
+                continue;
+            }
+            if (head_.compare_exchange_weak(head, head + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            slots_[(head + i) & (Capacity - 1)].item = items[i];
+        }
+        // Publish the first slot last: the consumer stops at it until the whole batch is there
+        for (size_t i = count; i-- > 0;) {
+            slots_[(head + i) & (Capacity - 1)].sequence.store(head + i + 1, std::memory_order_release);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Pop the oldest item (consumer side only)
+     * @return false if the queue is empty, or the oldest item is still being written
+     */
+    bool pop(T& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[tail & (Capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+            return false;
+        }
+        item = slot.item;
+        slot.sequence.store(tail + Capacity, std::memory_order_release);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Approximate number of queued items (claimed, possibly not yet published)
+     */
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return Capacity;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    Slot slots_[Capacity];
+    std::atomic<size_t> head_{0};
+    std::atomic<size_t> tail_{0};   // Written by the consumer only
+};
@@ -0,0 +1,159 @@
+/**
+ * @file preload_fs.cpp
+ * @brief RAM-headed clip filesystem implementation
+ */
+
+#include "preload_fs.h"
+#include "tracer.h"
+#include <FSImpl.h>
+#include <SD.h>
+#include <vector>
+
+static std::vector<PreloadedClip> preloadedClips;
+
+/**
+ * @brief Open clip: head from memory, tail from the SD card on demand.
+ */
+class PreloadFileImpl : public fs::FileImpl {
+public:
+    explicit PreloadFileImpl(const PreloadedClip& clip) : clip_(clip), position_(0), open_(true) {}
+    ~PreloadFileImpl() override { close(); }
+
+    size_t read(uint8_t* buf, size_t size) override {
+        if (!open_ || position_ >= clip_.size) return 0;
+
+        if (position_ < clip_.headLength) {
+            // Stop at the end of the head, so the decoder gets going on memory alone
+            // before the first SD access
+            size_t length = min((size_t)(clip_.headLength - position_), size);
+            memcpy(buf, clip_.data + position_, length);
+            position_ += length;
+            return length;
+        }
+
+        if (!tail_) {
+            TRACE_SCOPE_DETAIL(TRACE_SD, "SD.open", clip_.path.c_str());
+            tail_ = SD.open(clip_.path);
+            if (!tail_) return 0;
+        }
+        if (tail_.position() != position_ && !tail_.seek(position_)) return 0;
+        size_t length = tail_.read(buf, size);
+        position_ += length;
+        return length;
+    }
+
+    bool seek(uint32_t pos, fs::SeekMode mode) override {
+        int64_t target = pos;
+        if (mode == fs::SeekCur) target += position_;
+        if (mode == fs::SeekEnd) target = (int64_t)clip_.size - pos;
+        if (target < 0 || target > clip_.size) return false;
+        position_ = target;
+        return true;
+    }
+
+    size_t position() const override { return position_; }
+    size_t size() const override { return clip_.size; }
+
+    void close() override {
+        if (tail_) tail_.close();
+        open_ = false;
+    }
+
+    const char* path() const override { return clip_.path.c_str(); }
+    const char* name() const override {
+        int slash = clip_.path.lastIndexOf('/');
+        return clip_.path.c_str() + slash + 1;
+    }
+
+    operator bool() override { return open_; }
+
+    // Read-only file, no directory operations
+    size_t write(const uint8_t* buf, size_t size) override { return 0; }
+    void flush() override {}
+    bool setBufferSize(size_t size) override { return false; }
+    time_t getLastWrite() override { return 0; }
+    boolean isDirectory(void) override { return false; }
+    fs::FileImplPtr openNextFile(const char* mode) override { return fs::FileImplPtr(); }
+    boolean seekDir(long position) override { return false; }
+    String getNextFileName(void) override { return String(); }
+    String getNextFileName(bool* isDir) override { return String(); }
+    void rewindDirectory(void) override {}
+
+private:
+    PreloadedClip clip_;  // Copy, the clip list may grow while files are open
+    File tail_;
+    uint32_t position_;
+    bool open_;
+};
+
+class PreloadFSImpl : public fs::FSImpl {
+public:
+    fs::FileImplPtr open(const char* path, const char* mode, const bool create) override {
+        const PreloadedClip* clip = findPreloadedClip(path);
+        if (!clip || strcmp(mode, FILE_READ) != 0) return fs::FileImplPtr();
+        return std::make_shared<PreloadFileImpl>(*clip);
+    }
+
+    bool exists(const char* path) override { return findPreloadedClip(path) != nullptr; }
+    bool rename(const char* pathFrom, const char* pathTo) override { return false; }
+    bool remove(const char* path) override { return false; }
+    bool mkdir(const char* path) override { return false; }
+    bool rmdir(const char* path) override { return false; }
+};
+
+static fs::FS preloadFS(fs::FSImplPtr(new PreloadFSImpl()));
+
+bool preloadClip(const String& path, uint32_t headBytes, uint32_t wholeClipMax, uint32_t& budget) {
+    File file = SD.open(path);
+    if (!file) return false;
+
+    uint32_t size = file.size();
+    uint32_t headLength = size <= wholeClipMax ? size : min(headBytes, size);
+    if (headLength == 0 || headLength > budget) {
+        file.close();
+        return false;
+    }
+
+    uint8_t* data = (uint8_t*)(psramFound() ? ps_malloc(headLength) : malloc(headLength));
+    if (!data) {
+        file.close();
+        return false;
+    }
+
+    size_t read = file.read(data, headLength);
+    file.close();
+    if (read != headLength) {
+        free(data);
+        return false;
+    }
+
+    budget -= headLength;
+    preloadedClips.push_back({path, data, headLength, size});
+    return true;
+}
+
+const PreloadedClip* findPreloadedClip(const String& path) {
+    for (const PreloadedClip& clip : preloadedClips) {
+        if (clip.path == path) return &clip;
+    }
+    return nullptr;
+}
+
+void clearPreloadedClips() {
+    for (PreloadedClip& clip : preloadedClips) {
+        free(clip.data);
+    }
+    preloadedClips.clear();
+}
+
+uint32_t getPreloadedBytes() {
+    uint32_t total = 0;
+    for (const PreloadedClip& clip : preloadedClips) {
+        total += clip.headLength;
+    }
+    return total;
+}
+
+fs::FS& getPreloadFS() {
+    return preloadFS;
+}
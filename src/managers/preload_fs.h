@@ -0,0 +1,52 @@
+/**
+ * @file preload_fs.h
+ * @brief Read-only filesystem serving clip heads from RAM
+ * @details A preloaded clip is served from memory up to its head length and
+ *          from the SD card after that. The SD file is only opened when the
+ *          decoder reads past the head, so starting a clip does no FAT lookup
+ *          and no SD read. Pass getPreloadFS() to audio.connecttoFS().
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include <FS.h>
+
+// A clip head held in memory
+struct PreloadedClip {
+    String path;
+    uint8_t* data;
+    uint32_t headLength;  // Bytes in data
+    uint32_t size;        // Size of the whole file
+};
+
+/**
+ * @brief Load the start of a file into PSRAM (or RAM without PSRAM)
+ * @param path SD path
+ * @param headBytes Bytes to keep; the whole file is kept if it is at most wholeClipMax
+ * @param wholeClipMax Size up to which the whole file is kept
+ * @param budget Bytes still available for preloading, reduced by what is used
+ * @return true if the clip was preloaded, false if it could not be read or does not fit the budget
+ */
+bool preloadClip(const String& path, uint32_t headBytes, uint32_t wholeClipMax, uint32_t& budget);
+
+/**
+ * @brief Find a preloaded clip
+ * @return Clip, or nullptr if the path was not preloaded
+ */
+const PreloadedClip* findPreloadedClip(const String& path);
+
+/**
+ * @brief Release all preloaded clips
+ */
+void clearPreloadedClips();
+
+/**
+ * @brief Total bytes held by preloaded clips
+ */
+uint32_t getPreloadedBytes();
+
+/**
+ * @brief Filesystem that opens preloaded clips
+ */
+fs::FS& getPreloadFS();
@@ -0,0 +1,114 @@
+/**
+ * @file profiler.cpp
+ * @brief Loop stage profiler implementation
+ */
+
+#include "profiler.h"
+
+static const char* const STAGE_NAMES[PROFILE_STAGE_COUNT] = {
+    "loop",
+    "audio.loop",
+    "audio.hook",
+    "memeOverlay",
+    "audioCommands",
+    "volumeControl",
+    "programPlayback",
+    "stateSnapshot",
+    "webControl",
+    "http.route",
+    "http.static",
+    "statusEvents",
+};
+
+const char* getProfileStageName(ProfileStage stage) {
+    return stage < PROFILE_STAGE_COUNT ? STAGE_NAMES[stage] : "unknown";
+}
+
+#if PROFILER_ENABLED
+
+#define PROFILE_MAX_DEPTH 4     // loop > audio.loop > audio.hook
+#define PROFILE_LOOP_SPANS 32   // A few loop iterations
+
+static ProfileHistogram histograms[PROFILE_STAGE_COUNT];
+
+// Audio loop stages: open scopes, innermost last, and recently finished spans.
+// Only the audio loop touches these, so they are always consistent.
+struct StageSpan {
+    ProfileStage stage;
+    uint32_t startCycles;
+    uint32_t endCycles;
+};
+
+static StageSpan openStages[PROFILE_MAX_DEPTH];
+static uint8_t openDepth = 0;
+static StageSpan loopSpans[PROFILE_LOOP_SPANS];
+static uint32_t loopSpanCount = 0;
+
+void enterLoopStage(ProfileStage stage, uint32_t startCycles) {
+    if (openDepth < PROFILE_MAX_DEPTH) {
+        openStages[openDepth] = {stage, startCycles, 0};
+    }
+    openDepth++;
+}
+
+void recordProfileSample(ProfileStage stage, uint32_t startCycles, uint32_t endCycles) {
+    uint32_t cycles = endCycles - startCycles;
+    if (stage < PROFILE_FIRST_WEB_STAGE) {
+        if (openDepth > 0) openDepth--;
+        loopSpans[loopSpanCount++ % PROFILE_LOOP_SPANS] = {stage, startCycles, endCycles};
+    }
+
+    ProfileHistogram& histogram = histograms[stage];
+    histogram.buckets[31 - __builtin_clz(cycles | 1)]++;
+    histogram.count++;
+    histogram.totalCycles += cycles;
+    if (cycles > histogram.maxCycles) histogram.maxCycles = cycles;
+}
+
+ProfileHistogram getProfileHistogram(ProfileStage stage) {
+    return histograms[stage];
+}
+
+void resetProfile() {
+    memset(histograms, 0, sizeof(histograms));
+}
+
+uint32_t getProfilePercentile(const ProfileHistogram& histogram, int percent) {
+    if (histogram.count == 0) return 0;
+    uint64_t wanted = ((uint64_t)histogram.count * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < PROFILE_BUCKETS; bucket++) {
+        seen += histogram.buckets[bucket];
+        if (seen >= wanted) {
+            uint32_t upper = bucket == 31 ? UINT32_MAX : (2u << bucket) - 1;
+            return min(upper, histogram.maxCycles);
+        }
+    }
+    return histogram.maxCycles;
+}
+
+ProfileStage getLoopStageAt(uint32_t cycles) {
+    // The innermost stage containing the moment is the one that started last
+    ProfileStage found = PROFILE_STAGE_COUNT;
+    uint32_t foundStart = 0;
+    auto consider = [&](const StageSpan& span, bool open) {
+        // Differences instead of comparisons, so the cycle counter may wrap
+        if ((int32_t)(cycles - span.startCycles) < 0) return;
+        if (!open && (int32_t)(span.endCycles - cycles) < 0) return;
+        if (found == PROFILE_STAGE_COUNT || (int32_t)(span.startCycles - foundStart) > 0) {
+            found = span.stage;
+            foundStart = span.startCycles;
+        }
+    };
+
+    for (uint8_t i = 0; i < openDepth && i < PROFILE_MAX_DEPTH; i++) {
+        consider(openStages[i], true);
+    }
+    uint32_t kept = min(loopSpanCount, (uint32_t)PROFILE_LOOP_SPANS);
+    for (uint32_t i = 0; i < kept; i++) {
+        consider(loopSpans[(loopSpanCount - 1 - i) % PROFILE_LOOP_SPANS], false);
+    }
+    return found;
+}
+
+#endif
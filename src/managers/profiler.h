@@ -0,0 +1,114 @@
+/**
+ * @file profiler.h
+ * @brief Cycle-counter profiler for loop stages and request handlers
+ * @details PROFILE_SCOPE(stage) times the rest of the enclosing block with the
+ *          CPU cycle counter and records it into a fixed log2 histogram: bucket
+ *          n counts samples of 2^n to 2^(n+1)-1 cycles. Recording is a few
+ *          instructions and never allocates. Each stage is only recorded from one
+ *          task, so stages need no locking; readers get a possibly torn copy,
+ *          which is fine for telemetry. With PROFILER_ENABLED set to 0 the macro
+ *          expands to nothing.
+ *
+ *          The most recent audio loop stage spans are also kept, so the audio
+ *          loop can tell which stage was running at a moment in the near past.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "../config/config.h"
+
+enum ProfileStage : uint8_t {
+    // Audio loop (audio task)
+    PROFILE_LOOP,               // Whole loop() iteration
+    PROFILE_AUDIO_LOOP,         // audio.loop(), includes PROFILE_AUDIO_HOOK
+    PROFILE_AUDIO_HOOK,         // Decoded PCM processing
+    PROFILE_MEME_OVERLAY,
+    PROFILE_AUDIO_COMMANDS,
+    PROFILE_VOLUME_CONTROL,
+    PROFILE_PROGRAM_PLAYBACK,
+    PROFILE_STATE_SNAPSHOT,
+    // Web task
+    PROFILE_WEB_CONTROL,        // handleWebControl(), includes the request stages below
+    PROFILE_HTTP_ROUTE,         // Control route handlers
+    PROFILE_HTTP_STATIC,        // Static assets
+    PROFILE_STATUS_EVENTS,
+    PROFILE_STAGE_COUNT
+};
+
+// Stages before this one run on the audio loop
+#define PROFILE_FIRST_WEB_STAGE PROFILE_WEB_CONTROL
+
+#define PROFILE_BUCKETS 32
+
+struct ProfileHistogram {
+    uint32_t buckets[PROFILE_BUCKETS];
+    uint32_t count;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+};
+
+/**
+ * @brief Stage name as shown on /metrics, "unknown" for PROFILE_STAGE_COUNT
+ */
+const char* getProfileStageName(ProfileStage stage);
+
+#if PROFILER_ENABLED
+
+#include <esp_cpu.h>
+
+/**
+ * @brief Note that an audio loop stage started
+ */
+void enterLoopStage(ProfileStage stage, uint32_t startCycles);
+
+/**
+ * @brief Record one sample for a stage
+ */
+void recordProfileSample(ProfileStage stage, uint32_t startCycles, uint32_t endCycles);
+
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileStage stage) : stage_(stage), start_(esp_cpu_get_cycle_count()) {
+        if (stage < PROFILE_FIRST_WEB_STAGE) enterLoopStage(stage, start_);
+    }
+    ~ProfileScope() { recordProfileSample(stage_, start_, esp_cpu_get_cycle_count()); }
+
+private:
+    ProfileStage stage_;
+    uint32_t start_;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(stage) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(stage)
+
+/**
+ * @brief Copy of a stage's histogram
+ */
+ProfileHistogram getProfileHistogram(ProfileStage stage);
+
+/**
+ * @brief Clear all histograms
+ * @details Samples recorded by the other core while clearing may be lost.
+ */
+void resetProfile();
+
+/**
+ * @brief Upper bound in cycles of the bucket holding the given percentile
+ * @param percent 1..100
+ */
+uint32_t getProfilePercentile(const ProfileHistogram& histogram, int percent);
+
+/**
+ * @brief Innermost audio loop stage that was running at a moment (audio loop only)
+ * @param cycles Cycle count of the moment, within the last few loop iterations
+ * @return PROFILE_STAGE_COUNT if the moment is older than the kept spans
+ */
+ProfileStage getLoopStageAt(uint32_t cycles);
+
+#else
+
+#define PROFILE_SCOPE(stage) ((void)0)
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * @file program_events.cpp
+ * @brief Event queue and timer for the program state machines.
+ */
+
+#include "program_events.h"
+#include "spsc_queue.h"
+#include "logger.h"
+
+static constexpr LogTag LOG_TAG = LOG_TAG_PROGRAM;
+
+static const char* const EVENT_NAMES[PROGRAM_EVENT_COUNT] = {
+    "trackEnded", "timer", "streamConnected", "error", "command"
+};
+
+// Posted and taken by the audio task; the queue only keeps events in order
+static SpscQueue<ProgramEvent, PROGRAM_EVENT_QUEUE_DEPTH> eventQueue;
+static bool timerArmed = false;
+static uint32_t timerDeadline = 0;     // millis()
+static ProgramEventStats stats = {};
+
+const char* getProgramEventName(ProgramEventType type) {
+    return type < PROGRAM_EVENT_COUNT ? EVENT_NAMES[type] : "unknown";
+}
+
+void postProgramEvent(ProgramEventType type, int32_t arg) {
+    ProgramEvent event = {type, arg, nullptr};
+    if (!eventQueue.push(event)) {
+        stats.dropped++;
+        LOG_W("Program event queue full, %s dropped", getProgramEventName(type));
+    }
+}
+
+void scheduleProgramTimer(uint32_t delayMs) {
+    timerDeadline = millis() + delayMs;
+    timerArmed = true;
+}
+
+void cancelProgramTimer() {
+    timerArmed = false;
+}
+
+void clearProgramEvents() {
+    ProgramEvent event;
+    while (eventQueue.pop(event)) {
+    }
+    timerArmed = false;
+}
+
+void notePlaybackEnded() {
+    postProgramEvent(PROGRAM_EVENT_TRACK_ENDED);
+}
+
+bool nextProgramEvent(ProgramEvent& event) {
+    if (eventQueue.pop(event)) {
+        return true;
+    }
+    if (timerArmed && (int32_t)(millis() - timerDeadline) >= 0) {
+        timerArmed = false;
+        event = {PROGRAM_EVENT_TIMER, 0, nullptr};
+        return true;
+    }
+    return false;
+}
+
+void noteProgramEventDelivered(ProgramEventType type) {
+    if (type < PROGRAM_EVENT_COUNT) stats.delivered[type]++;
+}
+
+uint32_t getProgramIdleMs() {
+    if (eventQueue.size() > 0) return 0;
+    if (!timerArmed) return UINT32_MAX;
+    int32_t remaining = (int32_t)(timerDeadline - millis());
+    return remaining > 0 ? remaining : 0;
+}
+
+void noteProgramIdleSleep(uint32_t sleptMs) {
+    stats.idleSleeps++;
+    stats.idleMs += sleptMs;
+}
+
+ProgramEventStats getProgramEventStats() {
+    return stats;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file program_events.h
+ * @brief Events that drive the program state machines
+ * @details Programs do not poll the decoder or the clock. The audio task posts
+ *          an event when something happens - the decoder finished a track on
+ *          its own, a program timer expired, a stream connected or failed, a
+ *          user command arrived - and radio_manager hands it to the active
+ *          program. With no event pending and nothing playing, the audio task
+ *          sleeps until the next timer or command.
+ *
+ *          Everything here runs on the audio task, except the statistics.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "audio_commands.h"
+
+#define PROGRAM_EVENT_QUEUE_DEPTH 8
+
+enum ProgramEventType : uint8_t {
+    PROGRAM_EVENT_TRACK_ENDED,      // Decoder went idle by itself: end of file or stream lost
+    PROGRAM_EVENT_TIMER,            // The program's timer expired: note due, retry or reconnect backoff
+    PROGRAM_EVENT_STREAM_CONNECTED,
+    PROGRAM_EVENT_ERROR,            // arg = ProgramError
+    PROGRAM_EVENT_COMMAND,          // command = user command for the active program
+    PROGRAM_EVENT_COUNT
+};
+
+enum ProgramError : uint8_t {
+    PROGRAM_ERROR_PLAY_FAILED,      // File missing or not decodable
+    PROGRAM_ERROR_NO_FILES,         // Nothing to play in the configured folder or soundfont
+    PROGRAM_ERROR_CONNECT_FAILED    // Stream host did not answer
+};
+
+struct ProgramEvent {
+    ProgramEventType type;
+    int32_t arg;
+    const AudioCommand* command;    // PROGRAM_EVENT_COMMAND only, valid while the event is handled
+};
+
+struct ProgramEventStats {
+    uint32_t delivered[PROGRAM_EVENT_COUNT];
+    uint32_t dropped;               // Posted while the queue was full
+    uint32_t idleSleeps;            // Times the audio task slept waiting for an event
+    uint32_t idleMs;                // Total time it slept
+};
+
+/**
+ * @brief Event name as shown on /metrics and in traces
+ */
+const char* getProgramEventName(ProgramEventType type);
+
+/**
+ * @brief Queue an event for the active program
+ */
+void postProgramEvent(ProgramEventType type, int32_t arg = 0);
+
+/**
+ * @brief Arm the program timer, replacing any earlier deadline
+ * @param delayMs Milliseconds until PROGRAM_EVENT_TIMER, 0 for the next dispatch
+ */
+void scheduleProgramTimer(uint32_t delayMs);
+
+/**
+ * @brief Disarm the program timer
+ */
+void cancelProgramTimer();
+
+/**
+ * @brief Drop queued events and the timer - they belong to the program being left
+ */
+void clearProgramEvents();
+
+/**
+ * @brief Note that the decoder stopped inside audio.loop(), i.e. not by a command
+ */
+void notePlaybackEnded();
+
+/**
+ * @brief Take the next event: queued events first, then an expired timer
+ * @return false if there is nothing to handle yet
+ */
+bool nextProgramEvent(ProgramEvent& event);
+
+/**
+ * @brief Count an event as handled
+ */
+void noteProgramEventDelivered(ProgramEventType type);
+
+/**
+ * @brief How long nothing will happen unless a command arrives
+ * @return 0 if an event is pending, UINT32_MAX if no timer is armed
+ */
+uint32_t getProgramIdleMs();
+
+/**
+ * @brief Account for time the audio task slept waiting for an event
+ */
+void noteProgramIdleSleep(uint32_t sleptMs);
+
+/**
+ * @brief Event counters, possibly torn when read from another task
+ */
+ProgramEventStats getProgramEventStats();
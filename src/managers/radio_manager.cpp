@@ -7,23 +7,51 @@
 #include "stream_manager.h"
 #include "shuffle_manager.h"
 #include "generative_manager.h"
+#include "timeshift_manager.h"
+#include "state_snapshot.h"
+#include "memory_monitor.h"
+#include "program_events.h"
 #include "../hardware/hardware_setup.h"
 #include "../config/musicdata.h"
+#include "logger.h"
+#include "tracer.h"
 #include <SD.h>
 #include <vector>
 
+static constexpr LogTag LOG_TAG = LOG_TAG_PROGRAM;
+
 // Global program state - simplified
 static ProgramState programState = {
     .currentProgram = GENERATIVE_PROGRAM,
     .programActive = false
 };
 
+// State machine hooks per program, indexed by RadioProgram
+struct ProgramHooks {
+    const char* name;
+    MemoryTag memoryTag;
+    void (*enter)(const String& parameter);
+    void (*exit)();
+    bool (*handleEvent)(const ProgramEvent& event);   // false if the program ignores the event
+};
 
+static const ProgramHooks PROGRAM_HOOKS[] = {
+    {"SHUFFLE",    MEM_TAG_SHUFFLE,    enterShuffleProgram,    exitShuffleProgram,    handleShuffleEvent},
+    {"GENERATIVE", MEM_TAG_GENERATIVE, enterGenerativeProgram, exitGenerativeProgram, handleGenerativeEvent},
+    {"STREAM",     MEM_TAG_STREAM,     enterStreamProgram,     exitStreamProgram,     handleStreamEvent},
+};
 
-// Declare helper functions for program modes
-void handleShuffleProgramMode(const String& parameter);
-void handleGenerativeProgramMode();
-void handleStreamProgramMode(const String& parameter);
+/**
+ * @brief Hand one event to the active program.
+ * @return false if the program ignored it
+ */
+static bool deliverProgramEvent(const ProgramEvent& event) {
+    const ProgramHooks& hooks = PROGRAM_HOOKS[programState.currentProgram];
+    MEMORY_TAG(hooks.memoryTag);
+    TRACE_INSTANT(TRACE_PROGRAM, getProgramEventName(event.type), hooks.name);
+    noteProgramEventDelivered(event.type);
+    return hooks.handleEvent(event);
+}
 
 /**
  * @brief Sets the radio program mode and initializes program state.
@@ -34,43 +62,41 @@ void setProgramMode(RadioProgram program, const String& parameter) {
 
     // Set new program
     programState.currentProgram = program;
-    programState.programActive = false;
 
-    Serial.print("Program mode set to: ");
-    switch (program) {
-        case SHUFFLE_PROGRAM:
-            handleShuffleProgramMode(parameter);
-            break;
-
-        case GENERATIVE_PROGRAM:
-            handleGenerativeProgramMode();
-            break;
-
-        case STREAM_PROGRAM:
-            handleStreamProgramMode(parameter);
-            break;
+    const ProgramHooks& hooks = PROGRAM_HOOKS[program];
+    LOG_I("Program mode set to: %s", hooks.name);
+    {
+        MEMORY_TAG(hooks.memoryTag);
+        hooks.enter(parameter);
     }
+    programState.programActive = true;
 
-    Serial.println("Program initialization complete");
+    LOG_I("Program initialization complete");
 }
 
 /**
- * @brief Handles playback logic based on the current program.
+ * @brief Hands pending program events to the active program.
  */
 void handleProgramPlayback() {
-    switch (programState.currentProgram) {
-        case SHUFFLE_PROGRAM:
-            handleShuffleProgram();
-            break;
-            
-        case GENERATIVE_PROGRAM:
-            handleGenerativeProgram();
-            break;
-            
-        case STREAM_PROGRAM:
-            handleStreamProgram();
-            break;
+    ProgramEvent event;
+    while (nextProgramEvent(event)) {
+        // Stopped: nothing to drive until a program is set again
+        if (!programState.programActive) continue;
+        deliverProgramEvent(event);
+    }
+}
+
+void deliverProgramCommand(const AudioCommand& command) {
+    ProgramEvent event = {PROGRAM_EVENT_COMMAND, command.arg, &command};
+    if (programState.programActive && deliverProgramEvent(event)) {
+        return;
+    }
+    if (command.type == CMD_STREAM_CONNECT) {
+        // Connecting to a stream is a request to listen to it, whatever was playing
+        setProgramMode(STREAM_PROGRAM, command.text);
+        return;
     }
+    LOG_I("Command %d ignored by the %s program", command.type, PROGRAM_HOOKS[programState.currentProgram].name);
 }
 
 /**
@@ -98,17 +124,22 @@ bool isPlaybackActive() {
  * @brief Stops the current program and resets state.
  */
 void stopPlayback() {
-    Serial.println("Stopping playback");
+    LOG_I("Stopping playback");
     
-    // Stop audio
+    // Leave the running program before pulling the audio out from under it
+    if (programState.programActive) {
+        const ProgramHooks& hooks = PROGRAM_HOOKS[programState.currentProgram];
+        MEMORY_TAG(hooks.memoryTag);
+        hooks.exit();
+    }
+
+    // Stop audio and any recording of the previous stream
     audio.stopSong();
+    stopTimeshift();
     
-    // Reset program state
+    // Reset program state; anything still queued was meant for the old program
     programState.programActive = false;
-    
-    // Reset module states
-    getGenerativeState().generativeActive = false;
-    getStreamState().streamConnected = false;
+    clearProgramEvents();
 }
 
 // Convenience functions
@@ -120,35 +151,12 @@ void playDirectFile(const String& filename) {
     if (filename.startsWith("/")) {
         // SD card file
         setProgramMode(SHUFFLE_PROGRAM);
-        Serial.println("Playing direct file from SD: " + filename);
+        LOG_I("Playing direct file from SD: %s", filename.c_str());
         audio.connecttoFS(SD, filename.c_str());
+        noteTrackStarted(filename.c_str());
         programState.programActive = true;
     } else {
         // Web URL - use stream program
         setProgramMode(STREAM_PROGRAM, filename);
     }
 }
-
-void handleShuffleProgramMode(const String& parameter) {
-    Serial.println("SHUFFLE");
-    buildShuffleQueue(parameter.length() > 0 ? parameter : "/music");
-    programState.programActive = true;
-}
-
-void handleGenerativeProgramMode() {
-    Serial.println("GENERATIVE");
-    playSequence(); // This sets generativeActive and programActive
-    programState.programActive = true;
-}
-
-void handleStreamProgramMode(const String& parameter) {
-    Serial.println("STREAM");
-    if (parameter.length() > 0) {
-        connectToStream(parameter);
-    } else {
-        String defaultURL = getDefaultStreamURL();
-        Serial.println("DEBUG: Default stream URL from musicdata.h: " + defaultURL);
-        connectToStream(defaultURL);
-    }
-    programState.programActive = isStreamConnected();
-}
@@ -1,11 +1,15 @@
 /**
  * @file radio_manager.h
  * @brief Header file for managing radio program playback modes.
+ * @details Each program is a state machine with enter and exit hooks and an
+ *          event handler (see program_events.h). Switching programs runs the
+ *          old program's exit hook, then the new one's enter hook.
  */
 
 #pragma once
 
 #include "Arduino.h"
+#include "audio_commands.h"
 #include <vector>
 
 // Radio program modes
@@ -47,10 +51,16 @@ struct ProgramState {
 void setProgramMode(RadioProgram program, const String& parameter = "");
 
 /**
- * @brief Handles playback logic based on the current program.
+ * @brief Hands pending program events to the current program (audio task only).
+ * @details Returns at once when no event is pending; programs do no work between events.
  */
 void handleProgramPlayback();
 
+/**
+ * @brief Hands a user command to the current program as PROGRAM_EVENT_COMMAND (audio task only).
+ */
+void deliverProgramCommand(const AudioCommand& command);
+
 /**
  * @brief Gets the current program state.
  * @return Reference to the current program state.
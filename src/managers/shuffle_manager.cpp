@@ -4,9 +4,15 @@
  */
 
 #include "shuffle_manager.h"
+#include "state_snapshot.h"
 #include "../hardware/hardware_setup.h"
+#include "logger.h"
 #include <SD.h>
 
+static constexpr LogTag LOG_TAG = LOG_TAG_SHUFFLE;
+
+#define SHUFFLE_RETRY_MS 500    // After a track that would not start
+
 // Shuffle state
 static ShuffleState shuffleState = {
     .shuffleQueue = std::vector<String>(),
@@ -24,7 +30,7 @@ ShuffleState& getShuffleState() {
  * @brief Builds shuffle queue from music folder.
  */
 void buildShuffleQueue(const String& musicFolder) {
-    Serial.println("Building shuffle queue from: " + musicFolder);
+    LOG_I("Building shuffle queue from: %s", musicFolder.c_str());
     
     // Clear existing queue
     shuffleState.shuffleQueue.clear();
@@ -33,19 +39,19 @@ void buildShuffleQueue(const String& musicFolder) {
     
     // Check if SD card is available
     if (!SD.begin()) {
-        Serial.println("ERROR: SD card not available for shuffle queue");
+        LOG_E("SD card not available for shuffle queue");
         return;
     }
     
     // Open the music folder
     File dir = SD.open(musicFolder);
     if (!dir) {
-        Serial.println("ERROR: Could not open music folder: " + musicFolder);
+        LOG_E("Could not open music folder: %s", musicFolder.c_str());
         return;
     }
     
     if (!dir.isDirectory()) {
-        Serial.println("ERROR: " + musicFolder + " is not a directory");
+        LOG_E("%s is not a directory", musicFolder.c_str());
         dir.close();
         return;
     }
@@ -69,7 +75,7 @@ void buildShuffleQueue(const String& musicFolder) {
             filename.endsWith(".aac") || filename.endsWith(".AAC")) {
             
             shuffleState.shuffleQueue.push_back(fullPath);
-            Serial.println("Added to shuffle queue: " + fullPath);
+            LOG_D("Added to shuffle queue: %s", fullPath.c_str());
         }
         
         entry.close();
@@ -77,16 +83,16 @@ void buildShuffleQueue(const String& musicFolder) {
     
     dir.close();
     
-    Serial.println("Shuffle queue built with " + String(shuffleState.shuffleQueue.size()) + " files");
+    LOG_I("Shuffle queue built with %zu files", shuffleState.shuffleQueue.size());
 }
 
 /**
  * @brief Plays the next track in shuffle mode.
  */
-void playNextShuffleTrack() {
+bool playNextShuffleTrack() {
     if (shuffleState.shuffleQueue.empty()) {
-        Serial.println("Shuffle queue is empty");
-        return;
+        LOG_I("Shuffle queue is empty");
+        return false;
     }
     
     // Select random track, avoiding recently played
@@ -110,26 +116,69 @@ void playNextShuffleTrack() {
         }
     } while (attempts < maxAttempts);
     
-    // Add to recently played list
+    // Play the selected file
+    LOG_I("Playing shuffle track: %s", selectedFile.c_str());
+    if (!audio.connecttoFS(SD, selectedFile.c_str())) {
+        LOG_W("Failed to play: %s", selectedFile.c_str());
+        return false;
+    }
+    noteTrackStarted(selectedFile.c_str());
+    
+    // Add to recently played list; a file that failed to open was not heard,
+    // and counting it would let the retry pick the track that just played
     shuffleState.recentlyPlayed.push_back(selectedFile);
     
     // Keep recently played list manageable
     if (shuffleState.recentlyPlayed.size() > 5) {
         shuffleState.recentlyPlayed.erase(shuffleState.recentlyPlayed.begin());
     }
-    
-    // Play the selected file
-    Serial.println("Playing shuffle track: " + selectedFile);
-    audio.connecttoFS(SD, selectedFile.c_str());
+    return true;
 }
 
 /**
- * @brief Handles SHUFFLE program logic.
+ * @brief Play the next track, retrying shortly if it does not start.
  */
-void handleShuffleProgram() {
-    // Check if current song finished and auto-advance is enabled
-    if (!audio.isRunning() && shuffleState.shuffleAutoAdvance && !shuffleState.shuffleQueue.empty()) {
-        playNextShuffleTrack();
+static void advanceShuffle() {
+    if (!playNextShuffleTrack() && !shuffleState.shuffleQueue.empty()) {
+        // No track running means no end event - the timer is the only way on
+        scheduleProgramTimer(SHUFFLE_RETRY_MS);
+    }
+}
+
+void enterShuffleProgram(const String& parameter) {
+    shuffleState.musicFolder = parameter.length() > 0 ? parameter : "/music";
+    buildShuffleQueue(shuffleState.musicFolder);
+    advanceShuffle();
+}
+
+void exitShuffleProgram() {
+    cancelProgramTimer();
+}
+
+/**
+ * @brief SHUFFLE state machine: play, wait for the track to end, play the next one.
+ */
+bool handleShuffleEvent(const ProgramEvent& event) {
+    switch (event.type) {
+        case PROGRAM_EVENT_TRACK_ENDED:
+        case PROGRAM_EVENT_TIMER:
+            if (shuffleState.shuffleAutoAdvance) advanceShuffle();
+            return true;
+        case PROGRAM_EVENT_COMMAND:
+            if (event.command->type == CMD_SHUFFLE_NEXT) {
+                advanceShuffle();
+                return true;
+            }
+            if (event.command->type == CMD_SHUFFLE_FOLDER) {
+                shuffleState.musicFolder = event.command->text;
+                buildShuffleQueue(shuffleState.musicFolder);
+                // The current track finishes first; with nothing playing there is no end to wait for
+                if (!audio.isRunning()) advanceShuffle();
+                return true;
+            }
+            return false;
+        default:
+            return false;
     }
 }
 
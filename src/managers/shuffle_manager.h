@@ -1,14 +1,19 @@
 #pragma once
 
 #include "Arduino.h"
+#include "program_events.h"
 #include <vector>
 
 // Shuffle playback functions
 void buildShuffleQueue(const String& musicFolder);
-void playNextShuffleTrack();
-void handleShuffleProgram();
+bool playNextShuffleTrack();
 void playRandomFile(const String& musicFolder = "/music");
 
+// SHUFFLE program hooks, called by radio_manager
+void enterShuffleProgram(const String& parameter);
+void exitShuffleProgram();
+bool handleShuffleEvent(const ProgramEvent& event);
+
 // Shuffle state management
 struct ShuffleState {
     std::vector<String> shuffleQueue;
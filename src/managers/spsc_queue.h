@@ -0,0 +1,78 @@
+/**
+ * @file spsc_queue.h
+ * @brief Bounded lock-free single-producer/single-consumer queue
+ * @details One task pushes, one task pops; no locks and no allocation.
+ *          Capacity must be a power of two.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    /**
+     * @brief Push an item (producer side only)
+     * @return false if the queue is full
+     */
+    bool push(const T& item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        items_[head & (Capacity - 1)] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Push several items as one unit (producer side only)
+     * @details The consumer sees either none or all of them, in order.
+     * @return false if there is not room for all items - nothing is pushed
+     */
+    bool pushAll(const T* items, size_t count) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (Capacity - (head - tail_.load(std::memory_order_acquire)) < count) {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            items_[(head + i) & (Capacity - 1)] = items[i];
+        }
+        head_.store(head + count, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pop the oldest item (consumer side only)
+     * @return false if the queue is empty
+     */
+    bool pop(T& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items_[tail & (Capacity - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Approximate number of queued items
+     */
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return Capacity;
+    }
+
+private:
+    T items_[Capacity];
+    std::atomic<size_t> head_{0};
+    std::atomic<size_t> tail_{0};
+};
@@ -0,0 +1,82 @@
+/**
+ * @file state_snapshot.cpp
+ * @brief Seqlock-published playback state snapshot.
+ */
+
+#include "state_snapshot.h"
+#include "stream_manager.h"
+#include "timeshift_manager.h"
+#include "../hardware/hardware_setup.h"
+#include "../hardware/i2s_health.h"
+#include "tracer.h"
+#include <atomic>
+
+// Odd sequence = write in progress. Single writer (audio loop), any number of readers.
+static std::atomic<uint32_t> snapshotSequence{0};
+static StateSnapshot snapshot = {
+    .currentProgram = GENERATIVE_PROGRAM,
+    .programActive = false,
+    .audioRunning = false,
+    .streamConnected = false,
+    .timeshiftActive = false,
+    .audioFilePos = 0,
+    .audioBufferFill = 100,
+    .loopCount = 0,
+    .trackSerial = 0,
+    .trackName = ""
+};
+
+// Last start seen by the audio loop, copied into the next snapshot
+static uint32_t trackSerial = 0;
+static char trackName[SNAPSHOT_TRACK_NAME_LEN] = "";
+
+void noteTrackStarted(const char* name) {
+    TRACE_INSTANT(TRACE_PROGRAM, "start", name);
+
+    // Keep the tail - the file name is more useful than the folder
+    size_t length = strlen(name);
+    if (length >= sizeof(trackName)) {
+        name += length - (sizeof(trackName) - 1);
+    }
+    strlcpy(trackName, name, sizeof(trackName));
+    trackSerial++;
+    restartI2sHealthModel();
+}
+
+void publishStateSnapshot() {
+    ProgramState& state = getProgramState();
+    bool running = audio.isRunning();
+
+    StateSnapshot next;
+    next.currentProgram = state.currentProgram;
+    next.programActive = state.programActive;
+    next.audioRunning = running;
+    next.streamConnected = isStreamConnected();
+    next.timeshiftActive = isTimeshiftActive();
+    next.audioFilePos = running ? audio.getFilePos() : 0;
+    next.audioBufferFill = 100;
+    if (running) {
+        uint32_t filled = audio.inBufferFilled();
+        uint32_t size = filled + audio.inBufferFree();
+        if (size > 0) next.audioBufferFill = (uint8_t)((uint64_t)filled * 100 / size);
+    }
+    next.loopCount = snapshot.loopCount + 1;
+    next.trackSerial = trackSerial;
+    memcpy(next.trackName, trackName, sizeof(trackName));
+
+    snapshotSequence.fetch_add(1, std::memory_order_acq_rel);
+    snapshot = next;
+    snapshotSequence.fetch_add(1, std::memory_order_release);
+}
+
+StateSnapshot getStateSnapshot() {
+    StateSnapshot copy;
+    uint32_t before, after;
+    do {
+        before = snapshotSequence.load(std::memory_order_acquire);
+        copy = snapshot;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = snapshotSequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    return copy;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file state_snapshot.h
+ * @brief Consistent read-only view of playback state for other tasks
+ * @details The audio loop owns ProgramState and the audio engine. Once per
+ *          iteration it publishes a copy here; the web task reads that copy
+ *          instead of touching the live state.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "radio_manager.h"
+
+#define SNAPSHOT_TRACK_NAME_LEN 64
+
+// Playback state as seen from outside the audio loop
+struct StateSnapshot {
+    RadioProgram currentProgram;
+    bool programActive;
+    bool audioRunning;
+    bool streamConnected;
+    bool timeshiftActive;
+    uint32_t audioFilePos;   // Decoder position in the current file
+    uint8_t audioBufferFill; // Decoder input buffer fill in percent, 100 when idle
+    uint32_t loopCount;      // Audio loop iterations, useful to spot a stalled loop
+    uint32_t trackSerial;    // Bumped on every track, note or stream start
+    char trackName[SNAPSHOT_TRACK_NAME_LEN];   // File name or stream URL of the last start
+};
+
+/**
+ * @brief Record that a track, note or stream started (audio loop only)
+ * @param name File path or stream URL, published with the next snapshot
+ */
+void noteTrackStarted(const char* name);
+
+/**
+ * @brief Publish the current playback state (audio loop only)
+ */
+void publishStateSnapshot();
+
+/**
+ * @brief Get a consistent copy of the last published state (any task)
+ */
+StateSnapshot getStateSnapshot();
@@ -6,10 +6,21 @@
 #include "stream_manager.h"
 #include "../hardware/hardware_setup.h"
 #include "../config/musicdata.h"
+#include "timeshift_manager.h"
+#include "state_snapshot.h"
+#include "catalog_manager.h"
+#include "logger.h"
+#include "tracer.h"
+
+static constexpr LogTag LOG_TAG = LOG_TAG_STREAM;
+
+#define STREAM_MAX_RECONNECT_ATTEMPTS 3
+#define STREAM_RECONNECT_DELAY_MS 2000
 
 // Stream state
 static StreamState streamState = {
     .currentStreamURL = "",
+    .phase = STREAM_IDLE,
     .streamConnected = false,
     .reconnectAttempts = 0,
     .availableStreams = std::vector<String>()
@@ -27,61 +38,67 @@ bool isStreamConnected() {
  * @brief Connects to a stream URL.
  */
 void connectToStream(const String& url) {
-    Serial.println("=== STREAM CONNECTION ATTEMPT ===");
-    Serial.println("Connecting to stream: " + url);
+    TRACE_SCOPE_DETAIL(TRACE_STREAM, "stream.connect", url.c_str());
+    LOG_I("=== STREAM CONNECTION ATTEMPT ===");
+    LOG_I("Connecting to stream: %s", url.c_str());
     
     // Stop any current playback first
     audio.stopSong();
-    delay(500);
     
     streamState.currentStreamURL = url;
     streamState.streamConnected = false;
     streamState.reconnectAttempts = 0;
     
-    Serial.println("Attempting to connect to host...");
+    LOG_I("Attempting to connect to host...");
     
     // Attempt to connect
     if (audio.connecttohost(url.c_str())) {
         streamState.streamConnected = true;
-        Serial.println("✓ Stream connected successfully!");
-        Serial.println("Audio volume: " + String(audio.getVolume()));
-        delay(1000);
+        noteTrackStarted(url.c_str());
+        LOG_I("✓ Stream connected successfully!");
+        LOG_D("Audio volume: %d", audio.getVolume());
+        postProgramEvent(PROGRAM_EVENT_STREAM_CONNECTED);
     } else {
-        Serial.println("✗ Failed to connect to stream");
+        LOG_W("✗ Failed to connect to stream");
         streamState.reconnectAttempts++;
+        postProgramEvent(PROGRAM_EVENT_ERROR, PROGRAM_ERROR_CONNECT_FAILED);
     }
     
-    Serial.println("=== END STREAM CONNECTION ===");
+    LOG_I("=== END STREAM CONNECTION ===");
 }
 
 /**
  * @brief Handles stream reconnection logic.
  */
 void handleStreamReconnection() {
-    if (streamState.currentStreamURL.length() > 0 && streamState.reconnectAttempts < 3) {
-        Serial.println("Attempting stream reconnection (" + String(streamState.reconnectAttempts + 1) + "/3)");
+    if (streamState.currentStreamURL.length() > 0 && streamState.reconnectAttempts < STREAM_MAX_RECONNECT_ATTEMPTS) {
+        LOG_I("Attempting stream reconnection (%d/%d)", streamState.reconnectAttempts + 1,
+              STREAM_MAX_RECONNECT_ATTEMPTS);
+        TRACE_SCOPE_DETAIL(TRACE_STREAM, "stream.reconnect", streamState.currentStreamURL.c_str());
         
+        // The backoff already passed on the program timer
         audio.stopSong();
-        delay(2000);
         
-        Serial.println("Clearing audio buffers before reconnection...");
+        LOG_I("Clearing audio buffers before reconnection...");
         
         if (audio.connecttohost(streamState.currentStreamURL.c_str())) {
             streamState.streamConnected = true;
-            Serial.println("Stream reconnected successfully");
-            delay(1500);
+            LOG_I("Stream reconnected successfully");
+            postProgramEvent(PROGRAM_EVENT_STREAM_CONNECTED);
         } else {
             streamState.reconnectAttempts++;
-            Serial.println("Stream reconnection failed (attempt " + String(streamState.reconnectAttempts) + ")");
+            LOG_W("Stream reconnection failed (attempt %d)", streamState.reconnectAttempts);
+            TRACE_VALUE(TRACE_STREAM, "stream.reconnectFailed", streamState.reconnectAttempts);
             
-            if (streamState.reconnectAttempts >= 3) {
-                Serial.println("All reconnection attempts failed, trying default stream...");
+            if (streamState.reconnectAttempts >= STREAM_MAX_RECONNECT_ATTEMPTS) {
+                LOG_W("All reconnection attempts failed, trying default stream...");
                 String defaultURL = getDefaultStreamURL();
                 if (defaultURL != streamState.currentStreamURL) {
                     streamState.currentStreamURL = defaultURL;
                     streamState.reconnectAttempts = 0;
                 }
             }
+            postProgramEvent(PROGRAM_EVENT_ERROR, PROGRAM_ERROR_CONNECT_FAILED);
         }
     }
 }
@@ -90,16 +107,16 @@ void handleStreamReconnection() {
  * @brief Try the next available stream if current one has issues.
  */
 void tryNextStream() {
-    Serial.println("=== TRYING NEXT STREAM ===");
+    LOG_I("=== TRYING NEXT STREAM ===");
     
     if (streamState.availableStreams.size() == 0) {
-        Serial.println("No alternative streams available");
+        LOG_I("No alternative streams available");
         return;
     }
     
     // Get current stream index
     int currentIndex = -1;
-    for (int i = 0; i < streamState.availableStreams.size(); i++) {
+    for (int i = 0; i < (int)streamState.availableStreams.size(); i++) {
         if (streamState.availableStreams[i] == streamState.currentStreamURL) {
             currentIndex = i;
             break;
@@ -110,45 +127,94 @@ void tryNextStream() {
     int nextIndex = (currentIndex + 1) % streamState.availableStreams.size();
     String nextURL = streamState.availableStreams[nextIndex];
     
-    Serial.println("Switching from index " + String(currentIndex) + " to " + String(nextIndex));
-    Serial.println("New stream: " + nextURL);
+    LOG_I("Switching from index %d to %d", currentIndex, nextIndex);
+    LOG_I("New stream: %s", nextURL.c_str());
     
     connectToStream(nextURL);
     
-    Serial.println("=== STREAM SWITCH COMPLETE ===");
+    LOG_I("=== STREAM SWITCH COMPLETE ===");
 }
 
 /**
- * @brief Handles STREAM program logic.
+ * @brief Reconnect after the backoff, or give up once the attempts are used.
  */
-void handleStreamProgram() {
-    static unsigned long lastErrorCheck = 0;
-    static int consecutiveErrors = 0;
-    
-    // Monitor stream connection
-    if (!streamState.streamConnected && streamState.reconnectAttempts < 3) {
-        handleStreamReconnection();
-        return;
+static void scheduleReconnect() {
+    if (streamState.reconnectAttempts < STREAM_MAX_RECONNECT_ATTEMPTS) {
+        streamState.phase = STREAM_RECONNECTING;
+        scheduleProgramTimer(STREAM_RECONNECT_DELAY_MS);
+    } else {
+        LOG_W("Stream unavailable, waiting for a new connect request");
+        streamState.phase = STREAM_FAILED;
     }
-    
-    // Check if stream is still active
-    if (streamState.streamConnected && !audio.isRunning()) {
-        Serial.println("Stream disconnected, attempting reconnection");
-        streamState.streamConnected = false;
-        streamState.reconnectAttempts++;
-        return;
+}
+
+void enterStreamProgram(const String& parameter) {
+    // Catalog stations are the fallback list for tryNextStream()
+    streamState.availableStreams = getCatalogStationURLs();
+    streamState.phase = STREAM_PLAYING;
+    if (parameter.length() > 0) {
+        connectToStream(parameter);
+    } else {
+        String defaultURL = getDefaultStreamURL();
+        LOG_D("Default stream URL from musicdata.h: %s", defaultURL.c_str());
+        connectToStream(defaultURL);
     }
-    
-    // Check for decode errors every 5 seconds
-    if (millis() - lastErrorCheck > 5000) {
-        lastErrorCheck = millis();
-        
-        // If we have persistent decode errors, try next stream
-        if (consecutiveErrors > 10) {
-            Serial.println("Too many consecutive decode errors, trying next stream...");
-            tryNextStream();
-            consecutiveErrors = 0;
-        }
+}
+
+void exitStreamProgram() {
+    streamState.phase = STREAM_IDLE;
+    streamState.streamConnected = false;
+    cancelProgramTimer();
+}
+
+/**
+ * @brief STREAM state machine.
+ * @details A lost stream or failed connect moves to RECONNECTING, which retries
+ *          on the timer until the attempts run out. While time-shifted, the end
+ *          of the recording is handed to the time-shift code instead.
+ */
+bool handleStreamEvent(const ProgramEvent& event) {
+    switch (event.type) {
+        case PROGRAM_EVENT_STREAM_CONNECTED:
+            streamState.phase = STREAM_PLAYING;
+            cancelProgramTimer();
+            return true;
+        case PROGRAM_EVENT_TRACK_ENDED:
+            // Paused or playing from the recording - the live stream is not on the decoder
+            if (isTimeshiftActive()) {
+                handleTimeshiftPlayback();
+                return true;
+            }
+            if (streamState.streamConnected) {
+                LOG_I("Stream disconnected, attempting reconnection");
+                streamState.streamConnected = false;
+                streamState.reconnectAttempts++;
+                scheduleReconnect();
+            }
+            return true;
+        case PROGRAM_EVENT_ERROR:
+            if (!isTimeshiftActive()) scheduleReconnect();
+            return true;
+        case PROGRAM_EVENT_TIMER:
+            if (streamState.phase == STREAM_RECONNECTING && !isTimeshiftActive()) {
+                handleStreamReconnection();
+            }
+            return true;
+        case PROGRAM_EVENT_COMMAND:
+            if (event.command->type == CMD_STREAM_CONNECT) {
+                connectToStream(event.command->text);
+                return true;
+            }
+            if (event.command->type == CMD_STREAM_RESET) {
+                clearStreamCache();
+                // Connect to the reloaded default right away
+                streamState.phase = STREAM_RECONNECTING;
+                scheduleProgramTimer(0);
+                return true;
+            }
+            return false;
+        default:
+            return false;
     }
 }
 
@@ -156,10 +222,9 @@ void handleStreamProgram() {
  * @brief Force clear any cached stream configuration.
  */
 void clearStreamCache() {
-    Serial.println("=== CLEARING STREAM CACHE ===");
+    LOG_I("=== CLEARING STREAM CACHE ===");
     
     audio.stopSong();
-    delay(500);
     
     streamState.currentStreamURL = "";
     streamState.streamConnected = false;
@@ -167,10 +232,8 @@ void clearStreamCache() {
     
     // Force reload default URL
     String newURL = getDefaultStreamURL();
-    Serial.println("Forced reload - new default URL: " + newURL);
+    LOG_I("Forced reload - new default URL: %s", newURL.c_str());
     streamState.currentStreamURL = newURL;
     
-    delay(100);
-    
-    Serial.println("=== STREAM CACHE CLEARED ===");
+    LOG_I("=== STREAM CACHE CLEARED ===");
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Arduino.h"
+#include "program_events.h"
 #include <vector>
 
 // Stream management functions
@@ -9,11 +10,24 @@ void handleStreamReconnection();
 void tryNextStream();
 void clearStreamCache();
 bool isStreamConnected();
-void handleStreamProgram();
+
+// STREAM program hooks, called by radio_manager
+void enterStreamProgram(const String& parameter);
+void exitStreamProgram();
+bool handleStreamEvent(const ProgramEvent& event);
+
+// Where the program is between events
+enum StreamPhase : uint8_t {
+    STREAM_IDLE,            // Program not running
+    STREAM_PLAYING,         // Live or time-shifted audio on the decoder
+    STREAM_RECONNECTING,    // Waiting out the backoff before the next attempt
+    STREAM_FAILED           // Out of attempts, waiting for a command
+};
 
 // Stream state management
 struct StreamState {
     String currentStreamURL;
+    StreamPhase phase;
     bool streamConnected;
     int reconnectAttempts;
     std::vector<String> availableStreams;
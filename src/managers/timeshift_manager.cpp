@@ -0,0 +1,371 @@
+/**
+ * @file timeshift_manager.cpp
+ * @brief Stream recorder with batched SD writes and time-shift playback.
+ *
+ * The audio library does not expose the compressed bytes it decodes, so the
+ * recorder taps the stream with its own connection. A network task fills a RAM
+ * stream buffer and never touches SD; a lower-priority writer task drains it in
+ * whole TIMESHIFT_WRITE_BLOCK blocks so every write is large and sector aligned,
+ * and the directory entry is only synced every few blocks to limit card wear.
+ * The recording is linear - once TIMESHIFT_MAX_BYTES is reached it stops.
+ */
+
+#include "timeshift_manager.h"
+#include "stream_manager.h"
+#include "state_snapshot.h"
+#include "program_events.h"
+#include "../hardware/hardware_setup.h"
+#include "../config/config.h"
+#include "logger.h"
+#include <SD.h>
+#include <HTTPClient.h>
+#include <WiFiClientSecure.h>
+#include <freertos/stream_buffer.h>
+#include <esp_task_wdt.h>
+
+static constexpr LogTag LOG_TAG = LOG_TAG_TIMESHIFT;
+
+#define TIMESHIFT_SYNC_BLOCKS 4 // Sync the FAT entry every 4 blocks (~4 s at 128 kbps)
+
+// Recorder state shared between the network task, the writer task and the loop
+static StreamBufferHandle_t recordBuffer = NULL;
+static uint8_t* writeBlock = NULL;
+static volatile bool recorderRunning = false;
+static volatile bool stopRequested = false;
+static volatile bool netDone = false;
+static String recordURL;
+
+static volatile uint32_t bytesReceived = 0;
+static volatile uint32_t bytesRecorded = 0;
+static volatile uint32_t bytesSynced = 0;   // Visible to a reader opening the file
+static volatile uint32_t droppedChunks = 0;
+static volatile uint32_t droppedBytes = 0;
+static volatile uint32_t writeCount = 0;
+static volatile uint32_t writeMicrosTotal = 0;
+static volatile uint32_t maxWriteMs = 0;
+static unsigned long recordStartedAt = 0;
+
+// Playback state - only touched from the loop that owns the audio object
+static bool paused = false;
+static bool playingShifted = false;
+static uint32_t pausePos = 0;      // Byte offset to resume from
+static uint32_t snapshotEnd = 0;   // File size the decoder saw when it opened the recording
+
+/**
+ * @brief Measured stream rate, falling back to 128 kbps until enough data arrived.
+ */
+static uint32_t bytesPerSecond() {
+    unsigned long elapsed = millis() - recordStartedAt;
+    if (!recorderRunning && bytesRecorded == 0) return TIMESHIFT_DEFAULT_BYTES_PER_SEC;
+    if (elapsed < 5000 || bytesReceived == 0) return TIMESHIFT_DEFAULT_BYTES_PER_SEC;
+    return (uint32_t)((uint64_t)bytesReceived * 1000 / elapsed);
+}
+
+/**
+ * @brief Network side of the recorder - pulls the stream into RAM, dropping on overflow.
+ */
+static void recordNetTask(void* parameter) {
+    HTTPClient http;
+    WiFiClient plainClient;
+    WiFiClientSecure secureClient;
+    uint8_t chunk[1024];
+
+    bool started;
+    if (recordURL.startsWith("https://")) {
+        secureClient.setInsecure();
+        started = http.begin(secureClient, recordURL);
+    } else {
+        started = http.begin(plainClient, recordURL);
+    }
+    http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
+
+    int code = started ? http.GET() : -1;
+    if (code != HTTP_CODE_OK) {
+        LOG_W("Recorder: stream request failed (%d)", code);
+    } else {
+        // Watched from here on; connecting is bounded by the HTTP client's own timeouts
+        esp_task_wdt_add(NULL);
+        WiFiClient* stream = http.getStreamPtr();
+        while (!stopRequested && (stream->connected() || stream->available())) {
+            esp_task_wdt_reset();
+            size_t available = stream->available();
+            if (available == 0) {
+                vTaskDelay(pdMS_TO_TICKS(10));
+                continue;
+            }
+            size_t n = stream->readBytes(chunk, min(available, sizeof(chunk)));
+            size_t sent = xStreamBufferSend(recordBuffer, chunk, n, 0);
+            if (sent < n) {
+                // Writer fell behind (SD stall) - drop rather than block the network
+                droppedChunks++;
+                droppedBytes += n - sent;
+            }
+            bytesReceived += sent;
+
+            if (bytesReceived >= TIMESHIFT_MAX_BYTES) {
+                LOG_I("Recorder: window limit reached, stopping");
+                stopRequested = true;
+            }
+        }
+        esp_task_wdt_delete(NULL);
+    }
+    http.end();
+    netDone = true;
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Write one block to SD and update throughput statistics.
+ */
+static bool writeRecordBlock(File& file, size_t length) {
+    unsigned long start = micros();
+    size_t written = file.write(writeBlock, length);
+    unsigned long elapsed = micros() - start;
+
+    writeCount++;
+    writeMicrosTotal += elapsed;
+    if (elapsed / 1000 > maxWriteMs) maxWriteMs = elapsed / 1000;
+    bytesRecorded += written;
+
+    if (written != length) {
+        LOG_W("Recorder: short SD write (%zu/%zu)", written, length);
+        return false;
+    }
+    if (writeCount % TIMESHIFT_SYNC_BLOCKS == 0) {
+        file.flush();
+        bytesSynced = bytesRecorded;
+    }
+    return true;
+}
+
+/**
+ * @brief SD side of the recorder - low priority, whole-block writes only.
+ */
+static void recordWriteTask(void* parameter) {
+    esp_task_wdt_add(NULL);
+    File file = SD.open(TIMESHIFT_FILE_PATH, FILE_WRITE);
+    if (!file) {
+        LOG_E("Recorder: unable to open %s", TIMESHIFT_FILE_PATH);
+        stopRequested = true;
+    }
+
+    size_t fill = 0;
+    bool writeFailed = false;
+    while (file && !writeFailed) {
+        esp_task_wdt_reset();
+        size_t n = xStreamBufferReceive(recordBuffer, writeBlock + fill,
+                                        TIMESHIFT_WRITE_BLOCK - fill, pdMS_TO_TICKS(200));
+        fill += n;
+
+        if (fill == TIMESHIFT_WRITE_BLOCK) {
+            writeFailed = !writeRecordBlock(file, fill);
+            fill = 0;
+        } else if (netDone && n == 0 && xStreamBufferIsEmpty(recordBuffer)) {
+            break;
+        }
+    }
+
+    if (file) {
+        // The tail is the only write that is not a whole block
+        if (fill > 0 && !writeFailed) writeRecordBlock(file, fill);
+        file.close();
+        bytesSynced = bytesRecorded;
+    }
+    if (writeFailed) stopRequested = true;
+
+    // Wait for the network task to let go of the buffer before freeing it
+    while (!netDone) {
+        esp_task_wdt_reset();
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    vStreamBufferDelete(recordBuffer);
+    recordBuffer = NULL;
+    free(writeBlock);
+    writeBlock = NULL;
+
+    LOG_I("Recorder: stopped, %u bytes on SD, %u dropped chunks", bytesRecorded, droppedChunks);
+    recorderRunning = false;
+    esp_task_wdt_delete(NULL);
+    vTaskDelete(NULL);
+}
+
+bool startRecording() {
+    StreamState& stream = getStreamState();
+    if (recorderRunning) {
+        LOG_I("Recorder: already running");
+        return false;
+    }
+    if (!stream.streamConnected || stream.currentStreamURL.length() == 0) {
+        LOG_I("Recorder: no live stream to record");
+        return false;
+    }
+
+    writeBlock = (uint8_t*)(psramFound() ? ps_malloc(TIMESHIFT_WRITE_BLOCK) : malloc(TIMESHIFT_WRITE_BLOCK));
+    recordBuffer = xStreamBufferCreate(TIMESHIFT_RING_BYTES, 1);
+    if (!writeBlock || !recordBuffer) {
+        LOG_I("Recorder: not enough memory for buffers");
+        free(writeBlock);
+        writeBlock = NULL;
+        if (recordBuffer) vStreamBufferDelete(recordBuffer);
+        recordBuffer = NULL;
+        return false;
+    }
+
+    if (!SD.exists("/rec")) SD.mkdir("/rec");
+
+    recordURL = stream.currentStreamURL;
+    bytesReceived = bytesRecorded = bytesSynced = 0;
+    droppedChunks = droppedBytes = 0;
+    writeCount = writeMicrosTotal = maxWriteMs = 0;
+    stopRequested = false;
+    netDone = false;
+    recorderRunning = true;
+    recordStartedAt = millis();
+
+    // Both on the system core, writer below the network reader
+    xTaskCreatePinnedToCore(recordNetTask, "recnet", 6144, NULL, RECORDER_NET_TASK_PRIORITY, NULL, SYSTEM_TASK_CORE);
+    xTaskCreatePinnedToCore(recordWriteTask, "recwrite", 4096, NULL, RECORDER_WRITE_TASK_PRIORITY, NULL,
+                            SYSTEM_TASK_CORE);
+
+    LOG_I("Recorder: recording %s to %s", recordURL.c_str(), TIMESHIFT_FILE_PATH);
+    return true;
+}
+
+void stopRecording() {
+    if (recorderRunning) {
+        stopRequested = true;
+    }
+}
+
+bool isRecording() {
+    return recorderRunning && !stopRequested;
+}
+
+/**
+ * @brief Point the decoder at the recording, starting at a byte offset.
+ */
+static bool playRecordingFrom(uint32_t pos) {
+    snapshotEnd = bytesSynced;
+    if (pos >= snapshotEnd) {
+        return false; // Nothing on SD past this point yet
+    }
+    if (!audio.connecttoFS(SD, TIMESHIFT_FILE_PATH)) {
+        LOG_W("Time-shift: unable to open recording");
+        return false;
+    }
+    audio.setFilePos(pos);
+    playingShifted = true;
+    paused = false;
+    return true;
+}
+
+bool pauseTimeshift() {
+    if (paused) return true;
+
+    if (playingShifted) {
+        pausePos = audio.getFilePos();
+        audio.stopSong();
+    } else {
+        if (!isRecording()) {
+            LOG_I("Time-shift: pause needs an active recording");
+            return false;
+        }
+        // Live edge - everything received so far will be on SD by the time we resume
+        pausePos = bytesReceived;
+        audio.stopSong();
+    }
+    playingShifted = false;
+    paused = true;
+    LOG_I("Time-shift: paused at byte %u", pausePos);
+    return true;
+}
+
+bool resumeTimeshift() {
+    if (!paused) return false;
+    if (!playRecordingFrom(pausePos)) {
+        // Paused for less time than one sync interval - the live stream is still the right place
+        goLive();
+        return true;
+    }
+    LOG_I("Time-shift: resumed %u s behind live", (bytesReceived - pausePos) / bytesPerSecond());
+    return true;
+}
+
+bool seekTimeshift(uint32_t seconds) {
+    if (bytesRecorded == 0) return false;
+    // In 64 bits: a long window at a high rate does not fit 32, and must not wrap back to the start
+    uint64_t pos = (uint64_t)seconds * bytesPerSecond();
+    if (pos >= bytesSynced) {
+        goLive();
+        return true;
+    }
+    if (paused) {
+        pausePos = (uint32_t)pos;
+        return true;
+    }
+    return playRecordingFrom((uint32_t)pos);
+}
+
+void goLive() {
+    bool wasShifted = playingShifted || paused;
+    playingShifted = false;
+    paused = false;
+    if (wasShifted) {
+        StreamState& stream = getStreamState();
+        LOG_I("Time-shift: returning to live stream");
+        audio.stopSong();
+        stream.streamConnected = audio.connecttohost(stream.currentStreamURL.c_str());
+        // The STREAM program takes over from here, reconnecting if the live stream is gone
+        if (stream.streamConnected) {
+            postProgramEvent(PROGRAM_EVENT_STREAM_CONNECTED);
+        } else {
+            postProgramEvent(PROGRAM_EVENT_ERROR, PROGRAM_ERROR_CONNECT_FAILED);
+        }
+    }
+}
+
+bool isTimeshiftActive() {
+    return paused || playingShifted;
+}
+
+void handleTimeshiftPlayback() {
+    if (!playingShifted || audio.isRunning()) {
+        return;
+    }
+    // Decoder reached the end of the file as it was when opened
+    if (bytesSynced > snapshotEnd) {
+        playRecordingFrom(snapshotEnd);
+    } else if (isRecording()) {
+        // Caught up with the writer - jump to live rather than stutter at the edge
+        goLive();
+    } else {
+        LOG_I("Time-shift: end of recording");
+        goLive();
+    }
+}
+
+void stopTimeshift() {
+    playingShifted = false;
+    paused = false;
+    stopRecording();
+}
+
+TimeshiftStats getTimeshiftStats() {
+    TimeshiftStats stats;
+    uint32_t rate = bytesPerSecond();
+    stats.recording = isRecording();
+    stats.paused = paused;
+    stats.playingShifted = playingShifted;
+    stats.bytesRecorded = bytesRecorded;
+    stats.bytesBuffered = bytesReceived > bytesRecorded ? bytesReceived - bytesRecorded : 0;
+    stats.windowSeconds = bytesRecorded / rate;
+    if (playingShifted) stats.positionSeconds = getStateSnapshot().audioFilePos / rate;
+    else if (paused) stats.positionSeconds = pausePos / rate;
+    else stats.positionSeconds = stats.windowSeconds;
+    stats.droppedChunks = droppedChunks;
+    stats.droppedBytes = droppedBytes;
+    stats.writeCount = writeCount;
+    stats.writeKBps = writeMicrosTotal > 0 ? (uint32_t)((uint64_t)bytesRecorded * 1000 / writeMicrosTotal) : 0;
+    stats.maxWriteMs = maxWriteMs;
+    return stats;
+}
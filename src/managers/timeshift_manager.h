@@ -0,0 +1,87 @@
+/**
+ * @file timeshift_manager.h
+ * @brief Stream recording and time-shift playback
+ * @details Records the compressed stream to SD with large batched writes on
+ *          low-priority tasks, and lets the STREAM program pause, resume and
+ *          seek within the recorded window.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+// Snapshot of recorder and time-shift state
+struct TimeshiftStats {
+    bool recording;
+    bool paused;
+    bool playingShifted;      // Decoder is playing the recording instead of the live stream
+    uint32_t bytesRecorded;   // Flushed to SD
+    uint32_t bytesBuffered;   // Received but still waiting in RAM
+    uint32_t windowSeconds;   // Length of the recorded window
+    uint32_t positionSeconds; // Playback position within the window
+    uint32_t droppedChunks;   // Network reads that did not fit in the RAM buffer
+    uint32_t droppedBytes;
+    uint32_t writeCount;      // Number of SD block writes
+    uint32_t writeKBps;       // Average SD write throughput
+    uint32_t maxWriteMs;      // Slowest single SD write
+};
+
+/**
+ * @brief Start recording the current stream to SD
+ * @return true if the recorder started
+ */
+bool startRecording();
+
+/**
+ * @brief Stop recording and flush the remaining buffered data
+ */
+void stopRecording();
+
+/**
+ * @brief Check if the recorder is running
+ */
+bool isRecording();
+
+/**
+ * @brief Pause playback, keeping the recording going underneath
+ * @return true if playback was paused
+ */
+bool pauseTimeshift();
+
+/**
+ * @brief Resume playback from where it was paused
+ * @return true if playback resumed
+ */
+bool resumeTimeshift();
+
+/**
+ * @brief Seek within the recorded window
+ * @param seconds Position from the start of the recording; past the recorded window goes live
+ * @return true if the seek was applied
+ */
+bool seekTimeshift(uint32_t seconds);
+
+/**
+ * @brief Return to the live stream
+ */
+void goLive();
+
+/**
+ * @brief Check if the STREAM program is paused or playing from the recording
+ */
+bool isTimeshiftActive();
+
+/**
+ * @brief Time-shift playback logic, called by the STREAM program when the decoder finishes while shifted
+ */
+void handleTimeshiftPlayback();
+
+/**
+ * @brief Stop recording and drop any time-shift playback state
+ */
+void stopTimeshift();
+
+/**
+ * @brief Get recorder and playback statistics
+ */
+TimeshiftStats getTimeshiftStats();
@@ -0,0 +1,156 @@
+/**
+ * @file tracer.cpp
+ * @brief Event tracer implementation
+ */
+
+#include "tracer.h"
+#include "logger.h"
+#include <esp_heap_caps.h>
+
+static constexpr LogTag LOG_TAG = LOG_TAG_SYSTEM;
+
+static_assert((TRACE_RING_EVENTS_PSRAM & (TRACE_RING_EVENTS_PSRAM - 1)) == 0, "TRACE_RING_EVENTS_PSRAM must be a power of two");
+static_assert((TRACE_RING_EVENTS_RAM & (TRACE_RING_EVENTS_RAM - 1)) == 0, "TRACE_RING_EVENTS_RAM must be a power of two");
+
+#if TRACER_ENABLED
+
+std::atomic<uint32_t> traceCategories{0};
+
+static TraceEvent* ring = nullptr;
+static uint32_t ringMask = 0;
+static std::atomic<uint32_t> writeIndex{0};
+
+// Tasks are numbered in the order they first record
+static std::atomic<TaskHandle_t> threadHandles[TRACE_MAX_THREADS];
+static char threadNames[TRACE_MAX_THREADS][configMAX_TASK_NAME_LEN];   // Copied, tasks may end
+
+static uint8_t currentThread() {
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (uint8_t i = 0; i < TRACE_MAX_THREADS; i++) {
+        TaskHandle_t handle = threadHandles[i].load(std::memory_order_acquire);
+        if (handle == self) return i;
+        if (handle == nullptr) {
+            TaskHandle_t expected = nullptr;
+            if (threadHandles[i].compare_exchange_strong(expected, self, std::memory_order_acq_rel)) {
+                strlcpy(threadNames[i], pcTaskGetName(self), sizeof(threadNames[i]));
+                return i;
+            }
+        }
+    }
+    return TRACE_MAX_THREADS - 1;
+}
+
+void recordTraceEvent(TraceCategory category, char phase, const char* name,
+                      const char* detail, uint32_t value, bool hasValue) {
+    TraceEvent& event = ring[writeIndex.fetch_add(1, std::memory_order_relaxed) & ringMask];
+    event.timeUs = micros();
+    event.name = name;
+    event.value = value;
+    event.category = category;
+    event.phase = phase;
+    event.thread = currentThread();
+    event.hasValue = hasValue;
+    if (detail) {
+        copyTraceDetail(event.detail, detail);
+    } else {
+        event.detail[0] = '\0';
+    }
+}
+
+bool startTrace(uint32_t categories) {
+    if (!ring) {
+        uint32_t events = psramFound() ? TRACE_RING_EVENTS_PSRAM : TRACE_RING_EVENTS_RAM;
+        uint32_t caps = psramFound() ? MALLOC_CAP_SPIRAM : MALLOC_CAP_8BIT;
+        ring = (TraceEvent*)heap_caps_calloc(events, sizeof(TraceEvent), caps);
+        if (!ring) {
+            LOG_E("Trace ring of %lu events could not be allocated", (unsigned long)events);
+            return false;
+        }
+        ringMask = events - 1;
+    }
+
+    traceCategories.store(0, std::memory_order_relaxed);
+    vTaskDelay(1);   // Let events already being written land before the ring is reused
+    writeIndex.store(0, std::memory_order_relaxed);
+    traceCategories.store(categories & TRACE_ALL_CATEGORIES, std::memory_order_release);
+    LOG_I("Tracing started, %lu event ring", (unsigned long)(ringMask + 1));
+    return true;
+}
+
+void stopTrace() {
+    traceCategories.store(0, std::memory_order_relaxed);
+}
+
+TraceStatus getTraceStatus() {
+    uint32_t recorded = writeIndex.load(std::memory_order_relaxed);
+    uint32_t capacity = ring ? ringMask + 1 : 0;
+    uint32_t categories = traceCategories.load(std::memory_order_relaxed);
+    return TraceStatus{categories != 0, categories, capacity, recorded,
+                       recorded > capacity ? recorded - capacity : 0};
+}
+
+size_t exportTrace(void (*sink)(const char* data, size_t length, void* context), void* context) {
+    stopTrace();
+    vTaskDelay(1);   // Writers that passed the enabled check before the stop finish their event
+
+    const char* names[TRACE_MAX_THREADS];
+    size_t threads = 0;
+    while (threads < TRACE_MAX_THREADS && threadHandles[threads].load(std::memory_order_acquire)) {
+        names[threads] = threadNames[threads];
+        threads++;
+    }
+
+    // Events are at most a couple of hundred bytes, so a chunk always holds at least one
+    char chunk[TRACE_SEND_CHUNK];
+    size_t length = writeTraceHeader(chunk, sizeof(chunk), "GhostWhisper", names, threads);
+    length = min(length, sizeof(chunk) - 1);
+
+    uint32_t total = writeIndex.load(std::memory_order_relaxed);
+    uint32_t count = ring ? min(total, ringMask + 1) : 0;
+    uint32_t first = total - count;
+    uint32_t originUs = count ? ring[first & ringMask].timeUs : 0;
+
+    for (uint32_t i = first; i != total; i++) {
+        const TraceEvent& event = ring[i & ringMask];
+        size_t needed = writeTraceEvent(chunk + length, sizeof(chunk) - length, event, originUs);
+        if (needed >= sizeof(chunk) - length) {
+            sink(chunk, length, context);
+            length = 0;
+            needed = writeTraceEvent(chunk, sizeof(chunk), event, originUs);
+        }
+        length += needed;
+    }
+
+    size_t needed = writeTraceFooter(chunk + length, sizeof(chunk) - length, total - count);
+    if (needed >= sizeof(chunk) - length) {
+        sink(chunk, length, context);
+        length = 0;
+        needed = writeTraceFooter(chunk, sizeof(chunk), total - count);
+    }
+    length += needed;
+    sink(chunk, length, context);
+    return count;
+}
+
+#else
+
+bool startTrace(uint32_t categories) {
+    return false;
+}
+
+void stopTrace() {
+}
+
+TraceStatus getTraceStatus() {
+    return TraceStatus{false, 0, 0, 0, 0};
+}
+
+size_t exportTrace(void (*sink)(const char* data, size_t length, void* context), void* context) {
+    char chunk[128];
+    size_t length = writeTraceHeader(chunk, sizeof(chunk), "GhostWhisper", nullptr, 0);
+    length += writeTraceFooter(chunk + length, sizeof(chunk) - length, 0);
+    sink(chunk, length, context);
+    return 0;
+}
+
+#endif
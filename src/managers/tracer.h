@@ -0,0 +1,108 @@
+/**
+ * @file tracer.h
+ * @brief Flight-recorder event tracer
+ * @details TRACE_SCOPE records begin and end events with microsecond
+ *          timestamps, TRACE_INSTANT a single point in time. Events go into a
+ *          fixed ring in PSRAM that overwrites the oldest events, so a trace
+ *          downloaded right after a glitch shows the seconds leading up to it.
+ *          Any task may record; the ring is claimed with one atomic add.
+ *
+ *          Nothing is recorded until startTrace(), and a stopped tracer costs
+ *          one relaxed load per trace point. With TRACER_ENABLED set to 0 the
+ *          macros expand to nothing. The download is Chrome Trace Event JSON
+ *          (see trace_format.h).
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "../config/config.h"
+#include "../web/trace_format.h"
+#include <atomic>
+
+struct TraceStatus {
+    bool running;
+    uint32_t categories;   // Mask of TraceCategory bits being recorded
+    uint32_t capacity;     // Ring size in events, 0 until the first start
+    uint32_t recorded;     // Events since the last start
+    uint32_t dropped;      // Overwritten before they could be downloaded
+};
+
+#if TRACER_ENABLED
+
+// Categories being recorded, 0 while stopped
+extern std::atomic<uint32_t> traceCategories;
+
+inline bool traceEnabled(TraceCategory category) {
+    return (traceCategories.load(std::memory_order_relaxed) >> category) & 1u;
+}
+
+/**
+ * @brief Record one event; use the TRACE_ macros instead
+ */
+void recordTraceEvent(TraceCategory category, char phase, const char* name,
+                      const char* detail, uint32_t value, bool hasValue);
+
+class TraceScope {
+public:
+    TraceScope(TraceCategory category, const char* name, const char* detail = nullptr)
+        : category_(category), name_(name), active_(traceEnabled(category)) {
+        if (active_) recordTraceEvent(category, 'B', name, detail, 0, false);
+    }
+    ~TraceScope() {
+        // A stop in between leaves the begin open, which viewers show as unfinished
+        if (active_ && traceEnabled(category_)) recordTraceEvent(category_, 'E', name_, nullptr, 0, false);
+    }
+
+private:
+    TraceCategory category_;
+    const char* name_;
+    bool active_;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(category, name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(category, name)
+#define TRACE_SCOPE_DETAIL(category, name, detail) \
+    TraceScope TRACE_CONCAT(traceScope, __LINE__)(category, name, detail)
+#define TRACE_INSTANT(category, name, detail)                                       \
+    do {                                                                            \
+        if (traceEnabled(category)) recordTraceEvent(category, 'i', name, detail, 0, false); \
+    } while (0)
+#define TRACE_VALUE(category, name, value)                                          \
+    do {                                                                            \
+        if (traceEnabled(category)) recordTraceEvent(category, 'i', name, nullptr, value, true); \
+    } while (0)
+
+#else
+
+#define TRACE_SCOPE(category, name) ((void)0)
+#define TRACE_SCOPE_DETAIL(category, name, detail) ((void)0)
+#define TRACE_INSTANT(category, name, detail) ((void)0)
+#define TRACE_VALUE(category, name, value) ((void)0)
+
+#endif
+
+/**
+ * @brief Clear the ring and start recording
+ * @details The ring is allocated on the first start: TRACE_RING_EVENTS_PSRAM
+ *          events in PSRAM, or TRACE_RING_EVENTS_RAM without it.
+ * @param categories Mask of TraceCategory bits
+ * @return false if tracing is compiled out or the ring could not be allocated
+ */
+bool startTrace(uint32_t categories);
+
+/**
+ * @brief Stop recording and keep the ring for download
+ */
+void stopTrace();
+
+TraceStatus getTraceStatus();
+
+/**
+ * @brief Stop recording and stream the ring as Chrome Trace Event JSON
+ * @param sink Receives the document in pieces of up to TRACE_SEND_CHUNK bytes
+ * @param context Passed to sink
+ * @return Number of events written
+ */
+size_t exportTrace(void (*sink)(const char* data, size_t length, void* context), void* context);
@@ -0,0 +1,27 @@
+/**
+ * @file asset_bundle.cpp
+ * @brief Flash bundle index lookup
+ */
+
+#include "asset_bundle.h"
+
+#if __has_include("asset_bundle_data.h")
+#include "asset_bundle_data.h"
+#else
+// Bundle not generated (scripts/build_assets.py did not run) - everything falls back to SD
+static const BundledAsset* const BUNDLED_ASSETS = nullptr;
+static const size_t BUNDLED_ASSET_COUNT = 0;
+#endif
+
+const BundledAsset* findBundledAsset(const String& path) {
+    for (size_t i = 0; i < BUNDLED_ASSET_COUNT; i++) {
+        if (path == BUNDLED_ASSETS[i].path) {
+            return &BUNDLED_ASSETS[i];
+        }
+    }
+    return nullptr;
+}
+
+size_t getBundledAssetCount() {
+    return BUNDLED_ASSET_COUNT;
+}
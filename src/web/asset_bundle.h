@@ -0,0 +1,34 @@
+/**
+ * @file asset_bundle.h
+ * @brief Read-only web UI bundle compiled into flash
+ * @details The bundle is generated from view/ by scripts/build_assets.py. Assets
+ *          are served straight from the memory-mapped flash, so loading the UI
+ *          never touches the SD bus the decoder is reading from.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+
+// One asset in the flash bundle
+struct BundledAsset {
+    const char* path;          // Web path, e.g. "/js/main.js"
+    const char* contentType;
+    const char* hash;          // Content hash, same as in assets.json
+    const uint8_t* data;       // gzip data if gzip is true, raw bytes otherwise
+    uint32_t length;           // Length of data
+    uint32_t rawSize;          // Uncompressed size
+    bool gzip;
+};
+
+/**
+ * @brief Look up an asset in the flash bundle
+ * @param path Web path
+ * @return Asset or nullptr if the bundle does not contain it
+ */
+const BundledAsset* findBundledAsset(const String& path);
+
+/**
+ * @brief Number of assets compiled into flash
+ */
+size_t getBundledAssetCount();
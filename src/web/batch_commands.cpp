@@ -0,0 +1,308 @@
+/**
+ * @file batch_commands.cpp
+ * @brief Command batch parsing, validation and queueing
+ */
+
+#include "batch_commands.h"
+#include "../config/config.h"
+#include "../managers/audio_commands.h"
+#include "../managers/meme_manager.h"
+#include "../managers/radio_manager.h"
+#include "../managers/state_snapshot.h"
+
+#define BATCH_NAME_LEN 24
+#define NO_PROGRAM -1
+
+enum BatchArgKind : uint8_t {
+    ARG_NONE,
+    ARG_OPTIONAL_TEXT,   // Falls back to the spec's default text
+    ARG_TEXT,
+    ARG_NUMBER
+};
+
+// One command the batch endpoint accepts
+struct BatchCommandSpec {
+    const char* name;
+    AudioCommandType type;
+    BatchArgKind argKind;
+    int8_t program;            // RadioProgram selected by CMD_SET_PROGRAM
+    int8_t requiredProgram;    // Program that must be active, or NO_PROGRAM
+    const char* defaultText;
+};
+
+static const BatchCommandSpec BATCH_COMMANDS[] = {
+    {"shuffle",          CMD_SET_PROGRAM,      ARG_OPTIONAL_TEXT, SHUFFLE_PROGRAM,    NO_PROGRAM,         "/music"},
+    {"generative",       CMD_SET_PROGRAM,      ARG_OPTIONAL_TEXT, GENERATIVE_PROGRAM, NO_PROGRAM,         ""},
+    {"stream",           CMD_SET_PROGRAM,      ARG_OPTIONAL_TEXT, STREAM_PROGRAM,     NO_PROGRAM,         "http://reggae.stream.laut.fm/reggae"},
+    {"volume",           CMD_SET_VOLUME,       ARG_NUMBER,        NO_PROGRAM,         NO_PROGRAM,         nullptr},
+    {"random",           CMD_PLAY_RANDOM,      ARG_OPTIONAL_TEXT, NO_PROGRAM,         NO_PROGRAM,         "/music"},
+    {"stop",             CMD_STOP,             ARG_NONE,          NO_PROGRAM,         NO_PROGRAM,         nullptr},
+    {"pause",            CMD_PAUSE,            ARG_NONE,          NO_PROGRAM,         NO_PROGRAM,         nullptr},
+    {"resume",           CMD_RESUME,           ARG_NONE,          NO_PROGRAM,         NO_PROGRAM,         nullptr},
+    {"next",             CMD_SHUFFLE_NEXT,     ARG_NONE,          NO_PROGRAM,         SHUFFLE_PROGRAM,    nullptr},
+    {"folder",           CMD_SHUFFLE_FOLDER,   ARG_TEXT,          NO_PROGRAM,         NO_PROGRAM,         nullptr},
+    {"regenerate",       CMD_REGENERATE,       ARG_NONE,          NO_PROGRAM,         GENERATIVE_PROGRAM, nullptr},
+    {"connect",          CMD_STREAM_CONNECT,   ARG_TEXT,          NO_PROGRAM,         NO_PROGRAM,         nullptr},
+    {"reset",            CMD_STREAM_RESET,     ARG_NONE,          NO_PROGRAM,         NO_PROGRAM,         nullptr},
+    {"meme",             CMD_PLAY_MEME,        ARG_NUMBER,        NO_PROGRAM,         NO_PROGRAM,         nullptr},
+    {"record_start",     CMD_RECORD_START,     ARG_NONE,          NO_PROGRAM,         STREAM_PROGRAM,     nullptr},
+    {"record_stop",      CMD_RECORD_STOP,      ARG_NONE,          NO_PROGRAM,         NO_PROGRAM,         nullptr},
+    {"timeshift_pause",  CMD_TIMESHIFT_PAUSE,  ARG_NONE,          NO_PROGRAM,         STREAM_PROGRAM,     nullptr},
+    {"timeshift_resume", CMD_TIMESHIFT_RESUME, ARG_NONE,          NO_PROGRAM,         STREAM_PROGRAM,     nullptr},
+    {"timeshift_seek",   CMD_TIMESHIFT_SEEK,   ARG_NUMBER,        NO_PROGRAM,         STREAM_PROGRAM,     nullptr},
+    {"timeshift_live",   CMD_TIMESHIFT_LIVE,   ARG_NONE,          NO_PROGRAM,         NO_PROGRAM,         nullptr},
+};
+
+// A command as parsed from the body, before validation
+struct ParsedCommand {
+    char name[BATCH_NAME_LEN];
+    bool hasNumber;
+    bool hasText;
+    int32_t number;
+    char text[AUDIO_COMMAND_TEXT_LEN];
+};
+
+/**
+ * @brief Minimal reader for the batch grammar: an array of flat objects
+ *        whose values are strings or integers.
+ */
+class BatchReader {
+public:
+    explicit BatchReader(const char* body) : p_(body), error_(nullptr) {}
+
+    size_t parse(ParsedCommand* commands, size_t maxCommands) {
+        size_t count = 0;
+        skipSpace();
+        if (!expect('[')) return 0;
+        skipSpace();
+        if (*p_ == ']') {
+            p_++;
+        } else {
+            do {
+                if (count == maxCommands) {
+                    fail("Too many commands");
+                    return 0;
+                }
+                if (!parseCommand(commands[count])) return 0;
+                count++;
+                skipSpace();
+            } while (accept(','));
+            if (!expect(']')) return 0;
+        }
+        skipSpace();
+        if (*p_ != '\0') fail("Trailing data after the array");
+        return error_ ? 0 : count;
+    }
+
+    const char* error() const { return error_; }
+
+private:
+    void skipSpace() {
+        while (*p_ == ' ' || *p_ == '\t' || *p_ == '\r' || *p_ == '\n') p_++;
+    }
+
+    bool fail(const char* message) {
+        if (!error_) error_ = message;
+        return false;
+    }
+
+    bool accept(char c) {
+        skipSpace();
+        if (*p_ != c) return false;
+        p_++;
+        skipSpace();
+        return true;
+    }
+
+    bool expect(char c) {
+        return accept(c) || fail("Malformed JSON");
+    }
+
+    bool parseString(char* out, size_t size) {
+        if (!expect('"')) return false;
+        size_t length = 0;
+        while (*p_ != '"') {
+            char c = *p_++;
+            if (c == '\0') return fail("Unterminated string");
+            if (c == '\\') {
+                c = *p_++;
+                if (c != '"' && c != '\\' && c != '/') return fail("Unsupported escape in string");
+            }
+            if (length + 1 >= size) return fail("String too long");
+            out[length++] = c;
+        }
+        p_++;
+        out[length] = '\0';
+        return true;
+    }
+
+    bool parseNumber(int32_t& out) {
+        bool negative = *p_ == '-';
+        if (negative) p_++;
+        if (*p_ < '0' || *p_ > '9') return fail("Malformed JSON");
+        int64_t value = 0;
+        while (*p_ >= '0' && *p_ <= '9') {
+            value = value * 10 + (*p_++ - '0');
+            if (value > INT32_MAX) return fail("Number out of range");
+        }
+        out = (int32_t)(negative ? -value : value);
+        return true;
+    }
+
+    bool parseCommand(ParsedCommand& command) {
+        command.name[0] = '\0';
+        command.hasNumber = false;
+        command.hasText = false;
+        if (!expect('{')) return false;
+        if (accept('}')) return fail("Command without \"cmd\"");
+
+        do {
+            char key[8];
+            if (!parseString(key, sizeof(key))) return fail("Unknown key");
+            if (!expect(':')) return false;
+
+            if (strcmp(key, "cmd") == 0) {
+                if (!parseString(command.name, sizeof(command.name))) return false;
+            } else if (strcmp(key, "arg") == 0) {
+                if (*p_ == '"') {
+                    if (!parseString(command.text, sizeof(command.text))) return false;
+                    command.hasText = true;
+                } else {
+                    if (!parseNumber(command.number)) return false;
+                    command.hasNumber = true;
+                }
+            } else {
+                return fail("Unknown key");
+            }
+        } while (accept(','));
+
+        if (!expect('}')) return false;
+        return command.name[0] != '\0' || fail("Command without \"cmd\"");
+    }
+
+    const char* p_;
+    const char* error_;
+};
+
+static const BatchCommandSpec* findSpec(const char* name) {
+    for (const BatchCommandSpec& spec : BATCH_COMMANDS) {
+        if (strcmp(spec.name, name) == 0) return &spec;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Check one command and build its queue entry.
+ * @param program Program that will be active when the command runs; updated by program switches
+ * @return Error message, or nullptr if the command is valid
+ */
+static const char* validateCommand(const ParsedCommand& parsed, int& program, AudioCommand& command) {
+    const BatchCommandSpec* spec = findSpec(parsed.name);
+    if (!spec) return "Unknown command";
+
+    command.type = spec->type;
+    command.arg = 0;
+    command.queuedAt = micros();
+    command.text[0] = '\0';
+
+    switch (spec->argKind) {
+        case ARG_NONE:
+            if (parsed.hasText || parsed.hasNumber) return "Takes no argument";
+            break;
+        case ARG_OPTIONAL_TEXT:
+            if (parsed.hasNumber) return "Argument must be a string";
+            strlcpy(command.text, parsed.hasText ? parsed.text : spec->defaultText, sizeof(command.text));
+            break;
+        case ARG_TEXT:
+            if (!parsed.hasText || parsed.text[0] == '\0') return "Needs a string argument";
+            strlcpy(command.text, parsed.text, sizeof(command.text));
+            break;
+        case ARG_NUMBER:
+            if (!parsed.hasNumber) return "Needs a number argument";
+            command.arg = parsed.number;
+            break;
+    }
+
+    // Checked against the program earlier commands in this batch switch to
+    if (spec->requiredProgram != NO_PROGRAM && spec->requiredProgram != program) {
+        switch (spec->requiredProgram) {
+            case SHUFFLE_PROGRAM:
+                return "Not in shuffle mode";
+            case GENERATIVE_PROGRAM:
+                return "Not in generative mode";
+            default:
+                return "Not in stream mode";
+        }
+    }
+
+    switch (spec->type) {
+        case CMD_SET_PROGRAM:
+            command.arg = spec->program;
+            program = spec->program;
+            break;
+        case CMD_SET_VOLUME:
+            if (command.arg < MIN_VOLUME || command.arg > MAX_VOLUME) return "Volume out of range";
+            break;
+        case CMD_PLAY_MEME:
+            if (command.arg < 1 || command.arg > (int32_t)getMemeCount()) return "Meme not found";
+            break;
+        case CMD_TIMESHIFT_SEEK:
+            if (command.arg < 0) return "Seek position must not be negative";
+            break;
+        default:
+            break;
+    }
+    return nullptr;
+}
+
+int runCommandBatch(const char* body, JsonWriter& json) {
+    // Web task only, too large for its stack
+    static ParsedCommand parsed[BATCH_MAX_COMMANDS];
+    static AudioCommand commands[BATCH_MAX_COMMANDS];
+    const char* errors[BATCH_MAX_COMMANDS];
+
+    BatchReader reader(body);
+    size_t count = reader.parse(parsed, BATCH_MAX_COMMANDS);
+    if (reader.error()) {
+        json.beginObject()
+            .stringField("status", "error")
+            .stringField("message", reader.error())
+            .endObject();
+        return 400;
+    }
+
+    // Validate everything before queueing anything
+    int program = getStateSnapshot().currentProgram;
+    bool valid = true;
+    for (size_t i = 0; i < count; i++) {
+        errors[i] = validateCommand(parsed[i], program, commands[i]);
+        if (errors[i]) valid = false;
+    }
+
+    int code = 200;
+    const char* message = "Batch queued";
+    if (!valid) {
+        code = 400;
+        message = "Invalid command in batch, nothing was queued";
+    } else if (count > 0 && !enqueueAudioCommands(commands, count)) {
+        code = 503;
+        message = "Audio engine busy, nothing was queued";
+    }
+
+    json.beginObject()
+        .stringField("status", code == 200 ? "success" : "error")
+        .stringField("message", message)
+        .numberField("queued", code == 200 ? count : 0)
+        .key("results").beginArray();
+    for (size_t i = 0; i < count; i++) {
+        json.beginObject().stringField("cmd", parsed[i].name);
+        if (errors[i]) {
+            json.stringField("status", "error").stringField("message", errors[i]);
+        } else {
+            json.stringField("status", code == 200 ? "queued" : "valid");
+        }
+        json.endObject();
+    }
+    json.endArray().endObject();
+    return code;
+}
@@ -0,0 +1,27 @@
+/**
+ * @file batch_commands.h
+ * @brief POST /api/batch - several control commands in one request
+ * @details The body is a JSON array such as
+ *          [{"cmd":"shuffle","arg":"/music/dub"},{"cmd":"volume","arg":60}].
+ *          Every command is validated before anything is queued, then the whole
+ *          batch is handed to the audio loop as one unit, so it runs in order
+ *          with no other command in between. Nothing is queued if any command
+ *          is invalid.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "json_writer.h"
+
+#define BATCH_MAX_COMMANDS 8
+#define BATCH_MAX_BODY 1024
+#define BATCH_RESPONSE_SIZE 1024
+
+/**
+ * @brief Validate and queue a command batch (web task only)
+ * @param body Request body
+ * @param json Receives the response with one result per command
+ * @return HTTP status code for the response
+ */
+int runCommandBatch(const char* body, JsonWriter& json);
@@ -9,20 +9,51 @@
 #include "../hardware/volume_control.h"
 #include "../managers/meme_manager.h"
 #include "web_utils.h"
+#include "static_assets.h"
+#include "status_events.h"
 #include "../config/config.h"
+#include "../managers/profiler.h"
+#include "../managers/memory_monitor.h"
 #include "../managers/connection_manager.h"
+#include "../managers/logger.h"
 #include <WiFi.h>
+#include <esp_task_wdt.h>
+
+static constexpr LogTag LOG_TAG = LOG_TAG_WEB;
 
 // External web server reference
 extern WebServer server;
 
+static TaskHandle_t webTaskHandle = NULL;
+
+/**
+ * @brief Web server task - keeps slow handlers off the audio task's core.
+ */
+static void webServerTask(void* parameter) {
+    MEMORY_TAG(MEM_TAG_WEB);
+    esp_task_wdt_add(NULL);
+    for (;;) {
+        {
+            PROFILE_SCOPE(PROFILE_WEB_CONTROL);
+            handleWebControl();
+        }
+        {
+            PROFILE_SCOPE(PROFILE_STATUS_EVENTS);
+            serviceStatusEvents();
+        }
+        serviceVolumePersistence();
+        esp_task_wdt_reset();
+        vTaskDelay(1);
+    }
+}
+
 /**
  * @brief Initialize the web server control interface.
  */
 void initializeWebControl() {
     // Check if WiFi is connected or in AP mode
     if (WiFi.status() != WL_CONNECTED && WiFi.getMode() != WIFI_AP && WiFi.getMode() != WIFI_AP_STA) {
-        Serial.println("WiFi not connected and not in AP mode. Web server not started.");
+        LOG_I("WiFi not connected and not in AP mode. Web server not started.");
         return;
     }
 
@@ -34,17 +65,24 @@ void initializeWebControl() {
         // Scan meme files at startup
         scanMemeFiles();
         
+        // Hashes and sizes of the pre-compressed UI assets
+        loadAssetManifest();
+        
         // Check memory usage and limits
         checkMemoryLimits();
         
-        Serial.println("Web control interface initialized successfully!");
+        // Serve requests from a dedicated task pinned away from the audio task
+        xTaskCreatePinnedToCore(webServerTask, "web", WEB_TASK_STACK_SIZE, NULL,
+                                WEB_TASK_PRIORITY, &webTaskHandle, WEB_TASK_CORE);
+        
+        LOG_I("Web control interface initialized successfully!");
     } else {
-        Serial.println("Failed to start web server!");
+        LOG_W("Failed to start web server!");
     }
 }
 
 /**
- * @brief Handle incoming web server requests.
+ * @brief Handle incoming web server requests (web task).
  */
 void handleWebControl() {
     if (isWebServerActive()) {
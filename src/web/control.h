@@ -10,12 +10,12 @@
 
 /**
  * @brief Initialize the web server control interface.
- * @details Sets up HTTP routes for volume control and system status.
+ * @details Sets up HTTP routes and starts the web server task on WEB_TASK_CORE.
  */
 void initializeWebControl();
 
 /**
  * @brief Handle incoming web server requests.
- * @details Must be called in the main loop to process HTTP requests.
+ * @details Called repeatedly by the web server task, never from the audio loop.
  */
 void handleWebControl();
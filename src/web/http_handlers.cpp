@@ -9,201 +9,429 @@
 #include "web_routes.h"
 #include "../hardware/volume_control.h"
 #include "../managers/meme_manager.h"
+#include "../managers/preload_fs.h"
+#include "../managers/meme_overlay.h"
+#include "../hardware/audio_pipeline.h"
+#include "../hardware/i2s_health.h"
 #include "web_utils.h"
+#include "json_writer.h"
+#include "static_assets.h"
+#include "status_events.h"
+#include "batch_commands.h"
+#include "media_files.h"
+#include "metrics.h"
 #include "../managers/radio_manager.h"
 #include "../managers/connection_manager.h"
 #include "../managers/stream_manager.h"
 #include "../managers/shuffle_manager.h"
 #include "../managers/generative_manager.h"
+#include "../managers/catalog_manager.h"
+#include "../managers/timeshift_manager.h"
+#include "../managers/audio_commands.h"
+#include "../managers/state_snapshot.h"
+#include "../managers/profiler.h"
+#include "../managers/tracer.h"
 #include "../config/musicdata.h"
+#include "../managers/logger.h"
 #include <WiFi.h>
 #include <SD.h>
 #include <WebServer.h>
 
+static constexpr LogTag LOG_TAG = LOG_TAG_WEB;
+
 extern WebServer server;
 
+/**
+ * @brief Send a finished JSON document straight from its buffer.
+ * @details A document cut short by its buffer is not valid JSON, so it is never sent.
+ */
+static void sendJson(int code, const JsonWriter& json) {
+    if (json.overflowed()) {
+        LOG_W("Response for %s needs %zu bytes, not sent", server.uri().c_str(), json.requiredSize());
+        server.send_P(500, "application/json", "{\"status\":\"error\",\"message\":\"Response too large\"}");
+        return;
+    }
+    server.send_P(code, "application/json", json.c_str(), json.length());
+}
+
+/**
+ * @brief Shorten a request value for echoing in a response, on a UTF-8 boundary.
+ * @details Call after the full value is queued. Cut to JSON_ECHO_MAX, so that
+ *          even fully escaped it fits a JSON_RESPONSE_SIZE response.
+ */
+static const char* echoed(String& value) {
+    if (value.length() > JSON_ECHO_MAX) {
+        unsigned int cut = JSON_ECHO_MAX;
+        while (cut > 0 && ((uint8_t)value[cut] & 0xC0) == 0x80) cut--;
+        value.remove(cut);
+    }
+    return value.c_str();
+}
+
+/**
+ * @brief Send the common {"status":...,"message":...} response.
+ */
+static void sendStatus(int code, const char* status, const char* message) {
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject().stringField("status", status).stringField("message", message).endObject();
+    sendJson(code, json);
+}
+
+/**
+ * @brief Queue a command for the audio loop, answering 503 if the queue is full.
+ * @return true if queued - the caller still sends its own success response
+ */
+static bool queueOrReject(AudioCommandType type, int32_t arg = 0, const String& text = "") {
+    if (enqueueAudioCommand(type, arg, text)) {
+        return true;
+    }
+    sendStatus(503, "error", "Audio engine busy, try again");
+    return false;
+}
+
 // Basic page handlers
 void handleRoot() {
-    server.send(200, "text/html", generateMainPage());
+    sendHTMLPage("/index.html");
 }
 
 void handleMemePage() {
-    server.send(200, "text/html", loadHTMLFromSD("/meme.html"));
+    sendHTMLPage("/meme.html");
 }
 
 void handleStatus() {
-    server.send(200, "application/json", generateStatusJson());
+    size_t length;
+    const char* body = getStatusJson(&length);
+    server.send_P(200, "application/json", body, length);
 }
 
-void handleNotFound() {
-    String message = "File Not Found\n\n";
-    message += "URI: ";
-    message += server.uri();
-    message += "\nMethod: ";
-    message += (server.method() == HTTP_GET) ? "GET" : "POST";
-    message += "\nArguments: ";
-    message += server.args();
-    message += "\n";
-    
-    for (uint8_t i = 0; i < server.args(); i++) {
-        message += " " + server.argName(i) + ": " + server.arg(i) + "\n";
+void handleStatusEvents() {
+    if (!addStatusSubscriber(server.client())) {
+        sendStatus(503, "error", "Too many event subscribers, poll /status instead");
+        return;
     }
-    
-    Serial.println("404 Error: " + message);
-    server.send(404, "text/plain", message);
+    // The subscriber holds its own reference; release ours so the server moves on to the next client
+    server.client().stop();
+}
+
+void handleStatusEventStats() {
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    writeStatusEventStats(json);
+    sendJson(200, json);
+}
+
+void handleNotFound(const String& uri) {
+    // Probes and stale bookmarks are common - log the dispatcher's URI rather than a copy from server.uri()
+    LOG_I("404: %s", uri.c_str());
+    server.send_P(404, "text/plain", "Not Found");
 }
 
 void handleStaticFile() {
-    String path = server.uri();
-    if (path.endsWith("/")) path += "index.html";
-    
-    // Security check - prevent directory traversal
-    if (path.indexOf("..") >= 0) {
-        server.send(404, "text/plain", "Not Found");
+    serveStaticAsset(server.uri());
+}
+
+void handleAssetStats() {
+    static char buffer[ASSET_STATS_JSON_SIZE];   // Too large for the web task stack
+    JsonWriter json(buffer, sizeof(buffer));
+    writeAssetStatsJson(json);
+    sendJson(200, json);
+}
+
+void handleMetrics() {
+    if (server.hasArg("reset")) {
+        resetI2sHealth();
+#if PROFILER_ENABLED
+        resetProfile();
+#endif
+    }
+    static char buffer[METRICS_JSON_SIZE];   // Too large for the web task stack
+    JsonWriter json(buffer, sizeof(buffer));
+    writeMetricsJson(json);
+    sendJson(200, json);
+}
+
+void handleLogTail() {
+    uint32_t since = server.hasArg("since") ? strtoul(server.arg("since").c_str(), nullptr, 10) : 0;
+
+    static char buffer[LOG_JSON_SIZE];   // Too large for the web task stack
+    JsonWriter json(buffer, sizeof(buffer));
+    writeLogJson(json, since);
+    sendJson(200, json);
+}
+
+void handleLogConfig() {
+    LogLevel level = (LogLevel)logRuntimeLevel.load(std::memory_order_relaxed);
+    uint32_t tags = logRuntimeTags.load(std::memory_order_relaxed);
+
+    if (server.hasArg("level") && !parseLogLevel(server.arg("level").c_str(), &level)) {
+        sendStatus(400, "error", "Unknown log level");
         return;
     }
-    
-    // Map web paths to SD card paths
-    String sdPath = WEB_FILES_PATH + path;
-    
-    File file = SD.open(sdPath);
-    if (!file) {
-        server.send(404, "text/plain", "File not found: " + sdPath);
+    if (server.hasArg("tags")) {
+        // "all", or a comma separated list such as "stream,web"
+        String list = server.arg("tags");
+        if (list == "all") {
+            tags = 0xFFFFFFFFu;
+        } else {
+            tags = 0;
+            int start = 0;
+            while (start <= (int)list.length()) {
+                int end = list.indexOf(',', start);
+                if (end == -1) end = list.length();
+                String name = list.substring(start, end);
+                name.trim();
+                if (name.length() > 0) {
+                    LogTag tag = parseLogTag(name.c_str());
+                    if (tag == LOG_TAG_COUNT) {
+                        sendStatus(400, "error", "Unknown log tag");
+                        return;
+                    }
+                    tags |= 1u << tag;
+                }
+                start = end + 1;
+            }
+        }
+    }
+    setLogFilter(level, tags);
+
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    writeLogConfigJson(json);
+    sendJson(200, json);
+}
+
+static void sendTraceStatus() {
+    TraceStatus status = getTraceStatus();
+
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject()
+        .boolField("running", status.running)
+        .key("categories").beginArray();
+    for (int i = 0; i < TRACE_CATEGORY_COUNT; i++) {
+        if ((status.categories >> i) & 1u) json.stringValue(getTraceCategoryName((TraceCategory)i));
+    }
+    json.endArray()
+        .numberField("capacity", status.capacity)
+        .numberField("recorded", status.recorded)
+        .numberField("dropped", status.dropped)
+        .endObject();
+    sendJson(200, json);
+}
+
+void handleTraceStart() {
+    uint32_t categories = TRACE_ALL_CATEGORIES;
+    if (server.hasArg("categories") && !parseTraceCategories(server.arg("categories").c_str(), &categories)) {
+        sendStatus(400, "error", "Unknown trace category");
         return;
     }
-    
-    // Determine content type
-    String contentType = "text/plain";
-    if (path.endsWith(".html")) contentType = "text/html";
-    else if (path.endsWith(".css")) contentType = "text/css";
-    else if (path.endsWith(".js")) contentType = "application/javascript";
-    else if (path.endsWith(".png")) contentType = "image/png";
-    else if (path.endsWith(".jpg")) contentType = "image/jpeg";
-    else if (path.endsWith(".ico")) contentType = "image/x-icon";
-    
-    // Stream file content
-    server.streamFile(file, contentType);
-    file.close();
+    if (!startTrace(categories)) {
+        sendStatus(503, "error", "Tracing is not available");
+        return;
+    }
+    sendTraceStatus();
+}
+
+void handleTraceStop() {
+    stopTrace();
+    sendTraceStatus();
+}
+
+static void sendTraceChunk(const char* data, size_t length, void* context) {
+    server.sendContent(data, length);
+}
+
+void handleTraceDownload() {
+    // Several hundred KB from PSRAM - stream it, open the file in ui.perfetto.dev
+    server.sendHeader("Content-Disposition", "attachment; filename=\"ghostwhisper-trace.json\"");
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "application/json", "");
+    exportTrace(sendTraceChunk, nullptr);
+    server.sendContent("");
 }
 
 // Volume control handlers
+static void sendVolume(int volume) {
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject().stringField("status", "success").numberField("volume", volume).endObject();
+    sendJson(200, json);
+}
+
 void handleVolumeUp() {
     int newVolume = increaseVolume();
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"volume\":" + String(newVolume) + "}");
+    sendVolume(newVolume);
 }
 
 void handleVolumeDown() {
     int newVolume = decreaseVolume();
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"volume\":" + String(newVolume) + "}");
+    sendVolume(newVolume);
 }
 
 void handleSetVolume() {
     if (server.hasArg("level")) {
         int newVolume = server.arg("level").toInt();
         if (setVolume(newVolume)) {
-            server.send(200, "application/json", 
-                "{\"status\":\"success\",\"volume\":" + String(newVolume) + "}");
+            sendVolume(newVolume);
         } else {
-            server.send(400, "application/json", 
-                "{\"status\":\"error\",\"message\":\"Volume must be between " + String(MIN_VOLUME) + " and " + String(MAX_VOLUME) + "\"}");
+            char buffer[JSON_RESPONSE_SIZE];
+            JsonWriter json(buffer, sizeof(buffer));
+            json.beginObject()
+                .stringField("status", "error")
+                .stringFieldf("message", "Volume must be between %d and %d", MIN_VOLUME, MAX_VOLUME)
+                .endObject();
+            sendJson(400, json);
         }
     } else {
-        server.send(400, "application/json", 
-            "{\"status\":\"error\",\"message\":\"Missing volume level parameter\"}");
+        sendStatus(400, "error", "Missing volume level parameter");
     }
 }
 
 void handleVolumeTest() {
-    Serial.println("Volume test requested via web interface");
-    testVolumeControl();
-    server.send(200, "text/plain", "Volume diagnostic test completed. Check Serial Monitor for results.");
+    LOG_I("Volume test requested via web interface");
+    if (!queueOrReject(CMD_VOLUME_TEST)) return;
+    server.send(200, "text/plain", "Volume diagnostic test started. Check Serial Monitor for results.");
 }
 
 // Playback control handlers
 void handleRandomPlay() {
-    Serial.println("Random play requested via web interface");
+    LOG_I("Random play requested via web interface");
     
     String musicFolder = "/music";
     if (server.hasArg("folder")) {
         musicFolder = server.arg("folder");
     }
     
-    playRandomFile(musicFolder);
+    if (!queueOrReject(CMD_PLAY_RANDOM, 0, musicFolder)) return;
     
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"message\":\"Random playback started from folder: " + musicFolder + "\"}");
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject()
+        .stringField("status", "success")
+        .stringFieldf("message", "Random playback started from folder: %s", echoed(musicFolder))
+        .endObject();
+    sendJson(200, json);
 }
 
 void handleStop() {
-    Serial.println("Stop playback requested via web interface");
+    LOG_I("Stop playback requested via web interface");
     
-    audio.stopSong();
-    stopPlayback();
+    if (!queueOrReject(CMD_STOP)) return;
     
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"message\":\"Playback stopped\"}");
+    sendStatus(200, "success", "Playback stopped");
 }
 
 void handlePause() {
-    Serial.println("Pause playback requested via web interface");
+    LOG_I("Pause playback requested via web interface");
     
-    if (audio.isRunning()) {
-        audio.pauseResume();
-        server.send(200, "application/json", 
-            "{\"status\":\"success\",\"message\":\"Playback paused\"}");
+    if (getStateSnapshot().audioRunning) {
+        if (!queueOrReject(CMD_PAUSE)) return;
+        sendStatus(200, "success", "Playback paused");
     } else {
-        server.send(200, "application/json", 
-            "{\"status\":\"info\",\"message\":\"No active playback to pause\"}");
+        sendStatus(200, "info", "No active playback to pause");
     }
 }
 
 void handleResume() {
-    Serial.println("Resume playback requested via web interface");
+    LOG_I("Resume playback requested via web interface");
     
-    audio.pauseResume();
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"message\":\"Playback resumed\"}");
+    if (!queueOrReject(CMD_RESUME)) return;
+    sendStatus(200, "success", "Playback resumed");
 }
 
 // System handlers
 void handleMemoryCheck() {
-    Serial.println("Memory check requested via web interface");
-    checkMemoryLimits();
-    server.send(200, "text/plain", "Memory check completed. See Serial Monitor for detailed report.");
+    static char buffer[MEMORY_JSON_SIZE];   // Too large for the web task stack
+    JsonWriter json(buffer, sizeof(buffer));
+    writeMemoryJson(json);
+    sendJson(200, json);
 }
 
 void handleWiFiReset() {
-    Serial.println("WiFi reset requested via web interface");
+    LOG_I("WiFi reset requested via web interface");
     
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"message\":\"WiFi settings will be reset. Device will restart.\"}");
+    sendStatus(200, "success", "WiFi settings will be reset. Device will restart.");
     
     delay(1000);
     resetWiFiSettings();
 }
 
 void handleWiFiConfig() {
-    Serial.println("WiFi config portal requested via web interface");
+    LOG_I("WiFi config portal requested via web interface");
     
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"message\":\"WiFi configuration portal starting. Connect to device AP to configure.\"}");
+    sendStatus(200, "success", "WiFi configuration portal starting. Connect to device AP to configure.");
     
     delay(1000);
     startWiFiConfigPortal();
 }
 
+// Media preview handlers
+static const char* mediaContentType(const String& path) {
+    if (path.endsWith(".mp3")) return "audio/mpeg";
+    if (path.endsWith(".wav")) return "audio/wav";
+    if (path.endsWith(".ogg")) return "audio/ogg";
+    if (path.endsWith(".flac")) return "audio/flac";
+    if (path.endsWith(".m4a") || path.endsWith(".aac")) return "audio/mp4";
+    return nullptr;
+}
+
+void handleMediaFile() {
+    String path = server.arg("path");
+    // Only audio files under the music, meme and recording folders
+    bool allowedFolder = path.startsWith(String(MUSIC_FOLDER) + "/") || path.startsWith("/meme/") ||
+                         path.startsWith("/rec/");
+    const char* contentType = mediaContentType(path);
+    if (!allowedFolder || !contentType || path.indexOf("..") >= 0) {
+        sendStatus(403, "error", "Not a previewable audio file");
+        return;
+    }
+
+    File file;
+    {
+        TRACE_SCOPE_DETAIL(TRACE_SD, "SD.open", path.c_str());
+        file = SD.open(path);
+    }
+    if (!file || file.isDirectory()) {
+        sendStatus(404, "error", "File not found");
+        return;
+    }
+    sendFileWithRanges(file, contentType);
+    file.close();
+}
+
+void handleMediaStats() {
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    writeMediaStatsJson(json);
+    sendJson(200, json);
+}
+
 // Meme soundboard handlers
 void handleMemeList() {
-    String json = "{\"files\":[";
-    const std::vector<String>& memes = getMemeFiles();
-    for (size_t i = 0; i < memes.size(); ++i) {
-        if (i > 0) json += ",";
-        json += "\"" + memes[i] + "\"";
+    // The meme list is fixed after startup, so it is rendered once into a buffer of the right size
+    static char* body = nullptr;
+    static size_t length = 0;
+    if (!body) {
+        const std::vector<String>& memes = getMemeFiles();
+        auto render = [&memes](char* buffer, size_t size) {
+            JsonWriter json(buffer, size);
+            json.beginObject().key("files").beginArray();
+            for (const String& meme : memes) {
+                json.stringValue(meme.c_str());
+            }
+            json.endArray().endObject();
+            return json;
+        };
+        size_t required = render(nullptr, 0).requiredSize();
+        body = (char*)malloc(required);
+        if (!body) {
+            sendStatus(500, "error", "Out of memory");
+            return;
+        }
+        length = render(body, required).length();
     }
-    json += "]}";
-    server.send(200, "application/json", json);
+    server.send_P(200, "application/json", body, length);
 }
 
 void handleMemePlay() {
@@ -213,44 +441,89 @@ void handleMemePlay() {
     }
     
     int memeNum = server.arg("n").toInt();
-    if (playMeme(memeNum)) {
+    // Meme list is fixed after startup, so it can be validated here
+    if (memeNum >= 1 && memeNum <= (int)getMemeCount()) {
+        if (!queueOrReject(CMD_PLAY_MEME, memeNum)) return;
         server.send(200, "text/plain", "Playing meme " + String(memeNum));
     } else {
         server.send(404, "text/plain", "Meme file not found");
     }
 }
 
+void handleMemeStats() {
+    size_t length = 0;
+    const char* body = getMemeStatsJson(&length);
+    if (!body) {
+        sendStatus(500, "error", "Out of memory");
+        return;
+    }
+    server.send_P(200, "application/json", body, length);
+}
+
+// Batched command handler
+void handleApiBatch() {
+    if (server.method() != HTTP_POST) {
+        sendStatus(405, "error", "Use POST with a JSON array of commands");
+        return;
+    }
+    // The server keeps a non-form body in the "plain" argument
+    const String& body = server.arg("plain");
+    if (body.length() > BATCH_MAX_BODY) {
+        sendStatus(413, "error", "Batch too large");
+        return;
+    }
+
+    static char buffer[BATCH_RESPONSE_SIZE];   // Too large for the web task stack
+    JsonWriter json(buffer, sizeof(buffer));
+    int code = runCommandBatch(body.c_str(), json);
+    sendJson(code, json);
+}
+
 // Radio program handlers
 void handleProgramShuffle() {
-    Serial.println("Shuffle program requested via web interface");
+    LOG_I("Shuffle program requested via web interface");
     
     String musicFolder = "/music";
     if (server.hasArg("folder")) {
         musicFolder = server.arg("folder");
     }
     
-    setProgramMode(SHUFFLE_PROGRAM, musicFolder);
-    
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"message\":\"Shuffle program started\",\"program\":\"SHUFFLE\",\"folder\":\"" + musicFolder + "\"}");
+    if (!queueOrReject(CMD_SET_PROGRAM, SHUFFLE_PROGRAM, musicFolder)) return;
+    
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject()
+        .stringField("status", "success")
+        .stringField("message", "Shuffle program started")
+        .stringField("program", "SHUFFLE")
+        .stringField("folder", echoed(musicFolder))
+        .endObject();
+    sendJson(200, json);
 }
 
 void handleProgramGenerative() {
-    Serial.println("Generative program requested via web interface");
+    LOG_I("Generative program requested via web interface");
     
     String sequence = "";
     if (server.hasArg("sequence")) {
         sequence = server.arg("sequence");
     }
     
-    setProgramMode(GENERATIVE_PROGRAM, sequence);
-    
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"message\":\"Generative program started\",\"program\":\"GENERATIVE\",\"sequence\":\"" + sequence + "\"}");
+    if (!queueOrReject(CMD_SET_PROGRAM, GENERATIVE_PROGRAM, sequence)) return;
+    
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject()
+        .stringField("status", "success")
+        .stringField("message", "Generative program started")
+        .stringField("program", "GENERATIVE")
+        .stringField("sequence", echoed(sequence))
+        .endObject();
+    sendJson(200, json);
 }
 
 void handleProgramStream() {
-    Serial.println("Stream program requested via web interface");
+    LOG_I("Stream program requested via web interface");
     
     String streamURL;
     if (server.hasArg("url")) {
@@ -260,68 +533,80 @@ void handleProgramStream() {
         streamURL = "http://reggae.stream.laut.fm/reggae";
     }
     
-    setProgramMode(STREAM_PROGRAM, streamURL);
-    
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"message\":\"Stream program started\",\"program\":\"STREAM\",\"url\":\"" + streamURL + "\"}");
+    if (!queueOrReject(CMD_SET_PROGRAM, STREAM_PROGRAM, streamURL)) return;
+    
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject()
+        .stringField("status", "success")
+        .stringField("message", "Stream program started")
+        .stringField("program", "STREAM")
+        .stringField("url", echoed(streamURL))
+        .endObject();
+    sendJson(200, json);
 }
 
 void handleProgramNewStream() {
-    Serial.println("NEW Stream program requested via web interface - FORCING NEW URL");
-    
-    audio.stopSong();
-    delay(200);
+    LOG_I("NEW Stream program requested via web interface - FORCING NEW URL");
     
-    // Use the force new stream URL directly
+    // Use the force new stream URL directly - setProgramMode() stops the current song first
     String forceNewURL = "https://reggae.stream.laut.fm/reggae";
-    setProgramMode(STREAM_PROGRAM, forceNewURL);
-    
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"message\":\"NEW Stream program started with forced URL\",\"program\":\"NEWSTREAM\",\"url\":\"" + forceNewURL + "\"}");
+    if (!queueOrReject(CMD_SET_PROGRAM, STREAM_PROGRAM, forceNewURL)) return;
+    
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject()
+        .stringField("status", "success")
+        .stringField("message", "NEW Stream program started with forced URL")
+        .stringField("program", "NEWSTREAM")
+        .stringField("url", forceNewURL.c_str())
+        .endObject();
+    sendJson(200, json);
 }
 
 void handleProgramStatus() {
-    server.send(200, "application/json", generateStatusJson());
+    handleStatus();
 }
 
 // Program-specific handlers
 void handleShuffleNext() {
-    Serial.println("Shuffle next requested via web interface");
+    LOG_I("Shuffle next requested via web interface");
     
-    if (getCurrentProgram() != SHUFFLE_PROGRAM) {
-        server.send(400, "application/json", 
-            "{\"status\":\"error\",\"message\":\"Not in shuffle mode\"}");
+    if (getStateSnapshot().currentProgram != SHUFFLE_PROGRAM) {
+        sendStatus(400, "error", "Not in shuffle mode");
         return;
     }
     
-    playNextShuffleTrack();
+    if (!queueOrReject(CMD_SHUFFLE_NEXT)) return;
     
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"message\":\"Playing next shuffle track\"}");
+    sendStatus(200, "success", "Playing next shuffle track");
 }
 
 void handleShuffleFolder() {
-    Serial.println("Shuffle folder change requested via web interface");
+    LOG_I("Shuffle folder change requested via web interface");
     
     if (!server.hasArg("path")) {
-        server.send(400, "application/json", 
-            "{\"status\":\"error\",\"message\":\"Missing folder path parameter\"}");
+        sendStatus(400, "error", "Missing folder path parameter");
         return;
     }
     
     String folderPath = server.arg("path");
-    buildShuffleQueue(folderPath);
-    
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"message\":\"Shuffle folder changed to: " + folderPath + "\"}");
+    if (!queueOrReject(CMD_SHUFFLE_FOLDER, 0, folderPath)) return;
+    
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject()
+        .stringField("status", "success")
+        .stringFieldf("message", "Shuffle folder changed to: %s", echoed(folderPath))
+        .endObject();
+    sendJson(200, json);
 }
 
 void handleGenerativeSequence() {
-    Serial.println("Generative sequence change requested via web interface");
+    LOG_I("Generative sequence change requested via web interface");
     
-    if (getCurrentProgram() != GENERATIVE_PROGRAM) {
-        server.send(400, "application/json", 
-            "{\"status\":\"error\",\"message\":\"Not in generative mode\"}");
+    if (getStateSnapshot().currentProgram != GENERATIVE_PROGRAM) {
+        sendStatus(400, "error", "Not in generative mode");
         return;
     }
     
@@ -330,48 +615,199 @@ void handleGenerativeSequence() {
         sequence = server.arg("name");
     }
     
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"message\":\"Generative sequence changed to: " + sequence + "\"}");
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject()
+        .stringField("status", "success")
+        .stringFieldf("message", "Generative sequence changed to: %s", echoed(sequence))
+        .endObject();
+    sendJson(200, json);
 }
 
 void handleGenerativeRegenerate() {
-    Serial.println("Generative sequence regeneration requested via web interface");
+    LOG_I("Generative sequence regeneration requested via web interface");
     
-    if (getCurrentProgram() != GENERATIVE_PROGRAM) {
-        server.send(400, "application/json", 
-            "{\"status\":\"error\",\"message\":\"Not in generative mode\"}");
+    if (getStateSnapshot().currentProgram != GENERATIVE_PROGRAM) {
+        sendStatus(400, "error", "Not in generative mode");
         return;
     }
     
-    regenerateSequence();
+    if (!queueOrReject(CMD_REGENERATE)) return;
     
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"message\":\"New generative sequence generated and will start shortly\"}");
+    sendStatus(200, "success", "New generative sequence generated and will start shortly");
 }
 
 void handleStreamConnect() {
-    Serial.println("Stream connect requested via web interface");
+    LOG_I("Stream connect requested via web interface");
     
     if (!server.hasArg("url")) {
-        server.send(400, "application/json", 
-            "{\"status\":\"error\",\"message\":\"Missing stream URL parameter\"}");
+        sendStatus(400, "error", "Missing stream URL parameter");
         return;
     }
     
     String streamURL = server.arg("url");
-    connectToStream(streamURL);
-    
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"message\":\"Connecting to stream: " + streamURL + "\"}");
+    if (!queueOrReject(CMD_STREAM_CONNECT, 0, streamURL)) return;
+    
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject()
+        .stringField("status", "success")
+        .stringFieldf("message", "Connecting to stream: %s", echoed(streamURL))
+        .endObject();
+    sendJson(200, json);
 }
 
 void handleStreamReset() {
-    Serial.println("Stream reset requested via web interface");
+    LOG_I("Stream reset requested via web interface");
     
-    clearStreamCache();
+    if (!queueOrReject(CMD_STREAM_RESET)) return;
     // Use default stream URL directly
-    String newURL = "http://reggae.stream.laut.fm/reggae";
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject()
+        .stringField("status", "success")
+        .stringField("message", "Stream cache cleared and reset to default URL")
+        .stringField("url", "http://reggae.stream.laut.fm/reggae")
+        .endObject();
+    sendJson(200, json);
+}
+
+void handleStreamList() {
+    String etag = getCatalogETag();
+    server.sendHeader("ETag", etag);
+    server.sendHeader("Cache-Control", "no-cache");
+
+    if (server.header("If-None-Match") == etag) {
+        server.send(304);
+        return;
+    }
+    server.send(200, "application/json", getCatalogJson());
+}
+
+void handleStreamRefresh() {
+    LOG_I("Station catalog refresh requested via web interface");
+
+    bool online = getConnectionMode() == ONLINE;
+    if (online) {
+        requestCatalogRefresh();
+    }
+
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject()
+        .stringField("status", online ? "success" : "info")
+        .stringField("message", online ? "Catalog refresh scheduled" : "Offline - serving cached catalog")
+        .numberField("count", getCatalogStationCount())
+        .endObject();
+    sendJson(200, json);
+}
+
+// Recording and time-shift handlers
+void handleRecordStart() {
+    LOG_I("Recording requested via web interface");
     
-    server.send(200, "application/json", 
-        "{\"status\":\"success\",\"message\":\"Stream cache cleared and reset to default URL\",\"url\":\"" + newURL + "\"}");
+    if (getStateSnapshot().currentProgram != STREAM_PROGRAM) {
+        sendStatus(400, "error", "Not in stream mode");
+        return;
+    }
+    
+    if (isRecording() || !getStateSnapshot().streamConnected) {
+        sendStatus(409, "error", "Recorder busy or no live stream");
+        return;
+    }
+    
+    if (!queueOrReject(CMD_RECORD_START)) return;
+    sendStatus(200, "success", "Recording started");
+}
+
+void handleRecordStop() {
+    LOG_I("Recording stop requested via web interface");
+    
+    if (!queueOrReject(CMD_RECORD_STOP)) return;
+    sendStatus(200, "success", "Recording stopping");
+}
+
+void handleRecordStatus() {
+    TimeshiftStats stats = getTimeshiftStats();
+    
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject()
+        .boolField("recording", stats.recording)
+        .boolField("paused", stats.paused)
+        .boolField("playingShifted", stats.playingShifted)
+        .numberField("bytesRecorded", stats.bytesRecorded)
+        .numberField("bytesBuffered", stats.bytesBuffered)
+        .numberField("windowSeconds", stats.windowSeconds)
+        .numberField("positionSeconds", stats.positionSeconds)
+        .numberField("droppedChunks", stats.droppedChunks)
+        .numberField("droppedBytes", stats.droppedBytes)
+        .numberField("writeCount", stats.writeCount)
+        .numberField("writeKBps", stats.writeKBps)
+        .numberField("maxWriteMs", stats.maxWriteMs)
+        .endObject();
+    sendJson(200, json);
+}
+
+void handleRecordExport() {
+    File file = SD.open(TIMESHIFT_FILE_PATH);
+    if (!file) {
+        sendStatus(404, "error", "No recording on SD card");
+        return;
+    }
+    
+    server.sendHeader("Content-Disposition", "attachment; filename=\"ghostwhisper-recording.mp3\"");
+    sendFileWithRanges(file, "audio/mpeg");
+    file.close();
+}
+
+void handleTimeshiftPause() {
+    StateSnapshot snapshot = getStateSnapshot();
+    if (snapshot.currentProgram != STREAM_PROGRAM || (!snapshot.timeshiftActive && !isRecording())) {
+        sendStatus(400, "error", "Pause needs an active stream recording");
+        return;
+    }
+    if (!queueOrReject(CMD_TIMESHIFT_PAUSE)) return;
+    sendStatus(200, "success", "Stream paused");
+}
+
+void handleTimeshiftResume() {
+    if (!getStateSnapshot().timeshiftActive) {
+        sendStatus(400, "error", "Stream is not paused");
+        return;
+    }
+    if (!queueOrReject(CMD_TIMESHIFT_RESUME)) return;
+    sendStatus(200, "success", "Stream resumed");
+}
+
+void handleTimeshiftSeek() {
+    if (!server.hasArg("seconds")) {
+        sendStatus(400, "error", "Missing seconds parameter");
+        return;
+    }
+    
+    long seconds = server.arg("seconds").toInt();
+    if (seconds < 0) {
+        sendStatus(400, "error", "Seek position must not be negative");
+        return;
+    }
+    // Anything past the recording means live; the command argument is 32-bit
+    if (seconds > INT32_MAX) seconds = INT32_MAX;
+    if (getStateSnapshot().currentProgram != STREAM_PROGRAM || getTimeshiftStats().bytesRecorded == 0) {
+        sendStatus(400, "error", "Nothing recorded to seek in");
+        return;
+    }
+    if (!queueOrReject(CMD_TIMESHIFT_SEEK, seconds)) return;
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject()
+        .stringField("status", "success")
+        .stringFieldf("message", "Seeked to %lu s", (unsigned long)seconds)
+        .endObject();
+    sendJson(200, json);
+}
+
+void handleTimeshiftLive() {
+    if (!queueOrReject(CMD_TIMESHIFT_LIVE)) return;
+    sendStatus(200, "success", "Back to live stream");
 }
@@ -12,8 +12,11 @@
 void handleRoot();
 void handleMemePage();
 void handleStatus();
-void handleNotFound();
+void handleStatusEvents();
+void handleStatusEventStats();
+void handleNotFound(const String& uri);
 void handleStaticFile();
+void handleAssetStats();
 
 // Volume control handlers
 void handleVolumeUp();
@@ -29,9 +32,18 @@ void handleResume();
 
 // System handlers
 void handleMemoryCheck();
+void handleMetrics();
+void handleLogTail();
+void handleLogConfig();
+void handleTraceStart();
+void handleTraceStop();
+void handleTraceDownload();
 void handleWiFiReset();
 void handleWiFiConfig();
 
+// Batched command handler
+void handleApiBatch();
+
 // Radio program handlers
 void handleProgramShuffle();
 void handleProgramGenerative();
@@ -46,7 +58,24 @@ void handleGenerativeSequence();
 void handleGenerativeRegenerate();
 void handleStreamConnect();
 void handleStreamReset();
+void handleStreamList();
+void handleStreamRefresh();
+
+// Recording and time-shift handlers
+void handleRecordStart();
+void handleRecordStop();
+void handleRecordStatus();
+void handleRecordExport();
+void handleTimeshiftPause();
+void handleTimeshiftResume();
+void handleTimeshiftSeek();
+void handleTimeshiftLive();
+
+// Media preview handlers
+void handleMediaFile();
+void handleMediaStats();
 
 // Meme soundboard handlers
 void handleMemeList();
 void handleMemePlay();
+void handleMemeStats();
@@ -0,0 +1,135 @@
+/**
+ * @file json_writer.cpp
+ * @brief Fixed-buffer JSON writer implementation
+ */
+
+#include "json_writer.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+JsonWriter::JsonWriter(char* buffer, size_t size)
+    : buffer_(buffer), size_(size), length_(0), needsComma_(false) {
+    if (size_ > 0) buffer_[0] = '\0';
+}
+
+void JsonWriter::write(const char* data, size_t count) {
+    if (length_ + 1 < size_) {
+        size_t room = size_ - 1 - length_;
+        size_t n = count < room ? count : room;
+        memcpy(buffer_ + length_, data, n);
+        buffer_[length_ + n] = '\0';
+    }
+    length_ += count;
+}
+
+void JsonWriter::write(char c) {
+    write(&c, 1);
+}
+
+// Comma before every array element or object member except the first
+void JsonWriter::separate() {
+    if (needsComma_) write(',');
+    needsComma_ = true;
+}
+
+void JsonWriter::writeEscaped(const char* text) {
+    write('"');
+    const char* run = text;
+    for (const char* p = text; *p; p++) {
+        unsigned char c = *p;
+        if (c != '"' && c != '\\' && c >= 0x20) continue;
+
+        write(run, p - run);
+        run = p + 1;
+        if (c == '"' || c == '\\') {
+            char escaped[2] = {'\\', (char)c};
+            write(escaped, 2);
+        } else {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            write(escaped, 6);
+        }
+    }
+    write(run, strlen(run));
+    write('"');
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    write('{');
+    needsComma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    write('}');
+    needsComma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    write('[');
+    needsComma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    write(']');
+    needsComma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(const char* name) {
+    separate();
+    writeEscaped(name);
+    write(':');
+    needsComma_ = false;   // The value that follows belongs to this key
+    return *this;
+}
+
+JsonWriter& JsonWriter::stringValue(const char* text) {
+    separate();
+    writeEscaped(text ? text : "");
+    return *this;
+}
+
+JsonWriter& JsonWriter::numberValue(int64_t number) {
+    separate();
+    char digits[24];
+    int n = snprintf(digits, sizeof(digits), "%lld", (long long)number);
+    write(digits, n);
+    return *this;
+}
+
+JsonWriter& JsonWriter::boolValue(bool flag) {
+    separate();
+    if (flag) {
+        write("true", 4);
+    } else {
+        write("false", 5);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::stringField(const char* name, const char* text) {
+    return key(name).stringValue(text);
+}
+
+JsonWriter& JsonWriter::numberField(const char* name, int64_t number) {
+    return key(name).numberValue(number);
+}
+
+JsonWriter& JsonWriter::boolField(const char* name, bool flag) {
+    return key(name).boolValue(flag);
+}
+
+JsonWriter& JsonWriter::stringFieldf(const char* name, const char* format, ...) {
+    char text[JSON_FORMAT_SIZE];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    return key(name).stringValue(text);
+}
@@ -0,0 +1,70 @@
+/**
+ * @file json_writer.h
+ * @brief Fixed-buffer JSON writer
+ * @details Writes JSON into a caller-provided buffer without touching the heap.
+ *          Commas and string escaping are handled by the writer. Like snprintf,
+ *          output is truncated when the buffer is full, but requiredSize() still
+ *          reports how much space the whole document needs.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+class JsonWriter {
+public:
+    JsonWriter(char* buffer, size_t size);
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    /**
+     * @brief Start an object member; follow with a value or a nested object/array
+     */
+    JsonWriter& key(const char* name);
+
+    JsonWriter& stringValue(const char* text);
+    JsonWriter& numberValue(int64_t number);
+    JsonWriter& boolValue(bool flag);
+
+    // Shorthands for key() followed by a value
+    JsonWriter& stringField(const char* name, const char* text);
+    JsonWriter& numberField(const char* name, int64_t number);
+    JsonWriter& boolField(const char* name, bool flag);
+
+    /**
+     * @brief String member formatted with printf syntax (at most JSON_FORMAT_SIZE - 1 characters)
+     */
+    JsonWriter& stringFieldf(const char* name, const char* format, ...)
+        __attribute__((format(printf, 3, 4)));
+
+    const char* c_str() const { return buffer_; }
+
+    /**
+     * @brief Bytes actually in the buffer (excluding the terminator)
+     */
+    size_t length() const { return length_ < size_ ? length_ : (size_ > 0 ? size_ - 1 : 0); }
+
+    /**
+     * @brief Buffer size needed for the whole document, including the terminator
+     */
+    size_t requiredSize() const { return length_ + 1; }
+
+    bool overflowed() const { return length_ >= size_; }
+
+private:
+    void write(const char* data, size_t count);
+    void write(char c);
+    void separate();
+    void writeEscaped(const char* text);
+
+    char* buffer_;
+    size_t size_;
+    size_t length_;      // Total length written, may exceed size_ after truncation
+    bool needsComma_;
+};
+
+#define JSON_FORMAT_SIZE 160
@@ -0,0 +1,187 @@
+/**
+ * @file media_files.cpp
+ * @brief Range-capable SD file transfers
+ */
+
+#include "media_files.h"
+#include "../config/config.h"
+#include "../managers/state_snapshot.h"
+#include "../managers/tracer.h"
+#include <WebServer.h>
+
+extern WebServer server;
+
+#define SD_SECTOR_SIZE 512
+
+struct MediaStats {
+    uint32_t transfers;
+    uint32_t rangeRequests;
+    uint32_t unsatisfiable;
+    uint32_t aborted;
+    uint32_t bytesSent;
+    uint32_t transferMs;
+    uint32_t backoffs;          // Chunks that waited for the decoder
+    uint32_t backoffMs;
+    uint8_t minDecoderFill;     // Lowest decoder buffer fill seen during a transfer
+};
+
+// Word-aligned so the SD driver can DMA straight into it
+static uint8_t mediaBuffer[MEDIA_READ_CHUNK] __attribute__((aligned(4)));
+static MediaStats mediaStats = {0, 0, 0, 0, 0, 0, 0, 0, 100};
+
+/**
+ * @brief Parse a byte position, saturating at UINT32_MAX.
+ * @return false unless text is one or more digits
+ */
+static bool parseBytePosition(const String& text, uint32_t& value) {
+    if (text.length() == 0) return false;
+    uint64_t parsed = 0;
+    for (unsigned int i = 0; i < text.length(); i++) {
+        char c = text.charAt(i);
+        if (c < '0' || c > '9') return false;
+        parsed = parsed * 10 + (c - '0');
+        if (parsed > UINT32_MAX) parsed = UINT32_MAX;
+    }
+    value = (uint32_t)parsed;
+    return true;
+}
+
+/**
+ * @brief Parse a single "bytes=first-last" range against a file size.
+ * @return 1 for a valid range, 0 for no usable Range header, -1 if unsatisfiable
+ */
+static int parseRange(const String& header, uint32_t size, uint32_t& first, uint32_t& last) {
+    if (!header.startsWith("bytes=") || header.indexOf(',') >= 0) {
+        return 0;   // Missing, other units or multipart: send the whole file
+    }
+    int dash = header.indexOf('-');
+    if (dash < 0) return 0;
+    String from = header.substring(6, dash);
+    String to = header.substring(dash + 1);
+    from.trim();
+    to.trim();
+
+    if (from.length() == 0) {
+        // Suffix range: the last N bytes
+        uint32_t suffix;
+        if (!parseBytePosition(to, suffix)) return 0;
+        if (suffix == 0 || size == 0) return -1;
+        first = suffix >= size ? 0 : size - suffix;
+        last = size - 1;
+        return 1;
+    }
+
+    // A malformed range is ignored rather than read as position 0
+    uint32_t start;
+    uint32_t end = size - 1;
+    if (!parseBytePosition(from, start)) return 0;
+    if (to.length() > 0 && !parseBytePosition(to, end)) return 0;
+    if (start >= size || end < start) return -1;
+    first = start;
+    last = end < size ? end : size - 1;
+    return 1;
+}
+
+/**
+ * @brief Give the decoder the SD bus while its input buffer is running low.
+ */
+static void yieldToDecoder() {
+    uint32_t waited = 0;
+    while (waited < MEDIA_MAX_BACKOFF_MS) {
+        StateSnapshot state = getStateSnapshot();
+        if (!state.audioRunning) return;
+        if (state.audioBufferFill < mediaStats.minDecoderFill) {
+            mediaStats.minDecoderFill = state.audioBufferFill;
+        }
+        if (state.audioBufferFill >= MEDIA_DECODER_LOW_WATER) break;
+        vTaskDelay(pdMS_TO_TICKS(MEDIA_BACKOFF_MS));
+        waited += MEDIA_BACKOFF_MS;
+    }
+    if (waited > 0) {
+        mediaStats.backoffs++;
+        mediaStats.backoffMs += waited;
+    }
+}
+
+size_t sendFileWithRanges(File& file, const char* contentType, const char* contentEncoding) {
+    uint32_t size = file.size();
+    uint32_t first = 0;
+    uint32_t last = size > 0 ? size - 1 : 0;
+
+    int range = parseRange(server.header("Range"), size, first, last);
+    server.sendHeader("Accept-Ranges", "bytes");
+    if (contentEncoding) {
+        server.sendHeader("Content-Encoding", contentEncoding);
+    }
+
+    if (range < 0) {
+        mediaStats.unsatisfiable++;
+        server.sendHeader("Content-Range", "bytes */" + String(size));
+        server.send_P(416, "text/plain", "Range Not Satisfiable");
+        return 0;
+    }
+
+    uint32_t length = size > 0 ? last - first + 1 : 0;
+    if (range > 0) {
+        mediaStats.rangeRequests++;
+        char contentRange[48];
+        snprintf(contentRange, sizeof(contentRange), "bytes %lu-%lu/%lu",
+                 (unsigned long)first, (unsigned long)last, (unsigned long)size);
+        server.sendHeader("Content-Range", contentRange);
+    }
+    server.setContentLength(length);
+    server.send(range > 0 ? 206 : 200, contentType, "");
+    if (server.method() == HTTP_HEAD || length == 0) {
+        return 0;
+    }
+
+    mediaStats.transfers++;
+    uint32_t started = millis();
+    WiFiClient& client = server.client();
+    file.seek(first);
+
+    // Short first read so every later read starts on a sector boundary
+    uint32_t remaining = length;
+    size_t chunk = MEDIA_READ_CHUNK - (first % SD_SECTOR_SIZE);
+    size_t sent = 0;
+
+    while (remaining > 0) {
+        yieldToDecoder();
+        size_t want = chunk < remaining ? chunk : remaining;
+        int bytesRead;
+        {
+            TRACE_SCOPE(TRACE_SD, "SD.read");
+            bytesRead = file.read(mediaBuffer, want);
+        }
+        if (bytesRead <= 0) break;
+
+        size_t written = client.write(mediaBuffer, bytesRead);
+        sent += written;
+        remaining -= written;
+        if (written != (size_t)bytesRead) {
+            mediaStats.aborted++;   // Client went away, e.g. the player seeked elsewhere
+            break;
+        }
+        chunk = MEDIA_READ_CHUNK;
+    }
+
+    mediaStats.bytesSent += sent;
+    mediaStats.transferMs += millis() - started;
+    return sent;
+}
+
+void writeMediaStatsJson(JsonWriter& json) {
+    uint32_t kbps = mediaStats.transferMs > 0 ? mediaStats.bytesSent / mediaStats.transferMs : 0;
+    json.beginObject()
+        .numberField("transfers", mediaStats.transfers)
+        .numberField("rangeRequests", mediaStats.rangeRequests)
+        .numberField("unsatisfiable", mediaStats.unsatisfiable)
+        .numberField("aborted", mediaStats.aborted)
+        .numberField("bytesSent", mediaStats.bytesSent)
+        .numberField("transferMs", mediaStats.transferMs)
+        .numberField("throughputKBps", kbps)   // bytes per ms is roughly KB/s
+        .numberField("decoderBackoffs", mediaStats.backoffs)
+        .numberField("decoderBackoffMs", mediaStats.backoffMs)
+        .numberField("minDecoderFill", mediaStats.minDecoderFill)
+        .endObject();
+}
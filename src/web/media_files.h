@@ -0,0 +1,29 @@
+/**
+ * @file media_files.h
+ * @brief Large file transfers from the SD card with Range support
+ * @details Used for audio previews, recording downloads and SD-hosted UI files.
+ *          Answers single byte-range requests with 206 Partial Content, reads
+ *          the card in large sector-aligned chunks, and backs off while the
+ *          decoder's input buffer is low so playback keeps priority on the
+ *          SD bus. Web task only.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include <FS.h>
+#include "json_writer.h"
+
+/**
+ * @brief Send an open file as the response to the current request
+ * @param file Open file, left open for the caller to close
+ * @param contentType MIME type of the (decoded) content
+ * @param contentEncoding Content-Encoding header value, or nullptr
+ * @return Body bytes sent
+ */
+size_t sendFileWithRanges(File& file, const char* contentType, const char* contentEncoding = nullptr);
+
+/**
+ * @brief Write transfer throughput and decoder back-off counters as JSON
+ */
+void writeMediaStatsJson(JsonWriter& json);
@@ -0,0 +1,202 @@
+/**
+ * @file metrics.cpp
+ * @brief Runtime metrics implementation
+ */
+
+#include "metrics.h"
+#include "../managers/profiler.h"
+#include "../managers/memory_monitor.h"
+#include "../managers/logger.h"
+#include "../managers/program_events.h"
+#include "../hardware/i2s_health.h"
+#include <esp_heap_caps.h>
+
+#if PROFILER_ENABLED
+static void writeProfileJson(JsonWriter& json) {
+    uint32_t cyclesPerUs = getCpuFrequencyMhz();
+
+    json.key("profile").beginObject()
+        .numberField("cpuMhz", cyclesPerUs)
+        .key("stages").beginArray();
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++) {
+        ProfileStage stage = (ProfileStage)i;
+        ProfileHistogram histogram = getProfileHistogram(stage);
+
+        json.beginObject()
+            .stringField("name", getProfileStageName(stage))
+            .numberField("count", histogram.count)
+            .numberField("meanUs", histogram.count ? histogram.totalCycles / histogram.count / cyclesPerUs : 0)
+            .numberField("p50Us", getProfilePercentile(histogram, 50) / cyclesPerUs)
+            .numberField("p90Us", getProfilePercentile(histogram, 90) / cyclesPerUs)
+            .numberField("p99Us", getProfilePercentile(histogram, 99) / cyclesPerUs)
+            .numberField("maxUs", histogram.maxCycles / cyclesPerUs);
+
+        // Bucket n counts samples of 2^n to 2^(n+1)-1 cycles; trailing empty buckets are left out
+        int used = PROFILE_BUCKETS;
+        while (used > 0 && histogram.buckets[used - 1] == 0) used--;
+        json.key("log2Cycles").beginArray();
+        for (int bucket = 0; bucket < used; bucket++) {
+            json.numberValue(histogram.buckets[bucket]);
+        }
+        json.endArray().endObject();
+    }
+    json.endArray().endObject();
+}
+#endif
+
+static void writeAudioHealthJson(JsonWriter& json) {
+    I2sHealthStats health = getI2sHealthStats();
+    I2sGlitch glitches[I2S_GLITCH_HISTORY];
+    size_t count = getI2sGlitches(glitches, I2S_GLITCH_HISTORY);
+
+    json.key("audio").beginObject()
+        .numberField("underruns", health.underruns)
+        .numberField("underrunMs", health.silentUs / 1000)
+        .numberField("lastUnderrunMs", health.lastUnderrunMs)
+        .numberField("dmaCapacityFrames", health.capacityFrames)
+        .numberField("dmaFillFrames", health.fillFrames)
+        .numberField("dmaMinFillFrames", health.minFillFrames)
+        .numberField("blocks", health.blocks)
+        .key("glitches").beginArray();
+    for (size_t i = 0; i < count; i++) {
+        json.beginObject()
+            .numberField("t", glitches[i].timeMs)
+            .numberField("gapUs", glitches[i].gapUs)
+            .stringField("stage", getProfileStageName(glitches[i].stage))
+            .numberField("inputFill", glitches[i].inputFill)
+            .endObject();
+    }
+    json.endArray().endObject();
+}
+
+static void writeProgramEventsJson(JsonWriter& json) {
+    ProgramEventStats stats = getProgramEventStats();
+
+    json.key("program").beginObject()
+        .numberField("idleSleeps", stats.idleSleeps)
+        .numberField("idleMs", stats.idleMs)
+        .numberField("droppedEvents", stats.dropped)
+        .key("events").beginObject();
+    for (int i = 0; i < PROGRAM_EVENT_COUNT; i++) {
+        json.numberField(getProgramEventName((ProgramEventType)i), stats.delivered[i]);
+    }
+    json.endObject().endObject();
+}
+
+void writeMetricsJson(JsonWriter& json) {
+    json.beginObject()
+        .numberField("uptimeMs", millis());
+    writeAudioHealthJson(json);
+    writeProgramEventsJson(json);
+#if PROFILER_ENABLED
+    writeProfileJson(json);
+#else
+    json.key("profile").beginObject().boolField("enabled", false).endObject();
+#endif
+    json.endObject();
+}
+
+void writeMemoryJson(JsonWriter& json) {
+    size_t freeHeap = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    size_t largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+
+    json.beginObject()
+        .key("heap").beginObject()
+            .numberField("size", heap_caps_get_total_size(MALLOC_CAP_INTERNAL))
+            .numberField("free", freeHeap)
+            .numberField("minFree", heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL))
+            .numberField("largestBlock", largestBlock)
+            .numberField("fragmentation", freeHeap ? 100 - (uint64_t)largestBlock * 100 / freeHeap : 0)
+            .endObject()
+        .key("psram").beginObject()
+            .numberField("size", heap_caps_get_total_size(MALLOC_CAP_SPIRAM))
+            .numberField("free", heap_caps_get_free_size(MALLOC_CAP_SPIRAM))
+            .numberField("largestBlock", heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM))
+            .endObject();
+
+    MemoryTrend trend = getMemoryTrend();
+    json.key("trend").beginObject()
+        .boolField("valid", trend.valid)
+        .numberField("freePerMin", trend.freeHeapPerMin)
+        .numberField("largestBlockPerMin", trend.largestBlockPerMin)
+        .endObject();
+
+    uint32_t alertCount = 0;
+    MemoryAlert alert = getLastMemoryAlert(&alertCount);
+    json.key("alerts").beginObject()
+        .numberField("count", alertCount)
+        .stringField("last", getMemoryAlertName(alert.type))
+        .numberField("lastAt", alert.at)
+        .numberField("slopePerMin", alert.slopePerMin)
+        .numberField("minutesLeft", alert.minutesLeft)
+        .endObject();
+
+    MemorySample samples[MEMORY_HISTORY_SAMPLES];
+    size_t count = getMemoryHistory(samples, MEMORY_HISTORY_SAMPLES);
+    json.key("history").beginArray();
+    for (size_t i = 0; i < count; i++) {
+        json.beginObject()
+            .numberField("at", samples[i].at)
+            .numberField("free", samples[i].freeHeap)
+            .numberField("largestBlock", samples[i].largestBlock)
+            .numberField("fragmentation", samples[i].fragmentation)
+            .numberField("psramFree", samples[i].freePsram)
+            .endObject();
+    }
+    json.endArray();
+
+    json.boolField("tagging", MEMORY_TAGGING_ENABLED).key("tags").beginArray();
+    for (int i = 0; i < MEM_TAG_COUNT; i++) {
+        MemoryTagStats stats = getMemoryTagStats((MemoryTag)i);
+        json.beginObject()
+            .stringField("name", getMemoryTagName((MemoryTag)i))
+            .numberField("allocations", stats.allocations)
+            .numberField("frees", stats.frees)
+            .numberField("liveBytes", stats.liveBytes)
+            .numberField("peakBytes", stats.peakBytes)
+            .numberField("untracked", stats.untracked)
+            .endObject();
+    }
+    json.endArray().endObject();
+}
+
+static void writeLogFilterFields(JsonWriter& json) {
+    uint32_t tags = logRuntimeTags.load(std::memory_order_relaxed);
+
+    json.stringField("level", getLogLevelName((LogLevel)logRuntimeLevel.load(std::memory_order_relaxed)))
+        .key("tags").beginArray();
+    for (int i = 0; i < LOG_TAG_COUNT; i++) {
+        if ((tags >> i) & 1u) json.stringValue(getLogTagName((LogTag)i));
+    }
+    json.endArray();
+}
+
+void writeLogJson(JsonWriter& json, uint32_t since) {
+    static LogRecord records[LOG_TAIL_ENTRIES];   // Only the web task reads the tail
+    size_t count = readLogTail(since, records, LOG_TAIL_ENTRIES);
+    LogStats stats = getLogStats();
+
+    json.beginObject()
+        .numberField("next", count ? records[count - 1].id : since)
+        .numberField("written", stats.written)
+        .numberField("dropped", stats.dropped)
+        .numberField("truncated", stats.truncated);
+    writeLogFilterFields(json);
+    json.key("lines").beginArray();
+    for (size_t i = 0; i < count; i++) {
+        json.beginObject()
+            .numberField("id", records[i].id)
+            .numberField("t", records[i].timeMs)
+            .stringField("level", getLogLevelName(records[i].level))
+            .stringField("tag", getLogTagName(records[i].tag))
+            .stringField("msg", records[i].text)
+            .endObject();
+    }
+    json.endArray().endObject();
+}
+
+void writeLogConfigJson(JsonWriter& json) {
+    json.beginObject();
+    writeLogFilterFields(json);
+    json.endObject();
+}
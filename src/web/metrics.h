@@ -0,0 +1,37 @@
+/**
+ * @file metrics.h
+ * @brief Runtime metrics for /metrics
+ * @details Loop stage timing from the profiler, as histograms with max and
+ *          percentiles in microseconds, I2S underruns, the heap report for /memory and the
+ *          log tail for /log.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "json_writer.h"
+
+#define METRICS_JSON_SIZE 7424  // Every stage with all histogram buckets, the glitch history and event counts
+#define MEMORY_JSON_SIZE 3072   // Full sample history plus all tags
+#define LOG_JSON_SIZE 6144      // LOG_TAIL_ENTRIES escaped messages
+
+/**
+ * @brief Write all metrics as JSON
+ */
+void writeMetricsJson(JsonWriter& json);
+
+/**
+ * @brief Write heap, fragmentation, PSRAM, trends, alerts and per-subsystem allocations as JSON
+ */
+void writeMemoryJson(JsonWriter& json);
+
+/**
+ * @brief Write logged messages newer than a sequence number, plus logger counters and filter
+ * @param since Last id the client has seen (0 for everything kept)
+ */
+void writeLogJson(JsonWriter& json, uint32_t since);
+
+/**
+ * @brief Write the runtime log level and enabled tags
+ */
+void writeLogConfigJson(JsonWriter& json);
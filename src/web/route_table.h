@@ -0,0 +1,116 @@
+/**
+ * @file route_table.h
+ * @brief Compile-time perfect-hash route table
+ * @details The route list is a constexpr array. At compile time a hash seed is
+ *          searched so that every path lands in its own slot, which makes a
+ *          lookup one hash over the request path plus a single string compare.
+ *          Plain C++ with no Arduino dependency, so lookups can be benchmarked
+ *          on the host.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef void (*RouteHandler)();
+
+struct Route {
+    const char* path;
+    RouteHandler handler;
+};
+
+/**
+ * @brief FNV-1a over a path, mixed with a seed
+ */
+constexpr uint32_t routeHash(const char* path, size_t length, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)path[i];
+        hash *= 16777619u;
+    }
+    // Final avalanche so the low bits used for the slot depend on every byte
+    hash ^= hash >> 15;
+    hash *= 0x2c1b3c6du;
+    hash ^= hash >> 12;
+    return hash;
+}
+
+constexpr size_t routePathLength(const char* path) {
+    size_t length = 0;
+    while (path[length]) length++;
+    return length;
+}
+
+/**
+ * @brief Perfect-hash table over a fixed route list
+ * @tparam N Number of routes (at most 255)
+ * @tparam Slots Hash slots, a power of two. A single seed needs a sparse table:
+ *               256 slots keep the compile-time search short up to ~60 routes.
+ */
+template <size_t N, size_t Slots>
+class RouteTable {
+    static_assert(N < 256, "Slot indices are stored in a byte");
+    static_assert((Slots & (Slots - 1)) == 0, "Slots must be a power of two");
+    static_assert(Slots >= N, "Every route needs a slot");
+
+public:
+    constexpr RouteTable(const Route (&routes)[N]) : routes_(routes), seed_(findSeed(routes)) {
+        for (size_t i = 0; i < N; i++) {
+            slots_[slotFor(routes[i].path, routePathLength(routes[i].path), seed_)] = (uint8_t)(i + 1);
+        }
+    }
+
+    /**
+     * @brief Find the route for a request path
+     * @return Route or nullptr if the path is not in the table
+     */
+    const Route* find(const char* path, size_t length) const {
+        uint8_t slot = slots_[slotFor(path, length, seed_)];
+        if (slot == 0) return nullptr;
+        const Route& route = routes_[slot - 1];
+        return strcmp(route.path, path) == 0 ? &route : nullptr;
+    }
+
+    const Route* find(const char* path) const {
+        return find(path, strlen(path));
+    }
+
+    constexpr uint32_t seed() const { return seed_; }
+    constexpr size_t size() const { return N; }
+
+private:
+    static constexpr size_t slotFor(const char* path, size_t length, uint32_t seed) {
+        return routeHash(path, length, seed) & (Slots - 1);
+    }
+
+    static constexpr bool collisionFree(const Route (&routes)[N], uint32_t seed) {
+        bool used[Slots] = {};
+        for (size_t i = 0; i < N; i++) {
+            size_t slot = slotFor(routes[i].path, routePathLength(routes[i].path), seed);
+            if (used[slot]) return false;
+            used[slot] = true;
+        }
+        return true;
+    }
+
+    // Fails to compile (constexpr evaluation limit) rather than yield a table with collisions
+    static constexpr uint32_t findSeed(const Route (&routes)[N]) {
+        uint32_t seed = 0;
+        while (!collisionFree(routes, seed)) seed++;
+        return seed;
+    }
+
+    const Route* routes_;
+    uint32_t seed_;
+    uint8_t slots_[Slots] = {};
+};
+
+/**
+ * @brief Build a table with the slot count picked at the call site
+ */
+template <size_t Slots, size_t N>
+constexpr RouteTable<N, Slots> makeRouteTable(const Route (&routes)[N]) {
+    return RouteTable<N, Slots>(routes);
+}
@@ -0,0 +1,266 @@
+/**
+ * @file static_assets.cpp
+ * @brief Static web asset serving implementation
+ */
+
+#include "static_assets.h"
+#include "asset_bundle.h"
+#include "media_files.h"
+#include "../config/config.h"
+#include "../managers/logger.h"
+#include "../managers/tracer.h"
+#include <SD.h>
+#include <WebServer.h>
+#include <vector>
+
+static constexpr LogTag LOG_TAG = LOG_TAG_WEB;
+
+extern WebServer server;
+
+#define MAX_TRACKED_ROUTES 32
+
+// One manifest entry per asset under WEB_FILES_PATH
+struct AssetEntry {
+    String path;
+    String hash;
+    uint32_t size;
+    uint32_t gzSize;   // 0 if there is no .gz sibling
+};
+
+// Per-route accounting, only touched by the web task
+struct AssetStats {
+    String path;
+    uint32_t requests;
+    uint32_t notModified;
+    uint32_t bytesServed;
+    uint32_t bytesSaved;   // Bytes not sent thanks to gzip or a 304
+};
+
+static std::vector<AssetEntry> assetManifest;
+static std::vector<AssetStats> assetStats;
+static bool sdOverride = false;
+
+/**
+ * @brief Read an unsigned integer value following "key": within [from, to).
+ */
+static uint32_t readManifestNumber(const String& json, const char* key, int from, int to) {
+    int keyPos = json.indexOf(key, from);
+    if (keyPos == -1 || keyPos > to) return 0;
+    return json.substring(json.indexOf(':', keyPos) + 1).toInt();
+}
+
+size_t loadAssetManifest() {
+    assetManifest.clear();
+
+    // The flash bundle is the default UI; an artist opts into their own with /view/.override
+    sdOverride = SD.exists(String(WEB_FILES_PATH) + "/.override");
+    LOG_I("Web UI source: %s, %zu assets in flash", sdOverride ? "SD card (override)" : "flash bundle",
+          getBundledAssetCount());
+
+    File file = SD.open(String(WEB_FILES_PATH) + "/assets.json");
+    if (!file) {
+        LOG_I("No asset manifest on SD - serving assets uncompressed and uncached");
+        return 0;
+    }
+    String json = file.readString();
+    file.close();
+
+    // {"/app.js": {"gz": 4501, "hash": "cd041e0beb8a", "size": 20650}, ...}
+    int pos = 0;
+    while (true) {
+        int keyStart = json.indexOf("\"/", pos);
+        if (keyStart == -1) break;
+        int keyEnd = json.indexOf('"', keyStart + 1);
+        int entryEnd = json.indexOf('}', keyEnd);
+        if (keyEnd == -1 || entryEnd == -1) break;
+
+        AssetEntry entry;
+        entry.path = json.substring(keyStart + 1, keyEnd);
+        entry.size = readManifestNumber(json, "\"size\"", keyEnd, entryEnd);
+        entry.gzSize = readManifestNumber(json, "\"gz\"", keyEnd, entryEnd);
+
+        int hashKey = json.indexOf("\"hash\"", keyEnd);
+        if (hashKey != -1 && hashKey < entryEnd) {
+            int hashStart = json.indexOf('"', json.indexOf(':', hashKey)) + 1;
+            entry.hash = json.substring(hashStart, json.indexOf('"', hashStart));
+        }
+        assetManifest.push_back(entry);
+        pos = entryEnd + 1;
+    }
+
+    LOG_I("Loaded asset manifest with %zu entries", assetManifest.size());
+    return assetManifest.size();
+}
+
+static const AssetEntry* findAsset(const String& path) {
+    for (const auto& entry : assetManifest) {
+        if (entry.path == path) return &entry;
+    }
+    return nullptr;
+}
+
+static AssetStats* statsFor(const String& path) {
+    for (auto& stats : assetStats) {
+        if (stats.path == path) return &stats;
+    }
+    if (assetStats.size() >= MAX_TRACKED_ROUTES) {
+        return nullptr; // Unknown paths must not grow the table without bound
+    }
+    assetStats.push_back({path, 0, 0, 0, 0});
+    return &assetStats.back();
+}
+
+bool isSdAssetOverride() {
+    return sdOverride;
+}
+
+/**
+ * @brief Send caching headers and answer 304 if the client already has this representation.
+ * @return true if the request was completed with a 304
+ */
+static bool handleConditionalRequest(const String& hash, bool gzip, uint32_t variantSize, AssetStats* stats) {
+    // Strong ETag per representation, so gzip and identity never share one
+    String etag = "\"" + hash + (gzip ? "-gz\"" : "\"");
+    bool versioned = server.hasArg("v") && server.arg("v") == hash;
+
+    server.sendHeader("ETag", etag);
+    server.sendHeader("Vary", "Accept-Encoding");
+    server.sendHeader("Cache-Control", versioned ? "public, max-age=31536000, immutable" : "no-cache");
+
+    if (server.header("If-None-Match").indexOf(etag) >= 0) {
+        if (stats) {
+            stats->notModified++;
+            stats->bytesSaved += variantSize;
+        }
+        server.send(304);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Serve an asset straight out of the flash bundle.
+ */
+static void serveBundledAsset(const BundledAsset* asset, AssetStats* stats) {
+    if (handleConditionalRequest(asset->hash, asset->gzip, asset->length, stats)) {
+        return;
+    }
+    if (asset->gzip) {
+        server.sendHeader("Content-Encoding", "gzip");
+    }
+    // Zero-copy: send_P writes from the memory-mapped flash without a RAM buffer
+    server.send_P(200, asset->contentType, (PGM_P)asset->data, asset->length);
+
+    if (stats) {
+        stats->bytesServed += asset->length;
+        stats->bytesSaved += asset->rawSize - asset->length;
+    }
+}
+
+static String contentTypeFor(const String& path) {
+    if (path.endsWith(".html")) return "text/html";
+    if (path.endsWith(".css")) return "text/css";
+    if (path.endsWith(".js")) return "application/javascript";
+    if (path.endsWith(".json")) return "application/json";
+    if (path.endsWith(".png")) return "image/png";
+    if (path.endsWith(".jpg")) return "image/jpeg";
+    if (path.endsWith(".svg")) return "image/svg+xml";
+    if (path.endsWith(".ico")) return "image/x-icon";
+    return "text/plain";
+}
+
+void serveStaticAsset(String path) {
+    if (path.endsWith("/")) path += "index.html";
+
+    // Security check - prevent directory traversal
+    if (path.indexOf("..") >= 0) {
+        server.send_P(404, "text/plain", "Not Found");
+        return;
+    }
+
+    // Pages are templates and only go out rendered, through their routes; the manifest is internal
+    if (path.endsWith(".html") || path == "/assets.json") {
+        server.send_P(404, "text/plain", "Not Found");
+        return;
+    }
+
+    const BundledAsset* bundled = sdOverride ? nullptr : findBundledAsset(path);
+    const AssetEntry* asset = findAsset(path);
+
+    // With a manifest on SD, a path in neither source is a 404 without touching the SD bus
+    if (!bundled && !asset && !assetManifest.empty()) {
+        server.send_P(404, "text/plain", "Not Found");
+        return;
+    }
+
+    AssetStats* stats = statsFor(path);
+    if (stats) stats->requests++;
+    bool acceptsGzip = server.header("Accept-Encoding").indexOf("gzip") >= 0;
+
+    // A client without gzip support falls through to the raw copy on SD, if any,
+    // and still gets the bundled gzip when there is none
+    if (bundled && (!bundled->gzip || acceptsGzip)) {
+        serveBundledAsset(bundled, stats);
+        return;
+    }
+
+    // SD card: custom artist UI, or files the bundle does not contain
+    String sdPath = WEB_FILES_PATH + path;
+    bool useGzip = false;
+
+    if (asset) {
+        useGzip = asset->gzSize > 0 && acceptsGzip;
+        if (handleConditionalRequest(asset->hash, useGzip, useGzip ? asset->gzSize : asset->size, stats)) {
+            return;
+        }
+        if (useGzip) sdPath += ".gz";
+    }
+
+    File file;
+    {
+        TRACE_SCOPE_DETAIL(TRACE_SD, "SD.open", sdPath.c_str());
+        file = SD.open(sdPath);
+    }
+    if (!file) {
+        if (bundled && !asset) {
+            serveBundledAsset(bundled, stats);
+        } else {
+            server.send_P(404, "text/plain", "Not Found");
+        }
+        return;
+    }
+
+    size_t sent = sendFileWithRanges(file, contentTypeFor(path).c_str(), useGzip ? "gzip" : nullptr);
+    file.close();
+
+    if (stats) {
+        stats->bytesServed += sent;
+        if (useGzip) stats->bytesSaved += asset->size - asset->gzSize;
+    }
+}
+
+void writeAssetStatsJson(JsonWriter& json) {
+    uint32_t totalServed = 0;
+    uint32_t totalSaved = 0;
+
+    json.beginObject()
+        .stringField("source", sdOverride ? "sd" : "flash")
+        .numberField("bundledAssets", getBundledAssetCount())
+        .numberField("manifestEntries", assetManifest.size())
+        .key("routes").beginArray();
+    for (const AssetStats& stats : assetStats) {
+        json.beginObject()
+            .stringField("path", stats.path.c_str())
+            .numberField("requests", stats.requests)
+            .numberField("notModified", stats.notModified)
+            .numberField("bytesServed", stats.bytesServed)
+            .numberField("bytesSaved", stats.bytesSaved)
+            .endObject();
+        totalServed += stats.bytesServed;
+        totalSaved += stats.bytesSaved;
+    }
+    json.endArray()
+        .numberField("totalServed", totalServed)
+        .numberField("totalSaved", totalSaved)
+        .endObject();
+}
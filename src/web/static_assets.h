@@ -0,0 +1,42 @@
+/**
+ * @file static_assets.h
+ * @brief Static web asset serving with gzip, ETags and caching
+ * @details Serves the UI from the flash bundle, or from the SD card when the
+ *          artist override is present. SD assets use the assets.json manifest
+ *          written by scripts/build_assets.py for .gz siblings and ETags. Both
+ *          sources answer conditional requests with 304 and mark content-hashed
+ *          URLs as immutable.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include "json_writer.h"
+
+#define ASSET_STATS_JSON_SIZE 4096  // Enough for MAX_TRACKED_ROUTES routes
+
+/**
+ * @brief Pick the UI source and load the SD asset manifest
+ * @return Number of assets in the SD manifest (0 if none - SD assets are still served raw)
+ */
+size_t loadAssetManifest();
+
+/**
+ * @brief Check if the SD card overrides the flash bundle
+ * @return true if /view/.override exists on the SD card
+ */
+bool isSdAssetOverride();
+
+/**
+ * @brief Serve a static asset for the current request
+ * @details HTML pages and assets.json are never served raw - pages go through
+ *          sendHTMLPage() from their routes.
+ * @param path Request path, e.g. "/js/main.js"
+ */
+void serveStaticAsset(String path);
+
+/**
+ * @brief Write per-route byte accounting as JSON
+ * @param json Writer that receives bytes served and saved per route
+ */
+void writeAssetStatsJson(JsonWriter& json);
@@ -0,0 +1,207 @@
+/**
+ * @file status_events.cpp
+ * @brief Server-sent events push channel implementation
+ */
+
+#include "status_events.h"
+#include "web_utils.h"
+#include "../config/config.h"
+#include "../hardware/volume_control.h"
+#include "../hardware/i2s_health.h"
+#include "../managers/state_snapshot.h"
+
+// Everything the channel reports as deltas
+struct EventFields {
+    int volume;
+    RadioProgram currentProgram;
+    bool programActive;
+    bool audioRunning;
+    bool streamConnected;
+    bool timeshiftActive;
+    uint32_t trackSerial;
+    uint32_t underruns;
+    uint32_t freeHeap;
+};
+
+struct EventStats {
+    uint32_t subscribed;
+    uint32_t rejected;
+    uint32_t disconnected;
+    uint32_t events;
+    uint32_t heartbeats;
+    uint32_t bytesSent;
+};
+
+static WiFiClient subscribers[EVENT_MAX_SUBSCRIBERS];
+static EventFields lastSent;
+static uint32_t lastSendTime = 0;
+static EventStats eventStats = {};
+
+static EventFields readEventFields(const StateSnapshot& state) {
+    EventFields fields;
+    fields.volume = getCurrentVolume();
+    fields.currentProgram = state.currentProgram;
+    fields.programActive = state.programActive;
+    fields.audioRunning = state.audioRunning;
+    fields.streamConnected = state.streamConnected;
+    fields.timeshiftActive = state.timeshiftActive;
+    fields.trackSerial = state.trackSerial;
+    fields.underruns = getI2sHealthStats().underruns;
+    fields.freeHeap = ESP.getFreeHeap();
+    return fields;
+}
+
+static size_t subscriberCount() {
+    size_t count = 0;
+    for (WiFiClient& client : subscribers) {
+        if (client) count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Write one "data:" event to a subscriber, dropping it if the write fails.
+ */
+static bool writeEvent(WiFiClient& client, const char* data, size_t length) {
+    size_t written = client.write((const uint8_t*)"data: ", 6);
+    written += client.write((const uint8_t*)data, length);
+    written += client.write((const uint8_t*)"\n\n", 2);
+    if (written != length + 8) {
+        client.stop();
+        eventStats.disconnected++;
+        return false;
+    }
+    eventStats.bytesSent += written;
+    return true;
+}
+
+bool addStatusSubscriber(WiFiClient& client) {
+    WiFiClient* slot = nullptr;
+    for (WiFiClient& subscriber : subscribers) {
+        if (!subscriber.connected()) {
+            subscriber.stop();
+            slot = &subscriber;
+            break;
+        }
+    }
+    if (!slot) {
+        eventStats.rejected++;
+        return false;
+    }
+
+    // Copies share the socket, so it stays open after the server drops its reference
+    *slot = client;
+    slot->setNoDelay(true);
+    slot->print("HTTP/1.1 200 OK\r\n"
+                "Content-Type: text/event-stream\r\n"
+                "Cache-Control: no-cache\r\n"
+                "Connection: keep-alive\r\n\r\n"
+                "retry: 3000\n\n");
+
+    // Start from the full status; later events only carry what changed
+    size_t length;
+    const char* body = getStatusJson(&length);
+    if (writeEvent(*slot, body, length)) {
+        eventStats.subscribed++;
+    }
+
+    // First subscriber: deltas start from the state it was just sent
+    if (subscriberCount() == 1) {
+        lastSent = readEventFields(getStateSnapshot());
+        lastSendTime = millis();
+    }
+    return true;
+}
+
+void serviceStatusEvents() {
+    if (subscriberCount() == 0) return;
+
+    // Rate limit: changes inside the window are coalesced into the next event
+    uint32_t now = millis();
+    if (now - lastSendTime < EVENT_MIN_INTERVAL_MS) return;
+
+    StateSnapshot state = getStateSnapshot();
+    EventFields current = readEventFields(state);
+
+    char buffer[JSON_RESPONSE_SIZE];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject();
+    bool changed = false;
+
+    if (current.currentProgram != lastSent.currentProgram) {
+        json.stringField("currentProgram", getProgramName(current.currentProgram));
+        changed = true;
+    }
+    if (current.programActive != lastSent.programActive) {
+        json.boolField("programActive", current.programActive);
+        changed = true;
+    }
+    if (current.audioRunning != lastSent.audioRunning) {
+        json.boolField("audioRunning", current.audioRunning);
+        changed = true;
+    }
+    if (current.trackSerial != lastSent.trackSerial) {
+        json.stringField("track", state.trackName);
+        changed = true;
+    }
+    if (current.volume != lastSent.volume) {
+        json.numberField("volume", current.volume);
+        changed = true;
+    }
+    if (current.streamConnected != lastSent.streamConnected) {
+        json.boolField("streamConnected", current.streamConnected);
+        changed = true;
+    }
+    if (current.timeshiftActive != lastSent.timeshiftActive) {
+        json.boolField("timeshiftActive", current.timeshiftActive);
+        changed = true;
+    }
+    if (current.underruns != lastSent.underruns) {
+        // Only the newest glitch; /metrics has the history. gapUs is 0 while still silent.
+        I2sGlitch glitch;
+        json.numberField("underruns", current.underruns);
+        if (getI2sGlitches(&glitch, 1) == 1) {
+            json.key("lastUnderrun").beginObject()
+                .numberField("t", glitch.timeMs)
+                .numberField("gapUs", glitch.gapUs)
+                .stringField("stage", getProfileStageName(glitch.stage))
+                .numberField("inputFill", glitch.inputFill)
+                .endObject();
+        }
+        changed = true;
+    }
+
+    // Heap drifts constantly - on its own it is only worth an event when it moves noticeably
+    uint32_t heapDelta = current.freeHeap > lastSent.freeHeap ? current.freeHeap - lastSent.freeHeap
+                                                              : lastSent.freeHeap - current.freeHeap;
+    bool heartbeat = now - lastSendTime >= EVENT_HEARTBEAT_MS;
+    if (!changed && heapDelta < EVENT_HEAP_DELTA && !heartbeat) return;
+
+    json.numberField("freeHeap", current.freeHeap);
+    // The heartbeat keeps the connection alive and detects dead clients
+    if (heartbeat && !changed) {
+        json.numberField("uptime", now / 1000);
+        eventStats.heartbeats++;
+    }
+    json.endObject();
+
+    for (WiFiClient& client : subscribers) {
+        if (client) writeEvent(client, json.c_str(), json.length());
+    }
+    eventStats.events++;
+    lastSent = current;
+    lastSendTime = now;
+}
+
+void writeStatusEventStats(JsonWriter& json) {
+    json.beginObject()
+        .numberField("subscribers", subscriberCount())
+        .numberField("maxSubscribers", EVENT_MAX_SUBSCRIBERS)
+        .numberField("subscribed", eventStats.subscribed)
+        .numberField("rejected", eventStats.rejected)
+        .numberField("disconnected", eventStats.disconnected)
+        .numberField("events", eventStats.events)
+        .numberField("heartbeats", eventStats.heartbeats)
+        .numberField("bytesSent", eventStats.bytesSent)
+        .endObject();
+}
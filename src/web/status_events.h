@@ -0,0 +1,34 @@
+/**
+ * @file status_events.h
+ * @brief Server-sent events push channel for status changes
+ * @details Subscribers to /events get the full status once, then compact
+ *          deltas with only the fields that changed: program, track or note
+ *          start, volume, stream state, I2S underruns and heap. Changes are
+ *          coalesced and sent at most every EVENT_MIN_INTERVAL_MS, so a burst
+ *          of notes or volume clicks costs one event. Web task only.
+ */
+
+#pragma once
+
+#include "Arduino.h"
+#include <WiFi.h>
+#include "json_writer.h"
+
+/**
+ * @brief Take over a client as an event subscriber
+ * @details Writes the event-stream headers and the full status. The caller
+ *          must release its own reference to the connection afterwards.
+ * @param client Client of the current request
+ * @return false if the subscriber cap is reached (nothing was written)
+ */
+bool addStatusSubscriber(WiFiClient& client);
+
+/**
+ * @brief Send pending deltas and heartbeats, drop disconnected subscribers
+ */
+void serviceStatusEvents();
+
+/**
+ * @brief Write subscriber and traffic counters as JSON
+ */
+void writeStatusEventStats(JsonWriter& json);
@@ -0,0 +1,96 @@
+/**
+ * @file template_renderer.cpp
+ * @brief Streaming template renderer implementation
+ */
+
+#include "template_renderer.h"
+#include <string.h>
+
+// Placeholder names are upper case, as in %FREE_HEAP%
+static bool isNameChar(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+TemplateRenderer::TemplateRenderer(TemplateResolver resolver, TemplateSink sink, void* context)
+    : resolver_(resolver), sink_(sink), context_(context),
+      outputLength_(0), nameLength_(0), inPlaceholder_(false), written_(0) {}
+
+void TemplateRenderer::flush() {
+    if (outputLength_ == 0) return;
+    sink_(output_, outputLength_, context_);
+    written_ += outputLength_;
+    outputLength_ = 0;
+}
+
+void TemplateRenderer::put(char c) {
+    if (outputLength_ == TEMPLATE_OUTPUT_SIZE) flush();
+    output_[outputLength_++] = c;
+}
+
+void TemplateRenderer::put(const char* data, size_t length) {
+    while (length > 0) {
+        if (outputLength_ == TEMPLATE_OUTPUT_SIZE) flush();
+        size_t n = TEMPLATE_OUTPUT_SIZE - outputLength_;
+        if (n > length) n = length;
+        memcpy(output_ + outputLength_, data, n);
+        outputLength_ += n;
+        data += n;
+        length -= n;
+    }
+}
+
+// Emit an opening '%' and the name collected after it as literal text
+void TemplateRenderer::emitPending() {
+    put('%');
+    put(name_, nameLength_);
+    nameLength_ = 0;
+    inPlaceholder_ = false;
+}
+
+void TemplateRenderer::feed(const char* data, size_t length) {
+    const char* end = data + length;
+
+    while (data < end) {
+        if (!inPlaceholder_) {
+            // Copy literal text up to the next '%' in one go
+            const char* percent = (const char*)memchr(data, '%', end - data);
+            if (!percent) {
+                put(data, end - data);
+                return;
+            }
+            put(data, percent - data);
+            data = percent + 1;
+            inPlaceholder_ = true;
+            nameLength_ = 0;
+            continue;
+        }
+
+        char c = *data;
+        if (c == '%') {
+            name_[nameLength_] = '\0';
+            char value[TEMPLATE_VALUE_SIZE];
+            if (nameLength_ > 0 && resolver_(name_, value, sizeof(value))) {
+                put(value, strlen(value));
+                nameLength_ = 0;
+                inPlaceholder_ = false;
+                data++;
+            } else {
+                // "%FOO%VOLUME%" - the closing '%' may open the next placeholder
+                emitPending();
+            }
+        } else if (isNameChar(c) && nameLength_ < TEMPLATE_MAX_NAME) {
+            name_[nameLength_++] = c;
+            data++;
+        } else {
+            // Not a placeholder ("100%;"), reprocess c as literal text
+            emitPending();
+        }
+    }
+}
+
+void TemplateRenderer::finish() {
+    if (inPlaceholder_) {
+        emitPending();
+    }
+    flush();
+}
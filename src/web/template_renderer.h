@@ -0,0 +1,75 @@
+/**
+ * @file template_renderer.h
+ * @brief Streaming %PLACEHOLDER% substitution for HTML pages
+ * @details Input is fed in arbitrary chunks and output is flushed through a
+ *          sink in fixed-size pieces, so rendering a page needs a constant
+ *          amount of memory regardless of its size. Placeholders may span
+ *          chunk boundaries. Unknown names and stray '%' characters (CSS
+ *          widths, "%</p>") are passed through unchanged.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TEMPLATE_MAX_NAME 24      // Longest placeholder name, excluding the % delimiters
+#define TEMPLATE_OUTPUT_SIZE 512  // Output is handed to the sink in pieces of at most this size
+#define TEMPLATE_VALUE_SIZE 32    // Longest substituted value
+
+/**
+ * @brief Receives rendered output
+ * @param data Output bytes (not null-terminated)
+ * @param length Number of bytes
+ * @param context Caller context given to the renderer
+ */
+typedef void (*TemplateSink)(const char* data, size_t length, void* context);
+
+/**
+ * @brief Resolves a placeholder name to its value
+ * @param name Null-terminated placeholder name, e.g. "VOLUME"
+ * @param value Buffer for the null-terminated value
+ * @param valueSize Size of the value buffer
+ * @return false if the name is not a known variable (it is then emitted literally)
+ */
+typedef bool (*TemplateResolver)(const char* name, char* value, size_t valueSize);
+
+class TemplateRenderer {
+public:
+    TemplateRenderer(TemplateResolver resolver, TemplateSink sink, void* context);
+
+    /**
+     * @brief Render the next piece of the template
+     */
+    void feed(const char* data, size_t length);
+
+    /**
+     * @brief Flush any pending output, including an unterminated placeholder
+     */
+    void finish();
+
+    /**
+     * @brief Total bytes handed to the sink so far
+     */
+    uint32_t bytesWritten() const { return written_; }
+
+private:
+    void put(char c);
+    void put(const char* data, size_t length);
+    void flush();
+    void emitPending();
+
+    TemplateResolver resolver_;
+    TemplateSink sink_;
+    void* context_;
+
+    char output_[TEMPLATE_OUTPUT_SIZE];
+    size_t outputLength_;
+
+    // Name collected since the opening '%' - the carry-over between chunks
+    char name_[TEMPLATE_MAX_NAME + 1];
+    size_t nameLength_;
+    bool inPlaceholder_;
+
+    uint32_t written_;
+};
@@ -0,0 +1,114 @@
+/**
+ * @file trace_format.cpp
+ * @brief Chrome Trace Event JSON encoding
+ */
+
+#include "trace_format.h"
+#include "json_writer.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char* const CATEGORY_NAMES[TRACE_CATEGORY_COUNT] = {
+    "loop", "audio", "sd", "web", "program", "stream"
+};
+
+// Every event belongs to the one device process
+static const int TRACE_PID = 1;
+
+const char* getTraceCategoryName(TraceCategory category) {
+    return category < TRACE_CATEGORY_COUNT ? CATEGORY_NAMES[category] : "unknown";
+}
+
+bool parseTraceCategories(const char* list, uint32_t* mask) {
+    if (strcmp(list, "all") == 0) {
+        *mask = TRACE_ALL_CATEGORIES;
+        return true;
+    }
+
+    uint32_t parsed = 0;
+    while (*list) {
+        const char* end = strchr(list, ',');
+        size_t length = end ? (size_t)(end - list) : strlen(list);
+        if (length > 0) {
+            int found = -1;
+            for (int i = 0; i < TRACE_CATEGORY_COUNT; i++) {
+                if (strlen(CATEGORY_NAMES[i]) == length && strncmp(CATEGORY_NAMES[i], list, length) == 0) {
+                    found = i;
+                    break;
+                }
+            }
+            if (found < 0) return false;
+            parsed |= 1u << found;
+        }
+        list += length;
+        if (*list == ',') list++;
+    }
+    *mask = parsed;
+    return true;
+}
+
+void copyTraceDetail(char* detail, const char* text) {
+    // The end of a path or URL tells files and stations apart, the start rarely does
+    size_t length = strlen(text);
+    if (length >= TRACE_DETAIL_SIZE) {
+        text += length - (TRACE_DETAIL_SIZE - 1);
+        while ((*text & 0xC0) == 0x80) text++;   // Do not start inside a UTF-8 sequence
+    }
+    strncpy(detail, text, TRACE_DETAIL_SIZE - 1);
+    detail[TRACE_DETAIL_SIZE - 1] = '\0';
+}
+
+size_t writeTraceHeader(char* buffer, size_t size, const char* processName,
+                        const char* const* threadNames, size_t threadCount) {
+    JsonWriter json(buffer, size);
+    json.beginObject()
+        .stringField("displayTimeUnit", "ms")
+        .key("traceEvents").beginArray();
+
+    json.beginObject()
+        .stringField("name", "process_name")
+        .stringField("ph", "M")
+        .numberField("pid", TRACE_PID)
+        .key("args").beginObject().stringField("name", processName).endObject()
+        .endObject();
+    for (size_t i = 0; i < threadCount; i++) {
+        json.beginObject()
+            .stringField("name", "thread_name")
+            .stringField("ph", "M")
+            .numberField("pid", TRACE_PID)
+            .numberField("tid", i)
+            .key("args").beginObject().stringField("name", threadNames[i]).endObject()
+            .endObject();
+    }
+    return json.requiredSize() - 1;
+}
+
+size_t writeTraceEvent(char* buffer, size_t size, const TraceEvent& event, uint32_t originUs) {
+    if (size > 0) buffer[0] = ',';
+
+    char phase[2] = {event.phase, '\0'};
+    JsonWriter json(size > 1 ? buffer + 1 : nullptr, size > 1 ? size - 1 : 0);
+    json.beginObject()
+        .stringField("name", event.name)
+        .stringField("cat", getTraceCategoryName(event.category))
+        .stringField("ph", phase)
+        .numberField("ts", event.timeUs - originUs)   // Unsigned difference survives micros() wrapping
+        .numberField("pid", TRACE_PID)
+        .numberField("tid", event.thread);
+    if (event.phase == 'i') {
+        json.stringField("s", "t");   // Instant scoped to its thread
+    }
+    if (event.hasValue || event.detail[0]) {
+        json.key("args").beginObject();
+        if (event.hasValue) json.numberField("value", event.value);
+        if (event.detail[0]) json.stringField("detail", event.detail);
+        json.endObject();
+    }
+    json.endObject();
+    return json.requiredSize();   // Comma plus the object, without the terminator
+}
+
+size_t writeTraceFooter(char* buffer, size_t size, uint32_t dropped) {
+    int length = snprintf(buffer, size, "],\"otherData\":{\"droppedEvents\":%lu}}", (unsigned long)dropped);
+    return length > 0 ? (size_t)length : 0;
+}
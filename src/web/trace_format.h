@@ -0,0 +1,77 @@
+/**
+ * @file trace_format.h
+ * @brief Trace events and their Chrome Trace Event JSON encoding
+ * @details The firmware tracer records TraceEvents and the host simulator
+ *          produces the same records, so both are encoded here and open the
+ *          same way in Perfetto or chrome://tracing. No Arduino dependencies.
+ *
+ *          A document is the header, then one piece per event, then the
+ *          footer. Each piece is written separately so a trace far larger than
+ *          RAM can be streamed in small chunks.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum TraceCategory : uint8_t {
+    TRACE_LOOP,       // Audio loop iterations
+    TRACE_AUDIO,      // Decoder, hook and underruns
+    TRACE_SD,         // SD card file opens
+    TRACE_WEB,        // HTTP requests
+    TRACE_PROGRAM,    // Track, note and meme starts
+    TRACE_STREAM,     // Stream connects and reconnect states
+    TRACE_CATEGORY_COUNT
+};
+
+#define TRACE_DETAIL_SIZE 16
+#define TRACE_ALL_CATEGORIES ((1u << TRACE_CATEGORY_COUNT) - 1)
+
+struct TraceEvent {
+    uint32_t timeUs;                  // micros() when recorded
+    const char* name;                 // String literal
+    uint32_t value;                   // Numeric argument, if hasValue
+    TraceCategory category;
+    char phase;                       // 'B' begin, 'E' end, 'i' instant
+    uint8_t thread;                   // Index into the thread names
+    bool hasValue;
+    char detail[TRACE_DETAIL_SIZE];   // Tail of a path, URL or URI; empty if none
+};
+
+/**
+ * @brief Category name as used in traces and by parseTraceCategories()
+ */
+const char* getTraceCategoryName(TraceCategory category);
+
+/**
+ * @brief Parse "all" or a comma separated list of category names
+ * @return false if a name is unknown
+ */
+bool parseTraceCategories(const char* list, uint32_t* mask);
+
+/**
+ * @brief Copy the last TRACE_DETAIL_SIZE - 1 characters of text into a detail field
+ */
+void copyTraceDetail(char* detail, const char* text);
+
+/**
+ * @brief Write the document header and the process and thread names
+ * @return Length written, or the size needed if it did not fit (like snprintf)
+ */
+size_t writeTraceHeader(char* buffer, size_t size, const char* processName,
+                        const char* const* threadNames, size_t threadCount);
+
+/**
+ * @brief Write one event, preceded by the separating comma
+ * @param originUs Event time that becomes ts 0 (the oldest event in the trace)
+ * @return Length written, or the size needed if it did not fit
+ */
+size_t writeTraceEvent(char* buffer, size_t size, const TraceEvent& event, uint32_t originUs);
+
+/**
+ * @brief Write the document footer
+ * @param dropped Events lost to the ring wrapping, reported in otherData
+ * @return Length written, or the size needed if it did not fit
+ */
+size_t writeTraceFooter(char* buffer, size_t size, uint32_t dropped);
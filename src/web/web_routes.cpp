@@ -5,80 +5,134 @@
 
 #include "web_routes.h"
 #include "http_handlers.h"
+#include "route_table.h"
 #include "../config/config.h"
+#include "../managers/profiler.h"
+#include "../managers/logger.h"
+#include "../managers/tracer.h"
 #include <WiFi.h>
 
+static constexpr LogTag LOG_TAG = LOG_TAG_WEB;
+
 // Web server instance
 WebServer server(WEB_SERVER_PORT);
 static bool webServerActive = false;
 
-void setupWebRoutes() {
+// Control endpoints. Anything else is a static asset from the view/ bundle or SD folder.
+static constexpr Route ROUTES[] = {
     // Basic pages
-    server.on("/", handleRoot);
-    server.on("/meme", handleMemePage);
-    server.on("/status", handleStatus);
-    
+    {"/", handleRoot},
+    {"/index.html", handleRoot},
+    {"/meme", handleMemePage},
+    {"/meme.html", handleMemePage},
+    {"/status", handleStatus},
+    {"/events", handleStatusEvents},
+    {"/events/stats", handleStatusEventStats},
+
     // Volume control endpoints
-    server.on("/volume/up", handleVolumeUp);
-    server.on("/volume/down", handleVolumeDown);
-    server.on("/volume/set", handleSetVolume);
-    server.on("/test", handleVolumeTest);
-    
+    {"/volume/up", handleVolumeUp},
+    {"/volume/down", handleVolumeDown},
+    {"/volume/set", handleSetVolume},
+    {"/test", handleVolumeTest},
+
     // Playback control endpoints
-    server.on("/random", handleRandomPlay);
-    server.on("/stop", handleStop);
-    server.on("/pause", handlePause);
-    server.on("/resume", handleResume);
-    
+    {"/random", handleRandomPlay},
+    {"/stop", handleStop},
+    {"/pause", handlePause},
+    {"/resume", handleResume},
+
     // System endpoints
-    server.on("/memory", handleMemoryCheck);
-    server.on("/wifi/reset", handleWiFiReset);
-    server.on("/wifi/config", handleWiFiConfig);
-    
+    {"/memory", handleMemoryCheck},
+    {"/assets/stats", handleAssetStats},
+    {"/metrics", handleMetrics},
+    {"/log", handleLogTail},
+    {"/log/config", handleLogConfig},
+    {"/trace", handleTraceDownload},
+    {"/trace/start", handleTraceStart},
+    {"/trace/stop", handleTraceStop},
+    {"/wifi/reset", handleWiFiReset},
+    {"/wifi/config", handleWiFiConfig},
+
+    // Batched commands
+    {"/api/batch", handleApiBatch},
+
     // Radio program endpoints
-    server.on("/program/shuffle", handleProgramShuffle);
-    server.on("/program/generative", handleProgramGenerative);
-    server.on("/program/stream", handleProgramStream);
-    server.on("/program/newstream", handleProgramNewStream);
-    server.on("/program/status", handleProgramStatus);
-    
+    {"/program/shuffle", handleProgramShuffle},
+    {"/program/generative", handleProgramGenerative},
+    {"/program/stream", handleProgramStream},
+    {"/program/newstream", handleProgramNewStream},
+    {"/program/status", handleProgramStatus},
+
     // Program-specific endpoints
-    server.on("/shuffle/next", handleShuffleNext);
-    server.on("/shuffle/folder", handleShuffleFolder);
-    server.on("/generative/sequence", handleGenerativeSequence);
-    server.on("/generative/regenerate", handleGenerativeRegenerate);
-    server.on("/stream/connect", handleStreamConnect);
-    server.on("/stream/reset", handleStreamReset);
-    
+    {"/shuffle/next", handleShuffleNext},
+    {"/shuffle/folder", handleShuffleFolder},
+    {"/generative/sequence", handleGenerativeSequence},
+    {"/generative/regenerate", handleGenerativeRegenerate},
+    {"/stream/connect", handleStreamConnect},
+    {"/stream/reset", handleStreamReset},
+    {"/stream/list", handleStreamList},
+    {"/stream/refresh", handleStreamRefresh},
+
+    // Recording and time-shift endpoints
+    {"/record/start", handleRecordStart},
+    {"/record/stop", handleRecordStop},
+    {"/record/status", handleRecordStatus},
+    {"/record/export", handleRecordExport},
+    {"/timeshift/pause", handleTimeshiftPause},
+    {"/timeshift/resume", handleTimeshiftResume},
+    {"/timeshift/seek", handleTimeshiftSeek},
+    {"/timeshift/live", handleTimeshiftLive},
+
+    // Media previews and downloads
+    {"/media", handleMediaFile},
+    {"/media/stats", handleMediaStats},
+
     // Meme soundboard endpoints
-    server.on("/meme/list", handleMemeList);
-    server.on("/meme/play", handleMemePlay);
-    
-    // Static file endpoints
-    server.on("/style.css", handleStaticFile);
-    server.on("/app.js", handleStaticFile);
-    server.on("/favicon.ico", handleStaticFile);
-    
-    // JavaScript module endpoints
-    server.on("/js/volume.js", handleStaticFile);
-    server.on("/js/status.js", handleStaticFile);
-    server.on("/js/program.js", handleStaticFile);
-    server.on("/js/notifications.js", handleStaticFile);
-    server.on("/js/utils.js", handleStaticFile);
-    server.on("/js/playback.js", handleStaticFile);
-    server.on("/js/generative.js", handleStaticFile);
-    server.on("/js/main.js", handleStaticFile);
-    server.on("/js/stream.js", handleStaticFile);
-    server.on("/js/meme.js", handleStaticFile);
+    {"/meme/list", handleMemeList},
+    {"/meme/play", handleMemePlay},
+    {"/meme/stats", handleMemeStats}
+};
+
+static constexpr auto routeTable = makeRouteTable<ROUTE_TABLE_SLOTS>(ROUTES);
+
+/**
+ * @brief Single catch-all handler dispatching through the perfect-hash table.
+ * @details Replaces one RequestHandler per path, which the server walked linearly.
+ */
+class RouteTableHandler : public RequestHandler {
+public:
+    bool canHandle(HTTPMethod method, const String& uri) override {
+        return true;
+    }
+
+    bool handle(WebServer& server, HTTPMethod method, const String& uri) override {
+        TRACE_SCOPE_DETAIL(TRACE_WEB, "http", uri.c_str());
+        const Route* route = routeTable.find(uri.c_str(), uri.length());
+        if (route) {
+            PROFILE_SCOPE(PROFILE_HTTP_ROUTE);
+            route->handler();
+        } else if (method == HTTP_GET || method == HTTP_HEAD) {
+            PROFILE_SCOPE(PROFILE_HTTP_STATIC);
+            handleStaticFile();
+        } else {
+            handleNotFound(uri);
+        }
+        return true;
+    }
+};
+
+void setupWebRoutes() {
+    server.addHandler(new RouteTableHandler());
     
-    // 404 handler
-    server.onNotFound(handleNotFound);
+    // Request headers needed by conditional GET and Range handlers
+    static const char* headerKeys[] = { "If-None-Match", "Accept-Encoding", "Range" };
+    server.collectHeaders(headerKeys, sizeof(headerKeys) / sizeof(headerKeys[0]));
 }
 
 bool startWebServer() {
     // Check if WiFi is connected or in AP mode
     if (WiFi.status() != WL_CONNECTED && WiFi.getMode() != WIFI_AP && WiFi.getMode() != WIFI_AP_STA) {
-        Serial.println("WiFi not connected and not in AP mode. Web server not started.");
+        LOG_I("WiFi not connected and not in AP mode. Web server not started.");
         return false;
     }
     
@@ -96,7 +150,7 @@ void stopWebServer() {
     if (webServerActive) {
         server.stop();
         webServerActive = false;
-        Serial.println("Web server stopped.");
+        LOG_I("Web server stopped.");
     }
 }
 
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <WebServer.h>
+#include <detail/RequestHandler.h>
 
 // External web server instance
 extern WebServer server;
@@ -7,77 +7,178 @@
 #include "../config/config.h"
 #include "../hardware/volume_control.h"
 #include "../managers/radio_manager.h"
+#include "../managers/state_snapshot.h"
 #include "../managers/connection_manager.h"
 #include "../hardware/hardware_setup.h"
+#include "asset_bundle.h"
+#include "static_assets.h"
+#include "template_renderer.h"
+#include "json_writer.h"
+#include "../managers/logger.h"
+#include "../managers/tracer.h"
 #include <WiFi.h>
 #include <SD.h>
 #include <Audio.h>
+#include <WebServer.h>
+
+static constexpr LogTag LOG_TAG = LOG_TAG_WEB;
 
 // External references
 extern Audio audio;
+extern WebServer server;
 
-String loadHTMLFromSD(const char* filename) {
-    String fullPath = String(WEB_FILES_PATH) + filename;
-    File htmlFile = SD.open(fullPath);
-    if (!htmlFile) {
-        Serial.println("Failed to open HTML file: " + fullPath);
-        return "<html><body><h1>Error: Web files not found on SD card</h1><p>Please copy web files to SD card " + String(WEB_FILES_PATH) + " folder</p></body></html>";
-    }
-    
-    String html = "";
-    while (htmlFile.available()) {
-        html += char(htmlFile.read());
+/**
+ * @brief Resolve page template variables without touching the heap.
+ */
+static bool resolvePageVariable(const char* name, char* value, size_t valueSize) {
+    if (strcmp(name, "VOLUME") == 0) {
+        snprintf(value, valueSize, "%d", getCurrentVolume());
+    } else if (strcmp(name, "WIFI_IP") == 0) {
+        IPAddress ip = WiFi.localIP();
+        snprintf(value, valueSize, "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    } else if (strcmp(name, "UPTIME") == 0) {
+        snprintf(value, valueSize, "%lu", (unsigned long)(millis() / 1000));
+    } else if (strcmp(name, "FREE_HEAP") == 0) {
+        snprintf(value, valueSize, "%lu", (unsigned long)ESP.getFreeHeap());
+    } else {
+        return false;
     }
-    htmlFile.close();
-    
-    // Process template variables
-    html.replace("%VOLUME%", String(getCurrentVolume()));
-    html.replace("%WIFI_IP%", WiFi.localIP().toString());
-    html.replace("%UPTIME%", String(millis() / 1000));
-    html.replace("%FREE_HEAP%", String(ESP.getFreeHeap()));
-    
-    return html;
+    return true;
 }
 
-String generateMainPage() {
-    return loadHTMLFromSD("/index.html");
+static void sendPageChunk(const char* data, size_t length, void* context) {
+    server.sendContent(data, length);
 }
 
-String generateStatusJson() {
-    ProgramState& state = getProgramState();
-    String programName;
-    
-    switch (state.currentProgram) {
+void sendHTMLPage(const char* filename) {
+    // Pages are bundled uncompressed, so the flash copy can be templated directly
+    const BundledAsset* bundled = isSdAssetOverride() ? nullptr : findBundledAsset(filename);
+    File htmlFile;
+    if (!bundled || bundled->gzip) {
+        String fullPath = String(WEB_FILES_PATH) + filename;
+        TRACE_SCOPE_DETAIL(TRACE_SD, "SD.open", fullPath.c_str());
+        htmlFile = SD.open(fullPath);
+        if (!htmlFile) {
+            LOG_W("Failed to open HTML file: %s", fullPath.c_str());
+            server.send(200, "text/html", "<html><body><h1>Error: Web files not found on SD card</h1><p>Please copy web files to SD card " + String(WEB_FILES_PATH) + " folder</p></body></html>");
+            return;
+        }
+    }
+
+    // Length is unknown until placeholders are substituted - HTTP/1.1 clients get chunked encoding
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/html", "");
+
+    TemplateRenderer renderer(resolvePageVariable, sendPageChunk, nullptr);
+    if (htmlFile) {
+        uint8_t chunk[TEMPLATE_READ_CHUNK];
+        int bytesRead;
+        while ((bytesRead = htmlFile.read(chunk, sizeof(chunk))) > 0) {
+            renderer.feed((const char*)chunk, bytesRead);
+        }
+        htmlFile.close();
+    } else {
+        // Memory-mapped flash is read in place, no copy needed
+        for (uint32_t offset = 0; offset < bundled->length; offset += TEMPLATE_READ_CHUNK) {
+            uint32_t length = min((uint32_t)TEMPLATE_READ_CHUNK, bundled->length - offset);
+            renderer.feed((const char*)bundled->data + offset, length);
+        }
+    }
+    renderer.finish();
+
+    // Zero-length chunk terminates the response
+    server.sendContent("");
+}
+
+// Values /status reports that change only on events. Uptime and free heap
+// change between almost any two requests, so they stay out of the cache key.
+struct StatusFields {
+    int volume;
+    uint32_t ip;
+    RadioProgram currentProgram;
+    bool programActive;
+    bool audioRunning;
+    ConnectionMode connectionMode;
+
+    bool operator==(const StatusFields& other) const {
+        return volume == other.volume && ip == other.ip && currentProgram == other.currentProgram &&
+               programActive == other.programActive && audioRunning == other.audioRunning &&
+               connectionMode == other.connectionMode;
+    }
+};
+
+// Cached /status body, only touched by the web task. The rendered object is
+// kept without its closing brace; uptime and free heap go after it per request.
+static char statusBody[STATUS_JSON_SIZE];
+static size_t statusStableLength = 0;
+static size_t statusLength = 0;
+static StatusFields renderedStatus;
+static bool statusRendered = false;
+
+const char* getProgramName(RadioProgram program) {
+    switch (program) {
         case SHUFFLE_PROGRAM:
-            programName = "SHUFFLE";
-            break;
+            return "SHUFFLE";
         case GENERATIVE_PROGRAM:
-            programName = "GENERATIVE";
-            break;
+            return "GENERATIVE";
         case STREAM_PROGRAM:
-            programName = "STREAM";
-            break;
+            return "STREAM";
     }
-    
-    String json = "{";
-    json += "\"volume\":" + String(getCurrentVolume()) + ",";
-    json += "\"wifi\":\"" + WiFi.localIP().toString() + "\",";
-    json += "\"uptime\":" + String(millis() / 1000) + ",";
-    json += "\"freeHeap\":" + String(ESP.getFreeHeap()) + ",";
-    json += "\"totalHeap\":" + String(ESP.getHeapSize()) + ",";
-    json += "\"flashSize\":" + String(ESP.getFlashChipSize()) + ",";
-    json += "\"freeSketchSpace\":" + String(ESP.getFreeSketchSpace()) + ",";
-    json += "\"playbackActive\":" + String(isPlaybackActive() ? "true" : "false") + ",";
-    json += "\"currentProgram\":\"" + programName + "\",";
-    json += "\"programActive\":" + String(state.programActive ? "true" : "false") + ",";
-    json += "\"connectionMode\":\"" + String(getConnectionMode() == ONLINE ? "ONLINE" : "OFFLINE") + "\"";
-    json += "}";
-    
-    return json;
+    return "";
+}
+
+static void renderStatusJson(const StatusFields& fields) {
+    // Fixed for the lifetime of the firmware
+    static const uint32_t totalHeap = ESP.getHeapSize();
+    static const uint32_t flashSize = ESP.getFlashChipSize();
+    static const uint32_t freeSketchSpace = ESP.getFreeSketchSpace();
+
+    IPAddress ip(fields.ip);
+    JsonWriter json(statusBody, sizeof(statusBody));
+    json.beginObject()
+        .numberField("volume", fields.volume)
+        .stringFieldf("wifi", "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3])
+        .numberField("totalHeap", totalHeap)
+        .numberField("flashSize", flashSize)
+        .numberField("freeSketchSpace", freeSketchSpace)
+        .boolField("playbackActive", fields.programActive)
+        .boolField("audioRunning", fields.audioRunning)
+        .stringField("currentProgram", getProgramName(fields.currentProgram))
+        .boolField("programActive", fields.programActive)
+        .stringField("connectionMode", fields.connectionMode == ONLINE ? "ONLINE" : "OFFLINE")
+        .endObject();
+    statusStableLength = json.length() - 1;   // Drop the '}'
+}
+
+const char* getStatusJson(size_t* length) {
+    // Read the published snapshot - this runs on the web task, not the audio loop
+    StateSnapshot state = getStateSnapshot();
+
+    StatusFields fields;
+    fields.volume = getCurrentVolume();
+    fields.ip = (uint32_t)WiFi.localIP();
+    fields.currentProgram = state.currentProgram;
+    fields.programActive = state.programActive;
+    fields.audioRunning = state.audioRunning;
+    fields.connectionMode = getConnectionMode();
+
+    // Polling tabs get the cached body until something they show changes
+    if (!statusRendered || !(fields == renderedStatus)) {
+        renderStatusJson(fields);
+        renderedStatus = fields;
+        statusRendered = true;
+    }
+
+    int tail = snprintf(statusBody + statusStableLength, sizeof(statusBody) - statusStableLength,
+                        ",\"uptime\":%lu,\"freeHeap\":%lu}", (unsigned long)(millis() / 1000),
+                        (unsigned long)ESP.getFreeHeap());
+    statusLength = min(statusStableLength + (size_t)tail, sizeof(statusBody) - 1);
+    *length = statusLength;
+    return statusBody;
 }
 
 void checkMemoryLimits() {
-    Serial.println("=== MEMORY USAGE REPORT ===");
+    LOG_I("=== MEMORY USAGE REPORT ===");
     
     // Flash memory (program storage)
     size_t flashSize = ESP.getFlashChipSize();
@@ -86,11 +187,11 @@ void checkMemoryLimits() {
     
     float flashUsedPercent = ((float)sketchSize / flashSize) * 100;
     
-    Serial.printf("Flash Memory:\n");
-    Serial.printf("  Total Flash: %d bytes (%.1f MB)\n", flashSize, flashSize / 1048576.0);
-    Serial.printf("  Sketch Size: %d bytes (%.1f KB)\n", sketchSize, sketchSize / 1024.0);
-    Serial.printf("  Free Space:  %d bytes (%.1f KB)\n", freeSketchSpace, freeSketchSpace / 1024.0);
-    Serial.printf("  Used: %.1f%%\n", flashUsedPercent);
+    LOG_I("Flash Memory:");
+    LOG_I("  Total Flash: %zu bytes (%.1f MB)", flashSize, flashSize / 1048576.0);
+    LOG_I("  Sketch Size: %zu bytes (%.1f KB)", sketchSize, sketchSize / 1024.0);
+    LOG_I("  Free Space:  %zu bytes (%.1f KB)", freeSketchSpace, freeSketchSpace / 1024.0);
+    LOG_I("  Used: %.1f%%", flashUsedPercent);
     
     // RAM memory (runtime)
     size_t totalHeap = ESP.getHeapSize();
@@ -99,25 +200,25 @@ void checkMemoryLimits() {
     
     float ramUsedPercent = ((float)usedHeap / totalHeap) * 100;
     
-    Serial.printf("RAM Memory:\n");
-    Serial.printf("  Total RAM: %d bytes (%.1f KB)\n", totalHeap, totalHeap / 1024.0);
-    Serial.printf("  Used RAM:  %d bytes (%.1f KB)\n", usedHeap, usedHeap / 1024.0);
-    Serial.printf("  Free RAM:  %d bytes (%.1f KB)\n", freeHeap, freeHeap / 1024.0);
-    Serial.printf("  Used: %.1f%%\n", ramUsedPercent);
+    LOG_I("RAM Memory:");
+    LOG_I("  Total RAM: %zu bytes (%.1f KB)", totalHeap, totalHeap / 1024.0);
+    LOG_I("  Used RAM:  %zu bytes (%.1f KB)", usedHeap, usedHeap / 1024.0);
+    LOG_I("  Free RAM:  %zu bytes (%.1f KB)", freeHeap, freeHeap / 1024.0);
+    LOG_I("  Used: %.1f%%", ramUsedPercent);
     
     // Warnings
     if (flashUsedPercent > 80) {
-        Serial.println("⚠️  WARNING: Flash usage > 80% - Consider removing features!");
+        LOG_I("⚠️  WARNING: Flash usage > 80%% - Consider removing features!");
     }
     if (flashUsedPercent > 90) {
-        Serial.println("🚨 CRITICAL: Flash usage > 90% - May not fit on ESP32!");
+        LOG_I("🚨 CRITICAL: Flash usage > 90%% - May not fit on ESP32!");
     }
     if (ramUsedPercent > 70) {
-        Serial.println("⚠️  WARNING: RAM usage > 70% - System may become unstable!");
+        LOG_I("⚠️  WARNING: RAM usage > 70%% - System may become unstable!");
     }
     if (ramUsedPercent > 85) {
-        Serial.println("🚨 CRITICAL: RAM usage > 85% - System likely to crash!");
+        LOG_I("🚨 CRITICAL: RAM usage > 85%% - System likely to crash!");
     }
     
-    Serial.println("===========================");
+    LOG_I("===========================");
 }
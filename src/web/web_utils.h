@@ -7,25 +7,30 @@
 #pragma once
 
 #include "Arduino.h"
+#include "../managers/radio_manager.h"
 
 /**
- * @brief Load HTML file from SD card with template processing
- * @param filename HTML file name to load
- * @return Processed HTML content
+ * @brief Render an HTML page template to the current request
+ * @details Reads the flash bundle, or the SD card when the artist override is present,
+ *          in fixed chunks and streams it with chunked transfer encoding
+ * @param filename HTML file name to send, e.g. "/index.html"
  */
-String loadHTMLFromSD(const char* filename);
+void sendHTMLPage(const char* filename);
 
 /**
- * @brief Generate main control page HTML
- * @return HTML content for main page
+ * @brief Get the name a program is reported under
+ * @return "SHUFFLE", "GENERATIVE" or "STREAM"
  */
-String generateMainPage();
+const char* getProgramName(RadioProgram program);
 
 /**
- * @brief Generate system status JSON
- * @return JSON string with system status
+ * @brief Get the system status JSON
+ * @details The body is cached and only re-rendered when a value other than uptime
+ *          or free heap changes; those two are written in on every call
+ * @param length Receives the body length
+ * @return Null-terminated JSON, valid until the next call (web task only)
  */
-String generateStatusJson();
+const char* getStatusJson(size_t* length);
 
 /**
  * @brief Check memory limits and log report
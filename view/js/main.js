@@ -1,9 +1,8 @@
 // main.js - Main initialization and global variables
-import { updateStatus } from './status.js';
+import { subscribeStatus, unsubscribeStatus } from './status.js';
 import { showNotification } from './notifications.js';
 
 // Global variables
-export let statusUpdateInterval;
 export let isVolumeChanging = false;
 export let currentProgram = 'GENERATIVE';
 export let programStatus = {};
@@ -12,11 +11,8 @@ export let connectionMode = 'UNKNOWN';
 export function initializeApp() {
     console.log('GhostWhisper Control Panel loaded');
     
-    // Initial status update
-    updateStatus();
-    
-    // Set up periodic status updates (every 5 seconds)
-    statusUpdateInterval = setInterval(updateStatus, 5000);
+    // Status is pushed by the device; falls back to polling every 5 seconds
+    subscribeStatus();
     
     // Add smooth transitions to volume slider
     const volumeSlider = document.getElementById('volumeSlider');
@@ -36,9 +32,7 @@ export function initializeApp() {
 }
 
 export function cleanupApp() {
-    if (statusUpdateInterval) {
-        clearInterval(statusUpdateInterval);
-    }
+    unsubscribeStatus();
 }
 
 export function runVolumeTest() {
@@ -20,6 +20,14 @@ export async function loadMemeButtons() {
                 button.textContent = `${index + 1}: ${filename}`;
                 button.onclick = () => playMeme(index + 1);
                 memeButtonsContainer.appendChild(button);
+
+                // Listen on the phone without interrupting the speaker
+                const preview = document.createElement('button');
+                preview.className = 'button';
+                preview.textContent = '\u{1F3A7}';
+                preview.title = 'Preview on this device';
+                preview.onclick = () => previewMeme(file);
+                memeButtonsContainer.appendChild(preview);
             });
             console.log(`Loaded ${data.files.length} meme buttons`);
         } else {
@@ -49,3 +57,15 @@ export async function playMeme(number) {
         showNotification('Error playing meme', 'error');
     }
 }
+
+let previewAudio = null;
+
+// The player fetches the clip with Range requests, so seeking is cheap
+export function previewMeme(file) {
+    if (previewAudio) previewAudio.pause();
+    previewAudio = new Audio('/media?path=' + encodeURIComponent(file));
+    previewAudio.play().catch(error => {
+        console.error('Preview error:', error);
+        showNotification('Error previewing meme', 'error');
+    });
+}
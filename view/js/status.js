@@ -3,34 +3,49 @@
 import { updateProgramButtons, updateProgramControls } from './program.js';
 import { formatUptime, formatBytes } from './utils.js';
 
+// Last known status; push events only carry the fields that changed
+let status = {};
+let uptimeReceivedAt = Date.now();
+let events = null;
+let pollInterval = null;
+
+function renderStatus(data) {
+    if (data.connectionMode) window.connectionMode = data.connectionMode;
+    const statusDiv = document.getElementById('status');
+    if (statusDiv) {
+        statusDiv.innerHTML =
+            '<h3>System Status</h3>' +
+            '<p><strong>Current Program:</strong> ' + (data.currentProgram || 'Unknown') + '</p>' +
+            '<p><strong>Program Active:</strong> ' + (data.programActive ? 'Yes' : 'No') + '</p>' +
+            '<p><strong>Audio Running:</strong> ' + (data.audioRunning ? 'Yes' : 'No') + '</p>' +
+            (data.track ? '<p><strong>Now Playing:</strong> ' + data.track.split('/').pop() + '</p>' : '') +
+            '<p><strong>Volume:</strong> ' + data.volume + '%</p>' +
+            '<p><strong>WiFi:</strong> ' + data.wifi + '</p>' +
+            '<p><strong>Connection Mode:</strong> ' + (data.connectionMode || 'Unknown') + '</p>' +
+            '<p><strong>Uptime:</strong> ' + formatUptime(data.uptime + Math.floor((Date.now() - uptimeReceivedAt) / 1000)) + '</p>' +
+            '<p><strong>Free Heap:</strong> ' + formatBytes(data.freeHeap) + '</p>';
+        const currentProgramSpan = document.getElementById('currentProgram');
+        if (currentProgramSpan && data.currentProgram) {
+            currentProgramSpan.textContent = data.currentProgram;
+            window.currentProgram = data.currentProgram;
+            updateProgramButtons(data.currentProgram);
+            updateProgramControls(data.currentProgram.toLowerCase());
+        }
+        statusDiv.classList.add('status-update');
+        setTimeout(() => statusDiv.classList.remove('status-update'), 500);
+    }
+}
+
+function mergeStatus(data) {
+    Object.assign(status, data);
+    if (data.uptime !== undefined) uptimeReceivedAt = Date.now();
+    renderStatus(status);
+}
+
 export function updateStatus() {
     fetch('/status')
         .then(response => response.json())
-        .then(data => {
-            if (data.connectionMode) window.connectionMode = data.connectionMode;
-            const statusDiv = document.getElementById('status');
-            if (statusDiv) {
-                statusDiv.innerHTML =
-                    '<h3>System Status</h3>' +
-                    '<p><strong>Current Program:</strong> ' + (data.currentProgram || 'Unknown') + '</p>' +
-                    '<p><strong>Program Active:</strong> ' + (data.programActive ? 'Yes' : 'No') + '</p>' +
-                    '<p><strong>Audio Running:</strong> ' + (data.audioRunning ? 'Yes' : 'No') + '</p>' +
-                    '<p><strong>Volume:</strong> ' + data.volume + '%</p>' +
-                    '<p><strong>WiFi:</strong> ' + data.wifi + '</p>' +
-                    '<p><strong>Connection Mode:</strong> ' + (data.connectionMode || 'Unknown') + '</p>' +
-                    '<p><strong>Uptime:</strong> ' + formatUptime(data.uptime) + '</p>' +
-                    '<p><strong>Free Heap:</strong> ' + formatBytes(data.freeHeap) + '</p>';
-                const currentProgramSpan = document.getElementById('currentProgram');
-                if (currentProgramSpan && data.currentProgram) {
-                    currentProgramSpan.textContent = data.currentProgram;
-                    window.currentProgram = data.currentProgram;
-                    updateProgramButtons(data.currentProgram);
-                    updateProgramControls(data.currentProgram.toLowerCase());
-                }
-                statusDiv.classList.add('status-update');
-                setTimeout(() => statusDiv.classList.remove('status-update'), 500);
-            }
-        })
+        .then(mergeStatus)
         .catch(() => {
             const statusDiv = document.getElementById('status');
             if (statusDiv) {
@@ -38,3 +53,37 @@ export function updateStatus() {
             }
         });
 }
+
+function startPolling() {
+    if (pollInterval) return;
+    updateStatus();
+    pollInterval = setInterval(updateStatus, 5000);
+}
+
+// Subscribe to pushed status changes, polling /status when the device has no free slot
+export function subscribeStatus() {
+    if (!window.EventSource) {
+        startPolling();
+        return;
+    }
+    events = new EventSource('/events');
+    events.onmessage = (event) => mergeStatus(JSON.parse(event.data));
+    events.onerror = () => {
+        // A 503 (subscriber cap reached) closes the source for good; network drops reconnect by themselves
+        if (events.readyState === EventSource.CLOSED) {
+            events = null;
+            startPolling();
+        }
+    };
+}
+
+export function unsubscribeStatus() {
+    if (events) {
+        events.close();
+        events = null;
+    }
+    if (pollInterval) {
+        clearInterval(pollInterval);
+        pollInterval = null;
+    }
+}
@@ -10,23 +10,23 @@ let streamState = {
 };
 
 /**
- * Initialize stream mode - fetch stations from API
+ * Initialize stream mode - load stations from the device catalog
  */
 export function initializeStreamMode() {
     console.log('Initializing stream mode...');
-    fetchStationsFromAPI();
+    fetchStationsFromDevice();
     updateStreamUI();
 }
 
 /**
- * Fetch stations from remote API (frontend)
+ * Fetch stations from the catalog cached on the device (works offline)
  */
-async function fetchStationsFromAPI() {
+async function fetchStationsFromDevice() {
     try {
-        console.log('Fetching stations from API...');
-        showNotification('Loading stations...', 'info');
+        console.log('Fetching stations from device catalog...');
         
-        const response = await fetch('https://kolown.net/api/ghostwhisper_playlist');
+        // Served from SD with an ETag, so repeat loads revalidate cheaply
+        const response = await fetch('/stream/list');
         
         if (!response.ok) {
             throw new Error('Failed to fetch stations');
@@ -34,27 +34,29 @@ async function fetchStationsFromAPI() {
         
         const data = await response.json();
         
-        // Convert API response to station array
-        // API format: {"dayang": "https://kolown.net/storage/projects/whisper/Dayang%20Dayang.mp3"}
-        streamState.availableStations = Object.entries(data).map(([name, url]) => ({
+        // Catalog format: {"version": 3, "updated": 1712345678, "count": 1,
+        //                  "stations": {"dayang": "https://kolown.net/storage/projects/whisper/Dayang%20Dayang.mp3"}}
+        streamState.availableStations = Object.entries(data.stations || {}).map(([name, url]) => ({
             name: name,
             url: url
         }));
         
-        console.log(`Loaded ${streamState.availableStations.length} stations from API`);
-        showNotification(`Loaded ${streamState.availableStations.length} stations`, 'success');
-        
-        // Set first station as current
-        if (streamState.availableStations.length > 0) {
-            streamState.currentStation = streamState.availableStations[0].name;
-            streamState.currentIndex = 0;
+        if (streamState.availableStations.length === 0) {
+            throw new Error('Catalog is empty');
         }
         
+        console.log(`Loaded ${streamState.availableStations.length} stations (catalog v${data.version})`);
+        
+        // Keep the current station if it is still in the catalog
+        const keptIndex = streamState.availableStations.findIndex(s => s.name === streamState.currentStation);
+        streamState.currentIndex = keptIndex >= 0 ? keptIndex : 0;
+        streamState.currentStation = streamState.availableStations[streamState.currentIndex].name;
+        
         updateStreamUI();
         
     } catch (error) {
         console.error('Error fetching stations:', error);
-        showNotification('Error loading stations from API', 'error');
+        showNotification('Error loading stations from device', 'error');
         
         // Fallback to hardcoded stations
         streamState.availableStations = [
@@ -118,7 +120,7 @@ export function startStream() {
     
     if (streamState.availableStations.length === 0) {
         showNotification('No stations available - loading...', 'info');
-        fetchStationsFromAPI();
+        fetchStationsFromDevice();
         return;
     }
     
@@ -175,11 +177,17 @@ function updateStreamUI() {
 }
 
 /**
- * Refresh stations from API
+ * Ask the device to refresh its catalog from upstream, then reload it
  */
 export function refreshStations() {
     showNotification('Refreshing stations...', 'info');
-    fetchStationsFromAPI();
+    fetch('/stream/refresh')
+        .then(response => response.json())
+        .then(data => {
+            if (data.status === 'info') showNotification(data.message, 'info');
+        })
+        .catch(error => console.error('Catalog refresh error:', error))
+        .finally(() => setTimeout(fetchStationsFromDevice, 3000));
 }
 
 /**